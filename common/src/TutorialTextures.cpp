@@ -28,10 +28,71 @@ extern VkPhysicalDeviceMemoryProperties tutorialMemoryProperties;
 extern VkCommandPool cmdPool;
 extern VkPhysicalDevice tutorialGpu;
 
+// Record an image layout transition into cmdBuffer
+static void setImageLayout(VkCommandBuffer cmdBuffer, VkImage image,
+                           VkImageLayout oldImageLayout,
+                           VkImageLayout newImageLayout,
+                           VkPipelineStageFlags srcStages,
+                           VkPipelineStageFlags destStages) {
+  VkImageMemoryBarrier imageMemoryBarrier = {
+      .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      .pNext = NULL,
+      .srcAccessMask = 0,
+      .dstAccessMask = 0,
+      .oldLayout = oldImageLayout,
+      .newLayout = newImageLayout,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .image = image,
+      .subresourceRange =
+          {
+              .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+              .baseMipLevel = 0,
+              .levelCount = 1,
+              .baseArrayLayer = 0,
+              .layerCount = 1,
+          },
+  };
+
+  switch (oldImageLayout) {
+    case VK_IMAGE_LAYOUT_PREINITIALIZED:
+      imageMemoryBarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
+      break;
+
+    case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+      imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      break;
+
+    default:
+      break;
+  }
+
+  switch (newImageLayout) {
+    case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+      imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      break;
+
+    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+      imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+      break;
+
+    case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+      imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+      break;
+
+    default:
+      break;
+  }
+
+  vkCmdPipelineBarrier(cmdBuffer, srcStages, destStages, 0, 0, NULL, 0, NULL,
+                       1, &imageMemoryBarrier);
+}
+
 // Open texture file from asset, load it into the created texture
 // The supported texture format is in kTexFmt
-//     Skipping memory barriers the next draw command is far out
-//     by then, the blit will way complete ahead
+//     The linear image is written by the host in PREINITIALIZED layout,
+//     then either transitioned for sampling or copied into an optimal
+//     tiled image, with the barriers the copy needs on both sides
 VkResult tutorialLoadTextureFromFile(const char* filePath,
                                      struct texture_object* tex_obj,
                                      VkImageUsageFlags usage,
@@ -85,6 +146,7 @@ VkResult tutorialLoadTextureFromFile(const char* filePath,
                                VK_IMAGE_USAGE_SAMPLED_BIT),
           .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
           .queueFamilyIndexCount = 0,
+          .initialLayout = VK_IMAGE_LAYOUT_PREINITIALIZED,
           .flags = 0,
   };
   VkMemoryAllocateInfo mem_alloc = {
@@ -135,32 +197,32 @@ VkResult tutorialLoadTextureFromFile(const char* filePath,
   delete [] fileContent;
 
   tex_obj->imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
- 
-  // If linear is supported, we are done
-  if (!needBlit) {
-    return VK_SUCCESS;
-  }
 
   // save current image and mem as staging image and memory
-  VkImage stageImage = tex_obj->image;
-  VkDeviceMemory stageMem = tex_obj->mem;
-  tex_obj->image = VK_NULL_HANDLE;
-  tex_obj->mem   = VK_NULL_HANDLE;
-
-  // Create a tile texture to blit into
-  image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
-  image_create_info.usage  = VK_IMAGE_USAGE_TRANSFER_DST_BIT |
-                             VK_IMAGE_USAGE_SAMPLED_BIT;
-  CALL_VK(vkCreateImage(tutorialDevice, &image_create_info,
-                                    nullptr, &tex_obj->image));
-  vkGetImageMemoryRequirements(tutorialDevice, tex_obj->image, &mem_reqs);
+  VkImage stageImage = VK_NULL_HANDLE;
+  VkDeviceMemory stageMem = VK_NULL_HANDLE;
+  if (needBlit) {
+    stageImage = tex_obj->image;
+    stageMem = tex_obj->mem;
+    tex_obj->image = VK_NULL_HANDLE;
+    tex_obj->mem   = VK_NULL_HANDLE;
 
-  mem_alloc.allocationSize = mem_reqs.size;
-  VK_CHECK(memory_type_from_properties(mem_reqs.memoryTypeBits,
-                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                     &mem_alloc.memoryTypeIndex));
-  CALL_VK(vkAllocateMemory(tutorialDevice, &mem_alloc, nullptr, &tex_obj->mem));
-  CALL_VK(vkBindImageMemory(tutorialDevice, tex_obj->image, tex_obj->mem, 0));
+    // Create a tile texture to blit into
+    image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_create_info.usage  = VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                               VK_IMAGE_USAGE_SAMPLED_BIT;
+    image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    CALL_VK(vkCreateImage(tutorialDevice, &image_create_info,
+                                      nullptr, &tex_obj->image));
+    vkGetImageMemoryRequirements(tutorialDevice, tex_obj->image, &mem_reqs);
+
+    mem_alloc.allocationSize = mem_reqs.size;
+    VK_CHECK(memory_type_from_properties(mem_reqs.memoryTypeBits,
+                                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                       &mem_alloc.memoryTypeIndex));
+    CALL_VK(vkAllocateMemory(tutorialDevice, &mem_alloc, nullptr, &tex_obj->mem));
+    CALL_VK(vkBindImageMemory(tutorialDevice, tex_obj->image, tex_obj->mem, 0));
+  }
 
   VkCommandBuffer gfxCmd;
   const VkCommandBufferAllocateInfo cmd = {
@@ -180,28 +242,50 @@ VkResult tutorialLoadTextureFromFile(const char* filePath,
           .pInheritanceInfo = nullptr};
   CALL_VK(vkBeginCommandBuffer(gfxCmd, &cmd_buf_info));
 
-  VkImageCopy bltInfo = {
-    .srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-    .srcSubresource.mipLevel = 0,
-    .srcSubresource.baseArrayLayer = 0,
-    .srcSubresource.layerCount = 1,
-    .srcOffset.x = 0,
-    .srcOffset.y = 0,
-    .srcOffset.z = 0,
-    .dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-    .dstSubresource.mipLevel = 0,
-    .dstSubresource.baseArrayLayer = 0,
-    .dstSubresource.layerCount = 1,
-    .dstOffset.x = 0,
-    .dstOffset.y = 0,
-    .dstOffset.z = 0,
-    .extent.width = imgWidth,
-    .extent.height = imgHeight,
-    .extent.depth = 1,
-  };
-  vkCmdCopyImage(gfxCmd, stageImage,
-                 VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, tex_obj->image,
-                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bltInfo);
+  // If linear is supported, the host written image only needs to become
+  // readable by the fragment shader
+  if (!needBlit) {
+    setImageLayout(gfxCmd, tex_obj->image, VK_IMAGE_LAYOUT_PREINITIALIZED,
+                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                   VK_PIPELINE_STAGE_HOST_BIT,
+                   VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+  } else {
+    // the staging image was written by the host, the tiled one is brand new
+    setImageLayout(gfxCmd, stageImage, VK_IMAGE_LAYOUT_PREINITIALIZED,
+                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                   VK_PIPELINE_STAGE_HOST_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    setImageLayout(gfxCmd, tex_obj->image, VK_IMAGE_LAYOUT_UNDEFINED,
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                   VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                   VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkImageCopy bltInfo = {
+      .srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .srcSubresource.mipLevel = 0,
+      .srcSubresource.baseArrayLayer = 0,
+      .srcSubresource.layerCount = 1,
+      .srcOffset.x = 0,
+      .srcOffset.y = 0,
+      .srcOffset.z = 0,
+      .dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .dstSubresource.mipLevel = 0,
+      .dstSubresource.baseArrayLayer = 0,
+      .dstSubresource.layerCount = 1,
+      .dstOffset.x = 0,
+      .dstOffset.y = 0,
+      .dstOffset.z = 0,
+      .extent.width = imgWidth,
+      .extent.height = imgHeight,
+      .extent.depth = 1,
+    };
+    vkCmdCopyImage(gfxCmd, stageImage,
+                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, tex_obj->image,
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bltInfo);
+
+    setImageLayout(gfxCmd, tex_obj->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                   VK_PIPELINE_STAGE_TRANSFER_BIT,
+                   VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+  }
 
   CALL_VK(vkEndCommandBuffer(gfxCmd));
   VkFenceCreateInfo fenceInfo = {
@@ -228,7 +312,9 @@ VkResult tutorialLoadTextureFromFile(const char* filePath,
   vkDestroyFence(tutorialDevice, fence, nullptr);
 
   vkFreeCommandBuffers(tutorialDevice, cmdPool, 1, &gfxCmd);
-  vkDestroyImage(tutorialDevice, stageImage, nullptr);
-  vkFreeMemory(tutorialDevice, stageMem, nullptr);
+  if (needBlit) {
+    vkDestroyImage(tutorialDevice, stageImage, nullptr);
+    vkFreeMemory(tutorialDevice, stageMem, nullptr);
+  }
   return VK_SUCCESS;
 }
@@ -0,0 +1,385 @@
+#include "vulkan_profiler.h"
+
+#ifdef VK_WRAPPER_PROFILE
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include "vulkan_wrapper.h"
+
+namespace {
+
+constexpr uint32_t kMaxFunctions = 192;
+// timed calls and frames kept for the trace, the oldest are overwritten
+constexpr size_t kMaxTraceEvents = 65536;
+constexpr size_t kMaxTraceFrames = 4096;
+
+// the calls that can stall or take milliseconds, everything else is only counted
+const char* const kTimedFunctions[] = {
+    "vkCreateGraphicsPipelines", "vkCreateComputePipelines", "vkAllocateMemory", "vkQueueSubmit", "vkQueueWaitIdle",
+    "vkDeviceWaitIdle", "vkWaitForFences", "vkAcquireNextImageKHR", "vkQueuePresentKHR",
+};
+
+struct Counter {
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> ns;
+};
+
+struct TraceEvent {
+    uint32_t function;
+    uint32_t frame;
+    uint32_t thread;
+    uint64_t startNs;
+    uint64_t durationNs;
+};
+
+struct FrameMark {
+    uint32_t frame;
+    uint64_t endNs;
+    uint64_t calls;
+};
+
+const char* g_names[kMaxFunctions];
+bool g_timed[kMaxFunctions];
+uint32_t g_functionCount = 0;
+Counter g_current[kMaxFunctions];
+VulkanProfileEntry g_lastFrame[kMaxFunctions];
+VulkanProfileEntry g_totals[kMaxFunctions];
+std::atomic<uint32_t> g_frame{0};
+
+std::mutex g_traceMutex;
+std::vector<TraceEvent> g_events;
+size_t g_eventCount = 0;  // ever recorded, g_events is a ring of the last kMaxTraceEvents
+std::vector<FrameMark> g_frames;
+size_t g_frameCount = 0;
+
+std::atomic<uint32_t> g_nextThread{0};
+thread_local uint32_t t_thread = g_nextThread++;
+
+uint64_t now_ns() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+// measures one call of a timed function from construction to destruction
+struct CallTimer {
+    uint32_t function;
+    uint64_t start;
+
+    explicit CallTimer(uint32_t id) : function(id), start(now_ns()) {}
+    ~CallTimer() {
+        uint64_t duration = now_ns() - start;
+        g_current[function].ns.fetch_add(duration, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(g_traceMutex);
+        if (g_events.size() < kMaxTraceEvents) {
+            g_events.resize(kMaxTraceEvents);
+        }
+        g_events[g_eventCount++ % kMaxTraceEvents] = {function, g_frame.load(std::memory_order_relaxed), t_thread, start, duration};
+    }
+};
+
+template <int Id, typename F>
+struct Hook;
+
+// stands in for one entry point, Id indexes the counters
+template <int Id, typename R, typename... Args>
+struct Hook<Id, R(VKAPI_PTR*)(Args...)> {
+    static R(VKAPI_PTR* real)(Args...);
+
+    static R VKAPI_PTR call(Args... args) {
+        g_current[Id].calls.fetch_add(1, std::memory_order_relaxed);
+        if (!g_timed[Id]) {
+            return real(args...);
+        }
+        CallTimer timer(Id);
+        return real(args...);
+    }
+};
+
+template <int Id, typename R, typename... Args>
+R(VKAPI_PTR* Hook<Id, R(VKAPI_PTR*)(Args...)>::real)(Args...) = nullptr;
+
+bool is_timed(const char* name) {
+    for (const char* timed : kTimedFunctions) {
+        if (!strcmp(name, timed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// points fn at its hook, unless it is unloaded or already hooked
+template <int Id, typename F>
+void hook(F& fn, const char* name) {
+    static_assert(Id < kMaxFunctions, "raise kMaxFunctions");
+    using H = Hook<Id, F>;
+
+    g_names[Id]     = name;
+    g_timed[Id]     = is_timed(name);
+    g_functionCount = g_functionCount > Id ? g_functionCount : Id + 1;
+    if (!fn || fn == &H::call) {
+        return;
+    }
+    H::real = fn;
+    fn      = &H::call;
+}
+
+}  // namespace
+
+void VulkanProfilerInstall(void) {
+    hook<0>(vkCreateInstance, "vkCreateInstance");
+    hook<1>(vkDestroyInstance, "vkDestroyInstance");
+    hook<2>(vkEnumeratePhysicalDevices, "vkEnumeratePhysicalDevices");
+    hook<3>(vkGetPhysicalDeviceFeatures, "vkGetPhysicalDeviceFeatures");
+    hook<4>(vkGetPhysicalDeviceFormatProperties, "vkGetPhysicalDeviceFormatProperties");
+    hook<5>(vkGetPhysicalDeviceImageFormatProperties, "vkGetPhysicalDeviceImageFormatProperties");
+    hook<6>(vkGetPhysicalDeviceProperties, "vkGetPhysicalDeviceProperties");
+    hook<7>(vkGetPhysicalDeviceQueueFamilyProperties, "vkGetPhysicalDeviceQueueFamilyProperties");
+    hook<8>(vkGetPhysicalDeviceMemoryProperties, "vkGetPhysicalDeviceMemoryProperties");
+    hook<9>(vkGetInstanceProcAddr, "vkGetInstanceProcAddr");
+    hook<10>(vkGetDeviceProcAddr, "vkGetDeviceProcAddr");
+    hook<11>(vkCreateDevice, "vkCreateDevice");
+    hook<12>(vkDestroyDevice, "vkDestroyDevice");
+    hook<13>(vkEnumerateInstanceExtensionProperties, "vkEnumerateInstanceExtensionProperties");
+    hook<14>(vkEnumerateDeviceExtensionProperties, "vkEnumerateDeviceExtensionProperties");
+    hook<15>(vkEnumerateInstanceLayerProperties, "vkEnumerateInstanceLayerProperties");
+    hook<16>(vkEnumerateDeviceLayerProperties, "vkEnumerateDeviceLayerProperties");
+    hook<17>(vkGetDeviceQueue, "vkGetDeviceQueue");
+    hook<18>(vkQueueSubmit, "vkQueueSubmit");
+    hook<19>(vkQueueWaitIdle, "vkQueueWaitIdle");
+    hook<20>(vkDeviceWaitIdle, "vkDeviceWaitIdle");
+    hook<21>(vkAllocateMemory, "vkAllocateMemory");
+    hook<22>(vkFreeMemory, "vkFreeMemory");
+    hook<23>(vkMapMemory, "vkMapMemory");
+    hook<24>(vkUnmapMemory, "vkUnmapMemory");
+    hook<25>(vkFlushMappedMemoryRanges, "vkFlushMappedMemoryRanges");
+    hook<26>(vkInvalidateMappedMemoryRanges, "vkInvalidateMappedMemoryRanges");
+    hook<27>(vkGetDeviceMemoryCommitment, "vkGetDeviceMemoryCommitment");
+    hook<28>(vkBindBufferMemory, "vkBindBufferMemory");
+    hook<29>(vkBindImageMemory, "vkBindImageMemory");
+    hook<30>(vkGetBufferMemoryRequirements, "vkGetBufferMemoryRequirements");
+    hook<31>(vkGetImageMemoryRequirements, "vkGetImageMemoryRequirements");
+    hook<32>(vkGetImageSparseMemoryRequirements, "vkGetImageSparseMemoryRequirements");
+    hook<33>(vkGetPhysicalDeviceSparseImageFormatProperties, "vkGetPhysicalDeviceSparseImageFormatProperties");
+    hook<34>(vkQueueBindSparse, "vkQueueBindSparse");
+    hook<35>(vkCreateFence, "vkCreateFence");
+    hook<36>(vkDestroyFence, "vkDestroyFence");
+    hook<37>(vkResetFences, "vkResetFences");
+    hook<38>(vkGetFenceStatus, "vkGetFenceStatus");
+    hook<39>(vkWaitForFences, "vkWaitForFences");
+    hook<40>(vkCreateSemaphore, "vkCreateSemaphore");
+    hook<41>(vkDestroySemaphore, "vkDestroySemaphore");
+    hook<42>(vkCreateEvent, "vkCreateEvent");
+    hook<43>(vkDestroyEvent, "vkDestroyEvent");
+    hook<44>(vkGetEventStatus, "vkGetEventStatus");
+    hook<45>(vkSetEvent, "vkSetEvent");
+    hook<46>(vkResetEvent, "vkResetEvent");
+    hook<47>(vkCreateQueryPool, "vkCreateQueryPool");
+    hook<48>(vkDestroyQueryPool, "vkDestroyQueryPool");
+    hook<49>(vkGetQueryPoolResults, "vkGetQueryPoolResults");
+    hook<50>(vkCreateBuffer, "vkCreateBuffer");
+    hook<51>(vkDestroyBuffer, "vkDestroyBuffer");
+    hook<52>(vkCreateBufferView, "vkCreateBufferView");
+    hook<53>(vkDestroyBufferView, "vkDestroyBufferView");
+    hook<54>(vkCreateImage, "vkCreateImage");
+    hook<55>(vkDestroyImage, "vkDestroyImage");
+    hook<56>(vkGetImageSubresourceLayout, "vkGetImageSubresourceLayout");
+    hook<57>(vkCreateImageView, "vkCreateImageView");
+    hook<58>(vkDestroyImageView, "vkDestroyImageView");
+    hook<59>(vkCreateShaderModule, "vkCreateShaderModule");
+    hook<60>(vkDestroyShaderModule, "vkDestroyShaderModule");
+    hook<61>(vkCreatePipelineCache, "vkCreatePipelineCache");
+    hook<62>(vkDestroyPipelineCache, "vkDestroyPipelineCache");
+    hook<63>(vkGetPipelineCacheData, "vkGetPipelineCacheData");
+    hook<64>(vkMergePipelineCaches, "vkMergePipelineCaches");
+    hook<65>(vkCreateGraphicsPipelines, "vkCreateGraphicsPipelines");
+    hook<66>(vkCreateComputePipelines, "vkCreateComputePipelines");
+    hook<67>(vkDestroyPipeline, "vkDestroyPipeline");
+    hook<68>(vkCreatePipelineLayout, "vkCreatePipelineLayout");
+    hook<69>(vkDestroyPipelineLayout, "vkDestroyPipelineLayout");
+    hook<70>(vkCreateSampler, "vkCreateSampler");
+    hook<71>(vkDestroySampler, "vkDestroySampler");
+    hook<72>(vkCreateDescriptorSetLayout, "vkCreateDescriptorSetLayout");
+    hook<73>(vkDestroyDescriptorSetLayout, "vkDestroyDescriptorSetLayout");
+    hook<74>(vkCreateDescriptorPool, "vkCreateDescriptorPool");
+    hook<75>(vkDestroyDescriptorPool, "vkDestroyDescriptorPool");
+    hook<76>(vkResetDescriptorPool, "vkResetDescriptorPool");
+    hook<77>(vkAllocateDescriptorSets, "vkAllocateDescriptorSets");
+    hook<78>(vkFreeDescriptorSets, "vkFreeDescriptorSets");
+    hook<79>(vkUpdateDescriptorSets, "vkUpdateDescriptorSets");
+    hook<80>(vkCreateFramebuffer, "vkCreateFramebuffer");
+    hook<81>(vkDestroyFramebuffer, "vkDestroyFramebuffer");
+    hook<82>(vkCreateRenderPass, "vkCreateRenderPass");
+    hook<83>(vkDestroyRenderPass, "vkDestroyRenderPass");
+    hook<84>(vkGetRenderAreaGranularity, "vkGetRenderAreaGranularity");
+    hook<85>(vkCreateCommandPool, "vkCreateCommandPool");
+    hook<86>(vkDestroyCommandPool, "vkDestroyCommandPool");
+    hook<87>(vkResetCommandPool, "vkResetCommandPool");
+    hook<88>(vkAllocateCommandBuffers, "vkAllocateCommandBuffers");
+    hook<89>(vkFreeCommandBuffers, "vkFreeCommandBuffers");
+    hook<90>(vkBeginCommandBuffer, "vkBeginCommandBuffer");
+    hook<91>(vkEndCommandBuffer, "vkEndCommandBuffer");
+    hook<92>(vkResetCommandBuffer, "vkResetCommandBuffer");
+    hook<93>(vkCmdBindPipeline, "vkCmdBindPipeline");
+    hook<94>(vkCmdSetViewport, "vkCmdSetViewport");
+    hook<95>(vkCmdSetScissor, "vkCmdSetScissor");
+    hook<96>(vkCmdSetLineWidth, "vkCmdSetLineWidth");
+    hook<97>(vkCmdSetDepthBias, "vkCmdSetDepthBias");
+    hook<98>(vkCmdSetBlendConstants, "vkCmdSetBlendConstants");
+    hook<99>(vkCmdSetDepthBounds, "vkCmdSetDepthBounds");
+    hook<100>(vkCmdSetStencilCompareMask, "vkCmdSetStencilCompareMask");
+    hook<101>(vkCmdSetStencilWriteMask, "vkCmdSetStencilWriteMask");
+    hook<102>(vkCmdSetStencilReference, "vkCmdSetStencilReference");
+    hook<103>(vkCmdBindDescriptorSets, "vkCmdBindDescriptorSets");
+    hook<104>(vkCmdBindIndexBuffer, "vkCmdBindIndexBuffer");
+    hook<105>(vkCmdBindVertexBuffers, "vkCmdBindVertexBuffers");
+    hook<106>(vkCmdDraw, "vkCmdDraw");
+    hook<107>(vkCmdDrawIndexed, "vkCmdDrawIndexed");
+    hook<108>(vkCmdDrawIndirect, "vkCmdDrawIndirect");
+    hook<109>(vkCmdDrawIndexedIndirect, "vkCmdDrawIndexedIndirect");
+    hook<110>(vkCmdDispatch, "vkCmdDispatch");
+    hook<111>(vkCmdDispatchIndirect, "vkCmdDispatchIndirect");
+    hook<112>(vkCmdCopyBuffer, "vkCmdCopyBuffer");
+    hook<113>(vkCmdCopyImage, "vkCmdCopyImage");
+    hook<114>(vkCmdBlitImage, "vkCmdBlitImage");
+    hook<115>(vkCmdCopyBufferToImage, "vkCmdCopyBufferToImage");
+    hook<116>(vkCmdCopyImageToBuffer, "vkCmdCopyImageToBuffer");
+    hook<117>(vkCmdUpdateBuffer, "vkCmdUpdateBuffer");
+    hook<118>(vkCmdFillBuffer, "vkCmdFillBuffer");
+    hook<119>(vkCmdClearColorImage, "vkCmdClearColorImage");
+    hook<120>(vkCmdClearDepthStencilImage, "vkCmdClearDepthStencilImage");
+    hook<121>(vkCmdClearAttachments, "vkCmdClearAttachments");
+    hook<122>(vkCmdResolveImage, "vkCmdResolveImage");
+    hook<123>(vkCmdSetEvent, "vkCmdSetEvent");
+    hook<124>(vkCmdResetEvent, "vkCmdResetEvent");
+    hook<125>(vkCmdWaitEvents, "vkCmdWaitEvents");
+    hook<126>(vkCmdPipelineBarrier, "vkCmdPipelineBarrier");
+    hook<127>(vkCmdBeginQuery, "vkCmdBeginQuery");
+    hook<128>(vkCmdEndQuery, "vkCmdEndQuery");
+    hook<129>(vkCmdResetQueryPool, "vkCmdResetQueryPool");
+    hook<130>(vkCmdWriteTimestamp, "vkCmdWriteTimestamp");
+    hook<131>(vkCmdCopyQueryPoolResults, "vkCmdCopyQueryPoolResults");
+    hook<132>(vkCmdPushConstants, "vkCmdPushConstants");
+    hook<133>(vkCmdBeginRenderPass, "vkCmdBeginRenderPass");
+    hook<134>(vkCmdNextSubpass, "vkCmdNextSubpass");
+    hook<135>(vkCmdEndRenderPass, "vkCmdEndRenderPass");
+    hook<136>(vkCmdExecuteCommands, "vkCmdExecuteCommands");
+    hook<137>(vkDestroySurfaceKHR, "vkDestroySurfaceKHR");
+    hook<138>(vkGetPhysicalDeviceSurfaceSupportKHR, "vkGetPhysicalDeviceSurfaceSupportKHR");
+    hook<139>(vkGetPhysicalDeviceSurfaceCapabilitiesKHR, "vkGetPhysicalDeviceSurfaceCapabilitiesKHR");
+    hook<140>(vkGetPhysicalDeviceSurfaceFormatsKHR, "vkGetPhysicalDeviceSurfaceFormatsKHR");
+    hook<141>(vkGetPhysicalDeviceSurfacePresentModesKHR, "vkGetPhysicalDeviceSurfacePresentModesKHR");
+    hook<142>(vkCreateSwapchainKHR, "vkCreateSwapchainKHR");
+    hook<143>(vkDestroySwapchainKHR, "vkDestroySwapchainKHR");
+    hook<144>(vkGetSwapchainImagesKHR, "vkGetSwapchainImagesKHR");
+    hook<145>(vkAcquireNextImageKHR, "vkAcquireNextImageKHR");
+    hook<146>(vkQueuePresentKHR, "vkQueuePresentKHR");
+    hook<147>(vkGetPhysicalDeviceDisplayPropertiesKHR, "vkGetPhysicalDeviceDisplayPropertiesKHR");
+    hook<148>(vkGetPhysicalDeviceDisplayPlanePropertiesKHR, "vkGetPhysicalDeviceDisplayPlanePropertiesKHR");
+    hook<149>(vkGetDisplayPlaneSupportedDisplaysKHR, "vkGetDisplayPlaneSupportedDisplaysKHR");
+    hook<150>(vkGetDisplayModePropertiesKHR, "vkGetDisplayModePropertiesKHR");
+    hook<151>(vkCreateDisplayModeKHR, "vkCreateDisplayModeKHR");
+    hook<152>(vkGetDisplayPlaneCapabilitiesKHR, "vkGetDisplayPlaneCapabilitiesKHR");
+    hook<153>(vkCreateDisplayPlaneSurfaceKHR, "vkCreateDisplayPlaneSurfaceKHR");
+    hook<154>(vkCreateSharedSwapchainsKHR, "vkCreateSharedSwapchainsKHR");
+#ifdef VK_USE_PLATFORM_XLIB_KHR
+    hook<155>(vkCreateXlibSurfaceKHR, "vkCreateXlibSurfaceKHR");
+    hook<156>(vkGetPhysicalDeviceXlibPresentationSupportKHR, "vkGetPhysicalDeviceXlibPresentationSupportKHR");
+#endif
+#ifdef VK_USE_PLATFORM_XCB_KHR
+    hook<157>(vkCreateXcbSurfaceKHR, "vkCreateXcbSurfaceKHR");
+    hook<158>(vkGetPhysicalDeviceXcbPresentationSupportKHR, "vkGetPhysicalDeviceXcbPresentationSupportKHR");
+#endif
+#ifdef VK_USE_PLATFORM_WAYLAND_KHR
+    hook<159>(vkCreateWaylandSurfaceKHR, "vkCreateWaylandSurfaceKHR");
+    hook<160>(vkGetPhysicalDeviceWaylandPresentationSupportKHR, "vkGetPhysicalDeviceWaylandPresentationSupportKHR");
+#endif
+#ifdef VK_USE_PLATFORM_MIR_KHR
+    hook<161>(vkCreateMirSurfaceKHR, "vkCreateMirSurfaceKHR");
+    hook<162>(vkGetPhysicalDeviceMirPresentationSupportKHR, "vkGetPhysicalDeviceMirPresentationSupportKHR");
+#endif
+#ifdef VK_USE_PLATFORM_ANDROID_KHR
+    hook<163>(vkCreateAndroidSurfaceKHR, "vkCreateAndroidSurfaceKHR");
+#endif
+#ifdef VK_USE_PLATFORM_WIN32_KHR
+    hook<164>(vkCreateWin32SurfaceKHR, "vkCreateWin32SurfaceKHR");
+    hook<165>(vkGetPhysicalDeviceWin32PresentationSupportKHR, "vkGetPhysicalDeviceWin32PresentationSupportKHR");
+#endif
+#ifdef USE_DEBUG_EXTENTIONS
+    hook<166>(vkCreateDebugReportCallbackEXT, "vkCreateDebugReportCallbackEXT");
+    hook<167>(vkDestroyDebugReportCallbackEXT, "vkDestroyDebugReportCallbackEXT");
+    hook<168>(vkDebugReportMessageEXT, "vkDebugReportMessageEXT");
+#endif
+}
+
+void VulkanProfilerEndFrame(void) {
+    uint64_t frameCalls = 0;
+    for (uint32_t i = 0; i < g_functionCount; i++) {
+        uint64_t calls = g_current[i].calls.exchange(0, std::memory_order_relaxed);
+        uint64_t ns    = g_current[i].ns.exchange(0, std::memory_order_relaxed);
+        g_lastFrame[i] = {g_names[i], calls, ns, g_timed[i]};
+
+        g_totals[i].name  = g_names[i];
+        g_totals[i].timed = g_timed[i];
+        g_totals[i].calls += calls;
+        g_totals[i].ns += ns;
+        frameCalls += calls;
+    }
+
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    if (g_frames.size() < kMaxTraceFrames) {
+        g_frames.resize(kMaxTraceFrames);
+    }
+    g_frames[g_frameCount++ % kMaxTraceFrames] = {g_frame.load(std::memory_order_relaxed), now_ns(), frameCalls};
+    g_frame++;
+}
+
+const VulkanProfileEntry* VulkanProfilerLastFrame(uint32_t* outCount) {
+    *outCount = g_functionCount;
+    return g_lastFrame;
+}
+
+const VulkanProfileEntry* VulkanProfilerTotals(uint32_t* outCount) {
+    *outCount = g_functionCount;
+    return g_totals;
+}
+
+int VulkanProfilerWriteTrace(const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    // timestamps relative to the earliest one kept, in microseconds as the format wants. Events are
+    // recorded when the call ends, one on another thread may have started before the oldest
+    size_t firstEvent = g_eventCount > kMaxTraceEvents ? g_eventCount - kMaxTraceEvents : 0;
+    size_t firstFrame = g_frameCount > kMaxTraceFrames ? g_frameCount - kMaxTraceFrames : 0;
+    uint64_t origin   = UINT64_MAX;
+    for (size_t i = firstEvent; i < g_eventCount; i++) {
+        origin = std::min(origin, g_events[i % kMaxTraceEvents].startNs);
+    }
+    for (size_t i = firstFrame; i < g_frameCount; i++) {
+        origin = std::min(origin, g_frames[i % kMaxTraceFrames].endNs);
+    }
+
+    fprintf(file, "{\"traceEvents\": [\n");
+    const char* separator = "";
+    for (size_t i = firstEvent; i < g_eventCount; i++) {
+        const TraceEvent& event = g_events[i % kMaxTraceEvents];
+        fprintf(file, "%s{\"name\": \"%s\", \"cat\": \"vulkan\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f, \"args\": {\"frame\": %u}}",
+                separator, g_names[event.function], event.thread, (event.startNs - origin) / 1000.0, event.durationNs / 1000.0, event.frame);
+        separator = ",\n";
+    }
+    for (size_t i = firstFrame; i < g_frameCount; i++) {
+        const FrameMark& frame = g_frames[i % kMaxTraceFrames];
+        fprintf(file, "%s{\"name\": \"vulkan calls\", \"ph\": \"C\", \"pid\": 1, \"ts\": %.3f, \"args\": {\"calls\": %llu}}", separator, (frame.endNs - origin) / 1000.0,
+                (unsigned long long)frame.calls);
+        separator = ",\n";
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
+
+#endif  // VK_WRAPPER_PROFILE
@@ -0,0 +1,54 @@
+// Optional profiling shim for the vulkan_wrapper entry points.
+//
+// Built with VK_WRAPPER_PROFILE defined, every function pointer the wrapper sets is replaced by
+// a hook that counts the call, and times it for the expensive entry points (pipeline creation,
+// memory allocation, submits, fence waits, image acquires). Counters are kept per frame, the
+// application marks frame boundaries with VulkanProfilerEndFrame.
+//
+// Without VK_WRAPPER_PROFILE no hooks exist, the pointers go straight to the loader or driver and
+// the functions below compile to nothing.
+#ifndef VULKAN_PROFILER_H
+#define VULKAN_PROFILER_H
+
+#include <stdint.h>
+
+typedef struct VulkanProfileEntry {
+    const char* name;  // entry point, nullptr for slots of functions that were never loaded
+    uint64_t calls;
+    uint64_t ns;  // time spent inside, only for timed entry points
+    int timed;
+} VulkanProfileEntry;
+
+#ifdef VK_WRAPPER_PROFILE
+
+// wraps the current wrapper pointers, called by the Init* functions of the wrapper
+void VulkanProfilerInstall(void);
+
+// closes the current frame: its counters become the last frame stats and are reset
+void VulkanProfilerEndFrame(void);
+// counters of the last completed frame, one entry per wrapper function, count in *outCount
+const VulkanProfileEntry* VulkanProfilerLastFrame(uint32_t* outCount);
+// counters summed over every frame since start
+const VulkanProfileEntry* VulkanProfilerTotals(uint32_t* outCount);
+
+// Writes the timed calls of the most recent frames plus per-frame call counts as a Chrome trace
+// (chrome://tracing or ui.perfetto.dev). Returns 0 if the file can't be written.
+int VulkanProfilerWriteTrace(const char* path);
+
+#else
+
+static inline void VulkanProfilerInstall(void) {}
+static inline void VulkanProfilerEndFrame(void) {}
+static inline const VulkanProfileEntry* VulkanProfilerLastFrame(uint32_t* outCount) {
+    *outCount = 0;
+    return nullptr;
+}
+static inline const VulkanProfileEntry* VulkanProfilerTotals(uint32_t* outCount) {
+    *outCount = 0;
+    return nullptr;
+}
+static inline int VulkanProfilerWriteTrace(const char*) { return 0; }
+
+#endif  // VK_WRAPPER_PROFILE
+
+#endif  // VULKAN_PROFILER_H
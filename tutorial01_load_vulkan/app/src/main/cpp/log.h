@@ -1,9 +1,21 @@
+#pragma once
+#include <cstdlib>
+
+#ifdef __ANDROID__
 #include <android/log.h>
 
 static const char* kTAG = "VKEngine";
 #define LOGI(...) ((void)__android_log_print(ANDROID_LOG_INFO, kTAG, __VA_ARGS__))
 #define LOGW(...) ((void)__android_log_print(ANDROID_LOG_WARN, kTAG, __VA_ARGS__))
 #define LOGE(...) ((void)__android_log_print(ANDROID_LOG_ERROR, kTAG, __VA_ARGS__))
+#else
+#include <cstdio>
+
+// host builds log to stderr, one line per message like logcat
+#define LOGI(...) ((void)fprintf(stderr, "I/VKEngine: "), (void)fprintf(stderr, __VA_ARGS__), (void)fputc('\n', stderr))
+#define LOGW(...) ((void)fprintf(stderr, "W/VKEngine: "), (void)fprintf(stderr, __VA_ARGS__), (void)fputc('\n', stderr))
+#define LOGE(...) ((void)fprintf(stderr, "E/VKEngine: "), (void)fprintf(stderr, __VA_ARGS__), (void)fputc('\n', stderr))
+#endif
 
 #define VK_CHECK(x)                                                 \
     do {                                                            \
@@ -12,4 +24,4 @@ static const char* kTAG = "VKEngine";
             LOGE("Detected Vulkan error: %s", VkResultString(err)); \
             abort();                                                \
         }                                                           \
-    } while (0)
\ No newline at end of file
+    } while (0)
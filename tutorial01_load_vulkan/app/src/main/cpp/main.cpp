@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <android/log.h>
+#include <sys/system_properties.h>
 #include <cassert>
 #include <vector>
 #include <game-activity/native_app_glue/android_native_app_glue.h>
@@ -20,6 +21,7 @@
 #include "vkbootstrap/VkBootstrap.h"
 #include "vk_layerhelper.hpp"
 #include "vk_engine.h"
+#include "platform_android.h"
 
 // Android log function wrappers
 //static const char* kTAG = "VKEngine";
@@ -42,6 +44,9 @@
 
 // Global variables
 VulkanEngine vkEngine{};
+// the engine only sees these through the PlatformWindow and AssetSource interfaces
+AndroidWindow* window_      = nullptr;
+AndroidAssetSource* assets_ = nullptr;
 
 // We will call this function the window is opened.
 // This is where we will initialise everything
@@ -77,12 +82,28 @@ bool initialize(android_app* app) {
         return false;
     }
 
-    vkEngine.init(app);    
+    window_ = new AndroidWindow(app->window);
+    assets_ = new AndroidAssetSource(app->activity->assetManager);
+    // per-frame allocator stats on the sdcard, pull them with adb
+    vkEngine._memoryStatsDir = "/sdcard/";
+    // release builds start without layers and reuse the device capabilities of the last launch
+#ifdef NDEBUG
+    vkEngine._startupProfile = StartupProfile::Production;
+#endif
+    vkEngine._capabilityCachePath = std::string(app->activity->internalDataPath) + "/device_caps.bin";
+    // the pacing mode has no UI, pick it with adb shell setprop debug.vkengine.pacing low-latency
+    char pacing[PROP_VALUE_MAX] = {};
+    if (__system_property_get("debug.vkengine.pacing", pacing) > 0 && !parse_pacing_mode(pacing, vkEngine._pacingMode)) {
+        LOGW("unknown pacing mode %s, use fifo, mailbox, fifo-relaxed or low-latency", pacing);
+    }
+    vkEngine.init(window_, assets_);
 
     // Debug
-    LayerAndExtensions layerHelper{};
-    layerHelper.printLayers();
-    layerHelper.printExtensions();
+    if (vkEngine._startupProfile == StartupProfile::Development) {
+        LayerAndExtensions layerHelper{};
+        layerHelper.printLayers();
+        layerHelper.printExtensions();
+    }
 
     initialized_ = true;
     return 0;
@@ -90,6 +111,10 @@ bool initialize(android_app* app) {
 
 void terminate(void) {
     vkEngine.cleanup();
+    delete window_;
+    delete assets_;
+    window_ = nullptr;
+    assets_ = nullptr;
 }
 
 // Process the next main command.
@@ -0,0 +1,2863 @@
+// Scene replay benchmark for the Linux host build.
+// Renders a scripted scene headless along its deterministic camera path and writes the frame
+// timings, draw counts and memory use as JSON. With a baseline report it also acts as a
+// regression gate, and compare checks two existing reports against each other.
+//
+//   vkengine_bench run [--scene FILE] [--frames N] [--warmup N] [--width W] [--height H]
+//                      [--assets DIR]... [--label TEXT] [--out FILE] [--baseline FILE] [--threshold T]
+//                      [--trace FILE] [--cpu-culling] [--no-occlusion] [--single-queue]
+//                      [--fences] [--msaa N] [--dynamic-resolution] [--gpu-budget MS] [--hud] [--pacing MODE]
+//                      [--check-occlusion]
+//   vkengine_bench compare BASELINE CURRENT [--threshold T]
+//
+//   vkengine_bench dispatch [--calls N] [--repeats N] [--out FILE] [--baseline FILE] [--threshold T]
+//
+//   vkengine_bench startup [--repeats N] [--threads N] [--cache FILE] [--assets DIR]... [--trace FILE]
+//                          [--out FILE] [--baseline FILE] [--threshold T]
+//
+//   vkengine_bench jobs [--items N] [--grain N] [--repeats N] [--max-threads N] [--out FILE]
+//                       [--baseline FILE] [--threshold T]
+//
+//   vkengine_bench transforms [--nodes N] [--repeats N] [--out FILE] [--baseline FILE] [--threshold T]
+//
+//   vkengine_bench renderables [--objects N] [--repeats N] [--out FILE] [--baseline FILE] [--threshold T]
+//
+//   vkengine_bench lods [--mesh FILE] [--assets DIR]... [--repeats N] [--out FILE] [--baseline FILE] [--threshold T]
+//
+//   vkengine_bench meshlets [--mesh FILE] [--assets DIR]... [--objects N] [--repeats N] [--out FILE]
+//                           [--baseline FILE] [--threshold T]
+//
+//   vkengine_bench occlusion [--objects N] [--frames N] [--width W] [--height H] [--out FILE]
+//                            [--baseline FILE] [--threshold T]
+//
+//   vkengine_bench resolution [--frames N] [--budget MS] [--noise F] [--out FILE] [--baseline FILE] [--threshold T]
+//
+//   vkengine_bench hud [--frames N] [--warmup N] [--width W] [--height H] [--budget MS] [--assets DIR]... [--out FILE]
+//                      [--baseline FILE] [--threshold T]
+//
+//   vkengine_bench residency [--frames N] [--live N] [--rate N] [--budget MB] [--out FILE] [--baseline FILE] [--threshold T]
+//
+//   vkengine_bench ring [--frames N] [--capacity BYTES] [--alignment N] [--out FILE] [--baseline FILE] [--threshold T]
+//
+//   vkengine_bench pacing [--frames N] [--refresh MS] [--cpu MS] [--gpu MS] [--out FILE] [--baseline FILE] [--threshold T]
+//
+//   vkengine_bench graph [--width W] [--height H] [--repeats N] [--out FILE] [--baseline FILE] [--threshold T]
+//
+//   vkengine_bench bandwidth [--width W] [--height H] [--out FILE] [--baseline FILE] [--threshold T]
+//
+//   vkengine_bench tasks [--tasks N] [--threads N] [--rounds N] [--out FILE] [--baseline FILE] [--threshold T]
+//
+//   vkengine_bench timeline [--submits N] [--out FILE] [--baseline FILE] [--threshold T]
+//
+// All exit with 2 when a metric regressed by more than the threshold (default 0.05 = 5%). Most metrics
+// are lower is better, the comparison marks the ones where higher is better with (+).
+// run draws the meshlets cull.comp keeps with one indirect call, --cpu-culling switches back to a draw per object
+// and --no-occlusion to frustum and cone culling without the depth pyramid, or with --cpu-culling to
+// drawing every object without the occlusion queries. --single-queue keeps uploads on the graphics queue
+// even when the device has a transfer family, --fences syncs with a fence per submit instead of timeline
+// semaphores, as on Vulkan 1.1 devices without VK_KHR_timeline_semaphore. --msaa renders with up to N
+// samples resolved inside the main pass, which turns the depth pyramid off. pass_bytes is what the main
+// pass moves between tile and external memory, separate_resolve_bytes what it would move storing the
+// samples and resolving them after the pass. --dynamic-resolution renders the scene at the scale that keeps
+// the GPU time under --gpu-budget (default the refresh period) and upscales it, render_scale is where
+// it ended up and resolution_changes how often it moved. --hud draws the performance overlay and adds
+// hud_record_ms, the CPU time its layout and recording took. --pacing paces the frames with fifo (the default),
+// mailbox, fifo-relaxed or low-latency. objects_in_frustum counts the objects drawn_objects is out of.
+// --check-occlusion renders the scene a second time without the depth pyramid and exits with 1 when a scene
+// with occluders draws all of its objects in the frustum, or one without draws other objects than that.
+// dispatch measures the CPU cost of recording vkCmdPushConstants + vkCmdDraw through the loader
+// trampolines against the driver entry points of the vulkan_wrapper device table.
+// startup times engine init with the production profile, cold without the capability database and
+// warm with the one the cold start wrote, next to a serial init and a development profile init with
+// validation. Time to first frame is init plus the first draw() until the GPU finished it, and every
+// init phase of the warm start is a metric of its own.
+// jobs needs no GPU: it stress tests the job system, exiting with 1 when a job ran twice, not at all
+// or before its dependency, then times a transform-like parallel_for on 1, 2, 4.. up to --max-threads threads.
+// transforms needs no GPU either: it times TransformHierarchy::update() on an 8-ary tree of --nodes nodes
+// with 1% and with all of the nodes moved, and exits with 1 when a world matrix or the changed list is wrong.
+// renderables checks RenderableStore handles through random inserts and removals, then times the culling,
+// sort key and transform passes over --objects renderables in the store and in the RenderObject records
+// it replaced, which pointed at their mesh and material.
+// lods bakes the level of detail chain of an OBJ mesh and reports every level's triangles and its error
+// bound against the full mesh, absolute and relative to the mesh radius, plus how often an object
+// wobbling around a switching distance changes level with and without hysteresis. Exits with 1 when
+// the levels don't lose triangles and gain error monotonically or the hysteresis doesn't help.
+// meshlets splits the same mesh into meshlets and reports their sizes, how many triangles the normal
+// cone test removes seen from all around, and what the frustum and cone tests of cull.comp leave of a
+// grid of --objects objects against culling whole objects. Exits with 1 when a meshlet breaks the size
+// limits, the meshlets of a level don't hold its triangles or the cone test culls a front face.
+// occlusion needs no GPU: it runs the two phase occlusion culling of cull.comp on the CPU over a grid of
+// --objects spheres behind a wall while the camera slides past it, and reports how many objects are
+// drawn early, late and how many are actually visible. Exits with 1 when a visible object was culled.
+// resolution needs no GPU either: it drives the dynamic resolution controller with a synthetic trace of
+// --frames GPU times (at least 600), a heavy load, a light one and the heavy one again with --noise
+// jitter, and reports the scales it settles at and how long that takes. Exits with 1 when the scale still
+// moves in the second half of a load, the heavy load stays over --budget or the light one doesn't get
+// back to full size.
+// hud renders the default scene headless without and then with the performance overlay, and reports the
+// frame CPU times of both and what recording the overlay took. Exits with 1 when the overlay drew
+// nothing, recorded anything while off or its p95 recording time is over --budget (default 0.5 ms).
+// residency churns --live buffers of random sizes through a BufferResidency, replacing --rate of them
+// every frame for --frames frames and drawing a working set plus --rate random ones, then lets the
+// defragmentation settle. It reports the evictions, the evicted buffers drawn again, what the
+// defragmentation moved and the pool fragmentation after the churn and settled. Exits with 1 when a
+// buffer reads back wrong contents, the resident buffers go over --budget (default 32 MB) or the
+// defragmentation didn't bring the fragmentation down.
+// ring needs no GPU: it drives the LinearRing of FrameAllocator through --frames frames of odd sized
+// allocations at --alignment (a minUniformBufferOffsetAlignment, default 256) and the smaller alignments of
+// storage and instance data, retiring every frame FRAME_OVERLAP frames later as begin_frame does. Exits
+// with 1 when an offset is misaligned, a live range overlaps another, space comes back before its frame
+// retired or the ring wrapped fewer than 3 times.
+// pacing needs no GPU: it steps FramePacer on a FakeClock against a FIFO display refreshing every --refresh
+// ms (default 60 Hz), with frames of --cpu and --gpu ms and one a refresh period late halfway, in low
+// latency and in fifo mode. It reports the start to present latency of both. Exits with 1 when a settled
+// low latency frame misses its vblank or starts a refresh period or more before it, the late frame misses
+// more than one vblank, the frame after it doesn't make the next one or fifo has the lower latency.
+// graph needs no GPU: it compiles a deferred shading RenderGraph of gbuffer, lighting, bloom, tonemap and an
+// unread debug view over a depth image kept from the last frame, and times compile() over --repeats graphs.
+// Exits with 1 when the debug view isn't culled, a layout transition, source stage or source access differs
+// from the hand derived ones, or the transient images don't alias into 3 blocks of 20 bytes a pixel.
+// bandwidth needs no GPU: it describes the main pass with a stored color target and a transient depth
+// target, the same with 4x MSAA resolved in the pass and a pass loading its color target, and reports the
+// bytes they move between tile and external memory at --width x --height. Exits with 1 when the load or
+// store ops or the bytes of estimate_bandwidth and estimate_separate_resolve differ from the hand computed ones.
+// tasks needs no GPU: it runs a TaskGraph of --tasks tasks of up to 50 us, each depending on up to 3 of the
+// ones added before it, on one and on --threads threads (default 4) for --rounds rounds, and reports the run
+// times and the speedup. Exits with 1 when a task didn't run exactly once, started before a dependency ended
+// or one thread didn't run the tasks in add() order.
+// timeline submits --submits command buffers through the graphics GpuTimeline of a headless engine, once with
+// timeline semaphores and once with the fence fallback, retiring callbacks at their values on the way, and
+// reports what a submit costs the CPU in both. Exits with 1 when a callback ran out of retire order, before
+// its submit's commands were done or not at all once wait() reached its value.
+// On a machine without a GPU point the loader at a software ICD, e.g.
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json vkengine_bench run
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include "vulkan_wrapper.h"
+#include "vk_engine.h"
+#include "vk_bench.h"
+#include "vk_occlusion.h"
+#include "vk_resolution.h"
+#include "vulkan_profiler.h"
+
+#ifndef VKENGINE_SHADER_ROOT
+#define VKENGINE_SHADER_ROOT "."
+#endif
+#ifndef VKENGINE_ASSET_ROOT
+#define VKENGINE_ASSET_ROOT "assets"
+#endif
+
+static int usage(const char* program) {
+    LOGE("usage: %s run [--scene FILE] [--frames N] [--warmup N] [--width W] [--height H] [--assets DIR]... [--label TEXT] [--out FILE] [--baseline FILE] [--threshold T] [--trace FILE] [--cpu-culling] [--no-occlusion] [--single-queue] [--fences] [--msaa N] [--dynamic-resolution] [--gpu-budget MS] [--hud] [--pacing fifo|mailbox|fifo-relaxed|low-latency] [--check-occlusion]", program);
+    LOGE("       %s compare BASELINE CURRENT [--threshold T]", program);
+    LOGE("       %s dispatch [--calls N] [--repeats N] [--out FILE] [--baseline FILE] [--threshold T]", program);
+    LOGE("       %s startup [--repeats N] [--threads N] [--cache FILE] [--assets DIR]... [--trace FILE] [--out FILE] [--baseline FILE] [--threshold T]", program);
+    LOGE("       %s jobs [--items N] [--grain N] [--repeats N] [--max-threads N] [--out FILE] [--baseline FILE] [--threshold T]", program);
+    LOGE("       %s transforms [--nodes N] [--repeats N] [--out FILE] [--baseline FILE] [--threshold T]", program);
+    LOGE("       %s renderables [--objects N] [--repeats N] [--out FILE] [--baseline FILE] [--threshold T]", program);
+    LOGE("       %s lods [--mesh FILE] [--assets DIR]... [--repeats N] [--out FILE] [--baseline FILE] [--threshold T]", program);
+    LOGE("       %s meshlets [--mesh FILE] [--assets DIR]... [--objects N] [--repeats N] [--out FILE] [--baseline FILE] [--threshold T]", program);
+    LOGE("       %s occlusion [--objects N] [--frames N] [--width W] [--height H] [--out FILE] [--baseline FILE] [--threshold T]", program);
+    LOGE("       %s resolution [--frames N] [--budget MS] [--noise F] [--out FILE] [--baseline FILE] [--threshold T]", program);
+    LOGE("       %s hud [--frames N] [--warmup N] [--width W] [--height H] [--budget MS] [--assets DIR]... [--out FILE] [--baseline FILE] [--threshold T]", program);
+    LOGE("       %s residency [--frames N] [--live N] [--rate N] [--budget MB] [--out FILE] [--baseline FILE] [--threshold T]", program);
+    LOGE("       %s ring [--frames N] [--capacity BYTES] [--alignment N] [--out FILE] [--baseline FILE] [--threshold T]", program);
+    LOGE("       %s pacing [--frames N] [--refresh MS] [--cpu MS] [--gpu MS] [--out FILE] [--baseline FILE] [--threshold T]", program);
+    LOGE("       %s graph [--width W] [--height H] [--repeats N] [--out FILE] [--baseline FILE] [--threshold T]", program);
+    LOGE("       %s bandwidth [--width W] [--height H] [--out FILE] [--baseline FILE] [--threshold T]", program);
+    LOGE("       %s tasks [--tasks N] [--threads N] [--rounds N] [--out FILE] [--baseline FILE] [--threshold T]", program);
+    LOGE("       %s timeline [--submits N] [--out FILE] [--baseline FILE] [--threshold T]", program);
+    return 1;
+}
+
+// --out, --baseline and --threshold, the report options every subcommand but compare takes
+struct ReportArgs {
+    const char* outPath;
+    const char* baselinePath{nullptr};
+    double threshold{0.05};
+};
+
+// consumes argv[i] and its value when it is one of the report options
+static bool parse_report_arg(int argc, char** argv, int& i, ReportArgs& args) {
+    if (i + 1 >= argc) {
+        return false;
+    }
+    if (!strcmp(argv[i], "--out")) {
+        args.outPath = argv[++i];
+    } else if (!strcmp(argv[i], "--baseline")) {
+        args.baselinePath = argv[++i];
+    } else if (!strcmp(argv[i], "--threshold")) {
+        args.threshold = atof(argv[++i]);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// prints every metric and returns the number of regressions
+static int print_comparison(const BenchReport& baseline, const BenchReport& current, double threshold) {
+    int regressions = 0;
+    printf("%-28s %14s %14s %9s\n", "metric", "baseline", "current", "change");
+    for (const MetricDelta& delta : compare_reports(baseline, current, threshold)) {
+        // change is how much worse, (+) marks the metrics where higher is better and growing shows as negative
+        std::string name = delta.direction == MetricDirection::HigherIsBetter ? delta.name + " (+)" : delta.name;
+        printf("%-28s %14.4f %14.4f %+8.1f%%%s\n", name.c_str(), delta.baseline, delta.current, delta.change * 100.0, delta.regressed ? "  REGRESSED" : "");
+        regressions += delta.regressed ? 1 : 0;
+    }
+    if (regressions) {
+        printf("%d metric(s) regressed by more than %.1f%%\n", regressions, threshold * 100.0);
+    }
+    return regressions;
+}
+
+// writes and prints the report, then gates it against the baseline: the exit code of every subcommand
+static int finish_report(const BenchReport& report, const ReportArgs& args) {
+    if (!report.write(args.outPath)) {
+        LOGE("can't write %s", args.outPath);
+        return 1;
+    }
+    printf("%s", report.to_json().c_str());
+
+    if (args.baselinePath) {
+        BenchReport baseline;
+        if (!baseline.read(args.baselinePath)) {
+            LOGE("can't read baseline %s", args.baselinePath);
+            return 1;
+        }
+        return print_comparison(baseline, report, args.threshold) ? 2 : 0;
+    }
+    return 0;
+}
+
+// adds the shader and asset roots of the build behind the --assets ones and loads Vulkan, logs why and
+// returns false when there is no loader
+static bool open_vulkan(FileAssetSource& assets) {
+    assets.add_root(VKENGINE_SHADER_ROOT);
+    assets.add_root(VKENGINE_ASSET_ROOT);
+    if (!InitVulkan()) {
+        LOGE("Vulkan is unavailable, install a Vulkan driver and loader");
+        return false;
+    }
+    return true;
+}
+
+// open_vulkan(), then engine with the options set on it initialized headless at extent
+static bool open_headless_engine(VulkanEngine& engine, FileAssetSource& assets, VkExtent2D extent) {
+    if (!open_vulkan(assets)) {
+        return false;
+    }
+    engine.init_headless(&assets, extent);
+    return true;
+}
+
+static int compare(int argc, char** argv) {
+    double threshold = 0.05;
+    const char* paths[2];
+    int pathCount = 0;
+    for (int i = 2; i < argc; i++) {
+        if (!strcmp(argv[i], "--threshold") && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else if (pathCount < 2) {
+            paths[pathCount++] = argv[i];
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (pathCount != 2) {
+        return usage(argv[0]);
+    }
+
+    BenchReport baseline, current;
+    if (!baseline.read(paths[0]) || !current.read(paths[1])) {
+        LOGE("can't read %s or %s", paths[0], paths[1]);
+        return 1;
+    }
+    return print_comparison(baseline, current, threshold) ? 2 : 0;
+}
+
+// the scene again with frustum and cone culling only, drawnObjects of the same frame the measured run ended on
+static uint32_t drawn_without_occlusion(FileAssetSource& assets, const SceneConfig& scene, VkExtent2D extent, uint32_t frames) {
+    VulkanEngine engine{};
+    engine._sceneConfig      = scene;
+    engine._startupProfile   = StartupProfile::Production;
+    engine._occlusionCulling = false;
+    engine._occlusionQueries = false;
+    engine.init_headless(&assets, extent);
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        engine._view = scene.camera.view(frame);
+        engine.draw();
+    }
+    uint32_t drawn = engine._stats.drawnObjects;
+    engine.cleanup();
+    return drawn;
+}
+
+static int run(int argc, char** argv) {
+    const char* scenePath   = nullptr;
+    ReportArgs args         = {"bench.json"};
+    const char* label       = "";
+    const char* tracePath   = nullptr;
+    uint32_t frames         = 600;
+    uint32_t warmup         = 60;
+    VkExtent2D extent       = {1280, 720};
+    bool gpuCulling         = true;
+    bool occlusionCulling   = true;
+    bool asyncQueues        = true;
+    bool timelineSemaphores = true;
+    uint32_t msaaSamples    = 1;
+    bool dynamicResolution  = false;
+    double gpuBudgetMs      = 0.0;
+    bool hud                = false;
+    PacingMode pacingMode   = PacingMode::Fifo;
+    bool checkOcclusion     = false;
+    FileAssetSource assets;
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (parse_report_arg(argc, argv, i, args)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--scene") && hasValue) {
+            scenePath = argv[++i];
+        } else if (!strcmp(argv[i], "--frames") && hasValue) {
+            frames = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--warmup") && hasValue) {
+            warmup = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--width") && hasValue) {
+            extent.width = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--height") && hasValue) {
+            extent.height = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--assets") && hasValue) {
+            assets.add_root(argv[++i]);
+        } else if (!strcmp(argv[i], "--trace") && hasValue) {
+            tracePath = argv[++i];
+        } else if (!strcmp(argv[i], "--label") && hasValue) {
+            label = argv[++i];
+        } else if (!strcmp(argv[i], "--cpu-culling")) {
+            gpuCulling = false;
+        } else if (!strcmp(argv[i], "--no-occlusion")) {
+            occlusionCulling = false;
+        } else if (!strcmp(argv[i], "--single-queue")) {
+            asyncQueues = false;
+        } else if (!strcmp(argv[i], "--fences")) {
+            timelineSemaphores = false;
+        } else if (!strcmp(argv[i], "--msaa") && hasValue) {
+            msaaSamples = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--dynamic-resolution")) {
+            dynamicResolution = true;
+        } else if (!strcmp(argv[i], "--gpu-budget") && hasValue) {
+            gpuBudgetMs = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--hud")) {
+            hud = true;
+        } else if (!strcmp(argv[i], "--pacing") && hasValue && parse_pacing_mode(argv[i + 1], pacingMode)) {
+            i++;
+        } else if (!strcmp(argv[i], "--check-occlusion")) {
+            checkOcclusion = true;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    SceneConfig scene;
+    if (scenePath) {
+        FileAssetSource files;
+        files.add_root("");
+        std::vector<char> script;
+        std::string error;
+        if (!files.read(scenePath, script)) {
+            LOGE("can't read scene %s", scenePath);
+            return 1;
+        }
+        if (!parse_scene_script(std::string(script.begin(), script.end()), scene, error)) {
+            LOGE("%s: %s", scenePath, error.c_str());
+            return 1;
+        }
+    }
+
+    VulkanEngine engine{};
+    engine._sceneConfig                 = scene;
+    engine._startupProfile              = StartupProfile::Production;
+    engine._gpuCulling                  = gpuCulling;
+    engine._occlusionCulling            = occlusionCulling;
+    engine._occlusionQueries            = occlusionCulling;
+    engine._asyncQueues                 = asyncQueues;
+    engine._timelineSemaphores          = timelineSemaphores;
+    engine._msaaSamples                 = msaaSamples;
+    engine._dynamicResolution           = dynamicResolution;
+    engine._resolutionSettings.budgetNs = (uint64_t)(gpuBudgetMs * 1e6);
+    engine._hud                         = hud;
+    engine._pacingMode                  = pacingMode;
+    if (!open_headless_engine(engine, assets, extent)) {
+        return 1;
+    }
+    if (checkOcclusion && !(engine._gpuCulling && engine._occlusionCulling)) {
+        LOGE("--check-occlusion needs the depth pyramid, it is off with --cpu-culling, --no-occlusion and --msaa");
+        engine.cleanup();
+        return 1;
+    }
+
+    std::vector<double> cpuMs, gpuMs, apiCalls, hudMs;
+    RenderStats stats      = {};
+    MemoryUsage peakMemory = {};
+    SteadyClock clock;
+    uint64_t measureStart = 0;
+    // objects in each of the last frames' frusta, the draw counts arrive FRAME_OVERLAP frames late
+    std::deque<uint32_t> frustumObjects;
+
+    uint32_t total = warmup + frames;
+    for (uint32_t frame = 0; frame < total; frame++) {
+        if (frame == warmup) {
+            measureStart = clock.now_ns();
+        }
+        engine._view = scene.camera.view(frame);
+        engine.draw();
+        if (engine._gpuCulling) {
+            const RenderBounds* bounds = engine._renderables.bounds();
+            uint32_t inside            = 0;
+            for (uint32_t i = 0; i < engine._renderables.size(); i++) {
+                inside += sphere_in_frustum(engine._cullConstants.planes, bounds[i].center, bounds[i].radius) ? 1 : 0;
+            }
+            frustumObjects.push_back(inside);
+            if (frustumObjects.size() > FRAME_OVERLAP + 1) {
+                frustumObjects.pop_front();
+            }
+        }
+
+        // start to submit, including the wait for the frame slot
+        const FrameTiming& timing = engine._pacer.timing(frame);
+        if (frame >= warmup) {
+            cpuMs.push_back((timing.submitNs - timing.startNs) / 1e6);
+            stats = engine._stats;
+            if (engine._hud) {
+                hudMs.push_back(engine._perfHud.record_ns() / 1e6);
+            }
+
+            MemoryUsage memory         = engine.memory_usage();
+            peakMemory.allocationBytes = std::max(peakMemory.allocationBytes, memory.allocationBytes);
+            peakMemory.blockBytes      = std::max(peakMemory.blockBytes, memory.blockBytes);
+
+            // draw() closed the previous frame's API counters, empty without the wrapper profiler
+            uint32_t count                    = 0;
+            const VulkanProfileEntry* entries = VulkanProfilerLastFrame(&count);
+            uint64_t calls                    = 0;
+            for (uint32_t i = 0; i < count; i++) {
+                calls += entries[i].calls;
+            }
+            if (count > 0 && frame > warmup) {
+                apiCalls.push_back((double)calls);
+            }
+        }
+        // GPU times arrive once the frame slot comes around again
+        if (frame >= warmup + FRAME_OVERLAP) {
+            const FrameTiming& finished = engine._pacer.timing(frame - FRAME_OVERLAP);
+            if (finished.gpuNs) {
+                gpuMs.push_back(finished.gpuNs / 1e6);
+            }
+        }
+    }
+    double wallMs = (clock.now_ns() - measureStart) / 1e6;
+    // the frame the draw counts in stats belong to
+    uint32_t inFrustum = frustumObjects.empty() ? 0 : frustumObjects.front();
+
+    BenchReport report;
+    report.set_info("label", label);
+    report.set_info("scene", scenePath ? scenePath : "default");
+    report.set_info("device", engine._gpuProperties.deviceName);
+    report.set_info("extent", std::to_string(extent.width) + "x" + std::to_string(extent.height));
+    report.set_info("frames", std::to_string(frames));
+    report.set_info("culling", engine._gpuCulling ? "gpu" : "cpu");
+    report.set_info("occlusion", engine._occlusionCulling ? "depth pyramid" : !engine._occlusionQueries ? "off" : engine._queries._conditional ? "conditional rendering" : "queries");
+    const vkutil::QueueTopology& queues = engine._queueTopology;
+    report.set_info("queues", "graphics " + std::to_string(queues.graphicsFamily) + ", compute " + std::to_string(queues.computeFamily) + ", transfer " + std::to_string(queues.transferFamily));
+    report.set_info("sync", engine._timelineSemaphores ? "timeline semaphores" : "fences");
+    report.set_info("msaa", std::to_string(engine._sampleCount));
+    report.set_info("pacing", pacing_mode_name(engine._pacingMode));
+    report.add_metric("frame_ms", frames ? wallMs / frames : 0.0);
+    report.add_stats("cpu_ms", summarize(cpuMs));
+    if (!gpuMs.empty()) {
+        report.add_stats("gpu_ms", summarize(gpuMs));
+    }
+    report.add_metric("objects", stats.objects);
+    report.add_metric("draws", stats.draws);
+    report.add_metric("pipeline_binds", stats.pipelineBinds);
+    report.add_metric("descriptor_binds", stats.descriptorBinds);
+    report.add_metric("vertex_buffer_binds", stats.vertexBufferBinds);
+    report.add_metric("vertices", (double)stats.vertices);
+    report.add_metric("meshlets", stats.meshlets);
+    if (engine._gpuCulling) {
+        report.add_metric("objects_in_frustum", inFrustum);
+        report.add_metric("drawn_objects", stats.drawnObjects);
+        report.add_metric("late_objects", stats.lateObjects);
+        report.add_metric("meshlet_draws", stats.meshletDraws);
+    }
+    if (engine._occlusionQueries) {
+        report.add_metric("occlusion_queries", stats.occlusionQueries);
+        report.add_metric("skipped_draws", stats.skippedDraws, MetricDirection::HigherIsBetter);
+    }
+    // at the extent of the last frame, with dynamic resolution the main pass covers only part of the attachments
+    report.add_metric("pass_bytes", (double)engine._mainPass.estimate_bandwidth(engine._renderExtent).total());
+    if (engine._sampleCount != VK_SAMPLE_COUNT_1_BIT) {
+        report.add_metric("separate_resolve_bytes", (double)engine._mainPass.estimate_separate_resolve(engine._renderExtent).total());
+    }
+    if (engine._dynamicResolution) {
+        report.add_metric("render_scale", engine._resolution.scale(), MetricDirection::HigherIsBetter);
+        report.add_metric("resolution_changes", engine._resolution.changes());
+    }
+    report.add_metric("memory_allocated_bytes", (double)peakMemory.allocationBytes);
+    report.add_metric("memory_block_bytes", (double)peakMemory.blockBytes);
+    if (!hudMs.empty()) {
+        report.add_stats("hud_record_ms", summarize(hudMs));
+    }
+    if (!apiCalls.empty()) {
+        report.add_stats("api_calls", summarize(apiCalls));
+    }
+    if (tracePath && !VulkanProfilerWriteTrace(tracePath)) {
+        LOGE("can't write %s, the trace needs a build with VKENGINE_PROFILE_API", tracePath);
+    }
+
+    engine.cleanup();
+
+    // an occluder has to hide part of what is in the frustum, and without one the depth pyramid must not
+    // change what is drawn
+    if (checkOcclusion) {
+        uint32_t unoccluded = drawn_without_occlusion(assets, scene, extent, total);
+        report.add_metric("no_occlusion_drawn_objects", unoccluded);
+        bool hidden = !scene.occluders.empty();
+        if (hidden ? stats.drawnObjects >= inFrustum : stats.drawnObjects != unoccluded) {
+            LOGE("run: %u objects drawn of %u in the frustum, %u without occlusion culling, the scene %s occluders", stats.drawnObjects, inFrustum, unoccluded, hidden ? "has" : "has no");
+            return 1;
+        }
+    }
+
+    return finish_report(report, args);
+}
+
+// records calls push constant + draw pairs through the given entry points, returns ns per pair.
+// Only the recording is timed, the command buffer is never submitted
+static double record_pairs(VulkanEngine& engine, VkCommandPool pool, VkCommandBuffer cmd, Material* material, PFN_vkCmdPushConstants pushConstants, PFN_vkCmdDraw draw, uint32_t calls) {
+    VK_CHECK(vkResetCommandPool(engine._device, pool, 0));
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK(vkBeginCommandBuffer(cmd, &beginInfo));
+
+    VkClearValue clearValues[2] = {};
+    clearValues[1].depthStencil = {1.f, 0};
+
+    VkRenderPassBeginInfo rpInfo = {};
+    rpInfo.sType                 = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    rpInfo.renderPass            = engine._renderPass;
+    rpInfo.framebuffer           = engine._framebuffers[0];
+    rpInfo.renderArea.extent     = engine._windowExtent;
+    rpInfo.clearValueCount       = 2;
+    rpInfo.pClearValues          = clearValues;
+    vkCmdBeginRenderPass(cmd, &rpInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, material->pipeline);
+
+    MeshPushConstants constants = {};
+    SteadyClock clock;
+    uint64_t start = clock.now_ns();
+    for (uint32_t i = 0; i < calls; i++) {
+        constants.data.x = i;
+        pushConstants(cmd, material->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstants), &constants);
+        draw(cmd, 3, 1, 0, i % kMaxObjects);
+    }
+    uint64_t elapsed = clock.now_ns() - start;
+
+    vkCmdEndRenderPass(cmd);
+    VK_CHECK(vkEndCommandBuffer(cmd));
+    return calls ? (double)elapsed / calls : 0.0;
+}
+
+static int dispatch(int argc, char** argv) {
+    ReportArgs args  = {"dispatch.json"};
+    uint32_t calls   = 100000;
+    uint32_t repeats = 15;
+    FileAssetSource assets;
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (parse_report_arg(argc, argv, i, args)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--calls") && hasValue) {
+            calls = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--repeats") && hasValue) {
+            repeats = (uint32_t)atoi(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    // a tiny scene, only the pipeline and render pass are needed
+    VulkanEngine engine{};
+    engine._sceneConfig.objectCount = 0;
+    engine._startupProfile          = StartupProfile::Production;
+    if (!open_headless_engine(engine, assets, {64, 64})) {
+        return 1;
+    }
+    Material* material = engine.get_material("defaultmesh");
+
+    VkCommandPoolCreateInfo poolInfo = {};
+    poolInfo.sType                   = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex        = engine._graphicsQueueFamily;
+    VkCommandPool pool;
+    VK_CHECK(vkCreateCommandPool(engine._device, &poolInfo, nullptr, &pool));
+
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool                 = pool;
+    allocInfo.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount          = 1;
+    VkCommandBuffer cmd;
+    VK_CHECK(vkAllocateCommandBuffers(engine._device, &allocInfo, &cmd));
+
+    // vkGetInstanceProcAddr hands out the loader trampolines for device functions
+    auto trampolinePush = (PFN_vkCmdPushConstants)vkGetInstanceProcAddr(engine._instance, "vkCmdPushConstants");
+    auto trampolineDraw = (PFN_vkCmdDraw)vkGetInstanceProcAddr(engine._instance, "vkCmdDraw");
+    VulkanDeviceTable table;
+    LoadVulkanDeviceTable(engine._device, &table);
+
+    // one untimed pass grows the command buffer to full size first, then interleave the two
+    // so clock changes and cache state hit both alike
+    std::vector<double> trampolineNs, directNs;
+    record_pairs(engine, pool, cmd, material, table.vkCmdPushConstants, table.vkCmdDraw, calls);
+    for (uint32_t r = 0; r < repeats; r++) {
+        trampolineNs.push_back(record_pairs(engine, pool, cmd, material, trampolinePush, trampolineDraw, calls));
+        directNs.push_back(record_pairs(engine, pool, cmd, material, table.vkCmdPushConstants, table.vkCmdDraw, calls));
+    }
+
+    vkDestroyCommandPool(engine._device, pool, nullptr);
+
+    SampleStats trampoline = summarize(trampolineNs);
+    SampleStats direct     = summarize(directNs);
+
+    BenchReport report;
+    report.set_info("device", engine._gpuProperties.deviceName);
+    report.set_info("calls", std::to_string(calls));
+    report.set_info("repeats", std::to_string(repeats));
+    report.add_metric("trampoline_ns_per_pair_p50", trampoline.p50);
+    report.add_metric("trampoline_ns_per_pair_min", *std::min_element(trampolineNs.begin(), trampolineNs.end()));
+    report.add_metric("device_table_ns_per_pair_p50", direct.p50);
+    report.add_metric("device_table_ns_per_pair_min", *std::min_element(directNs.begin(), directNs.end()));
+
+    engine.cleanup();
+
+    printf("device table saves %.2f ns per push constant + draw pair (median)\n", trampoline.p50 - direct.p50);
+    return finish_report(report, args);
+}
+
+struct StartupSample {
+    double initMs;
+    double initVulkanMs;
+    double firstFrameMs;
+    bool cached;
+    std::vector<std::pair<std::string, double>> phaseMs;
+};
+
+// one full engine init, first frame and cleanup, the scene is the default one
+static StartupSample measure_startup(FileAssetSource& assets, StartupProfile profile, const char* cachePath, uint32_t threads, const char* tracePath) {
+    SteadyClock clock;
+    VulkanEngine engine{};
+    engine._startupProfile      = profile;
+    engine._capabilityCachePath = cachePath ? cachePath : "";
+    engine._initThreads         = threads;
+    engine._startupTracePath    = tracePath ? tracePath : "";
+
+    uint64_t start = clock.now_ns();
+    engine.init_headless(&assets, {256, 256});
+    uint64_t initEnd = clock.now_ns();
+    engine.draw();
+    VK_CHECK(vkDeviceWaitIdle(engine._device));
+    uint64_t frameEnd = clock.now_ns();
+
+    StartupSample sample = {(initEnd - start) / 1e6, engine.startup_phase_ns("vulkan") / 1e6, (frameEnd - start) / 1e6, engine._capabilitiesCached, {}};
+    for (uint32_t i = 0; i < engine._initGraph.task_count(); i++) {
+        sample.phaseMs.push_back({engine._initGraph.name(i), engine.startup_phase_ns(engine._initGraph.name(i)) / 1e6});
+    }
+    engine.cleanup();
+    return sample;
+}
+
+static int startup(int argc, char** argv) {
+    ReportArgs args       = {"startup.json"};
+    const char* cachePath = "bench_device_caps.bin";
+    const char* tracePath = nullptr;
+    uint32_t repeats      = 5;
+    uint32_t threads      = 0;
+    FileAssetSource assets;
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (parse_report_arg(argc, argv, i, args)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--repeats") && hasValue) {
+            repeats = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--threads") && hasValue) {
+            threads = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--trace") && hasValue) {
+            tracePath = argv[++i];
+        } else if (!strcmp(argv[i], "--cache") && hasValue) {
+            cachePath = argv[++i];
+        } else if (!strcmp(argv[i], "--assets") && hasValue) {
+            assets.add_root(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (!open_vulkan(assets)) {
+        return 1;
+    }
+
+    // the first init pays for loading the driver and warming the file cache, it isn't counted
+    measure_startup(assets, StartupProfile::Production, nullptr, threads, nullptr);
+
+    std::vector<double> coldMs, warmMs, serialMs, developmentMs, coldVulkanMs, warmVulkanMs, firstFrameMs;
+    std::vector<std::pair<std::string, std::vector<double>>> phaseMs;
+    for (uint32_t r = 0; r < repeats; r++) {
+        remove(cachePath);
+        StartupSample cold = measure_startup(assets, StartupProfile::Production, cachePath, threads, nullptr);
+        // the trace shows the last warm start
+        StartupSample warm = measure_startup(assets, StartupProfile::Production, cachePath, threads, r + 1 == repeats ? tracePath : nullptr);
+        if (cold.cached || !warm.cached) {
+            LOGE("the capability database at %s wasn't written or read back", cachePath);
+            return 1;
+        }
+        StartupSample serial      = measure_startup(assets, StartupProfile::Production, cachePath, 1, nullptr);
+        StartupSample development = measure_startup(assets, StartupProfile::Development, nullptr, threads, nullptr);
+
+        coldMs.push_back(cold.initMs);
+        coldVulkanMs.push_back(cold.initVulkanMs);
+        warmMs.push_back(warm.initMs);
+        warmVulkanMs.push_back(warm.initVulkanMs);
+        firstFrameMs.push_back(warm.firstFrameMs);
+        serialMs.push_back(serial.initMs);
+        developmentMs.push_back(development.initMs);
+        phaseMs.resize(warm.phaseMs.size());
+        for (size_t i = 0; i < warm.phaseMs.size(); i++) {
+            phaseMs[i].first = warm.phaseMs[i].first;
+            phaseMs[i].second.push_back(warm.phaseMs[i].second);
+        }
+    }
+    remove(cachePath);
+
+    BenchReport report;
+    report.set_info("repeats", std::to_string(repeats));
+    report.set_info("threads", std::to_string(threads));
+    report.add_metric("cold_init_ms_p50", summarize(coldMs).p50);
+    report.add_metric("cold_init_vulkan_ms_p50", summarize(coldVulkanMs).p50);
+    report.add_metric("warm_init_ms_p50", summarize(warmMs).p50);
+    report.add_metric("warm_init_vulkan_ms_p50", summarize(warmVulkanMs).p50);
+    report.add_metric("warm_first_frame_ms_p50", summarize(firstFrameMs).p50);
+    report.add_metric("serial_init_ms_p50", summarize(serialMs).p50);
+    report.add_metric("development_init_ms_p50", summarize(developmentMs).p50);
+    for (auto& phase : phaseMs) {
+        std::string name = phase.first;
+        std::replace(name.begin(), name.end(), ' ', '_');
+        report.add_metric("phase_" + name + "_ms_p50", summarize(phase.second).p50);
+    }
+
+    return finish_report(report, args);
+}
+
+// runs the job system through the cases the engine relies on, returns the number of failures
+static int stress_jobs(uint32_t workers) {
+    vkutil::JobSystem pool;
+    pool.init(workers);
+    int failures = 0;
+
+    // every index exactly once, with a range that doesn't divide into the grain
+    const uint32_t count = 100003;
+    std::vector<std::atomic<uint32_t>> visits(count);
+    pool.parallel_for(0, count, 97, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            visits[i].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    for (uint32_t i = 0; i < count; i++) {
+        if (visits[i].load() != 1) {
+            LOGE("jobs with %u workers: parallel_for visited %u %u times", workers, i, visits[i].load());
+            failures++;
+            break;
+        }
+    }
+
+    // jobs waiting on jobs of their own
+    std::atomic<uint32_t> nested{0};
+    vkutil::JobCounter outer;
+    for (uint32_t i = 0; i < 64; i++) {
+        pool.run([&]() { pool.parallel_for(0, 1000, 10, [&](uint32_t begin, uint32_t end) { nested += end - begin; }); }, &outer);
+    }
+    pool.wait(outer);
+    if (nested.load() != 64 * 1000) {
+        LOGE("jobs with %u workers: nested jobs counted %u of %u items", workers, nested.load(), 64 * 1000);
+        failures++;
+    }
+
+    // a chain of dependent groups
+    std::atomic<uint32_t> stage{0};
+    std::atomic<bool> early{false};
+    vkutil::JobCounter first, second;
+    for (uint32_t i = 0; i < 100; i++) {
+        pool.run([&]() { stage++; }, &first);
+    }
+    for (uint32_t i = 0; i < 100; i++) {
+        pool.run_after(first, [&]() { early = early || stage.load() < 100; }, &second);
+    }
+    pool.wait(second);
+    if (early.load()) {
+        LOGE("jobs with %u workers: a job ran before its dependency", workers);
+        failures++;
+    }
+
+    // more jobs than a deque holds, queued from the main thread and from a thread outside the system
+    std::atomic<uint32_t> ran{0};
+    vkutil::JobCounter many, foreign;
+    for (uint32_t i = 0; i < 3 * vkutil::JobDeque::kCapacity; i++) {
+        pool.run([&]() { ran++; }, &many);
+    }
+    std::thread outside([&]() {
+        for (uint32_t i = 0; i < 1000; i++) {
+            pool.run([&]() { ran++; }, &foreign);
+        }
+        pool.wait(foreign);
+    });
+    pool.wait(many);
+    outside.join();
+    if (ran.load() != 3 * vkutil::JobDeque::kCapacity + 1000) {
+        LOGE("jobs with %u workers: %u of %u queued jobs ran", workers, ran.load(), (uint32_t)(3 * vkutil::JobDeque::kCapacity + 1000));
+        failures++;
+    }
+    return failures;
+}
+
+static int jobs(int argc, char** argv) {
+    ReportArgs args     = {"jobs.json"};
+    uint32_t items      = 1 << 20;
+    uint32_t grain      = 1024;
+    uint32_t repeats    = 15;
+    uint32_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (parse_report_arg(argc, argv, i, args)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--items") && hasValue) {
+            items = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--grain") && hasValue) {
+            grain = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--repeats") && hasValue) {
+            repeats = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--max-threads") && hasValue) {
+            maxThreads = std::max(1, atoi(argv[++i]));
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    // a few rounds, races rarely show on the first one
+    for (uint32_t round = 0; round < 20; round++) {
+        for (uint32_t threads = 1; threads <= maxThreads; threads *= 2) {
+            if (stress_jobs(threads - 1)) {
+                return 1;
+            }
+        }
+    }
+
+    // parent * local for every item, what a scene transform update does
+    std::vector<glm::mat4> local(items, glm::translate(glm::mat4{1.f}, glm::vec3{1.f, 2.f, 3.f}));
+    std::vector<glm::mat4> world(items);
+    glm::mat4 parent = glm::rotate(glm::mat4{1.f}, 0.5f, glm::vec3{0.f, 1.f, 0.f});
+
+    SteadyClock clock;
+    BenchReport report;
+    report.set_info("items", std::to_string(items));
+    report.set_info("grain", std::to_string(grain));
+    report.set_info("repeats", std::to_string(repeats));
+    double singleMs = 0.0;
+    for (uint32_t threads = 1; threads <= maxThreads; threads *= 2) {
+        vkutil::JobSystem pool;
+        pool.init(threads - 1);
+        std::vector<double> ms;
+        for (uint32_t r = 0; r <= repeats; r++) {
+            uint64_t start = clock.now_ns();
+            pool.parallel_for(0, items, grain, [&](uint32_t begin, uint32_t end) {
+                for (uint32_t i = begin; i < end; i++) {
+                    world[i] = parent * local[i];
+                }
+            });
+            // the first pass only warms the caches and wakes the workers
+            if (r > 0) {
+                ms.push_back((clock.now_ns() - start) / 1e6);
+            }
+        }
+
+        // the cost of one empty job from queueing to done
+        const uint32_t emptyJobs = 100000;
+        vkutil::JobCounter counter;
+        uint64_t start = clock.now_ns();
+        for (uint32_t i = 0; i < emptyJobs; i++) {
+            pool.run([]() {}, &counter);
+        }
+        pool.wait(counter);
+        double jobNs = (double)(clock.now_ns() - start) / emptyJobs;
+
+        double p50         = summarize(ms).p50;
+        singleMs           = threads == 1 ? p50 : singleMs;
+        std::string suffix = "_" + std::to_string(threads) + "t";
+        report.add_metric("parallel_for_ms_p50" + suffix, p50);
+        report.add_metric("empty_job_ns" + suffix, jobNs);
+        if (threads > 1) {
+            report.add_metric("speedup" + suffix, singleMs / p50, MetricDirection::HigherIsBetter);
+        }
+        printf("%2u threads: %8.3f ms, %.2fx, %.0f ns per empty job\n", threads, p50, singleMs / p50, jobNs);
+    }
+
+    return finish_report(report, args);
+}
+
+// checks the last update() against a recompute from scratch, moved flags the nodes set_local() was called on
+static bool check_transforms(const TransformHierarchy& hierarchy, const std::vector<uint8_t>& moved) {
+    std::vector<glm::mat4> world(hierarchy.size());
+    std::vector<uint8_t> below(hierarchy.size());
+    std::vector<uint32_t> expected;
+    for (uint32_t node = 0; node < hierarchy.size(); node++) {
+        uint32_t parent = hierarchy.parent(node);
+        glm::mat4 local = hierarchy.local(node).matrix();
+        world[node]     = parent == TransformHierarchy::kNoParent ? local : world[parent] * local;
+        below[node]     = moved[node] || (parent != TransformHierarchy::kNoParent && below[parent]);
+        if (below[node]) {
+            expected.push_back(node);
+        }
+        if (world[node] != hierarchy.world(node)) {
+            LOGE("transforms: world matrix of node %u is stale", node);
+            return false;
+        }
+    }
+    if (expected != hierarchy.changed()) {
+        LOGE("transforms: %zu nodes listed as changed, expected %zu", hierarchy.changed().size(), expected.size());
+        return false;
+    }
+    return true;
+}
+
+static int transforms(int argc, char** argv) {
+    ReportArgs args  = {"transforms.json"};
+    uint32_t nodes   = 100000;
+    uint32_t repeats = 50;
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (parse_report_arg(argc, argv, i, args)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--nodes") && hasValue) {
+            nodes = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--repeats") && hasValue) {
+            repeats = (uint32_t)atoi(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    // breadth first 8-ary tree, most nodes are leaves a few levels down like in a real scene
+    TransformHierarchy hierarchy;
+    SceneRandom random(1);
+    for (uint32_t node = 0; node < nodes; node++) {
+        Transform local;
+        local.translation = glm::vec3((float)(random.next() % 100), 0.f, (float)(random.next() % 100)) * 0.01f;
+        hierarchy.add(node == 0 ? TransformHierarchy::kNoParent : (node - 1) / 8, local);
+    }
+    hierarchy.update();
+
+    SteadyClock clock;
+    BenchReport report;
+    report.set_info("nodes", std::to_string(nodes));
+    report.set_info("repeats", std::to_string(repeats));
+    const uint32_t percents[] = {1, 100};
+    for (uint32_t percent : percents) {
+        uint32_t movedCount = std::max(1u, (uint32_t)((uint64_t)nodes * percent / 100));
+        std::vector<double> ms, changed;
+        for (uint32_t r = 0; r <= repeats; r++) {
+            // a fresh random pick of nodes turns a little further every repeat
+            std::vector<uint8_t> moved(nodes);
+            for (uint32_t i = 0; i < movedCount; i++) {
+                uint32_t node   = movedCount == nodes ? i : random.next() % nodes;
+                Transform local = hierarchy.local(node);
+                local.rotation  = glm::rotate(local.rotation, 0.01f, glm::vec3(0.f, 1.f, 0.f));
+                hierarchy.set_local(node, local);
+                moved[node] = 1;
+            }
+
+            uint64_t start = clock.now_ns();
+            hierarchy.update();
+            uint64_t end = clock.now_ns();
+
+            // the first pass is checked against a full recompute instead of timed
+            if (r == 0) {
+                if (!check_transforms(hierarchy, moved)) {
+                    return 1;
+                }
+                continue;
+            }
+            ms.push_back((end - start) / 1e6);
+            changed.push_back((double)hierarchy.changed().size());
+        }
+        std::string suffix = "_" + std::to_string(percent) + "pct";
+        report.add_metric("update_ms_p50" + suffix, summarize(ms).p50);
+        report.add_metric("changed_nodes_avg" + suffix, summarize(changed).avg);
+    }
+
+    return finish_report(report, args);
+}
+
+// random inserts and removals against a plain map of what every live handle should read back
+static bool check_renderables() {
+    RenderableStore store;
+    std::vector<std::pair<RenderableHandle, uint32_t>> live;  // handle, expected mesh id
+    std::vector<RenderableHandle> removed;
+    SceneRandom random(7);
+    for (uint32_t step = 0; step < 200000; step++) {
+        uint32_t op = random.next() % 8;
+        if (op < 4 || live.empty()) {
+            RenderableDesc desc = {};
+            desc.mesh           = step;
+            live.push_back({store.insert(desc), step});
+        } else if (op < 7) {
+            uint32_t pick = random.next() % live.size();
+            if (!store.remove(live[pick].first)) {
+                LOGE("renderables: removing a live handle failed");
+                return false;
+            }
+            removed.push_back(live[pick].first);
+            live[pick] = live.back();
+            live.pop_back();
+        } else {
+            // bulk insertion in between
+            std::vector<RenderableDesc> descs(random.next() % 64);
+            for (size_t i = 0; i < descs.size(); i++) {
+                descs[i].mesh = step + (uint32_t)i;
+            }
+            std::vector<RenderableHandle> handles;
+            store.insert(descs, &handles);
+            for (size_t i = 0; i < handles.size(); i++) {
+                live.push_back({handles[i], step + (uint32_t)i});
+            }
+        }
+    }
+
+    if (store.size() != live.size()) {
+        LOGE("renderables: %u stored, %zu expected", store.size(), live.size());
+        return false;
+    }
+    for (auto& entry : live) {
+        uint32_t index = store.index(entry.first);
+        if (!store.valid(entry.first) || store.meshes()[index] != entry.second || store.handle(index).slot != entry.first.slot) {
+            LOGE("renderables: a live handle reads the wrong renderable");
+            return false;
+        }
+    }
+    for (RenderableHandle handle : removed) {
+        if (store.valid(handle) || store.remove(handle)) {
+            LOGE("renderables: a removed handle is still valid");
+            return false;
+        }
+    }
+    return true;
+}
+
+// what draw_objects read before RenderableStore: 80 byte records pointing at their mesh and material
+struct LegacyMesh {
+    RenderBounds bounds;
+    uint32_t id;
+};
+struct LegacyMaterial {
+    uint64_t pipeline;
+    uint32_t id;
+};
+struct LegacyRenderObject {
+    LegacyMesh* mesh;
+    LegacyMaterial* material;
+    glm::mat4 transformMatrix;
+};
+
+static int renderables(int argc, char** argv) {
+    ReportArgs args  = {"renderables.json"};
+    uint32_t objects = 1 << 20;
+    uint32_t repeats = 15;
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (parse_report_arg(argc, argv, i, args)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--objects") && hasValue) {
+            objects = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--repeats") && hasValue) {
+            repeats = (uint32_t)atoi(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    if (!check_renderables()) {
+        return 1;
+    }
+
+    // the same scattered scene in both layouts, meshes and materials are separate heap objects
+    const uint32_t meshCount = 64, materialCount = 256;
+    std::vector<std::unique_ptr<LegacyMesh>> meshes;
+    std::vector<std::unique_ptr<LegacyMaterial>> materials;
+    std::vector<RenderBounds> meshBounds;
+    SceneRandom random(3);
+    for (uint32_t i = 0; i < meshCount; i++) {
+        meshBounds.push_back({glm::vec3(0.f), 0.5f + (random.next() % 100) * 0.01f});
+        meshes.emplace_back(new LegacyMesh{meshBounds.back(), i});
+    }
+    for (uint32_t i = 0; i < materialCount; i++) {
+        materials.emplace_back(new LegacyMaterial{i, i});
+    }
+
+    RenderableStore store;
+    std::vector<RenderableDesc> descs(objects);
+    std::vector<LegacyRenderObject> legacy(objects);
+    std::vector<glm::mat4> worlds(objects);
+    for (uint32_t i = 0; i < objects; i++) {
+        glm::vec3 position = glm::vec3((float)(random.next() % 2000), (float)(random.next() % 50), (float)(random.next() % 2000)) * 0.1f - glm::vec3(100.f, 2.5f, 100.f);
+        worlds[i]          = glm::translate(glm::mat4{1.f}, position);
+        descs[i].mesh      = random.next() % meshCount;
+        descs[i].material  = random.next() % materialCount;
+        descs[i].transform = worlds[i];
+        descs[i].bounds    = meshBounds[descs[i].mesh].transformed(worlds[i]);
+        legacy[i]          = {meshes[descs[i].mesh].get(), materials[descs[i].material].get(), worlds[i]};
+    }
+    store.insert(descs);
+    descs.clear();
+
+    glm::mat4 projection = glm::perspective(glm::radians(70.f), 16.f / 9.f, 0.1f, 200.f);
+    glm::mat4 view       = glm::lookAt(glm::vec3(0.f, 10.f, -100.f), glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+    glm::vec4 planes[6];
+    frustum_planes(projection * view, planes);
+
+    SteadyClock clock;
+    std::vector<uint64_t> keys(objects);
+    std::vector<double> storeCullMs, legacyCullMs, storeKeyMs, legacyKeyMs, storeTransformMs, legacyTransformMs;
+    uint32_t storeVisible = 0, legacyVisible = 0;
+    for (uint32_t r = 0; r <= repeats; r++) {
+        // culling: bounds only in the store, the records derive them from the matrix and the mesh
+        uint64_t start             = clock.now_ns();
+        const RenderBounds* bounds = store.bounds();
+        storeVisible               = 0;
+        for (uint32_t i = 0; i < objects; i++) {
+            storeVisible += sphere_in_frustum(planes, bounds[i].center, bounds[i].radius) ? 1 : 0;
+        }
+        uint64_t storeCull = clock.now_ns();
+        legacyVisible      = 0;
+        for (const LegacyRenderObject& object : legacy) {
+            RenderBounds world = object.mesh->bounds.transformed(object.transformMatrix);
+            legacyVisible += sphere_in_frustum(planes, world.center, world.radius) ? 1 : 0;
+        }
+        uint64_t legacyCull = clock.now_ns();
+
+        // sort keys for state sorting, material first
+        const uint32_t* meshIds     = store.meshes();
+        const uint32_t* materialIds = store.materials();
+        for (uint32_t i = 0; i < objects; i++) {
+            keys[i] = (uint64_t)materialIds[i] << 32 | meshIds[i];
+        }
+        uint64_t storeKeys = clock.now_ns();
+        for (uint32_t i = 0; i < objects; i++) {
+            keys[i] = (uint64_t)legacy[i].material->id << 32 | legacy[i].mesh->id;
+        }
+        uint64_t legacyKeys = clock.now_ns();
+
+        // transform update writing every world matrix
+        glm::mat4* transforms = store.transforms();
+        for (uint32_t i = 0; i < objects; i++) {
+            transforms[i] = worlds[i];
+        }
+        uint64_t storeTransforms = clock.now_ns();
+        for (uint32_t i = 0; i < objects; i++) {
+            legacy[i].transformMatrix = worlds[i];
+        }
+        uint64_t legacyTransforms = clock.now_ns();
+
+        // the first pass only warms up
+        if (r > 0) {
+            storeCullMs.push_back((storeCull - start) / 1e6);
+            legacyCullMs.push_back((legacyCull - storeCull) / 1e6);
+            storeKeyMs.push_back((storeKeys - legacyCull) / 1e6);
+            legacyKeyMs.push_back((legacyKeys - storeKeys) / 1e6);
+            storeTransformMs.push_back((storeTransforms - legacyKeys) / 1e6);
+            legacyTransformMs.push_back((legacyTransforms - storeTransforms) / 1e6);
+        }
+    }
+    if (storeVisible != legacyVisible) {
+        LOGE("renderables: the store sees %u objects, the records %u", storeVisible, legacyVisible);
+        return 1;
+    }
+
+    // churn: remove and reinsert 1% of the objects through their handles
+    std::vector<RenderableHandle> handles;
+    for (uint32_t i = 0; i < objects; i += 100) {
+        handles.push_back(store.handle(i));
+    }
+    uint64_t churnStart = clock.now_ns();
+    for (RenderableHandle& handle : handles) {
+        uint32_t index      = store.index(handle);
+        RenderableDesc desc = {store.meshes()[index], store.materials()[index], store.transforms()[index], store.bounds()[index], store.flags()[index]};
+        store.remove(handle);
+        handle = store.insert(desc);
+    }
+    double churnNs = (double)(clock.now_ns() - churnStart) / handles.size();
+
+    BenchReport report;
+    report.set_info("objects", std::to_string(objects));
+    report.set_info("repeats", std::to_string(repeats));
+    report.set_info("visible", std::to_string(storeVisible));
+    report.add_metric("store_cull_ms_p50", summarize(storeCullMs).p50);
+    report.add_metric("legacy_cull_ms_p50", summarize(legacyCullMs).p50);
+    report.add_metric("store_sort_keys_ms_p50", summarize(storeKeyMs).p50);
+    report.add_metric("legacy_sort_keys_ms_p50", summarize(legacyKeyMs).p50);
+    report.add_metric("store_transforms_ms_p50", summarize(storeTransformMs).p50);
+    report.add_metric("legacy_transforms_ms_p50", summarize(legacyTransformMs).p50);
+    report.add_metric("store_remove_insert_ns", churnNs);
+
+    return finish_report(report, args);
+}
+
+// level changes of an object moving back and forth around distance over frames
+static uint32_t count_lod_switches(const Mesh& mesh, float distance, float hysteresis, uint32_t frames) {
+    // 1 pixel of error on a 1080 pixel high 70 degree view
+    float pixelsPerSlope = 1080.f / (2.f * tanf(glm::radians(70.f) * 0.5f));
+    uint32_t level       = 0;
+    uint32_t switches    = 0;
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        float wobble  = distance * (1.f + 0.02f * sinf(frame * 0.7f));
+        uint32_t next = select_lod(mesh._lods.data(), (uint32_t)mesh._lods.size(), pixelsPerSlope / wobble, level, 1.f, hysteresis);
+        if (next != level) {
+            switches++;
+        }
+        level = next;
+    }
+    return switches;
+}
+
+static int lods(int argc, char** argv) {
+    ReportArgs args      = {"lods.json"};
+    const char* meshFile = "monkey_smooth.obj";
+    uint32_t repeats     = 15;
+    FileAssetSource assets;
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (parse_report_arg(argc, argv, i, args)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--mesh") && hasValue) {
+            meshFile = argv[++i];
+        } else if (!strcmp(argv[i], "--assets") && hasValue) {
+            assets.add_root(argv[++i]);
+        } else if (!strcmp(argv[i], "--repeats") && hasValue) {
+            repeats = (uint32_t)atoi(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    assets.add_root(VKENGINE_ASSET_ROOT);
+
+    Mesh mesh;
+    if (!mesh.load_from_obj(&assets, meshFile)) {
+        LOGE("can't load %s", meshFile);
+        return 1;
+    }
+
+    // load_from_obj baked the chain already, these runs only time it
+    SteadyClock clock;
+    std::vector<double> bakeMs;
+    for (uint32_t r = 0; r < repeats; r++) {
+        uint64_t start = clock.now_ns();
+        mesh.build_lods();
+        bakeMs.push_back((clock.now_ns() - start) / 1e6);
+    }
+
+    BenchReport report;
+    report.set_info("mesh", meshFile);
+    report.set_info("levels", std::to_string(mesh._lods.size()));
+    report.add_metric("bake_ms_p50", summarize(bakeMs).p50);
+    for (size_t level = 0; level < mesh._lods.size(); level++) {
+        const MeshLod& lod = mesh._lods[level];
+        std::string suffix = "_lod" + std::to_string(level);
+        report.add_metric("triangles" + suffix, lod.vertexCount / 3);
+        report.add_metric("error" + suffix, lod.error);
+        report.add_metric("relative_error" + suffix, lod.error / mesh._bounds.radius);
+        printf("lod %zu: %6u triangles, error %.5f (%.2f%% of the radius)\n", level, lod.vertexCount / 3, lod.error, 100.f * lod.error / mesh._bounds.radius);
+
+        if (level > 0 && (lod.vertexCount >= mesh._lods[level - 1].vertexCount || lod.error < mesh._lods[level - 1].error)) {
+            LOGE("lods: level %zu doesn't simplify level %zu", level, level - 1);
+            return 1;
+        }
+    }
+
+    // wobble around the distance where the first coarser level takes over
+    if (mesh._lods.size() > 1) {
+        float pixelsPerSlope = 1080.f / (2.f * tanf(glm::radians(70.f) * 0.5f));
+        float switchDistance = mesh._lods[1].error * pixelsPerSlope;
+        uint32_t with        = count_lod_switches(mesh, switchDistance, 0.25f, 1000);
+        uint32_t without     = count_lod_switches(mesh, switchDistance, 0.f, 1000);
+        report.add_metric("switches_hysteresis", with);
+        report.add_metric("switches_no_hysteresis", without);
+        if (with > 1 || without <= with) {
+            LOGE("lods: %u level changes with hysteresis, %u without", with, without);
+            return 1;
+        }
+    }
+
+    return finish_report(report, args);
+}
+
+// false when a level's meshlets break the size limits or don't hold each of its triangles exactly once
+static bool check_meshlets(const Mesh& mesh) {
+    for (size_t level = 0; level < mesh._lods.size(); level++) {
+        const MeshLod& lod = mesh._lods[level];
+        // the triangles as position triples, welding only swapped in equal vertices
+        std::vector<std::array<float, 9>> expected, actual;
+        for (uint32_t i = 0; i < lod.vertexCount; i += 3) {
+            std::array<float, 9> triangle;
+            for (int k = 0; k < 3; k++) {
+                memcpy(&triangle[k * 3], &mesh._vertices[lod.firstVertex + i + k].position, sizeof(glm::vec3));
+            }
+            expected.push_back(triangle);
+        }
+        for (uint32_t m = lod.firstMeshlet; m < lod.firstMeshlet + lod.meshletCount; m++) {
+            const Meshlet& meshlet = mesh._meshlets[m];
+            std::vector<uint32_t> vertices(&mesh._meshletIndices[meshlet.firstIndex], &mesh._meshletIndices[meshlet.firstIndex + meshlet.triangleCount * 3]);
+            std::sort(vertices.begin(), vertices.end());
+            vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+            if (meshlet.triangleCount > kMeshletMaxTriangles || vertices.size() != meshlet.vertexCount || meshlet.vertexCount > kMeshletMaxVertices) {
+                LOGE("meshlets: meshlet %u of level %zu breaks the size limits", m, level);
+                return false;
+            }
+            for (uint32_t t = 0; t < meshlet.triangleCount; t++) {
+                std::array<float, 9> triangle;
+                for (int k = 0; k < 3; k++) {
+                    uint32_t vertex = mesh._meshletIndices[meshlet.firstIndex + t * 3 + k];
+                    memcpy(&triangle[k * 3], &mesh._vertices[vertex].position, sizeof(glm::vec3));
+                    if (glm::length(mesh._vertices[vertex].position - meshlet.center) > meshlet.radius * 1.0001f + 1e-6f) {
+                        LOGE("meshlets: meshlet %u of level %zu has a vertex outside its sphere", m, level);
+                        return false;
+                    }
+                }
+                actual.push_back(triangle);
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+        std::sort(actual.begin(), actual.end());
+        if (expected != actual) {
+            LOGE("meshlets: the meshlets of level %zu don't cover its triangles", level);
+            return false;
+        }
+    }
+    return true;
+}
+
+// triangles of mesh's level 0 facing away from eye, in meshlets the cone test culls and in all
+static void count_backfacing(const Mesh& mesh, const glm::vec3& eye, uint64_t& coneCulled, uint64_t& backfacing, uint64_t& wrong) {
+    const MeshLod& lod = mesh._lods[0];
+    for (uint32_t m = lod.firstMeshlet; m < lod.firstMeshlet + lod.meshletCount; m++) {
+        const Meshlet& meshlet = mesh._meshlets[m];
+        bool culled            = cone_backfacing(meshlet.center, meshlet.radius, meshlet.coneAxis, meshlet.coneCutoff, eye);
+        for (uint32_t t = 0; t < meshlet.triangleCount; t++) {
+            const uint32_t* corners = &mesh._meshletIndices[meshlet.firstIndex + t * 3];
+            glm::vec3 a             = mesh._vertices[corners[0]].position;
+            glm::vec3 normal        = glm::cross(mesh._vertices[corners[1]].position - a, mesh._vertices[corners[2]].position - a);
+            bool away               = glm::dot(normal, a - eye) >= 0.f;
+
+            backfacing += away ? 1 : 0;
+            coneCulled += culled ? 1 : 0;
+            wrong += culled && !away ? 1 : 0;
+        }
+    }
+}
+
+static int meshlets(int argc, char** argv) {
+    ReportArgs args      = {"meshlets.json"};
+    const char* meshFile = "monkey_smooth.obj";
+    uint32_t objects     = 4096;
+    uint32_t repeats     = 15;
+    FileAssetSource assets;
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (parse_report_arg(argc, argv, i, args)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--mesh") && hasValue) {
+            meshFile = argv[++i];
+        } else if (!strcmp(argv[i], "--assets") && hasValue) {
+            assets.add_root(argv[++i]);
+        } else if (!strcmp(argv[i], "--objects") && hasValue) {
+            objects = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--repeats") && hasValue) {
+            repeats = (uint32_t)atoi(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    assets.add_root(VKENGINE_ASSET_ROOT);
+
+    Mesh mesh;
+    if (!mesh.load_from_obj(&assets, meshFile)) {
+        LOGE("can't load %s", meshFile);
+        return 1;
+    }
+    if (!check_meshlets(mesh)) {
+        return 1;
+    }
+
+    SteadyClock clock;
+    std::vector<double> buildMs;
+    for (uint32_t r = 0; r < repeats; r++) {
+        uint64_t start = clock.now_ns();
+        mesh.build_meshlets();
+        buildMs.push_back((clock.now_ns() - start) / 1e6);
+    }
+
+    BenchReport report;
+    report.set_info("mesh", meshFile);
+    report.add_metric("build_ms_p50", summarize(buildMs).p50);
+    for (size_t level = 0; level < mesh._lods.size(); level++) {
+        const MeshLod& lod = mesh._lods[level];
+        uint32_t vertices  = 0, cones = 0;
+        for (uint32_t m = lod.firstMeshlet; m < lod.firstMeshlet + lod.meshletCount; m++) {
+            vertices += mesh._meshlets[m].vertexCount;
+            cones += mesh._meshlets[m].coneCutoff < 1.f ? 1 : 0;
+        }
+        std::string suffix = "_lod" + std::to_string(level);
+        report.add_metric("meshlets" + suffix, lod.meshletCount);
+        printf("lod %zu: %4u meshlets, %5.1f triangles and %4.1f vertices each, %u with a usable cone\n", level, lod.meshletCount, lod.vertexCount / 3.f / lod.meshletCount, (float)vertices / lod.meshletCount, cones);
+    }
+
+    // eyes all around the mesh, from close up to far away: the cone test may only cull back faces
+    uint64_t coneCulled = 0, backfacing = 0, wrong = 0;
+    srand(42);
+    for (uint32_t i = 0; i < 1000; i++) {
+        glm::vec3 direction(rand() / (float)RAND_MAX - 0.5f, rand() / (float)RAND_MAX - 0.5f, rand() / (float)RAND_MAX - 0.5f);
+        float distance = mesh._bounds.radius * (1.1f + 10.f * rand() / (float)RAND_MAX);
+        count_backfacing(mesh, mesh._bounds.center + glm::normalize(direction) * distance, coneCulled, backfacing, wrong);
+    }
+    if (wrong > 0) {
+        LOGE("meshlets: the cone test culled %llu front facing triangles", (unsigned long long)wrong);
+        return 1;
+    }
+    printf("cone test culls %.1f%% of the triangles, %.1f%% face away\n", 100.0 * coneCulled / (mesh._lods[0].vertexCount / 3 * 1000ull), 100.0 * backfacing / (mesh._lods[0].vertexCount / 3 * 1000ull));
+    report.add_metric("cone_kept_fraction", 1.0 - (double)coneCulled / (mesh._lods[0].vertexCount / 3 * 1000ull));
+
+    // what cull.comp leaves of a grid of full detail objects seen from above one corner, against
+    // culling whole objects only
+    glm::mat4 projection = glm::perspective(glm::radians(70.f), 1700.f / 900.f, 0.1f, 200.0f);
+    projection[1][1] *= -1;
+
+    int side       = (int)ceilf(sqrtf((float)objects));
+    float spacing  = mesh._bounds.radius * 3.f;
+    glm::vec3 eye  = glm::vec3(-side * 0.5f * spacing, 10.f * spacing, -side * 0.5f * spacing);
+    glm::mat4 view = glm::lookAt(eye, glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+    glm::vec4 planes[6];
+    frustum_planes(projection * view, planes);
+
+    const MeshLod& lod       = mesh._lods[0];
+    uint64_t objectTriangles = 0, meshletTriangles = 0;
+    for (uint32_t i = 0; i < objects; i++) {
+        glm::vec3 offset((int)(i / side - side / 2) * spacing, 0.f, (int)(i % side - side / 2) * spacing);
+        if (!sphere_in_frustum(planes, mesh._bounds.center + offset, mesh._bounds.radius)) {
+            continue;
+        }
+        objectTriangles += lod.vertexCount / 3;
+        for (uint32_t m = lod.firstMeshlet; m < lod.firstMeshlet + lod.meshletCount; m++) {
+            const Meshlet& meshlet = mesh._meshlets[m];
+            if (sphere_in_frustum(planes, meshlet.center + offset, meshlet.radius) && !cone_backfacing(meshlet.center + offset, meshlet.radius, meshlet.coneAxis, meshlet.coneCutoff, eye)) {
+                meshletTriangles += meshlet.triangleCount;
+            }
+        }
+    }
+    report.add_metric("triangles_object_culling", (double)objectTriangles);
+    report.add_metric("triangles_meshlet_culling", (double)meshletTriangles);
+    printf("%u objects: %llu triangles after object culling, %llu after meshlet culling\n", objects, (unsigned long long)objectTriangles, (unsigned long long)meshletTriangles);
+
+    return finish_report(report, args);
+}
+
+// the wall of the occlusion bench, a rectangle facing +z
+struct BenchWall {
+    glm::vec2 lower, upper;  // x and y
+    float z;
+};
+
+// depth buffer of the wall alone seen through viewproj, 1 where it doesn't cover the pixel
+static std::vector<float> render_wall_depth(const BenchWall& wall, const glm::mat4& viewproj, uint32_t width, uint32_t height) {
+    glm::mat4 inverse = glm::inverse(viewproj);
+    std::vector<float> depth(width * height, 1.f);
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            glm::vec2 ndc((x + 0.5f) / width * 2.f - 1.f, (y + 0.5f) / height * 2.f - 1.f);
+            glm::vec4 nearPoint = inverse * glm::vec4(ndc, 0.f, 1.f);
+            glm::vec4 farPoint  = inverse * glm::vec4(ndc, 1.f, 1.f);
+            glm::vec3 origin    = glm::vec3(nearPoint) / nearPoint.w;
+            glm::vec3 direction = glm::vec3(farPoint) / farPoint.w - origin;
+            if (fabsf(direction.z) < 1e-6f) {
+                continue;
+            }
+            float t       = (wall.z - origin.z) / direction.z;
+            glm::vec3 hit = origin + direction * t;
+            if (t < 0.f || t > 1.f || hit.x < wall.lower.x || hit.x > wall.upper.x || hit.y < wall.lower.y || hit.y > wall.upper.y) {
+                continue;
+            }
+            glm::vec4 clip       = viewproj * glm::vec4(hit, 1.f);
+            depth[y * width + x] = clip.z / clip.w;
+        }
+    }
+    return depth;
+}
+
+// brute force: a pixel where the sphere is in front of depth
+static bool sphere_visible_in(const std::vector<float>& depth, uint32_t width, uint32_t height, const glm::mat4& viewproj, const glm::vec3& center, float radius) {
+    // only the pixels of the sphere's box, all of them when it reaches behind the eye
+    glm::vec2 lower(0.f), upper(1.f);
+    glm::vec4 clip = viewproj * glm::vec4(center, 1.f);
+    if (clip.w > radius * 2.f) {
+        lower = glm::vec2(1.f);
+        upper = glm::vec2(0.f);
+        for (int i = 0; i < 8; i++) {
+            glm::vec3 corner = center + radius * glm::vec3((i & 1) ? 1.f : -1.f, (i & 2) ? 1.f : -1.f, (i & 4) ? 1.f : -1.f);
+            clip             = viewproj * glm::vec4(corner, 1.f);
+            lower            = glm::min(lower, glm::vec2(clip) / clip.w * 0.5f + 0.5f);
+            upper            = glm::max(upper, glm::vec2(clip) / clip.w * 0.5f + 0.5f);
+        }
+        lower = glm::clamp(lower, 0.f, 1.f);
+        upper = glm::clamp(upper, 0.f, 1.f);
+    }
+
+    glm::mat4 inverse = glm::inverse(viewproj);
+    for (uint32_t y = (uint32_t)(lower.y * height); y < std::min((uint32_t)(upper.y * height) + 1, height); y++) {
+        for (uint32_t x = (uint32_t)(lower.x * width); x < std::min((uint32_t)(upper.x * width) + 1, width); x++) {
+            glm::vec2 ndc((x + 0.5f) / width * 2.f - 1.f, (y + 0.5f) / height * 2.f - 1.f);
+            glm::vec4 nearPoint = inverse * glm::vec4(ndc, 0.f, 1.f);
+            glm::vec4 farPoint  = inverse * glm::vec4(ndc, 1.f, 1.f);
+            glm::vec3 origin    = glm::vec3(nearPoint) / nearPoint.w;
+            glm::vec3 direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - origin);
+            glm::vec3 toCenter  = center - origin;
+            float along         = glm::dot(toCenter, direction);
+            float distance2     = glm::dot(toCenter, toCenter) - along * along;
+            if (along < 0.f || distance2 > radius * radius) {
+                continue;
+            }
+            clip = viewproj * glm::vec4(origin + direction * (along - sqrtf(radius * radius - distance2)), 1.f);
+            if (clip.z / clip.w < depth[y * width + x]) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static int occlusion(int argc, char** argv) {
+    ReportArgs args  = {"occlusion.json"};
+    uint32_t objects = 4096;
+    uint32_t frames  = 60;
+    uint32_t width   = 320;
+    uint32_t height  = 180;
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (parse_report_arg(argc, argv, i, args)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--objects") && hasValue) {
+            objects = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--frames") && hasValue) {
+            frames = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--width") && hasValue) {
+            width = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--height") && hasValue) {
+            height = (uint32_t)atoi(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (frames < 2 || width == 0 || height == 0) {
+        return usage(argv[0]);
+    }
+
+    // a grid of spheres behind a wall, the camera slides sideways so objects come out from behind it
+    glm::mat4 projection = glm::perspective(glm::radians(70.f), (float)width / height, 0.1f, 200.0f);
+    projection[1][1] *= -1;
+    int side         = (int)ceilf(sqrtf((float)objects));
+    float spacing    = 2.f;
+    float radius     = 0.6f;
+    float gridFront  = (side - 1 - side / 2) * spacing;
+    BenchWall wall   = {glm::vec2(-8.f, -1.f), glm::vec2(8.f, 12.f), gridFront + 8.f};
+    glm::vec3 start  = glm::vec3(-20.f, 4.f, wall.z + 10.f);
+    glm::vec3 finish = glm::vec3(20.f, 4.f, wall.z + 10.f);
+
+    // frame by frame as cull.comp runs it: the early phase tests against the pyramid of the last
+    // frame's depth with the last frame's camera, the late phase retests what it rejected against the
+    // pyramid of this frame's early depth. The wall is always drawn early, it is never behind anything
+    uint64_t inFrustum = 0, drawnEarly = 0, drawnLate = 0, visible = 0, conservative = 0, popped = 0;
+    std::vector<PyramidLevel> lastPyramid;
+    glm::mat4 lastViewproj;
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        glm::vec3 eye                     = glm::mix(start, finish, (float)frame / (frames - 1));
+        glm::mat4 viewproj                = projection * glm::translate(glm::mat4(1.f), -eye);
+        std::vector<float> depth          = render_wall_depth(wall, viewproj, width, height);
+        std::vector<PyramidLevel> pyramid = build_depth_pyramid(depth, width, height);
+        glm::vec4 planes[6];
+        frustum_planes(viewproj, planes);
+
+        for (uint32_t i = 0; i < objects; i++) {
+            glm::vec3 center((int)(i / side) - side / 2, 0.f, (int)(i % side) - side / 2);
+            center *= spacing;
+            if (!sphere_in_frustum(planes, center, radius)) {
+                continue;
+            }
+            inFrustum++;
+            bool early = frame == 0 || !sphere_occluded(lastPyramid, lastViewproj, center, radius);
+            bool late  = !early && !sphere_occluded(pyramid, viewproj, center, radius);
+            bool seen  = sphere_visible_in(depth, width, height, viewproj, center, radius);
+
+            drawnEarly += early ? 1 : 0;
+            drawnLate += late ? 1 : 0;
+            visible += seen ? 1 : 0;
+            popped += seen && !early && !late ? 1 : 0;
+            conservative += !seen && (early || late) ? 1 : 0;
+        }
+        lastPyramid  = pyramid;
+        lastViewproj = viewproj;
+    }
+    if (popped > 0) {
+        LOGE("occlusion: %llu visible objects were culled", (unsigned long long)popped);
+        return 1;
+    }
+
+    BenchReport report;
+    report.set_info("resolution", std::to_string(width) + "x" + std::to_string(height));
+    report.add_metric("objects_in_frustum", (double)inFrustum / frames);
+    report.add_metric("objects_drawn", (double)(drawnEarly + drawnLate) / frames);
+    report.add_metric("objects_drawn_late", (double)drawnLate / frames);
+    report.add_metric("objects_visible", (double)visible / frames);
+    printf("per frame: %.1f objects in the frustum, %.1f drawn early and %.1f late, %.1f actually visible (%.1f drawn but hidden)\n", (double)inFrustum / frames, (double)drawnEarly / frames, (double)drawnLate / frames, (double)visible / frames, (double)conservative / frames);
+
+    return finish_report(report, args);
+}
+
+// GPU time of a synthetic frame: a fixed part and a part that follows the rendered pixels
+struct BenchGpuLoad {
+    double fixedMs;
+    double fullMs;  // the pixel part at scale 1
+};
+
+static uint64_t synthetic_gpu_ns(const BenchGpuLoad& load, float scale, double noise) {
+    double jitter = 1.0 + noise * (2.0 * rand() / RAND_MAX - 1.0);
+    return (uint64_t)((load.fixedMs + load.fullMs * scale * scale) * jitter * 1e6);
+}
+
+static int resolution(int argc, char** argv) {
+    ReportArgs args = {"resolution.json"};
+    uint32_t frames = 900;
+    double budgetMs = 16.0;
+    double noise    = 0.05;
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (parse_report_arg(argc, argv, i, args)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--frames") && hasValue) {
+            frames = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--budget") && hasValue) {
+            budgetMs = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--noise") && hasValue) {
+            noise = atof(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    // a load gets a third of the frames, at least enough for two raises to settle in its first half
+    if (frames < 600 || budgetMs <= 0.0 || noise < 0.0) {
+        return usage(argv[0]);
+    }
+
+    // the heavy load fits the budget at about 2/3 of the window size, the light one at full size.
+    // Every GPU time is only known FRAME_OVERLAP frames after the frame was recorded, as in draw()
+    BenchGpuLoad heavy = {budgetMs * 0.125, budgetMs * 1.75};
+    BenchGpuLoad light = {budgetMs * 0.125, budgetMs * 0.5};
+    ResolutionSettings settings;
+    ResolutionController controller;
+    controller.init(settings, (uint64_t)(budgetMs * 1e6));
+    std::deque<std::pair<float, uint64_t>> inFlight;
+    srand(1);
+
+    uint32_t phaseFrames = frames / 3;
+    float scales[3];
+    uint32_t settleFrames = 0, lateChanges = 0, heavyFrames = 0;
+    double heavyGpuMs     = 0.0;
+    for (uint32_t phase = 0; phase < 3; phase++) {
+        const BenchGpuLoad& load = phase == 1 ? light : heavy;
+        uint32_t lastChange      = 0;
+        for (uint32_t frame = 0; frame < phaseFrames; frame++) {
+            float scale    = controller.scale();
+            uint64_t gpuNs = synthetic_gpu_ns(load, scale, noise);
+            inFlight.push_back({scale, gpuNs});
+            if (inFlight.size() > FRAME_OVERLAP) {
+                if (controller.update(inFlight.front().first, inFlight.front().second)) {
+                    lastChange = frame + 1;
+                    lateChanges += frame >= phaseFrames / 2 ? 1 : 0;
+                }
+                inFlight.pop_front();
+            }
+            // the second half of a heavy load is where the scale should have settled under budget
+            if (phase != 1 && frame >= phaseFrames / 2) {
+                heavyGpuMs += gpuNs / 1e6;
+                heavyFrames++;
+            }
+        }
+        scales[phase] = controller.scale();
+        settleFrames  = std::max(settleFrames, lastChange);
+    }
+    heavyGpuMs /= heavyFrames;
+
+    printf("heavy load settles at scale %.2f, %.2f ms of %.2f ms, light load at %.2f. %u changes, the slowest load took %u frames to settle\n", scales[0], heavyGpuMs, budgetMs, scales[1], controller.changes(), settleFrames);
+    if (lateChanges > 0 || heavyGpuMs > budgetMs || scales[1] < settings.maxScale) {
+        LOGE("resolution: %u changes in the second half of a load, heavy load at %.2f ms, light load at scale %.2f", lateChanges, heavyGpuMs, scales[1]);
+        return 1;
+    }
+
+    BenchReport report;
+    report.set_info("budget_ms", std::to_string(budgetMs));
+    report.add_metric("heavy_scale", scales[0], MetricDirection::HigherIsBetter);
+    report.add_metric("heavy_gpu_ms", heavyGpuMs);
+    report.add_metric("light_scale", scales[1], MetricDirection::HigherIsBetter);
+    report.add_metric("settle_frames", settleFrames);
+    report.add_metric("resolution_changes", controller.changes());
+
+    return finish_report(report, args);
+}
+
+struct HudSample {
+    std::vector<double> cpuMs;
+    std::vector<double> recordMs;  // the overlay's share of cpuMs
+    uint32_t vertices;             // the overlay drew in the last frame
+    bool recorded;                 // anything at all, in any frame
+};
+
+// the default scene headless for warmup + frames frames, the warmup grows the overlay's vertex buffers
+static HudSample measure_hud(FileAssetSource& assets, VkExtent2D extent, uint32_t warmup, uint32_t frames, bool hud) {
+    VulkanEngine engine{};
+    engine._startupProfile = StartupProfile::Production;
+    engine._hud            = hud;
+    engine.init_headless(&assets, extent);
+
+    HudSample sample = {{}, {}, 0, false};
+    for (uint32_t frame = 0; frame < warmup + frames; frame++) {
+        engine._view = engine._sceneConfig.camera.view(frame);
+        engine.draw();
+        sample.recorded = sample.recorded || engine._perfHud.record_ns() > 0;
+        if (frame >= warmup) {
+            const FrameTiming& timing = engine._pacer.timing(frame);
+            sample.cpuMs.push_back((timing.submitNs - timing.startNs) / 1e6);
+            sample.recordMs.push_back(engine._perfHud.record_ns() / 1e6);
+        }
+    }
+    sample.vertices = engine._perfHud.vertex_count();
+    engine.cleanup();
+    return sample;
+}
+
+static int hud(int argc, char** argv) {
+    ReportArgs args   = {"hud.json"};
+    uint32_t frames   = 300;
+    uint32_t warmup   = 30;
+    VkExtent2D extent = {1280, 720};
+    double budgetMs   = 0.5;
+    FileAssetSource assets;
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (parse_report_arg(argc, argv, i, args)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--frames") && hasValue) {
+            frames = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--warmup") && hasValue) {
+            warmup = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--width") && hasValue) {
+            extent.width = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--height") && hasValue) {
+            extent.height = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--budget") && hasValue) {
+            budgetMs = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--assets") && hasValue) {
+            assets.add_root(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (frames == 0 || extent.width == 0 || extent.height == 0) {
+        return usage(argv[0]);
+    }
+    if (!open_vulkan(assets)) {
+        return 1;
+    }
+
+    HudSample off      = measure_hud(assets, extent, warmup, frames, false);
+    HudSample on       = measure_hud(assets, extent, warmup, frames, true);
+    SampleStats record = summarize(on.recordMs);
+    printf("overlay: %u vertices, recording %.3f ms p50 %.3f ms p95 of %.3f ms\n", on.vertices, record.p50, record.p95, budgetMs);
+    if (off.recorded || on.vertices == 0 || record.p95 > budgetMs) {
+        LOGE("hud: %s while off, %u vertices while on, recording %.3f ms p95", off.recorded ? "recorded" : "nothing recorded", on.vertices, record.p95);
+        return 1;
+    }
+
+    BenchReport report;
+    report.set_info("extent", std::to_string(extent.width) + "x" + std::to_string(extent.height));
+    report.set_info("frames", std::to_string(frames));
+    report.set_info("budget_ms", std::to_string(budgetMs));
+    report.add_stats("cpu_ms_off", summarize(off.cpuMs));
+    report.add_stats("cpu_ms_on", summarize(on.cpuMs));
+    report.add_stats("hud_record_ms", record);
+    report.add_metric("hud_vertices", on.vertices);
+
+    return finish_report(report, args);
+}
+
+// a buffer of the residency stress test, its contents follow from its seed
+struct ChurnBuffer {
+    uint32_t handle;
+    uint32_t seed;
+    VkDeviceSize size;
+};
+
+static void fill_churn(void* data, VkDeviceSize size, uint32_t seed) {
+    uint32_t* words = (uint32_t*)data;
+    for (VkDeviceSize i = 0; i < size / sizeof(uint32_t); i++) {
+        words[i] = seed * 2654435761u + (uint32_t)i;
+    }
+}
+
+// every resident buffer reads back what its fill wrote, after any number of evictions and moves
+static bool check_churn(BufferResidency& buffers, const std::vector<ChurnBuffer>& live) {
+    std::vector<uint32_t> expected, contents;
+    for (const ChurnBuffer& buffer : live) {
+        if (!buffers.resident(buffer.handle)) {
+            continue;
+        }
+        expected.resize(buffer.size / sizeof(uint32_t));
+        contents.resize(buffer.size / sizeof(uint32_t));
+        fill_churn(expected.data(), buffer.size, buffer.seed);
+        buffers.read(buffer.handle, contents.data());
+        if (contents != expected) {
+            LOGE("residency: buffer %u of seed %u reads back wrong contents", buffer.handle, buffer.seed);
+            return false;
+        }
+    }
+    return true;
+}
+
+static int residency(int argc, char** argv) {
+    ReportArgs args    = {"residency.json"};
+    uint32_t frames    = 2000;
+    uint32_t liveCount = 256;
+    uint32_t rate      = 4;
+    uint32_t budgetMb  = 32;
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (parse_report_arg(argc, argv, i, args)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--frames") && hasValue) {
+            frames = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--live") && hasValue) {
+            liveCount = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--rate") && hasValue) {
+            rate = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--budget") && hasValue) {
+            budgetMb = (uint32_t)atoi(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (frames == 0 || liveCount == 0 || rate == 0 || budgetMb == 0) {
+        return usage(argv[0]);
+    }
+
+    // the engine only provides the device, its allocator and the queues
+    FileAssetSource assets;
+    VulkanEngine engine{};
+    engine._startupProfile = StartupProfile::Production;
+    if (!open_headless_engine(engine, assets, {256, 256})) {
+        return 1;
+    }
+
+    // small blocks, so evictions and frees empty whole blocks for the defragmentation to give back
+    ResidencySettings settings;
+    settings.blockBytes  = 4 << 20;
+    settings.budgetBytes = (VkDeviceSize)budgetMb << 20;
+    BufferResidency buffers;
+    buffers.init(engine._allocator, engine._device, &engine._queues, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, settings);
+
+    // the first liveCount / 16 buffers are drawn every frame, rate random ones on top of them bring
+    // evicted buffers back. Churn replaces rate buffers a frame, then the settle frames only draw the
+    // working set and leave the defragmentation to close the holes
+    const uint32_t kWorkingSet   = std::max(liveCount / 16, 1u);
+    const uint32_t kSettleFrames = 480;
+    SceneRandom random(11);
+    SteadyClock clock;
+    std::vector<ChurnBuffer> live;
+    std::vector<double> beginMs;
+    uint32_t nextSeed        = 1;
+    bool correct             = true;
+    bool overBudget          = false;
+    VkDeviceSize peakPool    = 0;
+    float churnFragmentation = 0.f;
+    // the graphics timeline value of each slot's last frame
+    uint64_t slotValues[FRAME_OVERLAP] = {};
+    for (uint32_t frame = 0; frame < frames + kSettleFrames && correct; frame++) {
+        // the frame slot wait of draw(), finished defragmentation steps free their old places
+        engine._queues.timeline(vkutil::QueueKind::graphics).wait(slotValues[frame % FRAME_OVERLAP]);
+        engine._queues.collect();
+        uint64_t start = clock.now_ns();
+        buffers.begin_frame(frame);
+        beginMs.push_back((clock.now_ns() - start) / 1e6);
+
+        ResidencyStats stats = buffers.stats();
+        peakPool             = std::max(peakPool, stats.poolBytes);
+        if (stats.residentBytes > settings.budgetBytes && !overBudget) {
+            LOGE("residency: %.1f MB resident in frame %u, the budget is %u MB", stats.residentBytes / 1048576.0, frame, budgetMb);
+            overBudget = true;
+        }
+        if (frame == frames) {
+            churnFragmentation = stats.fragmentation;
+        }
+
+        bool churn = frame < frames;
+        if (churn) {
+            for (uint32_t i = 0; i < rate && live.size() >= liveCount; i++) {
+                uint32_t pick = random.next() % live.size();
+                buffers.destroy(live[pick].handle);
+                live[pick] = live.back();
+                live.pop_back();
+            }
+            // sizes from 16 KB to 512 KB, the holes the frees leave rarely fit the next buffer exactly
+            for (uint32_t i = 0; i < rate && live.size() < liveCount; i++) {
+                ChurnBuffer buffer = {0, nextSeed++, (1 + random.next() % 32) * (VkDeviceSize)16384};
+                uint32_t seed      = buffer.seed;
+                buffer.handle      = buffers.create(buffer.size, [seed](void* data, VkDeviceSize size) { fill_churn(data, size, seed); });
+                live.push_back(buffer);
+            }
+        }
+        // a command buffer of its own stands in for the frame's, the copies go ahead of the uses
+        uint64_t value                    = engine._queues.submit(vkutil::QueueKind::graphics, [&](VkCommandBuffer cmd) { buffers.record_defragment(cmd); });
+        slotValues[frame % FRAME_OVERLAP] = value;
+        buffers.submitted(value);
+        for (uint32_t i = 0; i < kWorkingSet && i < live.size(); i++) {
+            buffers.use(live[i].handle, frame);
+        }
+        for (uint32_t i = 0; churn && i < rate && !live.empty(); i++) {
+            buffers.use(live[random.next() % live.size()].handle, frame);
+        }
+        if (frame % 32 == 0) {
+            correct = check_churn(buffers, live);
+        }
+    }
+    // the last step ends, its moves count and its old places are freed
+    vkDeviceWaitIdle(engine._device);
+    engine._queues.collect();
+    correct = correct && check_churn(buffers, live);
+
+    ResidencyStats stats = buffers.stats();
+    printf("residency: %u evictions, %u restores, %u defragmentation steps moved %u buffers (%.1f MB), fragmentation %.3f after churn and %.3f settled\n", stats.evictions, stats.restores, stats.defragSteps, stats.allocationsMoved, stats.bytesMoved / 1048576.0, churnFragmentation, stats.fragmentation);
+    buffers.cleanup();
+    bool memoryBudget = engine._memoryBudget;
+    engine.cleanup();
+
+    // settled, the defragmentation either got under its threshold or at least below what the churn left
+    bool defragmented = stats.fragmentation <= settings.defragAbove || stats.fragmentation < churnFragmentation;
+    if (!correct || overBudget || !defragmented) {
+        LOGE("residency: %s, %s, fragmentation %.3f after churn and %.3f settled", correct ? "contents intact" : "wrong contents", overBudget ? "over budget" : "in budget", churnFragmentation, stats.fragmentation);
+        return 1;
+    }
+
+    BenchReport report;
+    report.set_info("frames", std::to_string(frames));
+    report.set_info("live", std::to_string(liveCount));
+    report.set_info("rate", std::to_string(rate));
+    report.set_info("budget_mb", std::to_string(budgetMb));
+    report.set_info("memory_budget", memoryBudget ? "VK_EXT_memory_budget" : "estimated");
+    report.add_stats("begin_frame_ms", summarize(beginMs));
+    report.add_metric("evictions", stats.evictions);
+    report.add_metric("restores", stats.restores);
+    report.add_metric("defrag_steps", stats.defragSteps);
+    report.add_metric("allocations_moved", stats.allocationsMoved);
+    report.add_metric("moved_mb", stats.bytesMoved / 1048576.0);
+    report.add_metric("blocks_freed", stats.blocksFreed, MetricDirection::HigherIsBetter);
+    report.add_metric("peak_pool_mb", peakPool / 1048576.0);
+    report.add_metric("fragmentation_churn", churnFragmentation);
+    report.add_metric("fragmentation_settled", stats.fragmentation);
+
+    return finish_report(report, args);
+}
+
+// a live sub-allocation of the ring and the frame it was made in
+struct RingRange {
+    VkDeviceSize offset;
+    VkDeviceSize end;
+    uint32_t frame;
+};
+
+static int ring(int argc, char** argv) {
+    ReportArgs args        = {"ring.json"};
+    uint32_t frames        = 10000;
+    VkDeviceSize capacity  = (64 << 10) + 37;
+    VkDeviceSize alignment = 256;
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (parse_report_arg(argc, argv, i, args)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--frames") && hasValue) {
+            frames = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--capacity") && hasValue) {
+            capacity = (VkDeviceSize)atoll(argv[++i]);
+        } else if (!strcmp(argv[i], "--alignment") && hasValue) {
+            alignment = (VkDeviceSize)atoll(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    // a power of two like every minUniformBufferOffsetAlignment, and room for a few allocations of it
+    if (frames < 100 || alignment == 0 || (alignment & (alignment - 1)) != 0 || capacity < alignment * 64) {
+        return usage(argv[0]);
+    }
+
+    // what FrameAllocator asks for: uniforms, storage buffers and 16 byte instance data
+    const VkDeviceSize alignments[] = {alignment, std::min<VkDeviceSize>(alignment, 64), 16, 4};
+    LinearRing ring;
+    ring.init(capacity);
+    SceneRandom random(7);
+    std::vector<RingRange> live;
+    SteadyClock clock;
+
+    uint64_t allocations  = 0, failures = 0, wraps = 0, allocateNs = 0;
+    VkDeviceSize head     = 0, peakUsed = 0;
+    double wasteSum       = 0.0;
+    uint32_t wasteSamples = 0;
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        // what FrameAllocator::begin_frame does once the fence of the slot signaled
+        VkDeviceSize before = ring.used();
+        ring.retire_frame(frame);
+        bool retiring        = false;
+        VkDeviceSize retired = 0;
+        for (const RingRange& range : live) {
+            if (range.frame + FRAME_OVERLAP == frame) {
+                retiring = true;
+                retired += range.end - range.offset;
+            }
+        }
+        live.erase(std::remove_if(live.begin(), live.end(), [=](const RingRange& range) { return range.frame + FRAME_OVERLAP <= frame; }), live.end());
+        VkDeviceSize liveBytes = 0;
+        for (const RingRange& range : live) {
+            liveBytes += range.end - range.offset;
+        }
+        // the retired frame gives back at least what it allocated, and nothing comes back without one
+        if (ring.used() > before || (retiring ? before - ring.used() < retired : ring.used() != before) || ring.used() < liveBytes) {
+            LOGE("ring: frame %u retired %llu of %llu used bytes, it allocated %llu and %llu are still live", frame, (unsigned long long)(before - ring.used()), (unsigned long long)before, (unsigned long long)retired, (unsigned long long)liveBytes);
+            return 1;
+        }
+        ring.begin_frame(frame);
+
+        // odd sizes so nearly every one needs padding, every 16th frame one big enough to fill the ring,
+        // and now and then a frame that allocates nothing
+        std::vector<VkDeviceSize> sizes(frame % 7 == 3 ? 0 : random.next() % 64);
+        for (VkDeviceSize& size : sizes) {
+            size = (random.next() % (capacity / 64)) | 1;
+        }
+        if (frame % 16 == 0) {
+            sizes.push_back((capacity / 2) | 1);
+        }
+        for (VkDeviceSize size : sizes) {
+            VkDeviceSize align = alignments[random.next() % 4];
+
+            VkDeviceSize offset;
+            uint64_t start = clock.now_ns();
+            bool allocated = ring.allocate(size, align, offset);
+            allocateNs += clock.now_ns() - start;
+            if (!allocated) {
+                failures++;
+                continue;
+            }
+            allocations++;
+
+            if (offset % align != 0 || offset + size > capacity) {
+                LOGE("ring: frame %u got offset %llu for %llu bytes at alignment %llu in a %llu byte ring", frame, (unsigned long long)offset, (unsigned long long)size, (unsigned long long)align, (unsigned long long)capacity);
+                return 1;
+            }
+            // space of a frame in flight handed out again before that frame retired
+            for (const RingRange& range : live) {
+                if (offset < range.end && range.offset < offset + size) {
+                    LOGE("ring: frame %u got [%llu, %llu) overlapping [%llu, %llu) of frame %u", frame, (unsigned long long)offset, (unsigned long long)(offset + size), (unsigned long long)range.offset, (unsigned long long)range.end, range.frame);
+                    return 1;
+                }
+            }
+            wraps += offset < head ? 1 : 0;
+            head = offset + size;
+            live.push_back({offset, offset + size, frame});
+            liveBytes += size;
+        }
+
+        peakUsed = std::max(peakUsed, ring.used());
+        if (ring.used() > capacity || ring.used() < liveBytes) {
+            LOGE("ring: frame %u has %llu bytes used for %llu live in a %llu byte ring", frame, (unsigned long long)ring.used(), (unsigned long long)liveBytes, (unsigned long long)capacity);
+            return 1;
+        }
+        if (ring.used() > 0) {
+            wasteSum += 1.0 - (double)liveBytes / ring.used();
+            wasteSamples++;
+        }
+    }
+
+    // both frames in flight retire, the whole ring is free again from the front
+    ring.retire_frame(frames);
+    ring.retire_frame(frames + 1);
+    VkDeviceSize offset = capacity;
+    if (ring.used() != 0 || !ring.allocate(capacity, alignment, offset) || offset != 0) {
+        LOGE("ring: %llu bytes still used after every frame retired, a whole ring allocation got offset %llu", (unsigned long long)ring.used(), (unsigned long long)offset);
+        return 1;
+    }
+    if (wraps < 3) {
+        LOGE("ring: wrapped %llu times in %u frames, not enough to test the wraparound", (unsigned long long)wraps, frames);
+        return 1;
+    }
+
+    double waste = wasteSamples ? wasteSum / wasteSamples : 0.0;
+    printf("%llu allocations in %u frames, %llu wraps, %llu failed with the ring full, peak %llu of %llu bytes used, %.1f%% padding and wrap waste\n", (unsigned long long)allocations, frames, (unsigned long long)wraps, (unsigned long long)failures, (unsigned long long)peakUsed,
+           (unsigned long long)capacity, waste * 100.0);
+
+    BenchReport report;
+    report.set_info("capacity", std::to_string(capacity));
+    report.set_info("alignment", std::to_string(alignment));
+    report.add_metric("allocate_ns", (double)allocateNs / (allocations + failures));
+    report.add_metric("waste", waste);
+    report.add_metric("failed_allocations", (double)failures);
+
+    return finish_report(report, args);
+}
+
+struct PacedFrame {
+    uint64_t predictedNs;  // FramePacer::predicted_start_ns() when the frame began
+    uint64_t startNs;
+    uint64_t presentNs;
+};
+
+// FramePacer on a FakeClock against a FIFO display: a frame shows at the first vblank after its GPU work is
+// done and no two share a vblank. The GPU and present times of a frame reach the pacer FRAME_OVERLAP frames
+// later, after the wait for its slot and swapchain image, in the order draw() does it
+static std::vector<PacedFrame> simulate_pacing(PacingMode mode, uint64_t refreshNs, uint64_t cpuNs, uint64_t gpuNs, uint32_t frames, uint32_t lateFrame) {
+    // vblanks are at multiples of the refresh period, 0 would read as no present yet
+    FakeClock clock(refreshNs * 10);
+    FramePacer pacer;
+    pacer.init(&clock, mode, refreshNs);
+
+    std::vector<PacedFrame> paced(frames);
+    std::vector<uint64_t> gpuEnd(frames);
+    uint64_t gpuFree = 0, lastPresent = 0;
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        paced[frame].predictedNs = pacer.predicted_start_ns();
+        pacer.begin_frame(frame);
+        paced[frame].startNs = clock.now_ns();
+        if (frame >= FRAME_OVERLAP) {
+            uint32_t finished = frame - FRAME_OVERLAP;
+            clock.sleep_until(std::max(gpuEnd[finished], paced[finished].presentNs));
+            pacer.gpu_finished(finished, gpuNs);
+            pacer.presented(finished, paced[finished].presentNs);
+        }
+
+        // the late frame takes a refresh period more on the CPU
+        clock.advance(frame == lateFrame ? cpuNs + refreshNs : cpuNs);
+        pacer.submitted(frame);
+        gpuEnd[frame] = gpuFree = std::max(clock.now_ns(), gpuFree) + gpuNs;
+
+        uint64_t earliest      = std::max(gpuEnd[frame], lastPresent + refreshNs);
+        paced[frame].presentNs = lastPresent = (earliest + refreshNs - 1) / refreshNs * refreshNs;
+    }
+    return paced;
+}
+
+static int pacing(int argc, char** argv) {
+    ReportArgs args  = {"pacing.json"};
+    uint32_t frames  = 600;
+    double refreshMs = 1000.0 / 60.0;
+    double cpuMs     = 4.0;
+    double gpuMs     = 6.0;
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (parse_report_arg(argc, argv, i, args)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--frames") && hasValue) {
+            frames = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--refresh") && hasValue) {
+            refreshMs = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--cpu") && hasValue) {
+            cpuMs = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--gpu") && hasValue) {
+            gpuMs = atof(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    uint64_t refreshNs = (uint64_t)(refreshMs * 1e6);
+    uint64_t cpuNs     = (uint64_t)(cpuMs * 1e6);
+    uint64_t gpuNs     = (uint64_t)(gpuMs * 1e6);
+    // the frame has to fit a refresh period with the pacer's margin, and the late frame's share of the
+    // average CPU time on top, or no pacing makes every vblank
+    if (frames < 200 || cpuNs == 0 || gpuNs == 0 || cpuNs + gpuNs + FramePacer::kSafetyMarginNs + refreshNs / 8 >= refreshNs) {
+        return usage(argv[0]);
+    }
+
+    // the pacer's averages settle in the first quarter, one late frame halfway
+    uint32_t warmup    = frames / 4;
+    uint32_t lateFrame = frames / 2;
+
+    std::vector<PacedFrame> lowLatency = simulate_pacing(PacingMode::LowLatency, refreshNs, cpuNs, gpuNs, frames, lateFrame);
+    std::vector<PacedFrame> fifo       = simulate_pacing(PacingMode::Fifo, refreshNs, cpuNs, gpuNs, frames, lateFrame);
+
+    // every settled frame makes the vblank after the previous one, and starts less than a refresh period
+    // before it as predicted. The late frame misses its vblank, and the next one already aims at the vblank
+    // after it although the pacer sees the late present only FRAME_OVERLAP frames later
+    uint32_t missed     = 0, catchUp = 0;
+    double lowLatencyMs = 0.0, fifoMs = 0.0;
+    uint32_t samples    = 0;
+    for (uint32_t frame = warmup; frame < frames; frame++) {
+        const PacedFrame& paced = lowLatency[frame];
+        uint64_t interval       = paced.presentNs - lowLatency[frame - 1].presentNs;
+        uint64_t latency        = paced.presentNs - paced.startNs;
+        uint64_t predicted      = paced.presentNs - std::min(paced.predictedNs, paced.startNs);
+        if (frame == lateFrame) {
+            if (interval != 2 * refreshNs) {
+                LOGE("pacing: the late frame %u showed %.2f ms after the previous one, not one vblank late", frame, interval / 1e6);
+                return 1;
+            }
+            continue;
+        }
+        if (interval != refreshNs || latency >= refreshNs || predicted >= refreshNs) {
+            if (frame < lateFrame) {
+                LOGE("pacing: settled frame %u showed %.2f ms after the previous one, %.2f ms after it started and %.2f ms after its predicted start", frame, interval / 1e6, latency / 1e6, predicted / 1e6);
+                return 1;
+            }
+            missed += interval != refreshNs ? 1 : 0;
+            catchUp = frame - lateFrame;
+            continue;
+        }
+        lowLatencyMs += latency / 1e6;
+        fifoMs += (fifo[frame].presentNs - fifo[frame].startNs) / 1e6;
+        samples++;
+    }
+    lowLatencyMs /= samples;
+    fifoMs /= samples;
+
+    printf("low latency pacing: %.2f ms from start to present against %.2f ms with fifo, %u frames after the late one to catch up, %u more missed vblanks\n", lowLatencyMs, fifoMs, catchUp, missed);
+    if (catchUp > 0 || missed > 0 || lowLatencyMs >= fifoMs) {
+        LOGE("pacing: %u frames to catch up, %u missed vblanks after the late frame, %.2f ms latency against %.2f ms with fifo", catchUp, missed, lowLatencyMs, fifoMs);
+        return 1;
+    }
+
+    BenchReport report;
+    report.set_info("refresh_ms", std::to_string(refreshMs));
+    report.add_metric("low_latency_ms", lowLatencyMs);
+    report.add_metric("fifo_latency_ms", fifoMs);
+
+    return finish_report(report, args);
+}
+
+// a barrier compile() has to produce, the destination follows from the access
+struct ExpectedBarrier {
+    const char* pass;
+    uint32_t resource;
+    VkImageLayout oldLayout;
+    VkImageLayout newLayout;
+    VkPipelineStageFlags srcStage;
+    VkAccessFlags srcAccess;
+};
+
+// deferred shading without a device: gbuffer, lighting, bloom and tonemap, plus a debug view nothing reads.
+// Depth is kept across frames like the engine's with occlusion culling, the last frame wrote it
+static vkutil::RenderGraph build_bench_graph(VkExtent2D extent, uint32_t& swapchain, uint32_t& debugPass) {
+    const VkPipelineStageFlags depthStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    vkutil::RenderGraph graph;
+    swapchain        = graph.import_image("swapchain", VK_FORMAT_B8G8R8A8_UNORM, extent, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    uint32_t albedo  = graph.create_image("albedo", VK_FORMAT_R8G8B8A8_UNORM, extent);
+    uint32_t normal  = graph.create_image("normal", VK_FORMAT_R16G16B16A16_SFLOAT, extent);
+    uint32_t depth   = graph.import_image("depth", VK_FORMAT_D32_SFLOAT, extent, VK_IMAGE_LAYOUT_UNDEFINED, depthStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
+    uint32_t hdr     = graph.create_image("hdr", VK_FORMAT_R16G16B16A16_SFLOAT, extent);
+    uint32_t bloom   = graph.create_image("bloom", VK_FORMAT_R16G16B16A16_SFLOAT, extent);
+    uint32_t debug   = graph.create_image("debug", VK_FORMAT_R8G8B8A8_UNORM, extent);
+    auto nothing     = [](VkCommandBuffer) {};
+
+    uint32_t gbuffer = graph.add_pass("gbuffer", nothing);
+    graph.use(gbuffer, albedo, vkutil::ImageAccess::ColorAttachment);
+    graph.use(gbuffer, normal, vkutil::ImageAccess::ColorAttachment);
+    graph.use(gbuffer, depth, vkutil::ImageAccess::DepthAttachment);
+
+    uint32_t lighting = graph.add_pass("lighting", nothing);
+    graph.use(lighting, albedo, vkutil::ImageAccess::Sampled);
+    graph.use(lighting, normal, vkutil::ImageAccess::Sampled);
+    graph.use(lighting, depth, vkutil::ImageAccess::DepthRead);
+    graph.use(lighting, hdr, vkutil::ImageAccess::ColorAttachment);
+
+    uint32_t blur = graph.add_pass("bloom", nothing);
+    graph.use(blur, hdr, vkutil::ImageAccess::Sampled);
+    graph.use(blur, bloom, vkutil::ImageAccess::StorageWrite);
+
+    uint32_t tonemap = graph.add_pass("tonemap", nothing);
+    graph.use(tonemap, hdr, vkutil::ImageAccess::Sampled);
+    graph.use(tonemap, bloom, vkutil::ImageAccess::Sampled);
+    graph.use(tonemap, swapchain, vkutil::ImageAccess::ColorAttachment);
+
+    debugPass = graph.add_pass("debug view", nothing);
+    graph.use(debugPass, normal, vkutil::ImageAccess::Sampled);
+    graph.use(debugPass, debug, vkutil::ImageAccess::ColorAttachment);
+    return graph;
+}
+
+static int graph(int argc, char** argv) {
+    ReportArgs args   = {"graph.json"};
+    VkExtent2D extent = {1920, 1080};
+    uint32_t repeats  = 1000;
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (parse_report_arg(argc, argv, i, args)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--width") && hasValue) {
+            extent.width = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--height") && hasValue) {
+            extent.height = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--repeats") && hasValue) {
+            repeats = (uint32_t)atoi(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (extent.width == 0 || extent.height == 0 || repeats == 0) {
+        return usage(argv[0]);
+    }
+
+    uint32_t swapchain, debugPass;
+    vkutil::RenderGraph graph = build_bench_graph(extent, swapchain, debugPass);
+    if (!graph.compile()) {
+        return 1;
+    }
+
+    // resources in creation order after the swapchain, 1 albedo, 2 normal, 3 depth, 4 hdr, 5 bloom
+    const VkPipelineStageFlags fragmentAndCompute = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    const VkPipelineStageFlags depthStages        = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    const ExpectedBarrier expected[] = {
+        {"gbuffer", 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0},
+        {"gbuffer", 2, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0},
+        // the transition of the imported depth waits for the last frame's depth writes
+        {"gbuffer", 3, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, depthStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT},
+        {"lighting", 1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT},
+        {"lighting", 2, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT},
+        {"lighting", 3, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, depthStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT},
+        {"lighting", 4, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0},
+        {"bloom", 4, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT},
+        // bloom takes over the memory of normal, it waits for everything that touched normal
+        {"bloom", 5, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | fragmentAndCompute, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT},
+        // hdr is already visible to the shader stages in the same layout, no barrier
+        {"tonemap", 5, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT},
+        {"tonemap", 0, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0},
+    };
+    const char* passNames[] = {"gbuffer", "lighting", "bloom", "tonemap"};
+
+    uint32_t barriers = 0;
+    bool wrong        = graph.schedule().size() != 4 || !graph.is_culled(debugPass);
+    for (uint32_t p = 0; p < graph.schedule().size() && !wrong; p++) {
+        const vkutil::CompiledPass& compiled = graph.schedule()[p];
+        wrong |= compiled.pass != p;
+        for (const vkutil::GraphBarrier& barrier : compiled.barriers) {
+            const ExpectedBarrier* want = barriers < sizeof(expected) / sizeof(expected[0]) ? &expected[barriers] : nullptr;
+            if (!want || strcmp(want->pass, passNames[p]) || want->resource != barrier.resource || want->oldLayout != barrier.oldLayout || want->newLayout != barrier.newLayout || want->srcStage != barrier.srcStage || want->srcAccess != barrier.srcAccess) {
+                LOGE("graph: unexpected barrier %u in %s on resource %u, layout %d to %d after stages 0x%x access 0x%x", barriers, passNames[p], barrier.resource, barrier.oldLayout, barrier.newLayout, barrier.srcStage, barrier.srcAccess);
+                return 1;
+            }
+            barriers++;
+        }
+    }
+    if (wrong || barriers != sizeof(expected) / sizeof(expected[0])) {
+        LOGE("graph: %zu passes scheduled, debug view %s, %u of %zu barriers", graph.schedule().size(), graph.is_culled(debugPass) ? "culled" : "kept", barriers, sizeof(expected) / sizeof(expected[0]));
+        return 1;
+    }
+    // the swapchain goes back to presentation after the last pass
+    const std::vector<vkutil::GraphBarrier>& final = graph.final_barriers();
+    if (final.size() != 1 || final[0].resource != swapchain || final[0].oldLayout != VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL || final[0].newLayout != VK_IMAGE_LAYOUT_PRESENT_SRC_KHR) {
+        LOGE("graph: %zu final barriers, not the one of the swapchain to PRESENT_SRC", final.size());
+        return 1;
+    }
+
+    // normal and bloom share a block, hdr and albedo live across the others, depth is imported: 8 + 8 + 4
+    // bytes a pixel aliased against 8 + 8 + 8 + 4
+    VkDeviceSize pixels = (VkDeviceSize)extent.width * extent.height;
+    if (graph.memory_block_count() != 3 || graph.aliased_memory() != 20 * pixels || graph.unaliased_memory() != 28 * pixels) {
+        LOGE("graph: %llu bytes in %u blocks, %llu without aliasing, expected %llu in 3 and %llu", (unsigned long long)graph.aliased_memory(), graph.memory_block_count(), (unsigned long long)graph.unaliased_memory(), (unsigned long long)(20 * pixels), (unsigned long long)(28 * pixels));
+        return 1;
+    }
+
+    std::vector<double> compileUs;
+    SteadyClock clock;
+    for (uint32_t r = 0; r < repeats; r++) {
+        vkutil::RenderGraph timed = build_bench_graph(extent, swapchain, debugPass);
+        uint64_t start            = clock.now_ns();
+        timed.compile();
+        compileUs.push_back((clock.now_ns() - start) / 1e3);
+    }
+
+    printf("%zu passes, %u barriers, %llu bytes of transient images in %u blocks instead of %llu\n", graph.schedule().size(), barriers, (unsigned long long)graph.aliased_memory(), graph.memory_block_count(), (unsigned long long)graph.unaliased_memory());
+
+    BenchReport report;
+    report.set_info("extent", std::to_string(extent.width) + "x" + std::to_string(extent.height));
+    report.add_stats("compile_us", summarize(compileUs));
+    report.add_metric("barriers", barriers);
+    report.add_metric("aliased_bytes", (double)graph.aliased_memory());
+
+    return finish_report(report, args);
+}
+
+// logs the pass when estimate moves other bytes than the hand computed ones
+static bool check_bandwidth(const char* pass, vkutil::PassBandwidth estimate, VkDeviceSize loadBytes, VkDeviceSize storeBytes) {
+    if (estimate.loadBytes == loadBytes && estimate.storeBytes == storeBytes) {
+        return true;
+    }
+    LOGE("bandwidth: %s loads %llu and stores %llu bytes, expected %llu and %llu", pass, (unsigned long long)estimate.loadBytes, (unsigned long long)estimate.storeBytes, (unsigned long long)loadBytes, (unsigned long long)storeBytes);
+    return false;
+}
+
+static int bandwidth(int argc, char** argv) {
+    ReportArgs args   = {"bandwidth.json"};
+    VkExtent2D extent = {1920, 1080};
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (parse_report_arg(argc, argv, i, args)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--width") && hasValue) {
+            extent.width = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--height") && hasValue) {
+            extent.height = (uint32_t)atoi(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (extent.width == 0 || extent.height == 0) {
+        return usage(argv[0]);
+    }
+
+    // the main pass without the depth pyramid: the color target is presented, depth is cleared and
+    // dropped, so it never leaves tile memory
+    vkutil::RenderPassDesc mainPass;
+    uint32_t color = mainPass.add_color(VK_FORMAT_B8G8R8A8_UNORM, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, true, false, true);
+    uint32_t depth = mainPass.set_depth(VK_FORMAT_D32_SFLOAT, true, false, false);
+    // 4x MSAA: the samples of both targets stay in tile memory, only the resolved texels are stored
+    vkutil::RenderPassDesc msaaPass;
+    uint32_t samples = msaaPass.add_color(VK_FORMAT_B8G8R8A8_UNORM, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true, false, false, VK_SAMPLE_COUNT_4_BIT);
+    msaaPass.set_depth(VK_FORMAT_D32_SFLOAT, true, false, false, VK_SAMPLE_COUNT_4_BIT);
+    msaaPass.add_resolve(samples, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, true);
+    // an overlay drawn over what an earlier pass left: loaded and stored
+    vkutil::RenderPassDesc overlayPass;
+    uint32_t loaded = overlayPass.add_color(VK_FORMAT_B8G8R8A8_UNORM, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, false, true, true);
+
+    VkAttachmentDescription colorDesc  = mainPass.describe(color);
+    VkAttachmentDescription depthDesc  = mainPass.describe(depth);
+    VkAttachmentDescription loadedDesc = overlayPass.describe(loaded);
+    bool ops                           = colorDesc.loadOp == VK_ATTACHMENT_LOAD_OP_CLEAR && colorDesc.storeOp == VK_ATTACHMENT_STORE_OP_STORE;
+    ops                                = ops && depthDesc.loadOp == VK_ATTACHMENT_LOAD_OP_CLEAR && depthDesc.storeOp == VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    ops                                = ops && depthDesc.stencilStoreOp == VK_ATTACHMENT_STORE_OP_DONT_CARE && !mainPass.is_transient(color) && mainPass.is_transient(depth);
+    ops                                = ops && loadedDesc.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD && loadedDesc.storeOp == VK_ATTACHMENT_STORE_OP_STORE;
+    ops                                = ops && loadedDesc.initialLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR && msaaPass.is_transient(samples);
+    if (!ops) {
+        LOGE("bandwidth: color loads with %d and stores with %d, depth loads with %d and stores with %d, the loaded color target loads with %d from layout %d", colorDesc.loadOp, colorDesc.storeOp, depthDesc.loadOp, depthDesc.storeOp, loadedDesc.loadOp, loadedDesc.initialLayout);
+        return 1;
+    }
+
+    // 4 bytes a texel for BGRA8 and D32. The main pass stores its color once and loads nothing, the MSAA
+    // pass only stores the resolved texels. Resolving after the pass would store the 4 samples of color
+    // and read them back, the overlay loads and stores its color
+    VkDeviceSize texels = (VkDeviceSize)extent.width * extent.height;
+    bool correct        = check_bandwidth("main pass", mainPass.estimate_bandwidth(extent), 0, 4 * texels);
+    correct             = check_bandwidth("main pass resolving after it", mainPass.estimate_separate_resolve(extent), 0, 4 * texels) && correct;
+    correct             = check_bandwidth("msaa pass", msaaPass.estimate_bandwidth(extent), 0, 4 * texels) && correct;
+    correct             = check_bandwidth("msaa pass resolving after it", msaaPass.estimate_separate_resolve(extent), 16 * texels, 20 * texels) && correct;
+    correct             = check_bandwidth("overlay pass", overlayPass.estimate_bandwidth(extent), 4 * texels, 4 * texels) && correct;
+    if (!correct) {
+        return 1;
+    }
+
+    printf("main pass %.1f MB, 4x msaa %.1f MB resolved in the pass and %.1f MB after it\n", mainPass.estimate_bandwidth(extent).total() / 1048576.0, msaaPass.estimate_bandwidth(extent).total() / 1048576.0, msaaPass.estimate_separate_resolve(extent).total() / 1048576.0);
+
+    BenchReport report;
+    report.set_info("extent", std::to_string(extent.width) + "x" + std::to_string(extent.height));
+    report.add_metric("pass_bytes", (double)mainPass.estimate_bandwidth(extent).total());
+    report.add_metric("msaa_pass_bytes", (double)msaaPass.estimate_bandwidth(extent).total());
+    report.add_metric("separate_resolve_bytes", (double)msaaPass.estimate_separate_resolve(extent).total());
+
+    return finish_report(report, args);
+}
+
+// what a task of the scheduler check saw, positions in the order tasks started and ended
+struct TaskRun {
+    std::atomic<uint32_t> runs{0};
+    uint32_t start{0};
+    uint32_t end{0};
+};
+
+// count tasks, each depending on up to 3 of the 16 added before it and spinning up to maxWorkNs
+static vkutil::TaskGraph build_task_graph(uint32_t count, uint64_t maxWorkNs, std::vector<std::vector<uint32_t>>& dependencies, std::vector<TaskRun>& runs, std::atomic<uint32_t>& sequence) {
+    SceneRandom random(23);
+    vkutil::TaskGraph graph;
+    dependencies.assign(count, {});
+    for (uint32_t i = 0; i < count; i++) {
+        std::vector<uint32_t>& deps = dependencies[i];
+        for (uint32_t d = 0, wanted = i ? random.next() % 4 : 0; d < wanted; d++) {
+            uint32_t dependency = i - 1 - random.next() % std::min(i, 16u);
+            if (std::find(deps.begin(), deps.end(), dependency) == deps.end()) {
+                deps.push_back(dependency);
+            }
+        }
+        uint64_t workNs = random.next() % (maxWorkNs + 1);
+        auto task       = [&runs, &sequence, i, workNs]() {
+            SteadyClock clock;
+            uint32_t start = sequence++;
+            for (uint64_t until = clock.now_ns() + workNs; clock.now_ns() < until;) {
+            }
+            runs[i].start = start;
+            runs[i].end   = sequence++;
+            runs[i].runs++;
+        };
+        switch (deps.size()) {
+            case 0:
+                graph.add("task " + std::to_string(i), task);
+                break;
+            case 1:
+                graph.add("task " + std::to_string(i), task, {deps[0]});
+                break;
+            case 2:
+                graph.add("task " + std::to_string(i), task, {deps[0], deps[1]});
+                break;
+            default:
+                graph.add("task " + std::to_string(i), task, {deps[0], deps[1], deps[2]});
+                break;
+        }
+    }
+    return graph;
+}
+
+// runs a graph of count tasks on threads threads and checks the order they ran in, returns the run time
+static bool check_task_graph(uint32_t count, uint32_t threads, uint64_t maxWorkNs, double& elapsedMs) {
+    std::vector<std::vector<uint32_t>> dependencies;
+    std::vector<TaskRun> runs(count);
+    std::atomic<uint32_t> sequence{0};
+    vkutil::TaskGraph graph = build_task_graph(count, maxWorkNs, dependencies, runs, sequence);
+    SteadyClock clock;
+    graph.run(&clock, threads);
+    elapsedMs = graph.elapsed_ns() / 1e6;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (runs[i].runs.load() != 1) {
+            LOGE("tasks with %u threads: task %u ran %u times", threads, i, runs[i].runs.load());
+            return false;
+        }
+        // with one thread every task starts right after the one added before it ended
+        if (threads == 1 && runs[i].start != 2 * i) {
+            LOGE("tasks with 1 thread: task %u started %u tasks in, not in add() order", i, runs[i].start / 2);
+            return false;
+        }
+        for (uint32_t dependency : dependencies[i]) {
+            const vkutil::TaskTiming& timing = graph.timing(i);
+            if (runs[i].start < runs[dependency].end || timing.startNs < graph.timing(dependency).endNs) {
+                LOGE("tasks with %u threads: task %u started before its dependency %u ended", threads, i, dependency);
+                return false;
+            }
+        }
+    }
+    if (graph.thread_count() != std::min(threads, count)) {
+        LOGE("tasks: ran on %u threads instead of %u", graph.thread_count(), std::min(threads, count));
+        return false;
+    }
+    return true;
+}
+
+static int tasks(int argc, char** argv) {
+    ReportArgs args  = {"tasks.json"};
+    uint32_t count   = 256;
+    uint32_t threads = 4;
+    uint32_t rounds  = 20;
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (parse_report_arg(argc, argv, i, args)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--tasks") && hasValue) {
+            count = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--threads") && hasValue) {
+            threads = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--rounds") && hasValue) {
+            rounds = (uint32_t)atoi(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (count == 0 || threads < 2 || rounds == 0) {
+        return usage(argv[0]);
+    }
+
+    // a few rounds, races rarely show on the first one. Tasks of up to 50 us, about what the shorter init
+    // tasks take, keep the threads contending for the ready set
+    const uint64_t kMaxWorkNs = 50000;
+    std::vector<double> serialMs, parallelMs;
+    for (uint32_t round = 0; round < rounds; round++) {
+        double ms;
+        if (!check_task_graph(count, 1, kMaxWorkNs, ms)) {
+            return 1;
+        }
+        serialMs.push_back(ms);
+        if (!check_task_graph(count, threads, kMaxWorkNs, ms)) {
+            return 1;
+        }
+        parallelMs.push_back(ms);
+    }
+
+    SampleStats serial   = summarize(serialMs);
+    SampleStats parallel = summarize(parallelMs);
+    printf("tasks: %u tasks in %.2f ms on 1 thread and %.2f ms on %u threads, %.2fx\n", count, serial.p50, parallel.p50, threads, serial.p50 / parallel.p50);
+
+    BenchReport report;
+    report.set_info("tasks", std::to_string(count));
+    report.set_info("threads", std::to_string(threads));
+    report.add_stats("serial_ms", serial);
+    report.add_stats("parallel_ms", parallel);
+    report.add_metric("speedup", serial.p50 / parallel.p50, MetricDirection::HigherIsBetter);
+
+    return finish_report(report, args);
+}
+
+// a callback the timeline check retired, as it ran
+struct RetiredCall {
+    uint32_t index;  // in the order retire() was called
+    uint64_t value;
+    uint32_t submit;
+    uint32_t mark;  // what the submit wrote for the host, submit + 1 once its commands are done
+};
+
+// submits through the engine's graphics timeline, each submit filling scratch memory to keep the GPU
+// behind and then marking its slot for the host, and retires 0 to 2 callbacks at every value. Every 16
+// submits it waits for the value 8 submits back, as the frames wait for theirs. Logs and returns false
+// when a callback ran out of order, before its submit's mark was written or not once its value was reached
+static bool check_timeline(VulkanEngine& engine, uint32_t submits, std::vector<double>& submitUs) {
+    const char* mode                = engine._timelineSemaphores ? "timeline semaphore" : "fence";
+    vkutil::GpuTimeline& timeline   = engine._queues.timeline(vkutil::QueueKind::graphics);
+    const VkDeviceSize scratchBytes = 16 << 20;
+    AllocatedBuffer scratch         = engine.create_buffer(scratchBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    AllocatedBuffer marks           = engine.create_buffer(submits * sizeof(uint32_t), VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU);
+    void* data;
+    VK_CHECK(vmaMapMemory(engine._allocator, marks._allocation, &data));
+    uint32_t* mapped = (uint32_t*)data;
+    memset(mapped, 0, submits * sizeof(uint32_t));
+    vmaFlushAllocation(engine._allocator, marks._allocation, 0, VK_WHOLE_SIZE);
+
+    std::vector<uint64_t> retiredValues;  // by retire index
+    std::vector<RetiredCall> calls;
+    SceneRandom random(11);
+    SteadyClock clock;
+    bool waited = true;
+    for (uint32_t i = 0; i < submits && waited; i++) {
+        uint64_t start = clock.now_ns();
+        uint64_t value = engine._queues.submit(vkutil::QueueKind::graphics, [&](VkCommandBuffer cmd) {
+            vkCmdFillBuffer(cmd, scratch._buffer, 0, scratchBytes, i);
+            vkCmdFillBuffer(cmd, marks._buffer, i * sizeof(uint32_t), sizeof(uint32_t), i + 1);
+            VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER, nullptr, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT};
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        });
+        submitUs.push_back((clock.now_ns() - start) / 1e3);
+
+        for (uint32_t r = 0, count = random.next() % 3; r < count; r++) {
+            uint32_t index = (uint32_t)retiredValues.size();
+            retiredValues.push_back(value);
+            timeline.retire(value, [&engine, &calls, &marks, mapped, index, value, i]() {
+                vmaInvalidateAllocation(engine._allocator, marks._allocation, i * sizeof(uint32_t), sizeof(uint32_t));
+                calls.push_back({index, value, i, mapped[i]});
+            });
+        }
+
+        engine._queues.collect();
+        if (i % 16 == 15) {
+            uint64_t reached = value - 8;
+            timeline.wait(reached);
+            engine._queues.collect();
+            // the callbacks run in retire order, the first one that didn't run has to be past reached
+            if (calls.size() < retiredValues.size() && retiredValues[calls.size()] <= reached) {
+                LOGE("timeline: with %s sync a callback at value %llu didn't run after waiting for %llu", mode, (unsigned long long)retiredValues[calls.size()], (unsigned long long)reached);
+                waited = false;
+            }
+        }
+    }
+    timeline.wait(timeline.submitted());
+    engine._queues.collect();
+
+    vmaUnmapMemory(engine._allocator, marks._allocation);
+    vmaDestroyBuffer(engine._allocator, marks._buffer, marks._allocation);
+    vmaDestroyBuffer(engine._allocator, scratch._buffer, scratch._allocation);
+    if (!waited) {
+        return false;
+    }
+
+    if (calls.size() != retiredValues.size()) {
+        LOGE("timeline: with %s sync %zu of %zu callbacks ran", mode, calls.size(), retiredValues.size());
+        return false;
+    }
+    for (size_t k = 0; k < calls.size(); k++) {
+        const RetiredCall& call = calls[k];
+        if (call.index != k || (k > 0 && call.value < calls[k - 1].value)) {
+            LOGE("timeline: with %s sync callback %u at value %llu ran in place %zu", mode, call.index, (unsigned long long)call.value, k);
+            return false;
+        }
+        if (call.mark != call.submit + 1) {
+            LOGE("timeline: with %s sync the callback at value %llu ran before its submit's commands were done", mode, (unsigned long long)call.value);
+            return false;
+        }
+    }
+    return true;
+}
+
+static int timeline(int argc, char** argv) {
+    ReportArgs args  = {"timeline.json"};
+    uint32_t submits = 256;
+    FileAssetSource assets;
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (parse_report_arg(argc, argv, i, args)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--submits") && hasValue) {
+            submits = (uint32_t)atoi(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (submits < 16) {
+        return usage(argv[0]);
+    }
+    if (!open_vulkan(assets)) {
+        return 1;
+    }
+
+    BenchReport report;
+    report.set_info("submits", std::to_string(submits));
+    for (bool timelineSemaphores : {true, false}) {
+        // a tiny scene, the engine only provides the device, the allocator and the queues
+        VulkanEngine engine{};
+        engine._sceneConfig.objectCount = 0;
+        engine._startupProfile          = StartupProfile::Production;
+        engine._timelineSemaphores      = timelineSemaphores;
+        engine.init_headless(&assets, {64, 64});
+        if (timelineSemaphores && !engine._timelineSemaphores) {
+            LOGW("timeline: the device has no timeline semaphores, only the fence fallback is checked");
+            engine.cleanup();
+            continue;
+        }
+
+        std::vector<double> submitUs;
+        bool correct = check_timeline(engine, submits, submitUs);
+        engine.cleanup();
+        if (!correct) {
+            return 1;
+        }
+        SampleStats submit = summarize(submitUs);
+        printf("%s sync: %u submits, %.1f us p50 a submit\n", timelineSemaphores ? "timeline semaphore" : "fence", submits, submit.p50);
+        report.add_stats(timelineSemaphores ? "submit_us_timeline" : "submit_us_fences", submit);
+    }
+
+    return finish_report(report, args);
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && !strcmp(argv[1], "run")) {
+        return run(argc, argv);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "compare")) {
+        return compare(argc, argv);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "dispatch")) {
+        return dispatch(argc, argv);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "startup")) {
+        return startup(argc, argv);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "jobs")) {
+        return jobs(argc, argv);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "transforms")) {
+        return transforms(argc, argv);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "renderables")) {
+        return renderables(argc, argv);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "lods")) {
+        return lods(argc, argv);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "meshlets")) {
+        return meshlets(argc, argv);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "occlusion")) {
+        return occlusion(argc, argv);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "resolution")) {
+        return resolution(argc, argv);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "hud")) {
+        return hud(argc, argv);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "residency")) {
+        return residency(argc, argv);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "ring")) {
+        return ring(argc, argv);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "pacing")) {
+        return pacing(argc, argv);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "graph")) {
+        return graph(argc, argv);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "bandwidth")) {
+        return bandwidth(argc, argv);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "tasks")) {
+        return tasks(argc, argv);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "timeline")) {
+        return timeline(argc, argv);
+    }
+    return usage(argv[0]);
+}
@@ -0,0 +1,89 @@
+// Linux host front-end.
+// There is no windowing library in the tree, so the host build runs the engine headless:
+// it renders a number of frames into offscreen images and reports how long they took.
+//
+//   vkengine_host [--frames N] [--width W] [--height H] [--assets DIR]... [--production] [--cache FILE]
+//                 [--threads N] [--trace FILE] [--pacing MODE]
+//
+// --production starts without validation layers, --cache keeps the device capabilities in FILE
+// so the next launch doesn't query them again. --threads sets the init threads, 1 initializes
+// serially, and --trace writes the init phases as chrome://tracing JSON. --pacing picks fifo (the default),
+// mailbox, fifo-relaxed or low-latency frame pacing.
+
+#include <cstdlib>
+#include <cstring>
+#include "vulkan_wrapper.h"
+#include "vk_engine.h"
+
+// the shaders compiled by the build and the source asset directory, set by CMakeLists.txt
+#ifndef VKENGINE_SHADER_ROOT
+#define VKENGINE_SHADER_ROOT "."
+#endif
+#ifndef VKENGINE_ASSET_ROOT
+#define VKENGINE_ASSET_ROOT "assets"
+#endif
+
+int main(int argc, char** argv) {
+    uint32_t frames        = 600;
+    VkExtent2D extent      = {1280, 720};
+    StartupProfile profile = StartupProfile::Development;
+    const char* cachePath  = "";
+    const char* tracePath  = "";
+    uint32_t threads       = 0;
+    PacingMode pacingMode  = PacingMode::Fifo;
+    FileAssetSource assets;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--frames") && hasValue) {
+            frames = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--width") && hasValue) {
+            extent.width = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--height") && hasValue) {
+            extent.height = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--assets") && hasValue) {
+            assets.add_root(argv[++i]);
+        } else if (!strcmp(argv[i], "--production")) {
+            profile = StartupProfile::Production;
+        } else if (!strcmp(argv[i], "--cache") && hasValue) {
+            cachePath = argv[++i];
+        } else if (!strcmp(argv[i], "--threads") && hasValue) {
+            threads = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--trace") && hasValue) {
+            tracePath = argv[++i];
+        } else if (!strcmp(argv[i], "--pacing") && hasValue && parse_pacing_mode(argv[i + 1], pacingMode)) {
+            i++;
+        } else {
+            LOGE("usage: %s [--frames N] [--width W] [--height H] [--assets DIR]... [--production] [--cache FILE] [--threads N] [--trace FILE] [--pacing fifo|mailbox|fifo-relaxed|low-latency]", argv[0]);
+            return 1;
+        }
+    }
+    assets.add_root(VKENGINE_SHADER_ROOT);
+    assets.add_root(VKENGINE_ASSET_ROOT);
+
+    if (!InitVulkan()) {
+        LOGE("Vulkan is unavailable, install a Vulkan driver and loader");
+        return 1;
+    }
+
+    VulkanEngine engine{};
+    engine._startupProfile      = profile;
+    engine._capabilityCachePath = cachePath;
+    engine._initThreads         = threads;
+    engine._startupTracePath    = tracePath;
+    engine._pacingMode          = pacingMode;
+    engine.init_headless(&assets, extent);
+
+    SteadyClock clock;
+    uint64_t start = clock.now_ns();
+    for (uint32_t i = 0; i < frames; i++) {
+        engine.draw();
+    }
+    uint64_t elapsed = clock.now_ns() - start;
+
+    engine.cleanup();
+
+    double ms = elapsed / 1e6;
+    LOGI("%u frames at %ux%u in %.1f ms, %.3f ms/frame", frames, extent.width, extent.height, ms, frames ? ms / frames : 0.0);
+    return 0;
+}
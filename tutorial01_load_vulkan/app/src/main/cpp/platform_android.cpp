@@ -0,0 +1,23 @@
+#include "vulkan_wrapper.h"
+#include "platform_android.h"
+#include "log.h"
+
+bool AndroidAssetSource::read(const char* path, std::vector<char>& outContent) {
+    AAsset* file = AAssetManager_open(_assetManager, path, AASSET_MODE_BUFFER);
+    if (!file) {
+        return false;
+    }
+    outContent.resize(AAsset_getLength(file));
+    AAsset_read(file, outContent.data(), outContent.size());
+    AAsset_close(file);
+    return true;
+}
+
+VkSurfaceKHR AndroidWindow::create_surface(VkInstance instance) {
+    VkAndroidSurfaceCreateInfoKHR createInfo{.sType = VK_STRUCTURE_TYPE_ANDROID_SURFACE_CREATE_INFO_KHR, .pNext = nullptr, .flags = 0, .window = _window};
+    VkSurfaceKHR surface;
+    VK_CHECK(vkCreateAndroidSurfaceKHR(instance, &createInfo, nullptr, &surface));
+    return surface;
+}
+
+VkExtent2D AndroidWindow::extent() const { return {(uint32_t)ANativeWindow_getWidth(_window), (uint32_t)ANativeWindow_getHeight(_window)}; }
@@ -0,0 +1,27 @@
+#pragma once
+#include <game-activity/native_app_glue/android_native_app_glue.h>
+#include "vk_assets.h"
+#include "vk_platform.h"
+
+// assets packed into the apk
+class AndroidAssetSource : public AssetSource {
+   public:
+    explicit AndroidAssetSource(AAssetManager* assetManager) : _assetManager(assetManager) {}
+
+    bool read(const char* path, std::vector<char>& outContent) override;
+
+   private:
+    AAssetManager* _assetManager;
+};
+
+// the activity window
+class AndroidWindow : public PlatformWindow {
+   public:
+    explicit AndroidWindow(ANativeWindow* window) : _window(window) {}
+
+    VkSurfaceKHR create_surface(VkInstance instance) override;
+    VkExtent2D extent() const override;
+
+   private:
+    ANativeWindow* _window;
+};
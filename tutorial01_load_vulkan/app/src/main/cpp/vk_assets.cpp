@@ -0,0 +1,20 @@
+#include <cstdio>
+#include "vk_assets.h"
+
+bool FileAssetSource::read(const char* path, std::vector<char>& outContent) {
+    for (const std::string& root : _roots) {
+        std::string fullPath = root.empty() ? std::string(path) : root + "/" + path;
+        FILE* file           = fopen(fullPath.c_str(), "rb");
+        if (!file) {
+            continue;
+        }
+        fseek(file, 0, SEEK_END);
+        long length = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        outContent.resize(length > 0 ? (size_t)length : 0);
+        size_t read = outContent.empty() ? 0 : fread(outContent.data(), 1, outContent.size(), file);
+        fclose(file);
+        return read == outContent.size();
+    }
+    return false;
+}
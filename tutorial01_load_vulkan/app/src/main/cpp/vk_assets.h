@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Read only access to the engine assets: shaders, meshes, textures and materials.
+// Paths are relative to the asset root, e.g. "shaders/mesh.vert.spv". Each front-end
+// supplies its own source, the apk on Android and plain directories on the host.
+class AssetSource {
+   public:
+    virtual ~AssetSource() = default;
+
+    // reads the whole asset, returns false when it doesn't exist
+    virtual bool read(const char* path, std::vector<char>& outContent) = 0;
+};
+
+// assets as files below a list of root directories, the first root holding the file wins
+class FileAssetSource : public AssetSource {
+   public:
+    void add_root(const std::string& directory) { _roots.push_back(directory); }
+    const std::vector<std::string>& roots() const { return _roots; }
+
+    bool read(const char* path, std::vector<char>& outContent) override;
+
+   private:
+    std::vector<std::string> _roots;
+};
@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "vk_bench.h"
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    // nearest rank
+    size_t rank = (size_t)std::ceil(p * sorted.size());
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+SampleStats summarize(std::vector<double> samples) {
+    SampleStats stats = {};
+    if (samples.empty()) {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+    stats.avg = sum / samples.size();
+    stats.p50 = percentile(samples, 0.50);
+    stats.p95 = percentile(samples, 0.95);
+    stats.p99 = percentile(samples, 0.99);
+    stats.max = samples.back();
+    return stats;
+}
+
+void BenchReport::set_info(const std::string& key, const std::string& value) {
+    for (auto& info : _info) {
+        if (info.first == key) {
+            info.second = value;
+            return;
+        }
+    }
+    _info.emplace_back(key, value);
+}
+
+void BenchReport::add_metric(const std::string& name, double value, MetricDirection direction) { _metrics.push_back({name, value, direction}); }
+
+void BenchReport::add_stats(const std::string& name, const SampleStats& stats) {
+    add_metric(name + "_avg", stats.avg);
+    add_metric(name + "_p50", stats.p50);
+    add_metric(name + "_p95", stats.p95);
+    add_metric(name + "_p99", stats.p99);
+    add_metric(name + "_max", stats.max);
+}
+
+const BenchReport::Metric* BenchReport::find(const std::string& name) const {
+    for (const Metric& metric : _metrics) {
+        if (metric.name == name) {
+            return &metric;
+        }
+    }
+    return nullptr;
+}
+
+static std::string escape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += (c == '\n' || c == '\t') ? ' ' : c;
+    }
+    return out;
+}
+
+std::string BenchReport::to_json() const {
+    std::string json = "{\n  \"info\": {";
+    for (size_t i = 0; i < _info.size(); i++) {
+        json += i ? ",\n    " : "\n    ";
+        json += "\"" + escape(_info[i].first) + "\": \"" + escape(_info[i].second) + "\"";
+    }
+    json += "\n  },\n  \"metrics\": {";
+    char number[64];
+    for (size_t i = 0; i < _metrics.size(); i++) {
+        json += i ? ",\n    " : "\n    ";
+        snprintf(number, sizeof(number), "%.9g", _metrics[i].value);
+        json += "\"" + escape(_metrics[i].name) + "\": " + number;
+    }
+    json += "\n  }";
+    bool directions = false;
+    for (const Metric& metric : _metrics) {
+        if (metric.direction == MetricDirection::HigherIsBetter) {
+            json += directions ? ",\n    " : ",\n  \"directions\": {\n    ";
+            json += "\"" + escape(metric.name) + "\": \"higher_is_better\"";
+            directions = true;
+        }
+    }
+    json += directions ? "\n  }\n}\n" : "\n}\n";
+    return json;
+}
+
+// just enough JSON for the reports to_json writes: objects of strings and numbers
+struct JsonCursor {
+    const std::string& text;
+    size_t pos;
+
+    void skip_space() {
+        while (pos < text.size() && isspace((unsigned char)text[pos])) {
+            pos++;
+        }
+    }
+    bool consume(char c) {
+        skip_space();
+        if (pos < text.size() && text[pos] == c) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+    bool string(std::string& out) {
+        if (!consume('"')) {
+            return false;
+        }
+        out.clear();
+        while (pos < text.size() && text[pos] != '"') {
+            if (text[pos] == '\\' && pos + 1 < text.size()) {
+                pos++;
+            }
+            out += text[pos++];
+        }
+        return consume('"');
+    }
+    bool number(double& out) {
+        skip_space();
+        const char* start = text.c_str() + pos;
+        char* end;
+        out = strtod(start, &end);
+        pos += end - start;
+        return end != start;
+    }
+};
+
+bool BenchReport::from_json(const std::string& json) {
+    JsonCursor cursor{json, 0};
+    _info.clear();
+    _metrics.clear();
+
+    if (!cursor.consume('{')) {
+        return false;
+    }
+    std::string section;
+    do {
+        if (!cursor.string(section) || !cursor.consume(':') || !cursor.consume('{')) {
+            return false;
+        }
+        if (!cursor.consume('}')) {
+            std::string key, value;
+            double number;
+            do {
+                if (!cursor.string(key) || !cursor.consume(':')) {
+                    return false;
+                }
+                if (section == "metrics") {
+                    if (!cursor.number(number)) {
+                        return false;
+                    }
+                    add_metric(key, number);
+                } else if (section == "directions") {
+                    // after the metrics, to_json writes them last
+                    if (!cursor.string(value)) {
+                        return false;
+                    }
+                    for (Metric& metric : _metrics) {
+                        if (metric.name == key && value == "higher_is_better") {
+                            metric.direction = MetricDirection::HigherIsBetter;
+                        }
+                    }
+                } else {
+                    if (!cursor.string(value)) {
+                        return false;
+                    }
+                    set_info(key, value);
+                }
+            } while (cursor.consume(','));
+            if (!cursor.consume('}')) {
+                return false;
+            }
+        }
+    } while (cursor.consume(','));
+    return cursor.consume('}');
+}
+
+bool BenchReport::write(const char* path) const {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    std::string json = to_json();
+    bool ok          = fwrite(json.data(), 1, json.size(), file) == json.size();
+    return fclose(file) == 0 && ok;
+}
+
+bool BenchReport::read(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    std::string json;
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        json.append(buffer, read);
+    }
+    fclose(file);
+    return from_json(json);
+}
+
+std::vector<MetricDelta> compare_reports(const BenchReport& baseline, const BenchReport& current, double threshold, double minDelta) {
+    std::vector<MetricDelta> deltas;
+    for (const BenchReport::Metric& base : baseline.metrics()) {
+        const BenchReport::Metric* now = current.find(base.name);
+        if (!now) {
+            continue;
+        }
+        bool higher = base.direction == MetricDirection::HigherIsBetter || now->direction == MetricDirection::HigherIsBetter;
+        // how much worse, in the metric's own direction
+        double worse = higher ? base.value - now->value : now->value - base.value;
+        MetricDelta delta;
+        delta.name      = base.name;
+        delta.baseline  = base.value;
+        delta.current   = now->value;
+        delta.change    = base.value != 0.0 ? worse / std::fabs(base.value) : (now->value != 0.0 ? (worse > 0.0 ? 1.0 : -1.0) : 0.0);
+        delta.direction = higher ? MetricDirection::HigherIsBetter : MetricDirection::LowerIsBetter;
+        delta.regressed = delta.change > threshold && worse > minDelta;
+        deltas.push_back(delta);
+    }
+    return deltas;
+}
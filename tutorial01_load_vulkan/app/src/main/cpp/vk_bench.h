@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// summary of per-frame samples, in the unit of the samples
+struct SampleStats {
+    double avg;
+    double p50;
+    double p95;
+    double p99;
+    double max;
+};
+
+SampleStats summarize(std::vector<double> samples);
+
+// which way a metric improves, most are times, sizes and counts where lower is better
+enum class MetricDirection {
+    LowerIsBetter,
+    HigherIsBetter,  // speedups, scales, work saved
+};
+
+// A benchmark result: a few descriptive fields plus named metrics, lower is better unless added otherwise.
+// Serialized as {"info": {"key": "value", ...}, "metrics": {"name": number, ...}, "directions": {"name":
+// "higher_is_better", ...}}, directions only lists the metrics that aren't lower is better.
+class BenchReport {
+   public:
+    struct Metric {
+        std::string name;
+        double value;
+        MetricDirection direction;
+    };
+
+    void set_info(const std::string& key, const std::string& value);
+    void add_metric(const std::string& name, double value, MetricDirection direction = MetricDirection::LowerIsBetter);
+    // adds name_avg, name_p50, name_p95, name_p99 and name_max
+    void add_stats(const std::string& name, const SampleStats& stats);
+
+    const std::vector<Metric>& metrics() const { return _metrics; }
+    // nullptr when the report has no such metric
+    const Metric* find(const std::string& name) const;
+
+    std::string to_json() const;
+    // reads what to_json wrote, returns false on anything else
+    bool from_json(const std::string& json);
+
+    bool write(const char* path) const;
+    bool read(const char* path);
+
+   private:
+    std::vector<std::pair<std::string, std::string>> _info;
+    std::vector<Metric> _metrics;
+};
+
+struct MetricDelta {
+    std::string name;
+    double baseline;
+    double current;
+    double change;  // relative, +0.1 is 10% worse whichever way the metric improves
+    MetricDirection direction;
+    bool regressed;
+};
+
+// Compares every metric both reports have. A metric regresses when it got worse by more than threshold
+// relative to the baseline, and by more than minDelta in absolute terms so that counters near zero
+// and sub-microsecond timings don't trip the gate on noise. Worse is growing, or shrinking for the
+// metrics either report marks as higher is better.
+std::vector<MetricDelta> compare_reports(const BenchReport& baseline, const BenchReport& current, double threshold, double minDelta = 1e-3);
@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "vk_capabilities.h"
+#include "log.h"
+
+// bump when the layout of the file changes
+static const uint32_t kDatabaseVersion = 3;
+static const char kDatabaseMagic[8]    = {'V', 'K', 'C', 'A', 'P', 'D', 'B', 0};
+
+const VkFormat kCapabilityFormats[] = {
+    VK_FORMAT_R8G8B8A8_UNORM,
+    VK_FORMAT_R8G8B8A8_SRGB,
+    VK_FORMAT_B8G8R8A8_UNORM,
+    VK_FORMAT_B8G8R8A8_SRGB,
+    VK_FORMAT_R16G16B16A16_SFLOAT,
+    VK_FORMAT_D32_SFLOAT,
+    VK_FORMAT_X8_D24_UNORM_PACK32,
+    VK_FORMAT_D24_UNORM_S8_UINT,
+    VK_FORMAT_D16_UNORM,
+};
+const uint32_t kCapabilityFormatCount = sizeof(kCapabilityFormats) / sizeof(kCapabilityFormats[0]);
+
+bool DeviceCapabilities::has_extension(const char* name) const {
+    return std::binary_search(extensions.begin(), extensions.end(), std::string(name));
+}
+
+VkFormatProperties DeviceCapabilities::format_properties(VkFormat format) const {
+    for (auto& entry : formats) {
+        if (entry.first == format) {
+            return entry.second;
+        }
+    }
+    return {};
+}
+
+bool query_device_identity(VkInstance instance, VkPhysicalDevice gpu, DeviceIdentity& outIdentity) {
+    auto getProperties2 = (PFN_vkGetPhysicalDeviceProperties2)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceProperties2");
+    if (!getProperties2) {
+        return false;
+    }
+    VkPhysicalDeviceIDProperties idProperties = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES};
+    VkPhysicalDeviceProperties2 properties2   = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, &idProperties};
+    getProperties2(gpu, &properties2);
+
+    memcpy(outIdentity.deviceUUID, idProperties.deviceUUID, VK_UUID_SIZE);
+    outIdentity.driverVersion = properties2.properties.driverVersion;
+    return true;
+}
+
+bool query_device_capabilities(VkInstance instance, VkPhysicalDevice gpu, DeviceCapabilities& outCaps) {
+    auto getFeatures2   = (PFN_vkGetPhysicalDeviceFeatures2)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2");
+    auto getProperties2 = (PFN_vkGetPhysicalDeviceProperties2)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceProperties2");
+    if (!getFeatures2 || !getProperties2) {
+        return false;
+    }
+    outCaps = {};
+
+    uint32_t count = 0;
+    VK_CHECK(vkEnumerateDeviceExtensionProperties(gpu, nullptr, &count, nullptr));
+    std::vector<VkExtensionProperties> extensions(count);
+    VK_CHECK(vkEnumerateDeviceExtensionProperties(gpu, nullptr, &count, extensions.data()));
+    for (auto& ext : extensions) {
+        outCaps.extensions.push_back(ext.extensionName);
+    }
+    std::sort(outCaps.extensions.begin(), outCaps.extensions.end());
+
+    // the extension structs may only be chained when their extension is there
+    bool descriptorIndexing                                             = outCaps.has_extension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    bool conditionalRendering                                           = outCaps.has_extension(VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME);
+    bool timelineSemaphore                                              = outCaps.has_extension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+    VkPhysicalDeviceConditionalRenderingFeaturesEXT conditionalFeatures = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_CONDITIONAL_RENDERING_FEATURES_EXT};
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures       = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR};
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures      = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT};
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProperties  = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT};
+    VkPhysicalDeviceIDProperties idProperties                           = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES, descriptorIndexing ? &indexingProperties : nullptr};
+
+    void* featureChain = nullptr;
+    if (conditionalRendering) {
+        conditionalFeatures.pNext = featureChain;
+        featureChain              = &conditionalFeatures;
+    }
+    if (timelineSemaphore) {
+        timelineFeatures.pNext = featureChain;
+        featureChain           = &timelineFeatures;
+    }
+    if (descriptorIndexing) {
+        indexingFeatures.pNext = featureChain;
+        featureChain           = &indexingFeatures;
+    }
+    VkPhysicalDeviceFeatures2 features2 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, featureChain};
+    getFeatures2(gpu, &features2);
+    VkPhysicalDeviceProperties2 properties2 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, &idProperties};
+    getProperties2(gpu, &properties2);
+
+    memcpy(outCaps.identity.deviceUUID, idProperties.deviceUUID, VK_UUID_SIZE);
+    outCaps.identity.driverVersion = properties2.properties.driverVersion;
+    outCaps.vendorID               = properties2.properties.vendorID;
+    outCaps.deviceID               = properties2.properties.deviceID;
+    outCaps.features               = features2.features;
+    vkGetPhysicalDeviceMemoryProperties(gpu, &outCaps.memory);
+
+    if (descriptorIndexing) {
+        outCaps.partiallyBound              = indexingFeatures.descriptorBindingPartiallyBound;
+        outCaps.sampledImageUpdateAfterBind = indexingFeatures.descriptorBindingSampledImageUpdateAfterBind;
+        outCaps.updateAfterBindTextureLimit = std::min({indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers, indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages, indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages});
+    }
+    outCaps.conditionalRendering = conditionalRendering && conditionalFeatures.conditionalRendering;
+    outCaps.timelineSemaphore    = timelineSemaphore && timelineFeatures.timelineSemaphore;
+
+    for (uint32_t i = 0; i < kCapabilityFormatCount; i++) {
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(gpu, kCapabilityFormats[i], &properties);
+        outCaps.formats.push_back({kCapabilityFormats[i], properties});
+    }
+    return true;
+}
+
+// plain little helpers over a byte buffer, the file never leaves the device that wrote it
+static void put(std::vector<char>& out, const void* data, size_t size) {
+    out.insert(out.end(), (const char*)data, (const char*)data + size);
+}
+
+static void put_u32(std::vector<char>& out, uint32_t value) {
+    put(out, &value, sizeof(value));
+}
+
+struct ByteReader {
+    const char* data;
+    size_t size;
+    size_t offset;
+
+    bool get(void* out, size_t bytes) {
+        if (bytes > size - offset) {
+            return false;
+        }
+        memcpy(out, data + offset, bytes);
+        offset += bytes;
+        return true;
+    }
+    bool get_u32(uint32_t& value) { return get(&value, sizeof(value)); }
+};
+
+bool CapabilityDatabase::load(const char* path) {
+    _devices.clear();
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    std::vector<char> bytes;
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + read);
+    }
+    fclose(file);
+
+    ByteReader reader = {bytes.data(), bytes.size(), 0};
+    char magic[sizeof(kDatabaseMagic)];
+    uint32_t version, featuresSize, memorySize, deviceCount;
+    if (!reader.get(magic, sizeof(magic)) || memcmp(magic, kDatabaseMagic, sizeof(magic)) != 0 || !reader.get_u32(version) || version != kDatabaseVersion) {
+        return false;
+    }
+    // the structs are stored raw, a build with other Vulkan headers can't read them
+    if (!reader.get_u32(featuresSize) || featuresSize != sizeof(VkPhysicalDeviceFeatures) || !reader.get_u32(memorySize) || memorySize != sizeof(VkPhysicalDeviceMemoryProperties)) {
+        return false;
+    }
+
+    std::vector<DeviceCapabilities> devices;
+    if (!reader.get_u32(deviceCount)) {
+        return false;
+    }
+    for (uint32_t d = 0; d < deviceCount; d++) {
+        DeviceCapabilities caps = {};
+        uint32_t extensionCount, formatCount, partiallyBound, updateAfterBind, conditionalRendering, timelineSemaphore;
+        if (!reader.get(caps.identity.deviceUUID, VK_UUID_SIZE) || !reader.get_u32(caps.identity.driverVersion) || !reader.get_u32(caps.vendorID) || !reader.get_u32(caps.deviceID)) {
+            return false;
+        }
+        if (!reader.get_u32(extensionCount)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < extensionCount; i++) {
+            uint32_t length;
+            if (!reader.get_u32(length) || length > VK_MAX_EXTENSION_NAME_SIZE) {
+                return false;
+            }
+            std::string name(length, '\0');
+            if (!reader.get(&name[0], length)) {
+                return false;
+            }
+            caps.extensions.push_back(name);
+        }
+        if (!reader.get(&caps.features, sizeof(caps.features)) || !reader.get(&caps.memory, sizeof(caps.memory))) {
+            return false;
+        }
+        if (!reader.get_u32(partiallyBound) || !reader.get_u32(updateAfterBind) || !reader.get_u32(caps.updateAfterBindTextureLimit) || !reader.get_u32(conditionalRendering) || !reader.get_u32(timelineSemaphore) || !reader.get_u32(formatCount)) {
+            return false;
+        }
+        caps.partiallyBound              = partiallyBound != 0;
+        caps.sampledImageUpdateAfterBind = updateAfterBind != 0;
+        caps.conditionalRendering        = conditionalRendering != 0;
+        caps.timelineSemaphore           = timelineSemaphore != 0;
+        for (uint32_t i = 0; i < formatCount; i++) {
+            uint32_t format;
+            VkFormatProperties properties;
+            if (!reader.get_u32(format) || !reader.get(&properties, sizeof(properties))) {
+                return false;
+            }
+            caps.formats.push_back({(VkFormat)format, properties});
+        }
+        devices.push_back(caps);
+    }
+    _devices = devices;
+    return true;
+}
+
+bool CapabilityDatabase::save(const char* path) const {
+    std::vector<char> bytes;
+    put(bytes, kDatabaseMagic, sizeof(kDatabaseMagic));
+    put_u32(bytes, kDatabaseVersion);
+    put_u32(bytes, sizeof(VkPhysicalDeviceFeatures));
+    put_u32(bytes, sizeof(VkPhysicalDeviceMemoryProperties));
+    put_u32(bytes, (uint32_t)_devices.size());
+    for (auto& caps : _devices) {
+        put(bytes, caps.identity.deviceUUID, VK_UUID_SIZE);
+        put_u32(bytes, caps.identity.driverVersion);
+        put_u32(bytes, caps.vendorID);
+        put_u32(bytes, caps.deviceID);
+        put_u32(bytes, (uint32_t)caps.extensions.size());
+        for (auto& name : caps.extensions) {
+            put_u32(bytes, (uint32_t)name.size());
+            put(bytes, name.data(), name.size());
+        }
+        put(bytes, &caps.features, sizeof(caps.features));
+        put(bytes, &caps.memory, sizeof(caps.memory));
+        put_u32(bytes, caps.partiallyBound);
+        put_u32(bytes, caps.sampledImageUpdateAfterBind);
+        put_u32(bytes, caps.updateAfterBindTextureLimit);
+        put_u32(bytes, caps.conditionalRendering);
+        put_u32(bytes, caps.timelineSemaphore);
+        put_u32(bytes, (uint32_t)caps.formats.size());
+        for (auto& entry : caps.formats) {
+            put_u32(bytes, (uint32_t)entry.first);
+            put(bytes, &entry.second, sizeof(entry.second));
+        }
+    }
+
+    // write next to the old file and swap, so a crash never leaves half a database behind
+    std::string tmpPath = std::string(path) + ".tmp";
+    FILE* file          = fopen(tmpPath.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    ok      = fclose(file) == 0 && ok;
+    if (!ok || rename(tmpPath.c_str(), path) != 0) {
+        remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+const DeviceCapabilities* CapabilityDatabase::find(const DeviceIdentity& identity) const {
+    for (auto& caps : _devices) {
+        if (memcmp(caps.identity.deviceUUID, identity.deviceUUID, VK_UUID_SIZE) == 0 && caps.identity.driverVersion == identity.driverVersion) {
+            return &caps;
+        }
+    }
+    return nullptr;
+}
+
+void CapabilityDatabase::store(const DeviceCapabilities& caps) {
+    for (auto& existing : _devices) {
+        if (memcmp(existing.identity.deviceUUID, caps.identity.deviceUUID, VK_UUID_SIZE) == 0) {
+            existing = caps;
+            return;
+        }
+    }
+    _devices.push_back(caps);
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "vk_types.h"
+
+// identifies a device and driver build, the key of the capability database
+struct DeviceIdentity {
+    uint8_t deviceUUID[VK_UUID_SIZE];
+    uint32_t driverVersion;
+};
+
+// What the engine asks the driver about a physical device before creating the logical device.
+struct DeviceCapabilities {
+    DeviceIdentity identity;
+    uint32_t vendorID;
+    uint32_t deviceID;
+    std::vector<std::string> extensions;  // sorted
+    VkPhysicalDeviceFeatures features;
+    VkPhysicalDeviceMemoryProperties memory;
+    std::vector<std::pair<VkFormat, VkFormatProperties>> formats;  // the formats in kCapabilityFormats
+
+    // descriptor indexing support of the material table, false and 0 without the extension
+    bool partiallyBound;
+    bool sampledImageUpdateAfterBind;
+    uint32_t updateAfterBindTextureLimit;  // smallest of the update-after-bind sampler and sampled image limits
+    // VK_EXT_conditional_rendering, draws predicated on the occlusion query results
+    bool conditionalRendering;
+    // VK_KHR_timeline_semaphore, core in Vulkan 1.2
+    bool timelineSemaphore;
+
+    bool has_extension(const char* name) const;
+    // all zero for a format outside kCapabilityFormats
+    VkFormatProperties format_properties(VkFormat format) const;
+};
+
+// formats whose properties are part of the database: color targets, textures and depth candidates
+extern const VkFormat kCapabilityFormats[];
+extern const uint32_t kCapabilityFormatCount;
+
+// one vkGetPhysicalDeviceProperties2 call, the only query a warm start makes
+bool query_device_identity(VkInstance instance, VkPhysicalDevice gpu, DeviceIdentity& outIdentity);
+// the full set of queries of a cold start
+bool query_device_capabilities(VkInstance instance, VkPhysicalDevice gpu, DeviceCapabilities& outCaps);
+
+// Device capabilities persisted between launches.
+// Entries are keyed by device UUID and driver version, so a driver update invalidates the entry of
+// its device and the next launch queries the driver again. The file is a raw dump for this build
+// and device only, anything that doesn't match the expected layout is dropped whole.
+class CapabilityDatabase {
+   public:
+    // false when the file is missing or unreadable, the database is empty then
+    bool load(const char* path);
+    bool save(const char* path) const;
+
+    // nullptr when the device isn't known or its driver changed
+    const DeviceCapabilities* find(const DeviceIdentity& identity) const;
+    // adds caps, replacing the entry of an older driver of the same device
+    void store(const DeviceCapabilities& caps);
+
+    size_t size() const { return _devices.size(); }
+
+   private:
+    std::vector<DeviceCapabilities> _devices;
+};
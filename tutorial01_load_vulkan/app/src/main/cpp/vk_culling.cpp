@@ -0,0 +1,362 @@
+#include <algorithm>
+#include <cstring>
+#include "vk_culling.h"
+#include "vk_occlusion.h"
+#include "vk_init.h"
+#include "log.h"
+
+namespace {
+
+AllocatedBuffer create_buffer(VmaAllocator allocator, VkDeviceSize size, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage, const char* name) {
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size               = size;
+    bufferInfo.usage              = usage;
+
+    VmaAllocationCreateInfo vmaallocInfo = {};
+    vmaallocInfo.usage                   = memoryUsage;
+    vmaallocInfo.pUserData               = (void*)name;
+
+    AllocatedBuffer buffer;
+    VK_CHECK(vmaCreateBuffer(allocator, &bufferInfo, &vmaallocInfo, &buffer._buffer, &buffer._allocation, nullptr));
+    return buffer;
+}
+
+AllocatedBuffer upload_buffer(VmaAllocator allocator, const void* data, VkDeviceSize size, VkBufferUsageFlags usage, const char* name) {
+    AllocatedBuffer buffer = create_buffer(allocator, size, usage, VMA_MEMORY_USAGE_CPU_TO_GPU, name);
+    void* mapped;
+    VK_CHECK(vmaMapMemory(allocator, buffer._allocation, &mapped));
+    memcpy(mapped, data, size);
+    vmaUnmapMemory(allocator, buffer._allocation);
+    return buffer;
+}
+
+}  // namespace
+
+void GpuCulling::init(VkDevice device, VmaAllocator allocator, VkBuffer transientBuffer, VkDeviceSize instanceRange, uint32_t maxDraws, bool occlusion, PFN_vkCmdDrawIndexedIndirectCountKHR drawIndexedIndirectCount) {
+    _device                   = device;
+    _allocator                = allocator;
+    _maxDraws                 = maxDraws;
+    _drawIndexedIndirectCount = drawIndexedIndirectCount;
+
+    // meshlet.vert reads the instances for the material, everything else is for the cull shader alone
+    VkDescriptorSetLayoutBinding bindings[] = {
+        vkinit::descriptorset_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT, kInstancesBinding),
+        vkinit::descriptorset_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, kMeshletsBinding),
+        vkinit::descriptorset_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, kDrawsBinding),
+        vkinit::descriptorset_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, kCountBinding),
+        vkinit::descriptorset_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, kOccludedBinding),
+        vkinit::descriptorset_layout_binding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, kPyramidBinding),
+    };
+    VkDescriptorSetLayoutCreateInfo setInfo = {};
+    setInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setInfo.pNext                           = nullptr;
+    setInfo.bindingCount                    = 6;
+    setInfo.pBindings                       = bindings;
+    VK_CHECK(vkCreateDescriptorSetLayout(_device, &setInfo, nullptr, &_setLayout));
+
+    VkDescriptorPoolSize sizes[] = {
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, FRAME_OVERLAP},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4 * FRAME_OVERLAP},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, FRAME_OVERLAP},
+    };
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags                      = 0;
+    poolInfo.maxSets                    = FRAME_OVERLAP;
+    poolInfo.poolSizeCount              = 3;
+    poolInfo.pPoolSizes                 = sizes;
+    VK_CHECK(vkCreateDescriptorPool(_device, &poolInfo, nullptr, &_pool));
+
+    VkDescriptorSetLayout layouts[FRAME_OVERLAP];
+    for (uint32_t i = 0; i < FRAME_OVERLAP; i++) {
+        layouts[i] = _setLayout;
+    }
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool              = _pool;
+    allocInfo.descriptorSetCount          = FRAME_OVERLAP;
+    allocInfo.pSetLayouts                 = layouts;
+    VK_CHECK(vkAllocateDescriptorSets(_device, &allocInfo, _sets));
+
+    // the draws never leave the GPU, the counts are cleared with vkCmdFillBuffer every frame and read
+    // back for the stats once the frame is done
+    VkDeviceSize drawBytes     = sizeof(VkDrawIndexedIndirectCommand) * (VkDeviceSize)_maxDraws * (occlusion ? 2 : 1);
+    VkDeviceSize occludedBytes = sizeof(uint32_t) * (instanceRange / sizeof(GPUInstance));
+    for (uint32_t i = 0; i < FRAME_OVERLAP; i++) {
+        _drawBuffers[i]     = create_buffer(_allocator, drawBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY, "MeshletDraws");
+        _countBuffers[i]    = create_buffer(_allocator, sizeof(GPUCullCounts), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU, "MeshletDrawCount");
+        _occludedBuffers[i] = create_buffer(_allocator, occludedBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY, "OccludedInstances");
+
+        VkDescriptorBufferInfo instanceInfo = {transientBuffer, 0, instanceRange};
+        VkDescriptorBufferInfo drawInfo     = {_drawBuffers[i]._buffer, 0, drawBytes};
+        VkDescriptorBufferInfo countInfo    = {_countBuffers[i]._buffer, 0, sizeof(GPUCullCounts)};
+        VkDescriptorBufferInfo occludedInfo = {_occludedBuffers[i]._buffer, 0, occludedBytes};
+        VkWriteDescriptorSet writes[]       = {
+            vkinit::write_descriptor_buffer(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, _sets[i], &instanceInfo, kInstancesBinding),
+            vkinit::write_descriptor_buffer(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, _sets[i], &drawInfo, kDrawsBinding),
+            vkinit::write_descriptor_buffer(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, _sets[i], &countInfo, kCountBinding),
+            vkinit::write_descriptor_buffer(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, _sets[i], &occludedInfo, kOccludedBinding),
+        };
+        vkUpdateDescriptorSets(_device, 4, writes, 0, nullptr);
+    }
+
+    LOGI("GpuCulling: %u draws per frame and list, %s, occlusion culling %s", _maxDraws, _drawIndexedIndirectCount ? "draw count from the GPU" : "fixed draw count", occlusion ? "on" : "off");
+}
+
+void GpuCulling::set_depth_pyramid(const DepthPyramid& pyramid) {
+    VkDescriptorImageInfo imageInfo = {pyramid._sampler, pyramid._view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    for (uint32_t i = 0; i < FRAME_OVERLAP; i++) {
+        VkWriteDescriptorSet write = vkinit::write_descriptor_image(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, _sets[i], &imageInfo, kPyramidBinding);
+        vkUpdateDescriptorSets(_device, 1, &write, 0, nullptr);
+    }
+}
+
+void GpuCulling::init_pipeline(VkShaderModule cullShader, VkDescriptorSetLayout materialLayout, VkDescriptorSetLayout frameLayout) {
+    VkPushConstantRange pushConstant   = {VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(GPUCullConstants)};
+    VkDescriptorSetLayout setLayouts[] = {materialLayout, frameLayout, _setLayout};
+
+    VkPipelineLayoutCreateInfo layoutInfo = vkinit::pipeline_layout_create_info();
+    layoutInfo.setLayoutCount             = 3;
+    layoutInfo.pSetLayouts                = setLayouts;
+    layoutInfo.pushConstantRangeCount     = 1;
+    layoutInfo.pPushConstantRanges        = &pushConstant;
+    VK_CHECK(vkCreatePipelineLayout(_device, &layoutInfo, nullptr, &_pipelineLayout));
+
+    VkComputePipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType                       = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage                       = vkinit::pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, cullShader);
+    pipelineInfo.layout                      = _pipelineLayout;
+    VK_CHECK(vkCreateComputePipelines(_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &_pipeline));
+}
+
+void GpuCulling::cleanup() {
+    vkDestroyPipeline(_device, _pipeline, nullptr);
+    vkDestroyPipelineLayout(_device, _pipelineLayout, nullptr);
+    for (uint32_t i = 0; i < FRAME_OVERLAP; i++) {
+        vmaDestroyBuffer(_allocator, _drawBuffers[i]._buffer, _drawBuffers[i]._allocation);
+        vmaDestroyBuffer(_allocator, _countBuffers[i]._buffer, _countBuffers[i]._allocation);
+        vmaDestroyBuffer(_allocator, _occludedBuffers[i]._buffer, _occludedBuffers[i]._allocation);
+    }
+    if (_hasGeometry) {
+        vmaDestroyBuffer(_allocator, _vertexBuffer._buffer, _vertexBuffer._allocation);
+        vmaDestroyBuffer(_allocator, _indexBuffer._buffer, _indexBuffer._allocation);
+        vmaDestroyBuffer(_allocator, _meshletBuffer._buffer, _meshletBuffer._allocation);
+    }
+    vkDestroyDescriptorPool(_device, _pool, nullptr);
+    vkDestroyDescriptorSetLayout(_device, _setLayout, nullptr);
+}
+
+void GpuCulling::upload_geometry(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<Meshlet>& meshlets) {
+    if (vertices.empty() || indices.empty() || meshlets.empty()) {
+        LOGE("GpuCulling: no meshlets to upload");
+        return;
+    }
+    _vertexBuffer  = upload_buffer(_allocator, vertices.data(), vertices.size() * sizeof(Vertex), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, "MeshletVertices");
+    _indexBuffer   = upload_buffer(_allocator, indices.data(), indices.size() * sizeof(uint32_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, "MeshletIndices");
+    _meshletBuffer = upload_buffer(_allocator, meshlets.data(), meshlets.size() * sizeof(Meshlet), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "Meshlets");
+    _hasGeometry   = true;
+
+    VkDescriptorBufferInfo meshletInfo = {_meshletBuffer._buffer, 0, meshlets.size() * sizeof(Meshlet)};
+    for (uint32_t i = 0; i < FRAME_OVERLAP; i++) {
+        VkWriteDescriptorSet write = vkinit::write_descriptor_buffer(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, _sets[i], &meshletInfo, kMeshletsBinding);
+        vkUpdateDescriptorSets(_device, 1, &write, 0, nullptr);
+    }
+}
+
+void GpuCulling::record_cull(VkCommandBuffer cmd, uint32_t frame, VkDescriptorSet frameSet, const uint32_t frameOffsets[2], uint32_t instanceOffset, const GPUCullConstants& constants) {
+    const AllocatedBuffer& draws = _drawBuffers[frame];
+    const AllocatedBuffer& count = _countBuffers[frame];
+    uint32_t list                = constants.phase == kCullLate ? 1 : 0;
+
+    // the late phase adds to the counts the early phase cleared. Without the count the draw reads all
+    // maxDraws commands of the list, the unwritten ones have to draw nothing
+    if (constants.phase != kCullLate) {
+        vkCmdFillBuffer(cmd, count._buffer, 0, sizeof(GPUCullCounts), 0);
+    }
+    if (!_drawIndexedIndirectCount) {
+        VkDeviceSize listBytes = sizeof(VkDrawIndexedIndirectCommand) * (VkDeviceSize)constants.maxDraws;
+        vkCmdFillBuffer(cmd, draws._buffer, listBytes * list, listBytes, 0);
+    }
+    // also orders the late phase after the early phase's flags and indirect reads
+    VkMemoryBarrier clearBarrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER, nullptr, VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT};
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+    if (_hasGeometry && constants.instanceCount > 0) {
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, _pipelineLayout, 1, 1, &frameSet, 2, frameOffsets);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, _pipelineLayout, 2, 1, &_sets[frame], 1, &instanceOffset);
+        vkCmdPushConstants(cmd, _pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(GPUCullConstants), &constants);
+        vkCmdDispatch(cmd, constants.instanceCount, 1, 1);
+    }
+
+    // the draws and the count are read as indirect arguments, the counts once more by read_counts
+    VkMemoryBarrier cullBarrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER, nullptr, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_HOST_READ_BIT};
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+}
+
+void GpuCulling::record_draw(VkCommandBuffer cmd, uint32_t frame, VkPipelineLayout layout, uint32_t instanceOffset, uint32_t maxDraws, uint32_t list) {
+    if (!_hasGeometry || maxDraws == 0) {
+        return;
+    }
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 2, 1, &_sets[frame], 1, &instanceOffset);
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(cmd, 0, 1, &_vertexBuffer._buffer, &offset);
+    vkCmdBindIndexBuffer(cmd, _indexBuffer._buffer, 0, VK_INDEX_TYPE_UINT32);
+
+    uint32_t stride         = sizeof(VkDrawIndexedIndirectCommand);
+    VkDeviceSize drawOffset = (VkDeviceSize)stride * maxDraws * list;
+    if (_drawIndexedIndirectCount) {
+        _drawIndexedIndirectCount(cmd, _drawBuffers[frame]._buffer, drawOffset, _countBuffers[frame]._buffer, sizeof(uint32_t) * list, maxDraws, stride);
+    } else {
+        vkCmdDrawIndexedIndirect(cmd, _drawBuffers[frame]._buffer, drawOffset, maxDraws, stride);
+    }
+}
+
+GPUCullCounts GpuCulling::read_counts(uint32_t frame) {
+    GPUCullCounts counts = {};
+    void* mapped;
+    VK_CHECK(vmaMapMemory(_allocator, _countBuffers[frame]._allocation, &mapped));
+    vmaInvalidateAllocation(_allocator, _countBuffers[frame]._allocation, 0, VK_WHOLE_SIZE);
+    memcpy(&counts, mapped, sizeof(counts));
+    vmaUnmapMemory(_allocator, _countBuffers[frame]._allocation);
+    return counts;
+}
+
+void DepthPyramid::init(VkDevice device, VmaAllocator allocator, VkExtent2D depthExtent) {
+    _device    = device;
+    _allocator = allocator;
+    depth_pyramid_extent(depthExtent.width, depthExtent.height, _extent.width, _extent.height);
+    _levels = std::min(depth_pyramid_levels(_extent.width, _extent.height), kMaxPyramidLevels);
+
+    VkImageCreateInfo imageInfo = vkinit::image_create_info(VK_FORMAT_R32_SFLOAT, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, {_extent.width, _extent.height, 1});
+    imageInfo.mipLevels         = _levels;
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
+    allocInfo.pUserData               = (void*)"DepthPyramid";
+    VK_CHECK(vmaCreateImage(_allocator, &imageInfo, &allocInfo, &_image._image, &_image._allocation, nullptr));
+
+    // cull.comp picks the level, the reduce dispatches write one level each
+    VkImageViewCreateInfo viewInfo       = vkinit::imageview_create_info(VK_FORMAT_R32_SFLOAT, _image._image, VK_IMAGE_ASPECT_COLOR_BIT);
+    viewInfo.subresourceRange.levelCount = _levels;
+    VK_CHECK(vkCreateImageView(_device, &viewInfo, nullptr, &_view));
+    viewInfo.subresourceRange.levelCount = 1;
+    for (uint32_t level = 0; level < _levels; level++) {
+        viewInfo.subresourceRange.baseMipLevel = level;
+        VK_CHECK(vkCreateImageView(_device, &viewInfo, nullptr, &_levelViews[level]));
+    }
+
+    // only read with texelFetch, the filter doesn't matter
+    VkSamplerCreateInfo samplerInfo = vkinit::sampler_create_info(VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE);
+    VK_CHECK(vkCreateSampler(_device, &samplerInfo, nullptr, &_sampler));
+}
+
+void DepthPyramid::init_reduce(VkShaderModule reduceShader, VkImageView depthView) {
+    VkDescriptorSetLayoutBinding bindings[] = {
+        vkinit::descriptorset_layout_binding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, 0),
+        vkinit::descriptorset_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, 1),
+    };
+    VkDescriptorSetLayoutCreateInfo setInfo = {};
+    setInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setInfo.pNext                           = nullptr;
+    setInfo.bindingCount                    = 2;
+    setInfo.pBindings                       = bindings;
+    VK_CHECK(vkCreateDescriptorSetLayout(_device, &setInfo, nullptr, &_setLayout));
+
+    VkDescriptorPoolSize sizes[] = {
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, _levels},
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _levels},
+    };
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags                      = 0;
+    poolInfo.maxSets                    = _levels;
+    poolInfo.poolSizeCount              = 2;
+    poolInfo.pPoolSizes                 = sizes;
+    VK_CHECK(vkCreateDescriptorPool(_device, &poolInfo, nullptr, &_pool));
+
+    VkDescriptorSetLayout layouts[kMaxPyramidLevels];
+    for (uint32_t level = 0; level < _levels; level++) {
+        layouts[level] = _setLayout;
+    }
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool              = _pool;
+    allocInfo.descriptorSetCount          = _levels;
+    allocInfo.pSetLayouts                 = layouts;
+    VK_CHECK(vkAllocateDescriptorSets(_device, &allocInfo, _sets));
+
+    // the pyramid stays in GENERAL while it is built, the level before is read while the next is written
+    for (uint32_t level = 0; level < _levels; level++) {
+        VkDescriptorImageInfo sourceInfo = {_sampler, depthView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL};
+        if (level > 0) {
+            sourceInfo = {_sampler, _levelViews[level - 1], VK_IMAGE_LAYOUT_GENERAL};
+        }
+        VkDescriptorImageInfo targetInfo = {VK_NULL_HANDLE, _levelViews[level], VK_IMAGE_LAYOUT_GENERAL};
+        VkWriteDescriptorSet writes[]    = {
+            vkinit::write_descriptor_image(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, _sets[level], &sourceInfo, 0),
+            vkinit::write_descriptor_image(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _sets[level], &targetInfo, 1),
+        };
+        vkUpdateDescriptorSets(_device, 2, writes, 0, nullptr);
+    }
+
+    VkPipelineLayoutCreateInfo layoutInfo = vkinit::pipeline_layout_create_info();
+    layoutInfo.setLayoutCount             = 1;
+    layoutInfo.pSetLayouts                = &_setLayout;
+    VK_CHECK(vkCreatePipelineLayout(_device, &layoutInfo, nullptr, &_pipelineLayout));
+
+    VkComputePipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType                       = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage                       = vkinit::pipeline_shader_stage_create_info(VK_SHADER_STAGE_COMPUTE_BIT, reduceShader);
+    pipelineInfo.layout                      = _pipelineLayout;
+    VK_CHECK(vkCreateComputePipelines(_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &_pipeline));
+    _hasReduce = true;
+}
+
+void DepthPyramid::cleanup() {
+    if (_hasReduce) {
+        vkDestroyPipeline(_device, _pipeline, nullptr);
+        vkDestroyPipelineLayout(_device, _pipelineLayout, nullptr);
+        vkDestroyDescriptorPool(_device, _pool, nullptr);
+        vkDestroyDescriptorSetLayout(_device, _setLayout, nullptr);
+    }
+    vkDestroySampler(_device, _sampler, nullptr);
+    for (uint32_t level = 0; level < _levels; level++) {
+        vkDestroyImageView(_device, _levelViews[level], nullptr);
+    }
+    vkDestroyImageView(_device, _view, nullptr);
+    vmaDestroyImage(_allocator, _image._image, _image._allocation);
+}
+
+void DepthPyramid::record_clear(VkCommandBuffer cmd) {
+    VkImageMemoryBarrier toTransfer = vkinit::image_barrier(_image._image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT);
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+    VkClearColorValue farPlane = {{1.f, 0.f, 0.f, 0.f}};
+    vkCmdClearColorImage(cmd, _image._image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &farPlane, 1, &toTransfer.subresourceRange);
+
+    VkImageMemoryBarrier toShader = vkinit::image_barrier(_image._image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toShader);
+    _cleared = true;
+}
+
+void DepthPyramid::record_build(VkCommandBuffer cmd) {
+    if (!_hasReduce) {
+        return;
+    }
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline);
+    uint32_t width  = _extent.width;
+    uint32_t height = _extent.height;
+    for (uint32_t level = 0; level < _levels; level++) {
+        if (level > 0) {
+            // the level just written is the source of the next
+            VkMemoryBarrier levelBarrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER, nullptr, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT};
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &levelBarrier, 0, nullptr, 0, nullptr);
+        }
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, _pipelineLayout, 0, 1, &_sets[level], 0, nullptr);
+        vkCmdDispatch(cmd, (width + 7) / 8, (height + 7) / 8, 1);
+        width  = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+    }
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/vec4.hpp>
+#include "vk_types.h"
+#include "vk_frame_allocator.h"
+#include "vk_mesh.h"
+
+// indirect draws the cull shader may write per frame and draw list, one per visible meshlet
+constexpr uint32_t kMaxMeshletDraws = 1 << 17;
+// levels of a depth pyramid for depth buffers up to 32768 pixels wide
+constexpr uint32_t kMaxPyramidLevels = 16;
+
+// GPUCullConstants::phase
+constexpr uint32_t kCullSinglePhase = 0;  // frustum and normal cones only, into draw list 0
+constexpr uint32_t kCullEarly       = 1;  // also against the last frame's depth pyramid, into draw list 0
+constexpr uint32_t kCullLate        = 2;  // what kCullEarly held back against this frame's pyramid, into list 1
+
+// one row of the instance buffer, matches Instance in cull.comp and meshlet.vert
+struct GPUInstance {
+    glm::vec4 sphere;       // world space bounds
+    uint32_t firstMeshlet;  // meshlets of the selected level of detail
+    uint32_t meshletCount;  // 0 for hidden objects
+    uint32_t material;      // row in the material table
+    uint32_t pad;
+};
+
+// push constants of cull.comp
+struct GPUCullConstants {
+    glm::vec4 planes[6];  // world space frustum planes, see frustum_planes
+    glm::vec4 eye;
+    uint32_t instanceCount;
+    uint32_t maxDraws;  // per draw list
+    uint32_t phase;
+    uint32_t pad;
+};
+
+// what cull.comp counted, per draw list. Matches its CountBuffer
+struct GPUCullCounts {
+    uint32_t draws[2];
+    uint32_t objects[2];  // instances that passed the object tests
+};
+
+// Hierarchical depth buffer of the occlusion test, see build_depth_pyramid for what its texels hold.
+// It lives across frames, the early cull phase reads the pyramid the last frame built
+class DepthPyramid {
+   public:
+    AllocatedImage _image;
+    VkImageView _view;  // every level, sampled by cull.comp
+    VkSampler _sampler;
+    VkExtent2D _extent;  // of level 0
+    uint32_t _levels;
+    bool _cleared{false};  // record_clear has been recorded
+
+    void init(VkDevice device, VmaAllocator allocator, VkExtent2D depthExtent);
+    // the depth_reduce.comp dispatches building the pyramid from depthView
+    void init_reduce(VkShaderModule reduceShader, VkImageView depthView);
+    void cleanup();
+
+    // first use: every level at the far plane, so nothing is occluded, left in SHADER_READ_ONLY_OPTIMAL
+    void record_clear(VkCommandBuffer cmd);
+    // with depth in DEPTH_STENCIL_READ_ONLY_OPTIMAL and the pyramid in GENERAL, one dispatch per level
+    void record_build(VkCommandBuffer cmd);
+
+   private:
+    VkDevice _device;
+    VmaAllocator _allocator;
+    VkImageView _levelViews[kMaxPyramidLevels];
+    bool _hasReduce{false};
+    VkDescriptorSetLayout _setLayout;
+    VkDescriptorPool _pool;
+    VkDescriptorSet _sets[kMaxPyramidLevels];  // level i reads level i - 1, level 0 the depth buffer
+    VkPipelineLayout _pipelineLayout;
+    VkPipeline _pipeline;
+};
+
+// GPU-driven meshlet rendering.
+// Every mesh's vertices and meshlet triangles live in one vertex and one index buffer. Each frame
+// cull.comp tests the instances and then their meshlets against the frustum and the meshlets' normal
+// cones, and writes one VkDrawIndexedIndirectCommand per surviving meshlet. The forward pass draws
+// them with a single indirect call, so recording no longer grows with the object count.
+// With occlusion culling every frame culls twice, see kCullEarly and kCullLate. The early phase also
+// rejects instances behind the last frame's depth pyramid, the late phase retests those against the
+// pyramid of the early phase's depth, so objects coming into view are drawn the same frame.
+class GpuCulling {
+   public:
+    static constexpr uint32_t kInstancesBinding = 0;
+    static constexpr uint32_t kMeshletsBinding  = 1;
+    static constexpr uint32_t kDrawsBinding     = 2;
+    static constexpr uint32_t kCountBinding     = 3;
+    static constexpr uint32_t kOccludedBinding  = 4;
+    static constexpr uint32_t kPyramidBinding   = 5;
+
+    VkDescriptorSetLayout _setLayout;  // set 2 of the cull and meshlet pipelines
+    VkPipelineLayout _pipelineLayout;
+    VkPipeline _pipeline;
+    uint32_t _maxDraws;
+
+    // transientBuffer is the frame allocator's buffer the instances are streamed through, instanceRange
+    // the widest slice of it one frame binds. drawIndexedIndirectCount is null without VK_KHR_draw_indirect_count,
+    // occlusion adds the second draw list of the late phase
+    void init(VkDevice device, VmaAllocator allocator, VkBuffer transientBuffer, VkDeviceSize instanceRange, uint32_t maxDraws, bool occlusion, PFN_vkCmdDrawIndexedIndirectCountKHR drawIndexedIndirectCount);
+    // sets 0 and 1 are shared with the mesh pipelines so the frame set binds the same way
+    void init_pipeline(VkShaderModule cullShader, VkDescriptorSetLayout materialLayout, VkDescriptorSetLayout frameLayout);
+    void cleanup();
+
+    // cull.comp always binds the pyramid, without occlusion culling it just stays cleared
+    void set_depth_pyramid(const DepthPyramid& pyramid);
+    // copies the pooled geometry into buffers of their own, the meshlets' firstIndex points into indices
+    void upload_geometry(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<Meshlet>& meshlets);
+
+    // records the cull dispatch of constants.phase, all but the late phase reset the frame's counts first.
+    // frameOffsets are the dynamic offsets of the frame set, instanceOffset the one of the frame's instances
+    void record_cull(VkCommandBuffer cmd, uint32_t frame, VkDescriptorSet frameSet, const uint32_t frameOffsets[2], uint32_t instanceOffset, const GPUCullConstants& constants);
+    // draws one draw list of record_cull, inside the render pass with a pipeline of layout bound
+    void record_draw(VkCommandBuffer cmd, uint32_t frame, VkPipelineLayout layout, uint32_t instanceOffset, uint32_t maxDraws, uint32_t list);
+    // the counts of the frame that last used the slot, call once its fence has signaled
+    GPUCullCounts read_counts(uint32_t frame);
+
+   private:
+    VkDevice _device;
+    VmaAllocator _allocator;
+    VkDescriptorPool _pool;
+    PFN_vkCmdDrawIndexedIndirectCountKHR _drawIndexedIndirectCount;
+
+    AllocatedBuffer _vertexBuffer;
+    AllocatedBuffer _indexBuffer;
+    AllocatedBuffer _meshletBuffer;
+    bool _hasGeometry{false};
+
+    // written by the cull shader, one per frame in flight
+    VkDescriptorSet _sets[FRAME_OVERLAP];
+    AllocatedBuffer _drawBuffers[FRAME_OVERLAP];
+    AllocatedBuffer _countBuffers[FRAME_OVERLAP];     // host visible for read_counts
+    AllocatedBuffer _occludedBuffers[FRAME_OVERLAP];  // per instance, what the early phase rejected
+};
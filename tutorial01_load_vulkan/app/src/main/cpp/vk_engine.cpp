@@ -1,17 +1,22 @@
 // #include "vk_init.h"
-#include <android/log.h>
+#include <algorithm>
+#include <cstring>
 #include <vector>
 #include <fstream>
+#include <sstream>
+#include <tinyobjloader/tiny_obj_loader.h>
 #include "vk_engine.h"
 #include "vkbootstrap/VkBootstrap.h"
 #include "vk_init.h"
+#include "vk_textures.h"
+#include "vulkan_profiler.h"
 // #define VMA_IMPLEMENTATION
 // #include "vk_mem_alloc.h"
 
 // we want to immediately abort when there is an error. In normal engines this would give an error message to the user, or perform a dump of state.
 using namespace std;
 
-static const char* VkResultString(VkResult err) {
+const char* VkResultString(VkResult err) {
     switch (err) {
 #define STR(r) \
     case r:    \
@@ -52,40 +57,109 @@ static const char* VkResultString(VkResult err) {
     }
 }
 
-void VulkanEngine::init(android_app* app) {
-    this->_app = app;
-    this->init_vulkan(app);
-    this->init_vma();
-    // load meshes
-    this->load_meshes();
-    // create the swapchain
-    this->init_swapchain(app);
-    this->init_commands();
-    this->init_default_renderpass();
-    this->init_framebuffers();
-    this->init_sync_structures();
-    this->init_pipelines();
-    this->init_scene();
-    this->init_querypool(this->_device, 1024);
+void VulkanEngine::init(PlatformWindow* window, AssetSource* assets) {
+    this->_window   = window;
+    this->_assets   = assets;
+    this->_headless = false;
+    this->init_engine();
+}
+
+void VulkanEngine::init_headless(AssetSource* assets, VkExtent2D extent) {
+    this->_window       = nullptr;
+    this->_assets       = assets;
+    this->_headless     = true;
+    this->_windowExtent = extent;
+    this->init_engine();
+}
+
+void VulkanEngine::init_engine() {
+    _jobs.init(_jobWorkers);
+
+    // asset I/O and mesh parsing don't need a device, they overlap with instance and device creation.
+    // Everything submitting through immediate_submit is chained, the upload context is single threaded
+    vkutil::TaskGraph& graph = _initGraph;
+    graph                    = vkutil::TaskGraph{};
+    uint32_t vulkan          = graph.add("vulkan", [this]() { init_vulkan(); });
+    uint32_t meshes          = graph.add("parse meshes", [this]() { parse_meshes(); });
+    uint32_t shaders         = graph.add("read shaders", [this]() { read_shaders(); });
+    uint32_t vma             = graph.add("allocator", [this]() { init_vma(); }, {vulkan});
+    // create the swapchain, or the offscreen images standing in for it
+    uint32_t swapchain       = graph.add("swapchain", [this]() { init_swapchain(); }, {vma});
+    uint32_t renderpass      = graph.add("render pass", [this]() { init_default_renderpass(); }, {swapchain});
+    uint32_t commands        = graph.add("commands", [this]() { init_commands(); }, {vulkan});
+    uint32_t descriptors     = graph.add("descriptors", [this]() { init_descriptors(); }, {vma});
+    uint32_t modules         = graph.add("shader modules", [this]() { create_shader_modules(); }, {vulkan, shaders});
+    uint32_t upload          = graph.add("upload meshes", [this]() { upload_meshes(); }, {vma, meshes});
+    uint32_t meshlets        = graph.add("meshlets", [this]() { upload_meshlets(); }, {upload, descriptors});
+    // writes the culling descriptor sets like meshlets does, writes to a set have to be externally synchronized
+    uint32_t pyramid         = graph.add("depth pyramid", [this]() { init_depth_pyramid(); }, {swapchain, descriptors, modules, meshlets});
+    uint32_t pipelines       = graph.add("pipelines", [this]() { init_pipelines(); }, {renderpass, descriptors, modules});
+    uint32_t defaultMaterial = graph.add("default material", [this]() { init_default_material(); }, {descriptors, commands});
+    uint32_t materials       = graph.add("materials", [this]() { load_materials("lost_empire.mtl"); }, {defaultMaterial, pipelines});
+    uint32_t upscale         = graph.add("upscale pass", [this]() { init_upscale_pass(); }, {swapchain, modules});
+    // nothing else waits for these, they only have to be done before the first frame
+    graph.add("framebuffers", [this]() { init_framebuffers(); }, {renderpass});
+    // after materials, the font upload is the last submit of the chain
+    graph.add("hud", [this]() { init_hud(); }, {materials, upscale});
+    graph.add("sync", [this]() { init_sync_structures(); }, {vulkan});
+    graph.add("render graph", [this]() { init_render_graph(); }, {swapchain, pyramid});
+    graph.add("scene", [this]() { init_scene(); }, {upload, materials});
+    graph.add("query pool", [this]() { init_querypool(this->_device, 1024); }, {vulkan});
+    graph.add("occlusion queries", [this]() { init_occlusion_queries(); }, {vma});
+    graph.run(&_steadyClock, _initThreads);
+
+    this->log_startup();
     this->_isInitialized = true;
 }
 
+uint64_t VulkanEngine::startup_phase_ns(const std::string& name) const {
+    for (uint32_t i = 0; i < _initGraph.task_count(); i++) {
+        if (_initGraph.name(i) == name) {
+            return _initGraph.timing(i).endNs - _initGraph.timing(i).startNs;
+        }
+    }
+    return 0;
+}
+
+void VulkanEngine::log_startup() {
+    for (uint32_t i = 0; i < _initGraph.task_count(); i++) {
+        const vkutil::TaskTiming& timing = _initGraph.timing(i);
+        LOGI("startup %-16s %8.2f ms at %8.2f ms on thread %u", _initGraph.name(i).c_str(), (timing.endNs - timing.startNs) / 1e6, timing.startNs / 1e6, timing.thread);
+    }
+    LOGI("startup took %.2f ms on %u threads", _initGraph.elapsed_ns() / 1e6, _initGraph.thread_count());
+
+    if (!_startupTracePath.empty()) {
+        std::ofstream out(_startupTracePath);
+        out << _initGraph.trace_json();
+        if (!out) {
+            LOGW("can't write the startup trace %s", _startupTracePath.c_str());
+        }
+    }
+}
+
 void VulkanEngine::cleanup() {
     if (_isInitialized) {
         vkDeviceWaitIdle(_device);
 
-        vkFreeCommandBuffers(_device, _commandPool, 1, &_mainCommandBuffer);
-
-        vkDestroyCommandPool(_device, _commandPool, nullptr);
-
-        vkDestroySwapchainKHR(_device, _swapchain, nullptr);
+        if (!_headless) {
+            vkDestroySwapchainKHR(_device, _swapchain, nullptr);
+        }
 
         // destroy the main renderpass
         vkDestroyRenderPass(_device, _renderPass, nullptr);
+        if (_occlusionCulling) {
+            vkDestroyRenderPass(_device, _lateRenderPass, nullptr);
+        }
+        if (_dynamicResolution) {
+            vkDestroyRenderPass(_device, _upscaleRenderPass, nullptr);
+        }
 
         // destroy swapchain resources
         for (int i = 0; i < _framebuffers.size(); i++) {
             vkDestroyFramebuffer(_device, _framebuffers[i], nullptr);
+            if (_dynamicResolution) {
+                vkDestroyFramebuffer(_device, _upscaleFramebuffers[i], nullptr);
+            }
             vkDestroyImageView(_device, _swapchainImageViews[i], nullptr);
         }
 
@@ -93,11 +167,14 @@ void VulkanEngine::cleanup() {
         this->_mainDeletionQueue.flush();
 
         vkDestroyDevice(_device, NULL);
-        vkDestroySurfaceKHR(_instance, _surface, nullptr);
+        if (!_headless) {
+            vkDestroySurfaceKHR(_instance, _surface, nullptr);
+        }
         vkDestroyInstance(_instance, NULL);
 
         LOGI("VKEngine Cleanup");
     }
+    _jobs.shutdown();
     this->_isInitialized = false;
 }
 
@@ -106,16 +183,23 @@ void VulkanEngine::init_vma() {
     allocatorInfo.physicalDevice         = _chosenGPU;
     allocatorInfo.device                 = _device;
     allocatorInfo.instance               = _instance;
+    // the device is at least 1.1, VMA then gets vkGetPhysicalDeviceMemoryProperties2 from the core
+    allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_1;
+    // without the extension VMA guesses the budget as 80% of each heap
+    if (_memoryBudget) {
+        allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
     vmaCreateAllocator(&allocatorInfo, &_allocator);
 }
 
-void VulkanEngine::init_vulkan(android_app* app) {
+void VulkanEngine::init_vulkan() {
     vkb::InstanceBuilder builder;
 
-    // make the Vulkan instance, with basic debug features
+    // make the Vulkan instance, with basic debug features. Headless skips the surface extensions
     auto inst_ret = builder.set_app_name("Example Vulkan Application")
-                        .request_validation_layers(true)
+                        .request_validation_layers(_startupProfile == StartupProfile::Development)
                         .require_api_version(1, 1, 0)
+                        .set_headless(_headless)
                         //.use_default_debug_messenger()
                         .build();
 
@@ -123,69 +207,241 @@ void VulkanEngine::init_vulkan(android_app* app) {
 
     // store the instance
     _instance = vkb_inst.instance;
+    // instance functions for the wrapper, device functions go through the loader until the device exists
+    InitVulkanInstance(_instance);
     // store the debug messenger
     //_debug_messenger = vkb_inst.debug_messenger;
 
-    // if we create a surface, we need the surface extension
-    VkAndroidSurfaceCreateInfoKHR createInfo{.sType = VK_STRUCTURE_TYPE_ANDROID_SURFACE_CREATE_INFO_KHR, .pNext = nullptr, .flags = 0, .window = app->window};
-    VK_CHECK(vkCreateAndroidSurfaceKHR(this->_instance, &createInfo, nullptr, &this->_surface));
-
     // use vkbootstrap to select a GPU.
     // We want a GPU that can write to the SDL surface and supports Vulkan 1.1
     vkb::PhysicalDeviceSelector selector{vkb_inst};
-    vkb::PhysicalDevice physicalDevice = selector.set_minimum_version(1, 1).set_surface(_surface).select().value();
+
+    // if we create a surface, we need the surface extension
+    if (!_headless) {
+        _surface = _window->create_surface(_instance);
+        selector.set_surface(_surface);
+        selector.add_desired_extension(VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME);
+    } else {
+        selector.require_present(false);
+    }
+    // mesh.frag indexes its texture array with the per-draw material, which needs dynamic indexing
+    VkPhysicalDeviceFeatures requiredFeatures               = {};
+    requiredFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+    vkb::PhysicalDevice physicalDevice                      = selector.set_minimum_version(1, 1)
+                                             .set_required_features(requiredFeatures)
+                                             .add_desired_extension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)
+                                             .add_desired_extension(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME)
+                                             .add_desired_extension(VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME)
+                                             .add_desired_extension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)
+                                             .add_desired_extension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)
+                                             .select()
+                                             .value();
+    _gpuProperties                     = physicalDevice.properties;
+    load_device_capabilities(physicalDevice.physical_device);
+
+    // the bindless material table wants a partially bound, update-after-bind texture array.
+    // Without it we fall back to a small fixed-size array that is fully written up front
+    _descriptorIndexing = _caps.partiallyBound && _caps.sampledImageUpdateAfterBind;
+    if (_descriptorIndexing) {
+        _bindlessTextureCapacity = std::min(kBindlessTextureCapacity, _caps.updateAfterBindTextureLimit);
+    } else {
+        _bindlessTextureCapacity = std::min({kFallbackTextureCapacity, _gpuProperties.limits.maxPerStageDescriptorSamplers, _gpuProperties.limits.maxPerStageDescriptorSampledImages});
+    }
+
+    // only enable the features the material table relies on
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT enabledIndexing = {};
+    enabledIndexing.sType                                         = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    enabledIndexing.descriptorBindingPartiallyBound               = VK_TRUE;
+    enabledIndexing.descriptorBindingSampledImageUpdateAfterBind  = VK_TRUE;
+
+    // the meshlet draws are one multi-draw indirect call whose firstInstance picks the object
+    _gpuCulling = _gpuCulling && _caps.features.multiDrawIndirect && _caps.features.drawIndirectFirstInstance;
+    if (_gpuCulling) {
+        physicalDevice.features.multiDrawIndirect         = VK_TRUE;
+        physicalDevice.features.drawIndirectFirstInstance = VK_TRUE;
+    }
+    VkSampleCountFlags sampleCounts = _gpuProperties.limits.framebufferColorSampleCounts & _gpuProperties.limits.framebufferDepthSampleCounts;
+    _sampleCount                    = vkutil::choose_sample_count(sampleCounts, _msaaSamples);
+    // the occlusion test runs in the cull shader on single sampled depth of the whole window, the occlusion
+    // queries replace it on the draw per object path
+    _occlusionCulling     = _occlusionCulling && _gpuCulling && _sampleCount == VK_SAMPLE_COUNT_1_BIT && !_dynamicResolution;
+    _occlusionQueries     = _occlusionQueries && !_gpuCulling;
+    _conditionalRendering = _occlusionQueries && _caps.conditionalRendering;
+    VkPhysicalDeviceConditionalRenderingFeaturesEXT enabledConditional = {};
+    enabledConditional.sType                                           = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_CONDITIONAL_RENDERING_FEATURES_EXT;
+    enabledConditional.conditionalRendering                            = VK_TRUE;
+
+    // Vulkan 1.1 devices without the extension sync with fences
+    _timelineSemaphores                                          = _timelineSemaphores && _caps.timelineSemaphore;
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR enabledTimeline = {};
+    enabledTimeline.sType                                        = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+    enabledTimeline.timelineSemaphore                            = VK_TRUE;
+
+    // a plain extension, vkbootstrap enabled it when the device has it
+    _memoryBudget = _caps.has_extension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
 
     // create the final Vulkan device
     vkb::DeviceBuilder deviceBuilder{physicalDevice};
+    if (_descriptorIndexing) {
+        deviceBuilder.add_pNext(&enabledIndexing);
+    }
+    if (_conditionalRendering) {
+        deviceBuilder.add_pNext(&enabledConditional);
+    }
+    if (_timelineSemaphores) {
+        deviceBuilder.add_pNext(&enabledTimeline);
+    }
 
     vkb::Device vkb_Device = deviceBuilder.build().value();
 
     // Get the VkDevice handle used in the rest of a Vulkan application
     _device    = vkb_Device.device;
     _chosenGPU = physicalDevice.physical_device;
+    // call the driver directly from here on instead of through the loader trampolines
+    InitVulkanDevice(_device);
 
     // use vkbootstrap to get a Graphics queue
     _graphicsQueue       = vkb_Device.get_queue(vkb::QueueType::graphics).value();
     _graphicsQueueFamily = vkb_Device.get_queue_index(vkb::QueueType::graphics).value();
-    LOGI("init vulkan end");
+    // vkbootstrap creates a queue in every family, pick the ones uploads and compute go to.
+    // Without _asyncQueues there is nothing but the graphics family to pick from
+    std::vector<VkQueueFamilyProperties> queueFamilies;
+    if (_asyncQueues) {
+        queueFamilies = physicalDevice.get_queue_families();
+    }
+    _queueTopology = vkutil::choose_queue_topology(queueFamilies, _graphicsQueueFamily);
+
+    // actual present times for the latency numbers and the low latency pacing, Android exposes them on most devices
+    _displayTiming = !_headless && _caps.has_extension(VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME);
+    if (_displayTiming) {
+        _getRefreshCycleDuration   = (PFN_vkGetRefreshCycleDurationGOOGLE)vkGetDeviceProcAddr(_device, "vkGetRefreshCycleDurationGOOGLE");
+        _getPastPresentationTiming = (PFN_vkGetPastPresentationTimingGOOGLE)vkGetDeviceProcAddr(_device, "vkGetPastPresentationTimingGOOGLE");
+        _displayTiming             = _getRefreshCycleDuration && _getPastPresentationTiming;
+    }
+    _getSemaphoreCounterValue = nullptr;
+    _waitSemaphores           = nullptr;
+    if (_timelineSemaphores) {
+        _getSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValueKHR)vkGetDeviceProcAddr(_device, "vkGetSemaphoreCounterValueKHR");
+        _waitSemaphores           = (PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr(_device, "vkWaitSemaphoresKHR");
+        _timelineSemaphores       = _getSemaphoreCounterValue && _waitSemaphores;
+    }
+    // with the count from the cull shader the draw stops at the last visible meshlet, without it every slot is read
+    _drawIndexedIndirectCount = nullptr;
+    if (_gpuCulling && _caps.has_extension(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME)) {
+        _drawIndexedIndirectCount = (PFN_vkCmdDrawIndexedIndirectCountKHR)vkGetDeviceProcAddr(_device, "vkCmdDrawIndexedIndirectCountKHR");
+    }
+    LOGI("init vulkan end, device capabilities %s", _capabilitiesCached ? "from the database" : "queried");
 }
 
-void VulkanEngine::init_swapchain(android_app* app) {
-    _windowExtent = {(uint32_t)ANativeWindow_getWidth(app->window), (uint32_t)ANativeWindow_getHeight(app->window)};
-    vkb::SwapchainBuilder swapchainBuilder{_chosenGPU, _device, _surface};
-    vkb::Swapchain vkbSwapchain = swapchainBuilder
-                                      .use_default_format_selection()
-                                      // use vsync present mode
-                                      .set_desired_present_mode(VK_PRESENT_MODE_FIFO_KHR)
-                                      .set_composite_alpha_flags(VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR)
-                                      .set_desired_extent(_windowExtent.width, _windowExtent.height)
-                                      .build()
-                                      .value();
+void VulkanEngine::init_swapchain() {
+    if (_headless) {
+        init_offscreen_targets();
+    } else {
+        _windowExtent = _window->extent();
+
+        // negotiate the present mode of the pacing mode with what the surface supports
+        uint32_t presentModeCount = 0;
+        VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(_chosenGPU, _surface, &presentModeCount, nullptr));
+        std::vector<VkPresentModeKHR> presentModes(presentModeCount);
+        VK_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(_chosenGPU, _surface, &presentModeCount, presentModes.data()));
+        _presentMode = choose_present_mode(_pacingMode, presentModes);
+
+        vkb::SwapchainBuilder swapchainBuilder{_chosenGPU, _device, _surface};
+        vkb::Swapchain vkbSwapchain = swapchainBuilder
+                                          .use_default_format_selection()
+                                          .set_desired_present_mode(_presentMode)
+                                          .set_composite_alpha_flags(VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR)
+                                          .set_desired_extent(_windowExtent.width, _windowExtent.height)
+                                          .build()
+                                          .value();
+
+        // store swapchain and its related images
+        _swapchain           = vkbSwapchain.swapchain;
+        _swapchainImages     = vkbSwapchain.get_images().value();
+        _swapchainImageViews = vkbSwapchain.get_image_views().value();
+
+        _swapchainImageFormat = vkbSwapchain.image_format;
+    }
 
-    // store swapchain and its related images
-    _swapchain           = vkbSwapchain.swapchain;
-    _swapchainImages     = vkbSwapchain.get_images().value();
-    _swapchainImageViews = vkbSwapchain.get_image_views().value();
+    VkRefreshCycleDurationGOOGLE refreshCycle = {kDefaultRefreshPeriodNs};
+    if (_displayTiming) {
+        VK_CHECK(_getRefreshCycleDuration(_device, _swapchain, &refreshCycle));
+    }
+    _pacer.init(_clock, _pacingMode, refreshCycle.refreshDuration);
+    LOGI("%s pacing: present mode %d, refresh period %llu ns, display timing %s", pacing_mode_name(_pacingMode), _presentMode, (unsigned long long)refreshCycle.refreshDuration, _displayTiming ? "on" : "off");
 
-    _swapchainImageFormat = vkbSwapchain.image_format;
+    // without a budget of its own dynamic resolution keeps the GPU inside a refresh period
+    uint64_t budget = _resolutionSettings.budgetNs ? _resolutionSettings.budgetNs : refreshCycle.refreshDuration;
+    _resolution.init(_resolutionSettings, budget);
+    _renderExtent = _dynamicResolution ? _resolution.render_extent(_windowExtent) : _windowExtent;
 
     // depth image size will match the window
     VkExtent3D depthImageExtent = {_windowExtent.width, _windowExtent.height, 1};
 
-    // hardcoding the depth format to 32 bit float
-    _depthFormat = VK_FORMAT_D32_SFLOAT;
+    // 32 bit float depth where the device can render to it, and sample it for the depth pyramid.
+    // D16 is always there, and one of the first two
+    VkFormatFeatureFlags depthFeatures = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    if (_occlusionCulling) {
+        depthFeatures |= VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+    }
+    _depthFormat = VK_FORMAT_D16_UNORM;
+    for (VkFormat format : {VK_FORMAT_D32_SFLOAT, VK_FORMAT_X8_D24_UNORM_PACK32}) {
+        if ((_caps.format_properties(format).optimalTilingFeatures & depthFeatures) == depthFeatures) {
+            _depthFormat = format;
+            break;
+        }
+    }
 
-    // the depth image will be an image with the format we selected and Depth Attachment usage flag
-    VkImageCreateInfo dimg_info = vkinit::image_create_info(_depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, depthImageExtent);
+    // the swapchain image is cleared and presented (the render graph moves it to PRESENT_SRC), depth is cleared and
+    // never read after the pass. Occlusion culling reduces depth into the pyramid and then draws on top in _latePass
+    // With MSAA color and depth are multisampled, cleared and dropped at the end of the pass, only the
+    // resolve into the swapchain image is stored. Dynamic resolution puts the scene target in place of
+    // the swapchain image
+    bool msaa                = _sampleCount != VK_SAMPLE_COUNT_1_BIT;
+    _mainPass                = vkutil::RenderPassDesc{};
+    uint32_t colorAttachment = _mainPass.add_color(_swapchainImageFormat, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true, false, !msaa, _sampleCount);
+    uint32_t depthAttachment = _mainPass.set_depth(_depthFormat, true, false, _occlusionCulling, _sampleCount);
+    if (msaa) {
+        _mainPass.add_resolve(colorAttachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true);
+    }
+    vkutil::PassBandwidth bw = _mainPass.estimate_bandwidth(_windowExtent);
+    LOGI("main pass: %u samples, %llu bytes loaded, %llu bytes stored per frame, %llu with a separate resolve", (uint32_t)_sampleCount, (unsigned long long)bw.loadBytes, (unsigned long long)bw.storeBytes, (unsigned long long)_mainPass.estimate_separate_resolve(_windowExtent).total());
+    if (_occlusionCulling) {
+        _latePass = vkutil::RenderPassDesc{};
+        _latePass.add_color(_swapchainImageFormat, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, false, true, true);
+        _latePass.set_depth(_depthFormat, false, true, false);
+    }
 
-    // for the depth image, we want to allocate it from GPU local memory
-    VmaAllocationCreateInfo dimg_allocinfo = {};
-    dimg_allocinfo.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
-    dimg_allocinfo.requiredFlags           = VkMemoryPropertyFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    dimg_allocinfo.pUserData = (void*)"Image";
+    // a transient depth image only lives in tile memory, so it is lazily allocated where the device supports it
+    VkImageUsageFlags depthUsage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | (_occlusionCulling ? VK_IMAGE_USAGE_SAMPLED_BIT : 0);
+    if (!vkutil::create_attachment_image(_allocator, _depthFormat, depthUsage, depthImageExtent, _sampleCount, _mainPass.is_transient(depthAttachment), _depthImage)) {
+        abort();
+    }
+    if (msaa) {
+        if (!vkutil::create_attachment_image(_allocator, _swapchainImageFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, depthImageExtent, _sampleCount, _mainPass.is_transient(colorAttachment), _msaaColorImage)) {
+            abort();
+        }
+        VkImageViewCreateInfo cview_info = vkinit::imageview_create_info(_swapchainImageFormat, _msaaColorImage._image, VK_IMAGE_ASPECT_COLOR_BIT);
+        VK_CHECK(vkCreateImageView(_device, &cview_info, nullptr, &_msaaColorView));
+        _mainDeletionQueue.push_function([=]() {
+            vkDestroyImageView(_device, _msaaColorView, nullptr);
+            vmaDestroyImage(_allocator, _msaaColorImage._image, _msaaColorImage._allocation);
+        });
+    }
 
-    // allocate and create the image
-    vmaCreateImage(_allocator, &dimg_info, &dimg_allocinfo, &_depthImage._image, &_depthImage._allocation, nullptr);
+    // the scene target is sampled by the upscale pass, the depth and MSAA images are shared with it.
+    // All of them are window sized, changing the scale never reallocates
+    if (_dynamicResolution) {
+        if (!vkutil::create_attachment_image(_allocator, _swapchainImageFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, depthImageExtent, VK_SAMPLE_COUNT_1_BIT, false, _sceneColorImage)) {
+            abort();
+        }
+        VkImageViewCreateInfo sview_info = vkinit::imageview_create_info(_swapchainImageFormat, _sceneColorImage._image, VK_IMAGE_ASPECT_COLOR_BIT);
+        VK_CHECK(vkCreateImageView(_device, &sview_info, nullptr, &_sceneColorView));
+        _mainDeletionQueue.push_function([=]() {
+            vkDestroyImageView(_device, _sceneColorView, nullptr);
+            vmaDestroyImage(_allocator, _sceneColorImage._image, _sceneColorImage._allocation);
+        });
+    }
 
     // build an image-view for the depth image to use for rendering
     VkImageViewCreateInfo dview_info = vkinit::imageview_create_info(_depthFormat, _depthImage._image, VK_IMAGE_ASPECT_DEPTH_BIT);
@@ -198,6 +454,30 @@ void VulkanEngine::init_swapchain(android_app* app) {
     });
 }
 
+void VulkanEngine::init_offscreen_targets() {
+    // engine owned color images take the place of the swapchain images, one per frame in flight
+    _swapchainImageFormat = kHeadlessFormat;
+    _presentMode          = VK_PRESENT_MODE_FIFO_KHR;
+
+    VkImageCreateInfo img_info            = vkinit::image_create_info(_swapchainImageFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, {_windowExtent.width, _windowExtent.height, 1});
+    VmaAllocationCreateInfo img_allocinfo = {};
+    img_allocinfo.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    for (uint32_t i = 0; i < kHeadlessImageCount; i++) {
+        AllocatedImage image;
+        VK_CHECK(vmaCreateImage(_allocator, &img_info, &img_allocinfo, &image._image, &image._allocation, nullptr));
+        _mainDeletionQueue.push_function([=]() { vmaDestroyImage(_allocator, image._image, image._allocation); });
+
+        VkImageView view;
+        VkImageViewCreateInfo view_info = vkinit::imageview_create_info(_swapchainImageFormat, image._image, VK_IMAGE_ASPECT_COLOR_BIT);
+        VK_CHECK(vkCreateImageView(_device, &view_info, nullptr, &view));
+
+        // cleanup() destroys the views together with the framebuffers, like the swapchain ones
+        _swapchainImages.push_back(image._image);
+        _swapchainImageViews.push_back(view);
+    }
+}
+
 void VulkanEngine::init_commands() {
     // create a command pool for commands submitted to the graphics queue.
     VkCommandPoolCreateInfo commandPoolInfo = {};
@@ -209,107 +489,38 @@ void VulkanEngine::init_commands() {
     // we also want the pool to allow for resetting of individual command buffers
     commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
-    VK_CHECK(vkCreateCommandPool(_device, &commandPoolInfo, nullptr, &_commandPool));
-
     // allocate the default command buffer that we will use for rendering
     VkCommandBufferAllocateInfo cmdAllocInfo = {};
     cmdAllocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     cmdAllocInfo.pNext                       = nullptr;
 
-    // commands will be made from our _commandPool
-    cmdAllocInfo.commandPool = _commandPool;
     // we will allocate 1 command buffer
     cmdAllocInfo.commandBufferCount = 1;
     // command level is Primary
     cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
 
-    VK_CHECK(vkAllocateCommandBuffers(_device, &cmdAllocInfo, &_mainCommandBuffer));
+    // every frame in flight records into its own pool and command buffer
+    for (int i = 0; i < FRAME_OVERLAP; i++) {
+        VK_CHECK(vkCreateCommandPool(_device, &commandPoolInfo, nullptr, &_frames[i]._commandPool));
+
+        // commands will be made from the frame's pool
+        cmdAllocInfo.commandPool = _frames[i]._commandPool;
+        VK_CHECK(vkAllocateCommandBuffers(_device, &cmdAllocInfo, &_frames[i]._mainCommandBuffer));
+
+        _mainDeletionQueue.push_function([=]() { vkDestroyCommandPool(_device, _frames[i]._commandPool, nullptr); });
+    }
+
+    // one-off submissions get their own pools per queue, they are reset after every immediate_submit
+    _queues.init(_device, _queueTopology, _getSemaphoreCounterValue, _waitSemaphores);
+    _mainDeletionQueue.push_function([=]() { _queues.cleanup(); });
 }
 
 void VulkanEngine::init_default_renderpass() {
-    // the renderpass will use this color attachment.
-    VkAttachmentDescription color_attachment = {};
-    // the attachment will have the format needed by the swapchain
-    color_attachment.format = _swapchainImageFormat;
-    // 1 sample, we won't be doing MSAA
-    color_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    // we Clear when this attachment is loaded
-    color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    // we keep the attachment stored when the renderpass ends
-    color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    // we don't care about stencil
-    color_attachment.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-
-    // we don't know or care about the starting layout of the attachment
-    color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-
-    // after the renderpass ends, the image has to be on a layout ready for display
-    color_attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-    VkAttachmentDescription depth_attachment = {};
-    // Depth attachment
-    depth_attachment.flags          = 0;
-    depth_attachment.format         = _depthFormat;
-    depth_attachment.samples        = VK_SAMPLE_COUNT_1_BIT;
-    depth_attachment.loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    depth_attachment.storeOp        = VK_ATTACHMENT_STORE_OP_STORE;
-    depth_attachment.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    depth_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depth_attachment.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
-    depth_attachment.finalLayout    = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-    VkAttachmentReference depth_attachment_ref = {};
-    depth_attachment_ref.attachment            = 1;
-    depth_attachment_ref.layout                = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-    VkAttachmentReference color_attachment_ref = {};
-    // attachment number will index into the pAttachments array in the parent renderpass itself
-    color_attachment_ref.attachment = 0;
-    color_attachment_ref.layout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    // we are going to create 1 subpass, which is the minimum you can do
-    VkSubpassDescription subpass = {};
-    subpass.pipelineBindPoint    = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.colorAttachmentCount = 1;
-    subpass.pColorAttachments    = &color_attachment_ref;
-    // hook the depth attachment into the subpass
-    subpass.pDepthStencilAttachment = &depth_attachment_ref;
-
-    // array of 2 attachments, one for the color, and other for depth
-    VkAttachmentDescription attachments[2] = {color_attachment, depth_attachment};
-
-    VkRenderPassCreateInfo render_pass_info = {};
-    render_pass_info.sType                  = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-
-    // connect the color attachment to the info
-    render_pass_info.attachmentCount = 2;
-    render_pass_info.pAttachments    = &attachments[0];
-    // connect the subpass to the info
-    render_pass_info.subpassCount = 1;
-    render_pass_info.pSubpasses   = &subpass;
-    //
-    VkSubpassDependency dependency = {};
-    dependency.srcSubpass          = VK_SUBPASS_EXTERNAL;
-    dependency.dstSubpass          = 0;
-    dependency.srcStageMask        = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.srcAccessMask       = 0;
-    dependency.dstStageMask        = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.dstAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    //
-    VkSubpassDependency depth_dependency = {};
-    depth_dependency.srcSubpass          = VK_SUBPASS_EXTERNAL;
-    depth_dependency.dstSubpass          = 0;
-    depth_dependency.srcStageMask        = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-    depth_dependency.srcAccessMask       = 0;
-    depth_dependency.dstStageMask        = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-    depth_dependency.dstAccessMask       = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-    //
-    VkSubpassDependency dependencies[2] = {dependency, depth_dependency};
-    render_pass_info.dependencyCount    = 2;
-    render_pass_info.pDependencies      = &dependencies[0];
-
-    VK_CHECK(vkCreateRenderPass(_device, &render_pass_info, nullptr, &_renderPass));
+    // load and store ops are inferred from the attachment usage declared in init_swapchain
+    _renderPass = _mainPass.build(_device);
+    if (_occlusionCulling) {
+        _lateRenderPass = _latePass.build(_device);
+    }
 }
 
 void VulkanEngine::init_framebuffers() {
@@ -328,54 +539,82 @@ void VulkanEngine::init_framebuffers() {
     const uint32_t swapchain_imagecount = _swapchainImages.size();
     _framebuffers                       = std::vector<VkFramebuffer>(swapchain_imagecount);
 
-    // create framebuffers for each of the swapchain image views
+    // create framebuffers for each of the swapchain image views, with MSAA the swapchain image is the
+    // resolve attachment behind the multisampled color and depth. With dynamic resolution the scene
+    // target takes the swapchain image's place and every framebuffer is the same
+    bool msaa = _sampleCount != VK_SAMPLE_COUNT_1_BIT;
     for (int i = 0; i < swapchain_imagecount; i++) {
-        VkImageView attachments[2];
-        attachments[0]          = _swapchainImageViews[i];
+        VkImageView target = _dynamicResolution ? _sceneColorView : _swapchainImageViews[i];
+        VkImageView attachments[3];
+        attachments[0]          = msaa ? _msaaColorView : target;
         attachments[1]          = _depthImageView;
+        attachments[2]          = target;
         fb_info.pAttachments    = &attachments[0];
-        fb_info.attachmentCount = 2;
+        fb_info.attachmentCount = msaa ? 3 : 2;
         VK_CHECK(vkCreateFramebuffer(_device, &fb_info, nullptr, &_framebuffers[i]));
     }
 }
 
 void VulkanEngine::init_sync_structures() {
-    // create synchronization structures
-    VkFenceCreateInfo fenceCreateInfo = {};
-    fenceCreateInfo.sType             = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceCreateInfo.pNext             = nullptr;
-
-    // we want to create the fence with the Create Signaled flag, so we can wait on it before using it on a GPU command (for the first frame)
-    fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-    VK_CHECK(vkCreateFence(_device, &fenceCreateInfo, nullptr, &_renderFence));
-    this->_mainDeletionQueue.push_function([=]() { vkDestroyFence(_device, _renderFence, nullptr); });
-
+    // the frames wait on the graphics timeline of _queues instead of fences, value 0 is always reached
     // for the semaphores we don't need any flags
     VkSemaphoreCreateInfo semaphoreCreateInfo = {};
     semaphoreCreateInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
     semaphoreCreateInfo.pNext                 = nullptr;
     semaphoreCreateInfo.flags                 = 0;
 
-    VK_CHECK(vkCreateSemaphore(_device, &semaphoreCreateInfo, nullptr, &_presentSemaphore));
-    this->_mainDeletionQueue.push_function([=]() { vkDestroySemaphore(_device, _presentSemaphore, nullptr); });
-    VK_CHECK(vkCreateSemaphore(_device, &semaphoreCreateInfo, nullptr, &_renderSemaphore));
-    this->_mainDeletionQueue.push_function([=]() { vkDestroySemaphore(_device, _renderSemaphore, nullptr); });
+    for (int i = 0; i < FRAME_OVERLAP; i++) {
+        _frames[i]._timelineValue = 0;
+
+        VK_CHECK(vkCreateSemaphore(_device, &semaphoreCreateInfo, nullptr, &_frames[i]._presentSemaphore));
+        this->_mainDeletionQueue.push_function([=]() { vkDestroySemaphore(_device, _frames[i]._presentSemaphore, nullptr); });
+        VK_CHECK(vkCreateSemaphore(_device, &semaphoreCreateInfo, nullptr, &_frames[i]._renderSemaphore));
+        this->_mainDeletionQueue.push_function([=]() { vkDestroySemaphore(_device, _frames[i]._renderSemaphore, nullptr); });
+    }
 }
 
 void VulkanEngine::draw() {
-    // wait until the GPU has finished rendering the last frame. Timeout of 1 second
-    VK_CHECK(vkWaitForFences(_device, 1, &_renderFence, true, 1000000000));
-    VK_CHECK(vkResetFences(_device, 1, &_renderFence));
+    FrameData& frame = get_current_frame();
+
+    // the Vulkan calls counted since the last draw() belong to the previous frame
+    VulkanProfilerEndFrame();
+
+    // low latency pacing sleeps here, so the frame slot wait and acquire below happen as late as possible
+    _pacer.begin_frame(_frameNumber);
+    // world matrices of the nodes moved since the last frame
+    update_transforms();
+    select_lods();
+
+    // wait until the GPU has finished rendering the frame that last used this slot. Timeout of 1 second
+    vkutil::GpuTimeline& timeline = _queues.timeline(vkutil::QueueKind::graphics);
+    timeline.wait(frame._timelineValue, 1000000000);
+    _queues.collect();
+    read_frame_timings();
+    // VMA refreshes the driver's budget once per frame index, the mesh buffers are evicted against it
+    vmaSetCurrentFrameIndex(_allocator, _frameNumber);
+    _meshBuffers.begin_frame(_frameNumber);
+
+    // the frames in flight keep the extent they were recorded with, a new scale starts with this one
+    if (_dynamicResolution) {
+        _renderExtent = _resolution.render_extent(_windowExtent);
+    }
+    frame._renderScale = _resolution.scale();
 
-    // request image from the swapchain, one second timeout
-    uint32_t swapchainImageIndex;
-    VK_CHECK(vkAcquireNextImageKHR(_device, _swapchain, 1000000000, _presentSemaphore, nullptr, &swapchainImageIndex));
+    // the slot's transient allocations are no longer read by the GPU
+    _frameAllocator.begin_frame(_frameNumber);
+
+    // request image from the swapchain, one second timeout.
+    // Headless owns one offscreen image per frame slot, the wait above already made it free
+    uint32_t swapchainImageIndex = _frameNumber % kHeadlessImageCount;
+    if (!_headless) {
+        VK_CHECK(vkAcquireNextImageKHR(_device, _swapchain, 1000000000, frame._presentSemaphore, nullptr, &swapchainImageIndex));
+    }
 
     // now that we are sure that the commands finished executing, we can safely reset the command buffer to begin recording again.
-    VK_CHECK(vkResetCommandBuffer(_mainCommandBuffer, 0));
+    VK_CHECK(vkResetCommandBuffer(frame._mainCommandBuffer, 0));
 
     // naming it cmd for shorter writing
-    VkCommandBuffer cmd = _mainCommandBuffer;
+    VkCommandBuffer cmd = frame._mainCommandBuffer;
 
     // begin the command buffer recording. We will use this command buffer exactly once, so we want to let Vulkan know that
     VkCommandBufferBeginInfo cmdBeginInfo = {};
@@ -386,6 +625,181 @@ void VulkanEngine::draw() {
     cmdBeginInfo.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     VK_CHECK(vkBeginCommandBuffer(cmd, &cmdBeginInfo));
 
+    // the graph transitions the swapchain image around the passes that render into it
+    _swapchainImageIndex = swapchainImageIndex;
+    _renderGraph.set_imported_image(_swapchainResource, _swapchainImages[swapchainImageIndex], _swapchainImageViews[swapchainImageIndex]);
+
+    // each frame in flight owns a pair of timestamp queries
+    auto query_count = _frameNumber % FRAME_OVERLAP;
+    vkCmdResetQueryPool(cmd, this->_vkQueryPool, query_count * 2, 2);
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, _vkQueryPool, query_count * 2);
+    // the defragmentation copies go ahead of the draws, which use the moved mesh buffers at their new place
+    _meshBuffers.record_defragment(cmd);
+    bool uploaded = upload_frame_data(_renderables);
+    if (_gpuCulling) {
+        // the slot's frame is done, the counts of the slot's last frame are final
+        if (_frameNumber >= FRAME_OVERLAP) {
+            GPUCullCounts counts = _culling.read_counts(_frameNumber % FRAME_OVERLAP);
+            _stats.drawnObjects  = counts.objects[0] + counts.objects[1];
+            _stats.lateObjects   = counts.objects[1];
+            _stats.meshletDraws  = counts.draws[0] + counts.draws[1];
+        }
+        if (!_depthPyramid._cleared) {
+            _depthPyramid.record_clear(cmd);
+        }
+    }
+    // with conditional rendering the draws are skipped on the GPU, the results read here are how many
+    if (_occlusionQueries) {
+        uint32_t occluded = _queries.begin_frame(cmd, _frameNumber, _renderables);
+        if (_queries._conditional) {
+            _stats.skippedDraws = occluded;
+        }
+    }
+    // the graph only tracks images, the cull dispatch and its barriers go in front of it.
+    // The two phases of occlusion culling dispatch from their graph passes instead
+    if (uploaded && _gpuCulling && !_occlusionCulling) {
+        _cullConstants.phase = kCullSinglePhase;
+        _culling.record_cull(cmd, _frameNumber % FRAME_OVERLAP, _frameSet, _frameOffsets, _instanceOffset, _cullConstants);
+    }
+    _renderGraph.execute(cmd);
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, _vkQueryPool, query_count * 2 + 1);
+
+    if (!_memoryStatsDir.empty()) {
+        char *stats_data = nullptr;
+        vmaBuildStatsString(_allocator, &stats_data, true);
+        std::ofstream out(_memoryStatsDir + std::to_string(_frameNumber) + ".stat");
+        out << stats_data;
+        out.close();
+        vmaFreeStatsString(_allocator, stats_data );
+    }
+
+    // finalize the command buffer (we can no longer add commands, but it can now be executed)
+    VK_CHECK(vkEndCommandBuffer(cmd));
+    _frameAllocator.end_frame();
+
+    // prepare the submission to the queue.
+    // we want to wait on the _presentSemaphore, as that semaphore is signaled when the swapchain is ready
+    // we will signal the _renderSemaphore, to signal that rendering has finished
+    VkSubmitInfo submit = {};
+    submit.sType        = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit.pNext        = nullptr;
+
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    submit.pWaitDstStageMask       = &waitStage;
+
+    // headless has nothing to wait for or present
+    submit.waitSemaphoreCount = _headless ? 0 : 1;
+    submit.pWaitSemaphores    = &frame._presentSemaphore;
+
+    submit.signalSemaphoreCount = _headless ? 0 : 1;
+    submit.pSignalSemaphores    = &frame._renderSemaphore;
+
+    submit.commandBufferCount = 1;
+    submit.pCommandBuffers    = &cmd;
+
+    // submit command buffer to the queue and execute it.
+    // the graphics timeline reaches the frame's value once the graphic commands finish execution
+    frame._timelineValue = timeline.submit(_graphicsQueue, submit);
+    _meshBuffers.submitted(frame._timelineValue);
+    _pacer.submitted(_frameNumber);
+
+    if (_headless) {
+        _frameNumber++;
+        return;
+    }
+
+    // this will put the image we just rendered into the visible window.
+    // we want to wait on the _renderSemaphore for that,
+    // as it's necessary that drawing commands have finished before the image is displayed to the user
+    VkPresentInfoKHR presentInfo = {};
+    presentInfo.sType            = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    presentInfo.pNext            = nullptr;
+
+    presentInfo.pSwapchains    = &_swapchain;
+    presentInfo.swapchainCount = 1;
+
+    presentInfo.pWaitSemaphores    = &frame._renderSemaphore;
+    presentInfo.waitSemaphoreCount = 1;
+
+    presentInfo.pImageIndices = &swapchainImageIndex;
+
+    // tag the present with the frame number so its display time can be matched up later
+    VkPresentTimeGOOGLE presentTime   = {(uint32_t)_frameNumber, 0};
+    VkPresentTimesInfoGOOGLE timeInfo = {VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE, nullptr, 1, &presentTime};
+    if (_displayTiming) {
+        presentInfo.pNext = &timeInfo;
+    }
+    VK_CHECK(vkQueuePresentKHR(_graphicsQueue, &presentInfo));
+
+    // increase the number of frames drawn
+    _frameNumber++;
+}
+
+void VulkanEngine::read_frame_timings() {
+    // the frame that used this slot before has finished, its timestamps are ready
+    uint32_t finished = _frameNumber - FRAME_OVERLAP;
+    if (_frameNumber >= FRAME_OVERLAP) {
+        uint64_t timestamps[2];
+        auto query_count = finished % FRAME_OVERLAP;
+        if (vkGetQueryPoolResults(_device, _vkQueryPool, query_count * 2, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+            uint64_t gpuNs = (uint64_t)((timestamps[1] - timestamps[0]) * _gpuProperties.limits.timestampPeriod);
+            _pacer.gpu_finished(finished, gpuNs);
+            // the slot still holds the scale the finished frame was recorded with
+            if (_dynamicResolution && _resolution.update(get_current_frame()._renderScale, gpuNs)) {
+                VkExtent2D extent = _resolution.render_extent(_windowExtent);
+                LOGI("dynamic resolution: scale %.2f, %ux%u", _resolution.scale(), extent.width, extent.height);
+            }
+        }
+        // without display timing the end of the frame's commands is the closest thing to a present time we get
+        if (!_displayTiming) {
+            _pacer.presented(finished, _clock->now_ns());
+        }
+    }
+
+    if (_displayTiming) {
+        uint32_t count = 0;
+        VK_CHECK(_getPastPresentationTiming(_device, _swapchain, &count, nullptr));
+        std::vector<VkPastPresentationTimingGOOGLE> timings(count);
+        if (count > 0 && _getPastPresentationTiming(_device, _swapchain, &count, timings.data()) >= VK_SUCCESS) {
+            for (uint32_t i = 0; i < count; i++) {
+                _pacer.presented(timings[i].presentID, timings[i].actualPresentTime);
+            }
+        }
+    }
+
+    if (_frameNumber % 120 == 0 && _pacer.average_latency_ns() > 0) {
+        LOGI("queue to present latency: last %.2f ms, average %.2f ms", _pacer.last_latency_ns() / 1e6, _pacer.average_latency_ns() / 1e6);
+    }
+    if (_frameNumber % 120 == 0) {
+        log_api_profile();
+    }
+}
+
+void VulkanEngine::log_api_profile() {
+    uint32_t count                    = 0;
+    const VulkanProfileEntry* entries = VulkanProfilerLastFrame(&count);
+    std::vector<const VulkanProfileEntry*> called;
+    for (uint32_t i = 0; i < count; i++) {
+        if (entries[i].calls > 0) {
+            called.push_back(&entries[i]);
+        }
+    }
+    if (called.empty()) {
+        return;
+    }
+
+    // the busiest entry points of the last frame
+    std::sort(called.begin(), called.end(), [](const VulkanProfileEntry* a, const VulkanProfileEntry* b) { return a->calls > b->calls; });
+    for (size_t i = 0; i < called.size() && i < 8; i++) {
+        if (called[i]->timed) {
+            LOGI("api %-28s %6llu calls %8.3f ms", called[i]->name, (unsigned long long)called[i]->calls, called[i]->ns / 1e6);
+        } else {
+            LOGI("api %-28s %6llu calls", called[i]->name, (unsigned long long)called[i]->calls);
+        }
+    }
+}
+
+void VulkanEngine::begin_main_pass(VkCommandBuffer cmd, VkRenderPass renderPass) {
     // make a clear-color from frame number. This will flash with a 120*pi frame period.
     VkClearValue clearValue;
     float flash      = abs(sin(_frameNumber / 120.f));
@@ -400,21 +814,29 @@ void VulkanEngine::draw() {
     VkRenderPassBeginInfo rpInfo = {};
     rpInfo.sType                 = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     rpInfo.pNext                 = nullptr;
-    rpInfo.renderPass            = _renderPass;
+    rpInfo.renderPass            = renderPass;
     rpInfo.renderArea.offset.x   = 0;
     rpInfo.renderArea.offset.y   = 0;
-    rpInfo.renderArea.extent     = _windowExtent;
-    rpInfo.framebuffer           = _framebuffers[swapchainImageIndex];
+    rpInfo.renderArea.extent     = _renderExtent;
+    rpInfo.framebuffer           = _framebuffers[_swapchainImageIndex];
 
     // connect clear values
     rpInfo.clearValueCount     = 2;
     VkClearValue clearValues[] = {clearValue, depthClear};
     rpInfo.pClearValues        = &clearValues[0];
-    auto query_count = 0;
-    vkCmdResetQueryPool(cmd, this->_vkQueryPool, query_count * 2, 2);
-    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, _vkQueryPool, query_count * 2);
     vkCmdBeginRenderPass(cmd, &rpInfo, VK_SUBPASS_CONTENTS_INLINE);
 
+    // with dynamic resolution the pipelines take viewport and scissor from here
+    if (_dynamicResolution) {
+        VkViewport viewport = {0.f, 0.f, (float)_renderExtent.width, (float)_renderExtent.height, 0.f, 1.f};
+        VkRect2D scissor    = {{0, 0}, _renderExtent};
+        vkCmdSetViewport(cmd, 0, 1, &viewport);
+        vkCmdSetScissor(cmd, 0, 1, &scissor);
+    }
+}
+
+void VulkanEngine::draw_forward_pass(VkCommandBuffer cmd) {
+    begin_main_pass(cmd, _renderPass);
 
 #if 0
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, _meshPipeline);
@@ -454,82 +876,294 @@ void VulkanEngine::draw() {
     // we can now draw the mesh
     vkCmdDraw(cmd, _monkeyMesh._vertices.size(), 1, 0, 0);
 #else
-    draw_objects(cmd, _renderables.data(), _renderables.size());
-    //
-    char *stats_data = nullptr;
-    vmaBuildStatsString(_allocator, &stats_data, true);
-    std::ofstream out("/sdcard/" + std::to_string(_frameNumber) + ".stat");
-    out << stats_data;
-    out.close();
-    vmaFreeStatsString(_allocator, stats_data );
+    if (_gpuCulling) {
+        draw_meshlets(cmd, 0);
+    } else {
+        draw_objects(cmd, _renderables);
+    }
 #endif
+    // with dynamic resolution the upscale pass comes after this one
+    if (_hud && !_dynamicResolution) {
+        draw_hud(cmd);
+    }
 
     // finalize the render pass
     vkCmdEndRenderPass(cmd);
-//    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, _vkQueryPool, query_count * 2 + 1);
-//    uint64_t times[512];
-//    auto res = vkGetQueryPoolResults(_device, _vkQueryPool, 0, query_count * 2, sizeof(uint64_t) * query_count * 2, times, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
-//    if (res == VK_SUCCESS) {
-//        LOGE("%ld", times[0]);
-//    }
+}
+
+void VulkanEngine::draw_cull_phase(VkCommandBuffer cmd, uint32_t phase) {
+    // upload_frame_data filled _cullConstants, nothing was culled when it ran out of space
+    if (_frameObjects > 0) {
+        _cullConstants.phase = phase;
+        _culling.record_cull(cmd, _frameNumber % FRAME_OVERLAP, _frameSet, _frameOffsets, _instanceOffset, _cullConstants);
+    }
+    begin_main_pass(cmd, phase == kCullLate ? _lateRenderPass : _renderPass);
+    draw_meshlets(cmd, phase == kCullLate ? 1 : 0);
+    if (_hud && phase == kCullLate) {
+        draw_hud(cmd);
+    }
+    vkCmdEndRenderPass(cmd);
+}
 
+void VulkanEngine::draw_meshlets(VkCommandBuffer cmd, uint32_t list) {
+    if (_frameObjects == 0) {
+        return;
+    }
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, _meshletPipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, _meshletPipelineLayout, 0, 1, &_materialTable._set, 0, nullptr);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, _meshletPipelineLayout, 1, 1, &_frameSet, 2, _frameOffsets);
+    _culling.record_draw(cmd, _frameNumber % FRAME_OVERLAP, _meshletPipelineLayout, _instanceOffset, _cullConstants.maxDraws, list);
+    _stats.pipelineBinds++;
+    _stats.descriptorBinds += 3;
+    _stats.vertexBufferBinds++;
+    _stats.draws++;
+}
 
-    // finalize the command buffer (we can no longer add commands, but it can now be executed)
-    VK_CHECK(vkEndCommandBuffer(cmd));
+void VulkanEngine::init_upscale_pass() {
+    if (!_dynamicResolution) {
+        return;
+    }
+    // every texel of the swapchain image is drawn, nothing to clear or load
+    vkutil::RenderPassDesc upscalePass;
+    upscalePass.add_color(_swapchainImageFormat, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, false, false, true);
+    _upscaleRenderPass = upscalePass.build(_device);
 
-    // prepare the submission to the queue.
-    // we want to wait on the _presentSemaphore, as that semaphore is signaled when the swapchain is ready
-    // we will signal the _renderSemaphore, to signal that rendering has finished
-    VkSubmitInfo submit = {};
-    submit.sType        = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit.pNext        = nullptr;
+    VkFramebufferCreateInfo fb_info = {};
+    fb_info.sType                   = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    fb_info.renderPass              = _upscaleRenderPass;
+    fb_info.attachmentCount         = 1;
+    fb_info.width                   = _windowExtent.width;
+    fb_info.height                  = _windowExtent.height;
+    fb_info.layers                  = 1;
+    _upscaleFramebuffers.resize(_swapchainImageViews.size());
+    for (size_t i = 0; i < _swapchainImageViews.size(); i++) {
+        fb_info.pAttachments = &_swapchainImageViews[i];
+        VK_CHECK(vkCreateFramebuffer(_device, &fb_info, nullptr, &_upscaleFramebuffers[i]));
+    }
 
-    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    submit.pWaitDstStageMask       = &waitStage;
+    // bilinear, the shader clamps to the rendered part of the target itself
+    VkSamplerCreateInfo samplerInfo = vkinit::sampler_create_info(VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE);
+    VK_CHECK(vkCreateSampler(_device, &samplerInfo, nullptr, &_upscaleSampler));
+
+    VkDescriptorSetLayoutBinding binding    = vkinit::descriptorset_layout_binding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 0);
+    VkDescriptorSetLayoutCreateInfo setInfo = {};
+    setInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setInfo.bindingCount                    = 1;
+    setInfo.pBindings                       = &binding;
+    VK_CHECK(vkCreateDescriptorSetLayout(_device, &setInfo, nullptr, &_upscaleSetLayout));
+
+    VkDescriptorPoolSize size           = {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1};
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets                    = 1;
+    poolInfo.poolSizeCount              = 1;
+    poolInfo.pPoolSizes                 = &size;
+    VK_CHECK(vkCreateDescriptorPool(_device, &poolInfo, nullptr, &_upscalePool));
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool              = _upscalePool;
+    allocInfo.descriptorSetCount          = 1;
+    allocInfo.pSetLayouts                 = &_upscaleSetLayout;
+    VK_CHECK(vkAllocateDescriptorSets(_device, &allocInfo, &_upscaleSet));
+    VkDescriptorImageInfo sceneInfo = {_upscaleSampler, _sceneColorView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    VkWriteDescriptorSet write      = vkinit::write_descriptor_image(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, _upscaleSet, &sceneInfo, 0);
+    vkUpdateDescriptorSets(_device, 1, &write, 0, nullptr);
+
+    VkPushConstantRange constants         = {VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(glm::vec4)};
+    VkPipelineLayoutCreateInfo layoutInfo = vkinit::pipeline_layout_create_info();
+    layoutInfo.setLayoutCount             = 1;
+    layoutInfo.pSetLayouts                = &_upscaleSetLayout;
+    layoutInfo.pushConstantRangeCount     = 1;
+    layoutInfo.pPushConstantRanges        = &constants;
+    VK_CHECK(vkCreatePipelineLayout(_device, &layoutInfo, nullptr, &_upscalePipelineLayout));
+
+    // one full screen triangle at window size, no vertex buffer and no depth
+    PipelineBuilder builder;
+    builder._shaderStages.push_back(vkinit::pipeline_shader_stage_create_info(VK_SHADER_STAGE_VERTEX_BIT, _fullscreenVertShader));
+    builder._shaderStages.push_back(vkinit::pipeline_shader_stage_create_info(VK_SHADER_STAGE_FRAGMENT_BIT, _upscaleFragShader));
+    builder._vertexInputInfo      = vkinit::vertex_input_state_create_info();
+    builder._inputAssembly        = vkinit::input_assembly_create_info(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+    builder._viewport             = {0.f, 0.f, (float)_windowExtent.width, (float)_windowExtent.height, 0.f, 1.f};
+    builder._scissor              = {{0, 0}, _windowExtent};
+    builder._rasterizer           = vkinit::rasterization_state_create_info(VK_POLYGON_MODE_FILL);
+    builder._rasterizer.cullMode  = VK_CULL_MODE_NONE;
+    builder._multisampling        = vkinit::multisampling_state_create_info();
+    builder._colorBlendAttachment = vkinit::color_blend_attachment_state();
+    builder._depthStencil         = vkinit::depth_stencil_create_info(false, false, VK_COMPARE_OP_ALWAYS);
+    builder._pipelineLayout       = _upscalePipelineLayout;
+    _upscalePipeline              = builder.build_pipeline(_device, _upscaleRenderPass);
 
-    submit.waitSemaphoreCount = 1;
-    submit.pWaitSemaphores    = &_presentSemaphore;
+    _mainDeletionQueue.push_function([=]() {
+        vkDestroyPipeline(_device, _upscalePipeline, nullptr);
+        vkDestroyPipelineLayout(_device, _upscalePipelineLayout, nullptr);
+        vkDestroyDescriptorPool(_device, _upscalePool, nullptr);
+        vkDestroyDescriptorSetLayout(_device, _upscaleSetLayout, nullptr);
+        vkDestroySampler(_device, _upscaleSampler, nullptr);
+    });
+}
 
-    submit.signalSemaphoreCount = 1;
-    submit.pSignalSemaphores    = &_renderSemaphore;
+void VulkanEngine::draw_upscale_pass(VkCommandBuffer cmd) {
+    VkRenderPassBeginInfo rpInfo = {};
+    rpInfo.sType                 = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    rpInfo.renderPass            = _upscaleRenderPass;
+    rpInfo.renderArea.extent     = _windowExtent;
+    rpInfo.framebuffer           = _upscaleFramebuffers[_swapchainImageIndex];
+    vkCmdBeginRenderPass(cmd, &rpInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-    submit.commandBufferCount = 1;
-    submit.pCommandBuffers    = &cmd;
+    // the rendered corner of the target over the whole target, the filter stays half a texel inside it
+    glm::vec4 constants;
+    constants.x = (float)_renderExtent.width / _windowExtent.width;
+    constants.y = (float)_renderExtent.height / _windowExtent.height;
+    constants.z = (_renderExtent.width - 0.5f) / _windowExtent.width;
+    constants.w = (_renderExtent.height - 0.5f) / _windowExtent.height;
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, _upscalePipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, _upscalePipelineLayout, 0, 1, &_upscaleSet, 0, nullptr);
+    vkCmdPushConstants(cmd, _upscalePipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(constants), &constants);
+    vkCmdDraw(cmd, 3, 1, 0, 0);
+    if (_hud) {
+        draw_hud(cmd);
+    }
+    vkCmdEndRenderPass(cmd);
+}
 
-    // submit command buffer to the queue and execute it.
-    //_renderFence will now block until the graphic commands finish execution
-    VK_CHECK(vkQueueSubmit(_graphicsQueue, 1, &submit, _renderFence));
+void VulkanEngine::init_hud() {
+    if (!_hud) {
+        return;
+    }
+    // the upscale pass is the last one on the swapchain image with dynamic resolution, otherwise the
+    // main pass or the late pass, which is compatible with it
+    VkRenderPass renderPass       = _dynamicResolution ? _upscaleRenderPass : _renderPass;
+    VkSampleCountFlagBits samples = _dynamicResolution ? VK_SAMPLE_COUNT_1_BIT : _sampleCount;
+    if (!_perfHud.init(_instance, _chosenGPU, _device, _graphicsQueueFamily, _graphicsQueue, renderPass, samples, FRAME_OVERLAP)) {
+        _hud = false;
+        return;
+    }
+    _mainDeletionQueue.push_function([=]() { _perfHud.cleanup(); });
 
-    // this will put the image we just rendered into the visible window.
-    // we want to wait on the _renderSemaphore for that,
-    // as it's necessary that drawing commands have finished before the image is displayed to the user
-    VkPresentInfoKHR presentInfo = {};
-    presentInfo.sType            = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    presentInfo.pNext            = nullptr;
+    // the font texture is read by fragment shaders, a transfer family can't hand it over at that stage
+    _queues.submit_and_wait(vkutil::QueueKind::graphics, [&](VkCommandBuffer cmd) { _perfHud.upload_fonts(cmd); });
+    _perfHud.end_upload();
+}
 
-    presentInfo.pSwapchains    = &_swapchain;
-    presentInfo.swapchainCount = 1;
+void VulkanEngine::draw_hud(VkCommandBuffer cmd) {
+    // the counters of this frame are complete by now, its GPU time arrives FRAME_OVERLAP frames later
+    MemoryUsage memory         = memory_usage();
+    HudCounters counters       = {};
+    counters.draws             = _stats.draws;
+    counters.indirectDraws     = _stats.meshletDraws;
+    counters.pipelineBinds     = _stats.pipelineBinds;
+    counters.descriptorBinds   = _stats.descriptorBinds;
+    counters.vertexBufferBinds = _stats.vertexBufferBinds;
+    counters.triangles         = _stats.vertices / 3;
+    counters.memoryUsage       = memory.usageBytes;
+    counters.memoryBudget      = memory.budgetBytes;
+    // every pipeline is built by init, none is ever waiting
+    counters.pipelineQueue = 0;
+    _perfHud.record(cmd, _windowExtent, _pacer, _frameNumber - (int)FRAME_OVERLAP, counters);
+}
 
-    presentInfo.pWaitSemaphores    = &_renderSemaphore;
-    presentInfo.waitSemaphoreCount = 1;
+void VulkanEngine::select_lods() {
+    // the projection of draw_objects, 70 degrees vertical field of view over the rendered height
+    float pixelsPerSlope       = _renderExtent.height / (2.f * tanf(glm::radians(70.f) * 0.5f));
+    glm::vec3 eye              = glm::inverse(_view)[3];
+    const RenderBounds* bounds = _renderables.bounds();
+    const uint32_t* meshIds    = _renderables.meshes();
+    uint32_t* lods             = _renderables.lods();
+    _jobs.parallel_for(0, _renderables.size(), 1024, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            const Mesh* mesh = _meshById[meshIds[i]];
+            if (mesh->_lods.size() < 2 || _lodThreshold <= 0.f) {
+                lods[i] = 0;
+                continue;
+            }
+            // the model space error scales with the object, seen from the closest point of its sphere
+            float scale    = mesh->_bounds.radius > 0.f ? bounds[i].radius / mesh->_bounds.radius : 1.f;
+            float distance = std::max(glm::length(bounds[i].center - eye) - bounds[i].radius, 0.1f);
+            lods[i]        = select_lod(mesh->_lods.data(), (uint32_t)mesh->_lods.size(), scale * pixelsPerSlope / distance, lods[i], _lodThreshold, _lodHysteresis);
+        }
+    });
+}
 
-    presentInfo.pImageIndices = &swapchainImageIndex;
-    VK_CHECK(vkQueuePresentKHR(_graphicsQueue, &presentInfo));
+void VulkanEngine::init_depth_pyramid() {
+    // cull.comp binds the pyramid either way, without occlusion culling it is only ever cleared
+    if (!_gpuCulling) {
+        return;
+    }
+    _depthPyramid.init(_device, _allocator, _windowExtent);
+    if (_occlusionCulling) {
+        _depthPyramid.init_reduce(_depthReduceShader, _depthImageView);
+    }
+    _culling.set_depth_pyramid(_depthPyramid);
+    _mainDeletionQueue.push_function([=]() { _depthPyramid.cleanup(); });
+}
 
-    // increase the number of frames drawn
-    _frameNumber++;
+void VulkanEngine::init_render_graph() {
+    // the swapchain image is handed over once the acquire semaphore wait at COLOR_ATTACHMENT_OUTPUT is done.
+    // Headless leaves the offscreen image ready to be copied out instead of presented.
+    // Without occlusion culling depth stays with _mainPass, it is transient and never leaves the render pass
+    VkImageLayout finalLayout = _headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    _swapchainResource        = _renderGraph.import_image("swapchain", _swapchainImageFormat, _windowExtent, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, finalLayout);
+
+    // with dynamic resolution the scene passes draw into the scene target and the upscale pass draws it
+    // onto the swapchain image. The last frame's upscale pass has to be done sampling it first
+    uint32_t target = _swapchainResource;
+    if (_dynamicResolution) {
+        _sceneResource = _renderGraph.import_image("scene", _swapchainImageFormat, _windowExtent, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        _renderGraph.set_imported_image(_sceneResource, _sceneColorImage._image, _sceneColorView);
+        target = _sceneResource;
+    }
+
+    if (_occlusionCulling) {
+        // draw what was visible last frame, build the pyramid of its depth, then draw what the pyramid
+        // shows was wrongly held back. The pyramid is left for the next frame's early phase. The last
+        // frame's depth writes end in the attachment layout without a barrier, the transition waits for them
+        VkPipelineStageFlags depthStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        _depthResource                   = _renderGraph.import_image("depth", _depthFormat, _windowExtent, VK_IMAGE_LAYOUT_UNDEFINED, depthStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+        _pyramidResource                 = _renderGraph.import_image("depth pyramid", VK_FORMAT_R32_SFLOAT, _depthPyramid._extent, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        _renderGraph.set_imported_image(_depthResource, _depthImage._image, _depthImageView);
+        _renderGraph.set_imported_image(_pyramidResource, _depthPyramid._image._image, _depthPyramid._view);
+
+        uint32_t early = _renderGraph.add_pass("early", [this](VkCommandBuffer cmd) { draw_cull_phase(cmd, kCullEarly); });
+        _renderGraph.use(early, _pyramidResource, vkutil::ImageAccess::Sampled);
+        _renderGraph.use(early, target, vkutil::ImageAccess::ColorAttachment);
+        _renderGraph.use(early, _depthResource, vkutil::ImageAccess::DepthAttachment);
+
+        uint32_t reduce = _renderGraph.add_pass("depth pyramid", [this](VkCommandBuffer cmd) { _depthPyramid.record_build(cmd); });
+        _renderGraph.use(reduce, _depthResource, vkutil::ImageAccess::DepthRead);
+        _renderGraph.use(reduce, _pyramidResource, vkutil::ImageAccess::StorageWrite);
+
+        uint32_t late = _renderGraph.add_pass("late", [this](VkCommandBuffer cmd) { draw_cull_phase(cmd, kCullLate); });
+        _renderGraph.use(late, _pyramidResource, vkutil::ImageAccess::Sampled);
+        _renderGraph.use(late, target, vkutil::ImageAccess::ColorAttachment);
+        _renderGraph.use(late, _depthResource, vkutil::ImageAccess::DepthAttachment);
+    } else {
+        uint32_t forward = _renderGraph.add_pass("forward", [this](VkCommandBuffer cmd) { draw_forward_pass(cmd); });
+        _renderGraph.use(forward, target, vkutil::ImageAccess::ColorAttachment);
+    }
+    if (_dynamicResolution) {
+        uint32_t upscale = _renderGraph.add_pass("upscale", [this](VkCommandBuffer cmd) { draw_upscale_pass(cmd); });
+        _renderGraph.use(upscale, _sceneResource, vkutil::ImageAccess::Sampled);
+        _renderGraph.use(upscale, _swapchainResource, vkutil::ImageAccess::ColorAttachment);
+    }
+
+    if (!_renderGraph.compile() || !_renderGraph.realize(_device, _allocator)) {
+        abort();
+    }
+    _mainDeletionQueue.push_function([=]() { _renderGraph.cleanup(_device, _allocator); });
 }
 
 bool VulkanEngine::load_shader_module(const char* filePath, VkShaderModule* outShaderModule) {
-    auto AssetManager = this->_app->activity->assetManager;
-    AAsset* file      = AAssetManager_open(AssetManager, filePath, AASSET_MODE_BUFFER);
-    size_t fileLength = AAsset_getLength(file);
-
-    char* fileContent = new char[fileLength];
-    AAsset_read(file, fileContent, fileLength);
+    std::vector<char> fileContent;
+    if (!read_asset(filePath, fileContent)) {
+        return false;
+    }
+    return create_shader_module(fileContent, outShaderModule);
+}
 
-    const uint32_t* content = (const uint32_t*)fileContent;
-    VkShaderModuleCreateInfo createInfo{.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, .pNext = nullptr, .flags = 0, .codeSize = fileLength, .pCode = content};
+bool VulkanEngine::create_shader_module(const std::vector<char>& code, VkShaderModule* outShaderModule) {
+    const uint32_t* content = (const uint32_t*)code.data();
+    VkShaderModuleCreateInfo createInfo{.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, .pNext = nullptr, .flags = 0, .codeSize = code.size(), .pCode = content};
 
     // check that the creation goes well.
     VkShaderModule shaderModule;
@@ -538,24 +1172,99 @@ bool VulkanEngine::load_shader_module(const char* filePath, VkShaderModule* outS
     }
 
     *outShaderModule = shaderModule;
-    delete[] fileContent;
 
     return true;
 }
 
-void VulkanEngine::init_pipelines() {
-    // shader module loading
-    VkShaderModule meshVertShader, meshFragShader;
+void VulkanEngine::read_shaders() {
+    if (!read_asset("shaders/mesh.vert.spv", _meshVertCode)) {
+        LOGE("Error when reading the mesh vertex shader");
+    }
+    if (!read_asset("shaders/mesh.frag.spv", _meshFragCode)) {
+        LOGE("Error on read mesh.frag");
+    }
+    if (!read_asset("shaders/meshlet.vert.spv", _meshletVertCode)) {
+        LOGE("Error on read meshlet.vert");
+    }
+    if (!read_asset("shaders/cull.comp.spv", _cullCompCode)) {
+        LOGE("Error on read cull.comp");
+    }
+    if (!read_asset("shaders/depth_reduce.comp.spv", _depthReduceCode)) {
+        LOGE("Error on read depth_reduce.comp");
+    }
+    if (!read_asset("shaders/proxy.vert.spv", _proxyVertCode)) {
+        LOGE("Error on read proxy.vert");
+    }
+    if (!read_asset("shaders/fullscreen.vert.spv", _fullscreenVertCode)) {
+        LOGE("Error on read fullscreen.vert");
+    }
+    if (!read_asset("shaders/upscale.frag.spv", _upscaleFragCode)) {
+        LOGE("Error on read upscale.frag");
+    }
+}
 
-    if (!this->load_shader_module("shaders/mesh.vert.spv", &meshVertShader)) {
+void VulkanEngine::create_shader_modules() {
+    if (!this->create_shader_module(_meshVertCode, &_meshVertShader)) {
         LOGE("Error when building the triangle vertex shader module");
     }
-    if (!this->load_shader_module("shaders/mesh.frag.spv", &meshFragShader)) {
+    if (!this->create_shader_module(_meshFragCode, &_meshFragShader)) {
         LOGE("Error on load mesh.frag");
     }
+    if (_gpuCulling && !this->create_shader_module(_meshletVertCode, &_meshletVertShader)) {
+        LOGE("Error on load meshlet.vert");
+    }
+    if (_gpuCulling && !this->create_shader_module(_cullCompCode, &_cullCompShader)) {
+        LOGE("Error on load cull.comp");
+    }
+    if (_occlusionCulling && !this->create_shader_module(_depthReduceCode, &_depthReduceShader)) {
+        LOGE("Error on load depth_reduce.comp");
+    }
+    if (_occlusionQueries && !this->create_shader_module(_proxyVertCode, &_proxyVertShader)) {
+        LOGE("Error on load proxy.vert");
+    }
+    if (_dynamicResolution && !this->create_shader_module(_fullscreenVertCode, &_fullscreenVertShader)) {
+        LOGE("Error on load fullscreen.vert");
+    }
+    if (_dynamicResolution && !this->create_shader_module(_upscaleFragCode, &_upscaleFragShader)) {
+        LOGE("Error on load upscale.frag");
+    }
+    // the modules keep their own copy of the code
+    _meshVertCode.clear();
+    _meshFragCode.clear();
+    _meshletVertCode.clear();
+    _cullCompCode.clear();
+    _depthReduceCode.clear();
+    _proxyVertCode.clear();
+    _fullscreenVertCode.clear();
+    _upscaleFragCode.clear();
+
+    _mainDeletionQueue.push_function([=]() {
+        vkDestroyShaderModule(_device, _meshVertShader, nullptr);
+        vkDestroyShaderModule(_device, _meshFragShader, nullptr);
+        if (_gpuCulling) {
+            vkDestroyShaderModule(_device, _meshletVertShader, nullptr);
+            vkDestroyShaderModule(_device, _cullCompShader, nullptr);
+        }
+        if (_occlusionCulling) {
+            vkDestroyShaderModule(_device, _depthReduceShader, nullptr);
+        }
+        if (_occlusionQueries) {
+            vkDestroyShaderModule(_device, _proxyVertShader, nullptr);
+        }
+        if (_dynamicResolution) {
+            vkDestroyShaderModule(_device, _fullscreenVertShader, nullptr);
+            vkDestroyShaderModule(_device, _upscaleFragShader, nullptr);
+        }
+    });
+}
 
+void VulkanEngine::init_pipelines() {
     // we start from just the default empty pipeline layout info
     VkPipelineLayoutCreateInfo mesh_pipeline_layout_info = vkinit::pipeline_layout_create_info();
+    // set 0 is the bindless material table, set 1 the per-frame camera and object data
+    VkDescriptorSetLayout setLayouts[]       = {_materialTable._setLayout, _frameSetLayout};
+    mesh_pipeline_layout_info.setLayoutCount = 2;
+    mesh_pipeline_layout_info.pSetLayouts    = setLayouts;
     VkPushConstantRange push_constant;
     push_constant.offset                             = 0;
     push_constant.size                               = sizeof(MeshPushConstants);
@@ -566,8 +1275,13 @@ void VulkanEngine::init_pipelines() {
 
     // build the stage-create-info for both vertex and fragment stages. This lets the pipeline know the shader modules per stage
     PipelineBuilder pipelineBuilder;
-    pipelineBuilder._shaderStages.push_back(vkinit::pipeline_shader_stage_create_info(VK_SHADER_STAGE_VERTEX_BIT, meshVertShader));
-    pipelineBuilder._shaderStages.push_back(vkinit::pipeline_shader_stage_create_info(VK_SHADER_STAGE_FRAGMENT_BIT, meshFragShader));
+    pipelineBuilder._shaderStages.push_back(vkinit::pipeline_shader_stage_create_info(VK_SHADER_STAGE_VERTEX_BIT, _meshVertShader));
+    pipelineBuilder._shaderStages.push_back(vkinit::pipeline_shader_stage_create_info(VK_SHADER_STAGE_FRAGMENT_BIT, _meshFragShader));
+
+    // the size of the texture array in mesh.frag is a specialization constant
+    VkSpecializationMapEntry textureCapacityEntry = {0, 0, sizeof(uint32_t)};
+    VkSpecializationInfo textureCapacityInfo      = {1, &textureCapacityEntry, sizeof(uint32_t), &_materialTable._textureCapacity};
+    pipelineBuilder._shaderStages[1].pSpecializationInfo = &textureCapacityInfo;
 
     // input assembly is the configuration for drawing triangle lists, strips, or individual points.
     // we are just going to draw triangle list
@@ -584,12 +1298,17 @@ void VulkanEngine::init_pipelines() {
 
     pipelineBuilder._scissor.offset = {0, 0};
     pipelineBuilder._scissor.extent = _windowExtent;
+    // dynamic resolution renders a different part of the attachments every frame, begin_main_pass sets them
+    if (_dynamicResolution) {
+        pipelineBuilder._dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    }
 
     // configure the rasterizer to draw filled triangles
     pipelineBuilder._rasterizer = vkinit::rasterization_state_create_info(VK_POLYGON_MODE_FILL);
 
-    // we don't use multisampling, so just run the default one
-    pipelineBuilder._multisampling = vkinit::multisampling_state_create_info();
+    // every pipeline of _renderPass rasterizes with its sample count
+    pipelineBuilder._multisampling                      = vkinit::multisampling_state_create_info();
+    pipelineBuilder._multisampling.rasterizationSamples = _sampleCount;
 
     // a single blend attachment with no blending and writing to RGBA
     pipelineBuilder._colorBlendAttachment = vkinit::color_blend_attachment_state();
@@ -612,16 +1331,58 @@ void VulkanEngine::init_pipelines() {
 
     // adding the pipelines to the deletion queue
     _mainDeletionQueue.push_function([=]() {
-        // deleting all of the vulkan shaders
-        vkDestroyShaderModule(_device, meshVertShader, nullptr);
-        vkDestroyShaderModule(_device, meshFragShader, nullptr);
-
         // vkDestroyPipeline(_device, _trianglePipeline, nullptr);
         vkDestroyPipeline(_device, _meshPipeline, nullptr);
 
         // vkDestroyPipelineLayout(_device, _trianglePipelineLayout, nullptr);
         vkDestroyPipelineLayout(_device, _meshPipelineLayout, nullptr);
     });
+
+    if (_occlusionQueries) {
+        // the proxies only touch depth, and only to test against it. No fragment shader, no vertex buffer
+        VkPushConstantRange proxyConstant          = {VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4)};
+        VkPipelineLayoutCreateInfo proxyLayoutInfo = vkinit::pipeline_layout_create_info();
+        proxyLayoutInfo.pushConstantRangeCount     = 1;
+        proxyLayoutInfo.pPushConstantRanges        = &proxyConstant;
+        VK_CHECK(vkCreatePipelineLayout(_device, &proxyLayoutInfo, nullptr, &_proxyPipelineLayout));
+
+        PipelineBuilder proxyBuilder                      = pipelineBuilder;
+        proxyBuilder._shaderStages                        = {vkinit::pipeline_shader_stage_create_info(VK_SHADER_STAGE_VERTEX_BIT, _proxyVertShader)};
+        proxyBuilder._vertexInputInfo                     = vkinit::vertex_input_state_create_info();
+        proxyBuilder._depthStencil                        = vkinit::depth_stencil_create_info(true, false, VK_COMPARE_OP_LESS_OR_EQUAL);
+        proxyBuilder._rasterizer.cullMode                 = VK_CULL_MODE_NONE;
+        proxyBuilder._colorBlendAttachment.colorWriteMask = 0;
+        proxyBuilder._pipelineLayout                      = _proxyPipelineLayout;
+        _proxyPipeline                                    = proxyBuilder.build_pipeline(_device, _renderPass);
+
+        _mainDeletionQueue.push_function([=]() {
+            vkDestroyPipeline(_device, _proxyPipeline, nullptr);
+            vkDestroyPipelineLayout(_device, _proxyPipelineLayout, nullptr);
+        });
+    }
+    if (!_gpuCulling) {
+        return;
+    }
+
+    // the meshlet pipeline takes the material from the instance buffer in set 2 instead of a push constant
+    VkDescriptorSetLayout meshletSetLayouts[]    = {_materialTable._setLayout, _frameSetLayout, _culling._setLayout};
+    VkPipelineLayoutCreateInfo meshletLayoutInfo = vkinit::pipeline_layout_create_info();
+    meshletLayoutInfo.setLayoutCount             = 3;
+    meshletLayoutInfo.pSetLayouts                = meshletSetLayouts;
+    VK_CHECK(vkCreatePipelineLayout(_device, &meshletLayoutInfo, nullptr, &_meshletPipelineLayout));
+
+    // the cone test only holds for back-face culled triangles, the CPU path keeps drawing both sides
+    pipelineBuilder._shaderStages[0]      = vkinit::pipeline_shader_stage_create_info(VK_SHADER_STAGE_VERTEX_BIT, _meshletVertShader);
+    pipelineBuilder._rasterizer.cullMode  = VK_CULL_MODE_BACK_BIT;
+    pipelineBuilder._rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    pipelineBuilder._pipelineLayout       = _meshletPipelineLayout;
+    _meshletPipeline                      = pipelineBuilder.build_pipeline(_device, _renderPass);
+    _culling.init_pipeline(_cullCompShader, _materialTable._setLayout, _frameSetLayout);
+
+    _mainDeletionQueue.push_function([=]() {
+        vkDestroyPipeline(_device, _meshletPipeline, nullptr);
+        vkDestroyPipelineLayout(_device, _meshletPipelineLayout, nullptr);
+    });
 }
 
 VkPipeline PipelineBuilder::build_pipeline(VkDevice device, VkRenderPass pass) {
@@ -636,6 +1397,11 @@ VkPipeline PipelineBuilder::build_pipeline(VkDevice device, VkRenderPass pass) {
     viewportState.scissorCount  = 1;
     viewportState.pScissors     = &_scissor;
 
+    VkPipelineDynamicStateCreateInfo dynamicState = {};
+    dynamicState.sType                            = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount                = (uint32_t)_dynamicStates.size();
+    dynamicState.pDynamicStates                   = _dynamicStates.data();
+
     // setup dummy color blending. We aren't using transparent objects yet
     // the blending is just "no blend", but we do write to the color attachment
     VkPipelineColorBlendStateCreateInfo colorBlending = {};
@@ -661,6 +1427,7 @@ VkPipeline PipelineBuilder::build_pipeline(VkDevice device, VkRenderPass pass) {
     pipelineInfo.pRasterizationState = &_rasterizer;
     pipelineInfo.pMultisampleState   = &_multisampling;
     pipelineInfo.pColorBlendState    = &colorBlending;
+    pipelineInfo.pDynamicState       = _dynamicStates.empty() ? nullptr : &dynamicState;
     pipelineInfo.layout              = _pipelineLayout;
     pipelineInfo.renderPass          = pass;
     pipelineInfo.subpass             = 0;
@@ -679,7 +1446,7 @@ VkPipeline PipelineBuilder::build_pipeline(VkDevice device, VkRenderPass pass) {
     }
 }
 
-void VulkanEngine::load_meshes() {
+void VulkanEngine::parse_meshes() {
     // make the array 3 vertices long
     _triangleMesh._vertices.resize(3);
 
@@ -693,8 +1460,21 @@ void VulkanEngine::load_meshes() {
     _triangleMesh._vertices[1].color = {0.f, 1.f, 0.0f};  // pure green
     _triangleMesh._vertices[2].color = {0.f, 1.f, 0.0f};  // pure green
 
+    // vertex uvs, the triangle shows the whole texture
+    _triangleMesh._vertices[0].uv = {1.f, 1.f};
+    _triangleMesh._vertices[1].uv = {0.f, 1.f};
+    _triangleMesh._vertices[2].uv = {0.5f, 0.f};
+    _triangleMesh.compute_bounds();
+    _triangleMesh.build_lods();
+    _triangleMesh.build_meshlets();
+
     // load the monkey
-    _monkeyMesh.load_from_obj(this->_app->activity->assetManager, "monkey_smooth.obj");
+    _monkeyMesh.load_from_obj(_assets, "monkey_smooth.obj");
+}
+
+void VulkanEngine::upload_meshes() {
+    _meshBuffers.init(_allocator, _device, &_queues, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, _residencySettings);
+    _mainDeletionQueue.push_function([=]() { _meshBuffers.cleanup(); });
 
     // we don't care about the vertex normals
     upload_mesh(_triangleMesh);
@@ -705,31 +1485,253 @@ void VulkanEngine::load_meshes() {
     this->_meshes["triangle"] = _triangleMesh;
 }
 
+void VulkanEngine::upload_meshlets() {
+    if (!_gpuCulling) {
+        return;
+    }
+    // one vertex and one index buffer for all meshes, so a single indirect call draws every meshlet.
+    // The indices are rebased onto the mesh's first vertex, the draws need no vertex offset
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<Meshlet> meshlets;
+    for (auto& it : _meshes) {
+        Mesh& mesh          = it.second;
+        uint32_t baseVertex = (uint32_t)vertices.size();
+        uint32_t baseIndex  = (uint32_t)indices.size();
+        mesh._meshletBase   = (uint32_t)meshlets.size();
+        vertices.insert(vertices.end(), mesh._vertices.begin(), mesh._vertices.end());
+        for (uint32_t index : mesh._meshletIndices) {
+            indices.push_back(baseVertex + index);
+        }
+        for (Meshlet meshlet : mesh._meshlets) {
+            meshlet.firstIndex += baseIndex;
+            meshlets.push_back(meshlet);
+        }
+    }
+    _culling.upload_geometry(vertices, indices, meshlets);
+    LOGI("upload_meshlets: %lu meshlets, %lu triangles", meshlets.size(), indices.size() / 3);
+}
+
 void VulkanEngine::upload_mesh(Mesh& mesh) {
-    // allocate vertex buffer
+    // the vertices stay on the CPU, an evicted buffer is filled from them again. The copies in _meshes
+    // share the handle, _meshBuffers.cleanup() frees it
+    const Vertex* vertices = mesh._vertices.data();
+    mesh._vertexBuffer     = _meshBuffers.create(mesh._vertices.size() * sizeof(Vertex), [vertices](void* data, VkDeviceSize size) { memcpy(data, vertices, size); });
+}
+
+void VulkanEngine::immediate_submit(std::function<void(VkCommandBuffer cmd)>&& function, const vkutil::QueueHandoff& handoff) {
+    // on the copy engine the upload runs next to the frames already on the graphics queue
+    _queues.submit_and_wait(vkutil::QueueKind::transfer, std::move(function), handoff);
+}
+
+AllocatedBuffer VulkanEngine::create_buffer(size_t allocSize, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage) {
     VkBufferCreateInfo bufferInfo = {};
     bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    // this is the total size, in bytes, of the buffer we are allocating
-    bufferInfo.size = mesh._vertices.size() * sizeof(Vertex);
-    // this buffer is going to be used as a Vertex Buffer
-    bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    bufferInfo.pNext              = nullptr;
+    bufferInfo.size               = allocSize;
+    bufferInfo.usage              = usage;
 
-    // let the VMA library know that this data should be writeable by CPU, but also readable by GPU
     VmaAllocationCreateInfo vmaallocInfo = {};
-    vmaallocInfo.usage                   = VMA_MEMORY_USAGE_CPU_TO_GPU;
-    vmaallocInfo.pUserData = (void*)"Mesh";
+    vmaallocInfo.usage                   = memoryUsage;
+
+    AllocatedBuffer newBuffer;
+    VK_CHECK(vmaCreateBuffer(_allocator, &bufferInfo, &vmaallocInfo, &newBuffer._buffer, &newBuffer._allocation, nullptr));
+    return newBuffer;
+}
 
-    // allocate the buffer
-    VK_CHECK(vmaCreateBuffer(_allocator, &bufferInfo, &vmaallocInfo, &mesh._vertexBuffer._buffer, &mesh._vertexBuffer._allocation, nullptr));
+MemoryUsage VulkanEngine::memory_usage() {
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS] = {};
+    vmaGetBudget(_allocator, budgets);
 
-    // add the destruction of triangle mesh buffer to the deletion queue
-    _mainDeletionQueue.push_function([=]() { vmaDestroyBuffer(_allocator, mesh._vertexBuffer._buffer, mesh._vertexBuffer._allocation); });
+    const VkPhysicalDeviceMemoryProperties* memoryProperties;
+    vmaGetMemoryProperties(_allocator, &memoryProperties);
 
-    // copy vertex data
-    void* data;
-    vmaMapMemory(_allocator, mesh._vertexBuffer._allocation, &data);
-    memcpy(data, mesh._vertices.data(), mesh._vertices.size() * sizeof(Vertex));
-    vmaUnmapMemory(_allocator, mesh._vertexBuffer._allocation);
+    MemoryUsage usage = {};
+    for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; i++) {
+        usage.allocationBytes += budgets[i].allocationBytes;
+        usage.blockBytes += budgets[i].blockBytes;
+        usage.usageBytes += budgets[i].usage;
+        usage.budgetBytes += budgets[i].budget;
+    }
+    return usage;
+}
+
+bool VulkanEngine::read_asset(const char* filePath, std::vector<char>& outContent) {
+    if (!_assets->read(filePath, outContent)) {
+        LOGE("asset %s not found", filePath);
+        return false;
+    }
+    return true;
+}
+
+void VulkanEngine::load_device_capabilities(VkPhysicalDevice gpu) {
+    CapabilityDatabase database;
+    DeviceIdentity identity;
+    _capabilitiesCached = false;
+    if (!_capabilityCachePath.empty() && database.load(_capabilityCachePath.c_str()) && query_device_identity(_instance, gpu, identity)) {
+        const DeviceCapabilities* cached = database.find(identity);
+        if (cached) {
+            _caps               = *cached;
+            _capabilitiesCached = true;
+            return;
+        }
+    }
+
+    if (!query_device_capabilities(_instance, gpu, _caps)) {
+        LOGE("the device lacks the Vulkan 1.1 property queries");
+        abort();
+    }
+    if (!_capabilityCachePath.empty()) {
+        database.store(_caps);
+        if (!database.save(_capabilityCachePath.c_str())) {
+            LOGW("can't write the capability database %s", _capabilityCachePath.c_str());
+        }
+    }
+}
+
+void VulkanEngine::init_descriptors() {
+    _materialTable.init(_device, _allocator, _descriptorIndexing, _bindlessTextureCapacity, kMaterialCapacity);
+    _mainDeletionQueue.push_function([=]() { _materialTable.cleanup(); });
+
+    // one sampler for every material, nearest filtering keeps the lost_empire atlas blocky
+    VkSamplerCreateInfo samplerInfo = vkinit::sampler_create_info(VK_FILTER_NEAREST);
+    VK_CHECK(vkCreateSampler(_device, &samplerInfo, nullptr, &_blockySampler));
+    _mainDeletionQueue.push_function([=]() { vkDestroySampler(_device, _blockySampler, nullptr); });
+
+    // transient per-frame data: camera uniforms and object matrices, addressed with dynamic offsets
+    VkDeviceSize objectRange = sizeof(GPUObjectData) * kMaxObjects;
+    _frameAllocator.init(_allocator, _gpuProperties.limits, kTransientBufferSize, objectRange);
+    _mainDeletionQueue.push_function([=]() { _frameAllocator.cleanup(); });
+
+    VkDescriptorPoolSize sizes[]        = {{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 10}, {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 10}};
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags                      = 0;
+    poolInfo.maxSets                    = 10;
+    poolInfo.poolSizeCount              = 2;
+    poolInfo.pPoolSizes                 = sizes;
+    VK_CHECK(vkCreateDescriptorPool(_device, &poolInfo, nullptr, &_descriptorPool));
+
+    // cull.comp reads the camera, for the occlusion test, and the object matrices as well
+    VkDescriptorSetLayoutBinding frameBindings[] = {
+        vkinit::descriptorset_layout_binding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT, 0),
+        vkinit::descriptorset_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT, 1),
+    };
+    VkDescriptorSetLayoutCreateInfo setInfo = {};
+    setInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setInfo.pNext                           = nullptr;
+    setInfo.bindingCount                    = 2;
+    setInfo.pBindings                       = frameBindings;
+    VK_CHECK(vkCreateDescriptorSetLayout(_device, &setInfo, nullptr, &_frameSetLayout));
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool              = _descriptorPool;
+    allocInfo.descriptorSetCount          = 1;
+    allocInfo.pSetLayouts                 = &_frameSetLayout;
+    VK_CHECK(vkAllocateDescriptorSets(_device, &allocInfo, &_frameSet));
+
+    // one set covers every frame, the dynamic offsets select the frame's slice of the ring
+    VkDescriptorBufferInfo cameraInfo = {_frameAllocator._buffer, 0, sizeof(GPUCameraData)};
+    VkDescriptorBufferInfo objectInfo = {_frameAllocator._buffer, 0, objectRange};
+    VkWriteDescriptorSet writes[]     = {
+        vkinit::write_descriptor_buffer(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, _frameSet, &cameraInfo, 0),
+        vkinit::write_descriptor_buffer(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, _frameSet, &objectInfo, 1),
+    };
+    vkUpdateDescriptorSets(_device, 2, writes, 0, nullptr);
+
+    _mainDeletionQueue.push_function([=]() {
+        vkDestroyDescriptorSetLayout(_device, _frameSetLayout, nullptr);
+        vkDestroyDescriptorPool(_device, _descriptorPool, nullptr);
+    });
+
+    if (_gpuCulling) {
+        uint32_t maxDraws = std::min(kMaxMeshletDraws, _gpuProperties.limits.maxDrawIndirectCount);
+        _culling.init(_device, _allocator, _frameAllocator._buffer, sizeof(GPUInstance) * kMaxObjects, maxDraws, _occlusionCulling, _drawIndexedIndirectCount);
+        _mainDeletionQueue.push_function([=]() { _culling.cleanup(); });
+    }
+}
+
+void VulkanEngine::init_default_material() {
+    // slot 0 is a white texture and row 0 a white material, "defaultmesh" renders with them
+    uint32_t whitePixel = 0xffffffff;
+    Texture white;
+    vkutil::upload_image(*this, &whitePixel, 1, 1, white);
+    white.slot               = _materialTable.add_texture(white.imageView, _blockySampler);
+    _loadedTextures["white"] = white;
+
+    GPUMaterialParams defaultParams = {};
+    defaultParams.diffuse           = {1.f, 1.f, 1.f, 0.f};
+    defaultParams.textures          = {white.slot, white.slot, 0, 0};
+    _materialTable.add_material(defaultParams);
+    _materialTable.update();
+}
+
+uint32_t VulkanEngine::load_texture(const std::string& file) {
+    auto it = _loadedTextures.find(file);
+    if (it != _loadedTextures.end()) {
+        return it->second.slot;
+    }
+
+    Texture texture;
+    if (!vkutil::load_image_from_asset(*this, file.c_str(), texture)) {
+        return _loadedTextures["white"].slot;
+    }
+    texture.slot          = _materialTable.add_texture(texture.imageView, _blockySampler);
+    _loadedTextures[file] = texture;
+    return texture.slot;
+}
+
+void VulkanEngine::load_materials(const char* filename) {
+    std::vector<char> content;
+    if (!read_asset(filename, content)) {
+        LOGE("load_materials: can't open %s", filename);
+        return;
+    }
+
+    std::istringstream in(std::string(content.begin(), content.end()));
+    std::map<std::string, int> materialMap;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn;
+    std::string err;
+    tinyobj::LoadMtl(&materialMap, &materials, &in, &warn, &err);
+    if (!warn.empty()) {
+        LOGE("WARN: %s", warn.c_str());
+    }
+    if (!err.empty()) {
+        LOGE("ERROR: %s", err.c_str());
+        return;
+    }
+
+    uint32_t whiteSlot = _loadedTextures["white"].slot;
+    for (auto& m : materials) {
+        GPUMaterialParams params = {};
+        // a map_d texture turns on the alpha test
+        params.diffuse    = {m.diffuse[0], m.diffuse[1], m.diffuse[2], m.alpha_texname.empty() ? 0.f : 0.5f};
+        params.textures.x = m.diffuse_texname.empty() ? whiteSlot : load_texture(m.diffuse_texname);
+        params.textures.y = m.alpha_texname.empty() ? whiteSlot : load_texture(m.alpha_texname);
+
+        // every material shares the mesh pipeline, only the table row differs
+        create_material(_meshPipeline, _meshPipelineLayout, m.name, _materialTable.add_material(params));
+        _sceneMaterials.push_back(m.name);
+    }
+    _materialTable.update();
+
+    LOGI("load_materials %s materials=%lu textures=%u", filename, materials.size(), _materialTable.texture_count());
+}
+
+void VulkanEngine::init_occlusion_queries() {
+    if (!_occlusionQueries) {
+        return;
+    }
+    PFN_vkCmdBeginConditionalRenderingEXT beginConditional = nullptr;
+    PFN_vkCmdEndConditionalRenderingEXT endConditional     = nullptr;
+    if (_conditionalRendering) {
+        beginConditional = (PFN_vkCmdBeginConditionalRenderingEXT)vkGetDeviceProcAddr(_device, "vkCmdBeginConditionalRenderingEXT");
+        endConditional   = (PFN_vkCmdEndConditionalRenderingEXT)vkGetDeviceProcAddr(_device, "vkCmdEndConditionalRenderingEXT");
+    }
+    _queries.init(_device, _allocator, beginConditional, endConditional);
+    _mainDeletionQueue.push_function([=]() { _queries.cleanup(); });
 }
 
 void VulkanEngine::init_querypool(VkDevice vkDevice, uint32_t count) {
@@ -1,20 +1,47 @@
 #pragma once
-// #include "vk_types.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <deque>
 #include <iostream>
 #include <queue>
 #include <functional>
 #include <map>
+#include <mutex>
 #include <unordered_map>
-#include <game-activity/native_app_glue/android_native_app_glue.h>
 #include "vulkan_wrapper.h"
 #include "vma/vk_mem_alloc.h"
+#include "vk_types.h"
 #include "vk_mesh.h"
+#include "vk_material.h"
+#include "vk_frame_allocator.h"
+#include "vk_renderpass.h"
+#include "vk_rendergraph.h"
+#include "vk_pacing.h"
+#include "vk_resolution.h"
+#include "vk_hud.h"
+#include "vk_residency.h"
+#include "vk_assets.h"
+#include "vk_platform.h"
+#include "vk_scene.h"
+#include "vk_transforms.h"
+#include "vk_renderables.h"
+#include "vk_capabilities.h"
+#include "vk_taskgraph.h"
+#include "vk_jobs.h"
+#include "vk_culling.h"
+#include "vk_occlusion_queries.h"
+#include "vk_queues.h"
 #include "log.h"
 
 struct DeletionQueue {
     std::deque<std::function<void()>> deletors;
+    std::mutex mutex;  // init tasks push from several threads
 
-    void push_function(std::function<void()>&& function) { deletors.push_back(function); }
+    void push_function(std::function<void()>&& function) {
+        std::lock_guard<std::mutex> lock(mutex);
+        deletors.push_back(function);
+    }
 
     void flush() {
         // reverse iterate the deletion queue to execute all the functions
@@ -30,29 +57,149 @@ struct DeletionQueue {
 struct Material {
     VkPipeline pipeline;
     VkPipelineLayout pipelineLayout;
+    uint32_t paramIndex;  // row in the bindless material table
+};
+
+// objects the frame descriptor set can address, sizes the storage buffer range
+constexpr uint32_t kMaxObjects = 10000;
+// ring capacity of the transient frame allocator, shared by all frames in flight
+constexpr VkDeviceSize kTransientBufferSize = 4 * 1024 * 1024;
+// assumed refresh period when the display can't tell us, 60Hz
+constexpr uint64_t kDefaultRefreshPeriodNs = 16666667;
+// offscreen color targets of the headless mode, one per frame in flight
+constexpr uint32_t kHeadlessImageCount = FRAME_OVERLAP;
+constexpr VkFormat kHeadlessFormat     = VK_FORMAT_R8G8B8A8_UNORM;
+
+enum class StartupProfile {
+    Development,  // validation layers when installed
+    Production,   // no layers, nothing but the engine's own queries
+};
+
+struct GPUCameraData {
+    glm::mat4 view;
+    glm::mat4 proj;
+    glm::mat4 viewproj;
+    glm::mat4 lastViewproj;  // of the frame before, the early cull phase tests against its depth pyramid
+};
+
+struct GPUObjectData {
+    glm::mat4 modelMatrix;
+};
+
+struct FrameData {
+    VkSemaphore _presentSemaphore, _renderSemaphore;
+    uint64_t _timelineValue;  // of the graphics timeline, reached once the frame's commands are done
+    float _renderScale;       // dynamic resolution scale the frame was recorded with
+
+    VkCommandPool _commandPool;          // the command pool for our commands
+    VkCommandBuffer _mainCommandBuffer;  // the buffer we will record into
+};
+
+// what the forward pass recorded for the last frame
+struct RenderStats {
+    uint32_t objects;
+    uint32_t draws;
+    uint32_t pipelineBinds;
+    uint32_t descriptorBinds;  // vkCmdBindDescriptorSets calls
+    uint32_t vertexBufferBinds;
+    uint64_t vertices;
+    uint32_t meshlets;  // handed to the cull shader, the draws it keeps stay on the GPU
+    // what the cull shader kept, read back FRAME_OVERLAP frames late
+    uint32_t drawnObjects;  // instances drawn by either cull phase
+    uint32_t lateObjects;   // of those, the ones the late phase found visible after all
+    uint32_t meshletDraws;
+    // occlusion queries of the draw per object path
+    uint32_t occlusionQueries;
+    uint32_t skippedDraws;  // occluded objects left out, with conditional rendering the ones the GPU discarded a frame earlier
 };
 
-struct RenderObject {
-    Mesh* mesh;
-    Material* material;
-    glm::mat4 transformMatrix;
+struct MemoryUsage {
+    VkDeviceSize allocationBytes;  // sum of all VMA allocations
+    VkDeviceSize blockBytes;       // VkDeviceMemory behind them
+    VkDeviceSize usageBytes;       // the process's use VMA estimates, from VK_EXT_memory_budget when enabled
+    VkDeviceSize budgetBytes;      // what the heaps give the process
 };
 
 class VulkanEngine {
    public:
-    android_app* _app;
+    PlatformWindow* _window;  // null in headless mode
+    AssetSource* _assets;
 
-    std::vector<RenderObject> _renderables;
+    RenderableStore _renderables;
 
     std::unordered_map<std::string, Material> _materials;
     std::unordered_map<std::string, Mesh> _meshes;
+    std::unordered_map<std::string, Texture> _loadedTextures;
+    // what the mesh and material ids of _renderables refer to, handed out by mesh_id and material_id
+    std::vector<Mesh*> _meshById;
+    std::vector<Material*> _materialById;
+    std::unordered_map<std::string, uint32_t> _meshIds;
+    std::unordered_map<std::string, uint32_t> _materialIds;
+
+    MaterialTable _materialTable;
+    // materials read from lost_empire.mtl, in file order
+    std::vector<std::string> _sceneMaterials;
+    // objects init_scene creates, set before init()
+    SceneConfig _sceneConfig;
+    // placement of the renderables, move _sceneRoot to move the whole scene
+    TransformHierarchy _transforms;
+    uint32_t _sceneRoot;
+    // renderable of every transform node, an invalid handle for nodes that only group others
+    std::vector<RenderableHandle> _transformObjects;
+    // camera of draw_objects, starts at the scene camera's first frame
+    glm::mat4 _view;
+    // screen space error in pixels a mesh level of detail may cause, 0 always draws the full meshes
+    float _lodThreshold{1.f};
+    // fraction a coarser level has to stay below the threshold by before an object switches to it
+    float _lodHysteresis{0.25f};
+    // cull meshlets in cull.comp and draw them with one indirect call, set before init().
+    // Turned off on devices without multiDrawIndirect or drawIndirectFirstInstance
+    bool _gpuCulling{true};
+    // with _gpuCulling, also cull objects hidden behind the depth of the last frame, in two phases
+    // against a depth pyramid. Set before init()
+    bool _occlusionCulling{true};
+    // without _gpuCulling, hold back objects of at least _occlusionQueryMinVertices vertices whose bounding
+    // box was hidden in an earlier frame, see OcclusionQueries. Set before init()
+    bool _occlusionQueries{true};
+    uint32_t _occlusionQueryMinVertices{1024};
+    // uploads on a transfer queue family and compute on a compute family of their own when the device
+    // has them, otherwise everything goes to the graphics queue. Set before init()
+    bool _asyncQueues{true};
+    // submits reach values of a timeline semaphore per queue. Without VK_KHR_timeline_semaphore every
+    // submit signals a fence instead, see vkutil::GpuTimeline. Set before init()
+    bool _timelineSemaphores{true};
+    // samples per pixel of the main pass, lowered to what the device renders color and depth with.
+    // The multisampled attachments stay in tile memory and are resolved inside the pass, which leaves
+    // no depth to build the pyramid from: more than 1 turns _occlusionCulling off. Set before init()
+    uint32_t _msaaSamples{1};
+    VkSampleCountFlagBits _sampleCount;  // what init_vulkan picked for _msaaSamples
+    // renders the scene into an offscreen target at _resolution's scale of the window and upscales it
+    // onto the swapchain image in a final pass, the scale follows the GPU time of the timestamp queries.
+    // Only part of the target is rendered, the pyramid would cover stale depth: turns _occlusionCulling
+    // off. Set before init()
+    bool _dynamicResolution{false};
+    ResolutionSettings _resolutionSettings;
+    ResolutionController _resolution;
+    VkExtent2D _renderExtent;  // the scene's size this frame, _windowExtent without _dynamicResolution
+    RenderStats _stats;
+    // draws PerfHud over the last pass on the swapchain image: frame time graphs, the _stats counters and
+    // memory against the budget. Off, nothing of it is created or recorded. Set before init()
+    bool _hud{false};
+    PerfHud _perfHud;
+    // mesh vertex buffers live in a pool of their own, the least recently drawn are evicted near the
+    // memory budget and the pool is defragmented a few moves per frame. Set before init()
+    ResidencySettings _residencySettings;
+    BufferResidency _meshBuffers;
+    // directory the allocator stats are written to every frame, empty for none
+    std::string _memoryStatsDir;
 
     VkQueryPool _vkQueryPool;
     // create material and add it to the map
-    Material* create_material(VkPipeline pipeline, VkPipelineLayout layout, const std::string& name) {
+    Material* create_material(VkPipeline pipeline, VkPipelineLayout layout, const std::string& name, uint32_t paramIndex = 0) {
         Material mat;
         mat.pipeline       = pipeline;
         mat.pipelineLayout = layout;
+        mat.paramIndex     = paramIndex;
         _materials[name]   = mat;
         return &_materials[name];
     }
@@ -77,45 +224,178 @@ class VulkanEngine {
         return &it->second;
     }
 
-    // our draw function
-    void draw_objects(VkCommandBuffer cmd, RenderObject* first, int count) {
+    // id of a mesh or material in _meshById and _materialById, assigned on first use
+    uint32_t mesh_id(const std::string& name) {
+        auto it = _meshIds.find(name);
+        if (it != _meshIds.end()) {
+            return it->second;
+        }
+        _meshById.push_back(get_mesh(name));
+        return _meshIds[name] = (uint32_t)_meshById.size() - 1;
+    }
+    uint32_t material_id(const std::string& name) {
+        auto it = _materialIds.find(name);
+        if (it != _materialIds.end()) {
+            return it->second;
+        }
+        _materialById.push_back(get_material(name));
+        return _materialIds[name] = (uint32_t)_materialById.size() - 1;
+    }
+
+    // streams the camera, every object matrix and, with _gpuCulling, every instance through the frame
+    // allocator. Recorded before the render graph, the cull dispatch has to run outside the render pass
+    bool upload_frame_data(const RenderableStore& renderables) {
         // make a model view matrix for rendering the object
-        // camera view
-        glm::vec3 camPos = {0.f, -6.f, -10.f};
-        glm::mat4 view   = glm::translate(glm::mat4(1.f), camPos);
+        glm::mat4 view = _view;
         // camera projection
         glm::mat4 projection = glm::perspective(glm::radians(70.f), 1700.f / 900.f, 0.1f, 200.0f);
         projection[1][1] *= -1;
-        Mesh* lastMesh         = nullptr;
-        Material* lastMaterial = nullptr;
-        for (int i = 0; i < count; i++) {
-            RenderObject& object = first[i];
-
-            // only bind the pipeline if it doesn't match with the already bound one
-            if (object.material != lastMaterial) {
-                vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, object.material->pipeline);
-                lastMaterial = object.material;
+
+        _stats         = {};
+        _frameObjects  = 0;
+        uint32_t count = renderables.size();
+        if (count > kMaxObjects) {
+            LOGE("upload_frame_data: %u objects, only %u fit the object buffer", count, kMaxObjects);
+            count = kMaxObjects;
+        }
+
+        TransientAllocation cameraData, objectData, instanceData;
+        if (!_frameAllocator.alloc_uniform(sizeof(GPUCameraData), cameraData) || !_frameAllocator.alloc_storage(sizeof(GPUObjectData) * count, objectData)) {
+            return false;
+        }
+        if (_gpuCulling && !_frameAllocator.alloc_storage(sizeof(GPUInstance) * count, instanceData)) {
+            return false;
+        }
+        GPUCameraData* camera = (GPUCameraData*)cameraData.data;
+        camera->view          = view;
+        camera->proj          = projection;
+        camera->viewproj      = projection * view;
+        camera->lastViewproj  = _frameNumber == 0 ? camera->viewproj : _viewproj;
+        _viewproj             = camera->viewproj;
+
+        GPUObjectData* objects      = (GPUObjectData*)objectData.data;
+        const glm::mat4* transforms = renderables.transforms();
+        _jobs.parallel_for(0, count, 1024, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                objects[i].modelMatrix = transforms[i];
+            }
+        });
+        _frameOffsets[0] = cameraData.offset;
+        _frameOffsets[1] = objectData.offset;
+        _frameObjects    = count;
+        _stats.objects   = count;
+        if (!_gpuCulling) {
+            return true;
+        }
+
+        // the selected level of detail's meshlets, every one of them may become a draw
+        GPUInstance* instances      = (GPUInstance*)instanceData.data;
+        const RenderBounds* bounds  = renderables.bounds();
+        const uint32_t* meshIds     = renderables.meshes();
+        const uint32_t* materialIds = renderables.materials();
+        const uint32_t* flags       = renderables.flags();
+        const uint32_t* lods        = renderables.lods();
+        std::atomic<uint32_t> meshlets{0};
+        _jobs.parallel_for(0, count, 1024, [&](uint32_t begin, uint32_t end) {
+            uint32_t chunkMeshlets = 0;
+            for (uint32_t i = begin; i < end; i++) {
+                const Mesh* mesh          = _meshById[meshIds[i]];
+                const MeshLod& lod        = mesh->_lods[lods[i]];
+                instances[i].sphere       = glm::vec4(bounds[i].center, bounds[i].radius);
+                instances[i].firstMeshlet = mesh->_meshletBase + lod.firstMeshlet;
+                instances[i].meshletCount = (flags[i] & kRenderableHidden) ? 0 : lod.meshletCount;
+                instances[i].material     = _materialById[materialIds[i]]->paramIndex;
+                chunkMeshlets += instances[i].meshletCount;
+            }
+            meshlets += chunkMeshlets;
+        });
+        _stats.meshlets = meshlets;
+        _instanceOffset = instanceData.offset;
+
+        frustum_planes(projection * view, _cullConstants.planes);
+        _cullConstants.eye           = glm::inverse(view)[3];
+        _cullConstants.instanceCount = count;
+        _cullConstants.maxDraws      = std::min(_stats.meshlets, _culling._maxDraws);
+        if (_stats.meshlets > _culling._maxDraws && _frameNumber % 120 == 0) {
+            LOGW("upload_frame_data: %u meshlets, only %u draws fit the draw buffer", _stats.meshlets, _culling._maxDraws);
+        }
+        return true;
+    }
+
+    // one draw per visible renderable, the CPU path when _gpuCulling is off
+    void draw_objects(VkCommandBuffer cmd, const RenderableStore& renderables) {
+        uint32_t count = std::min(_frameObjects, renderables.size());
+    _proxyObjects.clear();
+
+        // the binding decisions compare ids, the mesh and material are only looked at when they change
+        const uint32_t* meshIds     = renderables.meshes();
+        const uint32_t* materialIds = renderables.materials();
+        const uint32_t* flags       = renderables.flags();
+        const uint32_t* lods        = renderables.lods();
+        uint32_t lastMeshId         = UINT32_MAX;
+        uint32_t lastMaterialId     = UINT32_MAX;
+        Mesh* mesh                  = nullptr;
+        Material* material          = nullptr;
+        VkPipeline lastPipeline     = VK_NULL_HANDLE;
+        for (uint32_t i = 0; i < count; i++) {
+            if (flags[i] & kRenderableHidden) {
+                continue;
             }
 
-            glm::mat4 model = object.transformMatrix;
-            // final render matrix, that we are calculating on the cpu
-            glm::mat4 mesh_matrix = projection * view * model;
+            // only bind the pipeline if it doesn't match with the already bound one.
+            // Materials sharing a pipeline only differ by their table row, so they don't break the batch
+            if (materialIds[i] != lastMaterialId) {
+                material       = _materialById[materialIds[i]];
+                lastMaterialId = materialIds[i];
+                if (material->pipeline != lastPipeline) {
+                    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, material->pipeline);
+                    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, material->pipelineLayout, 0, 1, &_materialTable._set, 0, nullptr);
+                    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, material->pipelineLayout, 1, 1, &_frameSet, 2, _frameOffsets);
+                    lastPipeline = material->pipeline;
+                    _stats.pipelineBinds++;
+                    _stats.descriptorBinds += 2;
+                }
+            }
 
             MeshPushConstants constants;
-            constants.render_matrix = mesh_matrix;
+            constants.data = {material->paramIndex, 0, 0, 0};
 
             // upload the mesh to the GPU via push constants
-            vkCmdPushConstants(cmd, object.material->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstants), &constants);
+            vkCmdPushConstants(cmd, material->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstants), &constants);
 
             // only bind the mesh if it's a different one from last bind
-            if (object.mesh != lastMesh) {
+            if (meshIds[i] != lastMeshId) {
+                mesh       = _meshById[meshIds[i]];
+                lastMeshId = meshIds[i];
                 // bind the mesh vertex buffer with offset 0
-                VkDeviceSize offset = 0;
-                vkCmdBindVertexBuffers(cmd, 0, 1, &object.mesh->_vertexBuffer._buffer, &offset);
-                lastMesh = object.mesh;
+                VkDeviceSize offset   = 0;
+                VkBuffer vertexBuffer = _meshBuffers.use(mesh->_vertexBuffer, _frameNumber);
+                vkCmdBindVertexBuffers(cmd, 0, 1, &vertexBuffer, &offset);
+                _stats.vertexBufferBinds++;
+            }
+            // we can now draw, firstInstance picks the object matrix
+            const MeshLod& lod = mesh->_lods[lods[i]];
+            bool queried       = _occlusionQueries && lod.vertexCount >= _occlusionQueryMinVertices;
+            if (queried) {
+                _proxyObjects.push_back(i);
+                if (!_queries.begin_draw(cmd, i)) {
+                    _stats.skippedDraws++;
+                    continue;
+                }
             }
-            // we can now draw
-            vkCmdDraw(cmd, object.mesh->_vertices.size(), 1, 0, 0);
+            vkCmdDraw(cmd, lod.vertexCount, 1, lod.firstVertex, i);
+            if (queried) {
+                _queries.end_draw(cmd, i);
+            }
+            _stats.draws++;
+            _stats.vertices += lod.vertexCount;
+        }
+
+        // the proxies go last so they are tested against everything drawn this frame
+        if (!_proxyObjects.empty()) {
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, _proxyPipeline);
+            _stats.pipelineBinds++;
+            _stats.occlusionQueries = _queries.record_proxies(cmd, _proxyPipelineLayout, renderables, _proxyObjects, _viewproj);
         }
     }
 
@@ -126,9 +406,37 @@ class VulkanEngine {
 
     VkDevice _device;             // Vulkan device for commands
     VkPhysicalDevice _chosenGPU;  // GPU chosen as the default device
+    VkPhysicalDeviceProperties _gpuProperties;
+
+    bool _descriptorIndexing;           // VK_EXT_descriptor_indexing enabled for the material table
+    bool _conditionalRendering;         // VK_EXT_conditional_rendering enabled for _queries
+    bool _memoryBudget;                 // VK_EXT_memory_budget enabled, VMA's budget comes from the driver
+    uint32_t _bindlessTextureCapacity;  // texture slots of the material table
+
+   public:  // startup, pick _startupProfile and _capabilityCachePath before init()
+    StartupProfile _startupProfile{StartupProfile::Development};
+    // file of the capability database, empty to query the driver on every launch
+    std::string _capabilityCachePath;
+    DeviceCapabilities _caps;
+    bool _capabilitiesCached;  // _caps came from the database
+    // threads of the init task graph, 0 for one per core and 1 for the old serial init
+    uint32_t _initThreads{0};
+    // file the chrome://tracing JSON of the init phases is written to, empty for none
+    std::string _startupTracePath;
+    vkutil::TaskGraph _initGraph;
+
+    // time spent in one init phase, 0 when there is no such phase
+    uint64_t startup_phase_ns(const std::string& name) const;
+
+   public:  // jobs, the thread calling init() takes part in them whenever it waits
+    // job threads besides the render thread, 0 for one per remaining core
+    uint32_t _jobWorkers{0};
+    vkutil::JobSystem _jobs;
 
    public:                      // swap chain
     VkSwapchainKHR _swapchain;  // from other articles
+    bool _headless;             // offscreen images instead of a surface and swapchain
+    VkPresentModeKHR _presentMode;
     VkExtent2D _windowExtent;
     VkFormat _swapchainImageFormat;                 // image format expected by the windowing system
     std::vector<VkImage> _swapchainImages;          // array of images from the swapchain
@@ -138,14 +446,54 @@ class VulkanEngine {
     VkQueue _graphicsQueue;         // queue we will submit to
     uint32_t _graphicsQueueFamily;  // family of that queue
 
-    VkCommandPool _commandPool;          // the command pool for our commands
-    VkCommandBuffer _mainCommandBuffer;  // the buffer we will record into
+    FrameData _frames[FRAME_OVERLAP];
+
+    vkutil::QueueTopology _queueTopology;  // families picked in init_vulkan
+    vkutil::QueueSubmitter _queues;        // one-off submissions, see immediate_submit
    public:
     VkRenderPass _renderPass;
-
-   public:  // sync
-    VkSemaphore _presentSemaphore, _renderSemaphore;
-    VkFence _renderFence;
+    vkutil::RenderPassDesc _mainPass;  // attachment usage of _renderPass, decides which attachments are transient
+    // the late cull phase draws on top of _renderPass's results, same attachments so the framebuffers are shared
+    VkRenderPass _lateRenderPass;
+    vkutil::RenderPassDesc _latePass;
+
+    vkutil::RenderGraph _renderGraph;
+    uint32_t _swapchainResource;    // the swapchain image inside _renderGraph
+    uint32_t _depthResource;        // the depth image and the depth pyramid, only with _occlusionCulling
+    uint32_t _pyramidResource;
+    uint32_t _sceneResource;        // the scene target, only with _dynamicResolution
+    uint32_t _swapchainImageIndex;  // image acquired for the frame being recorded
+
+   public:  // frame pacing, pick _pacingMode and _clock before init()
+    PacingMode _pacingMode{PacingMode::Fifo};
+    SteadyClock _steadyClock;
+    Clock* _clock{&_steadyClock};
+    FramePacer _pacer;
+
+    bool _displayTiming;  // VK_GOOGLE_display_timing enabled, present times are exact
+    PFN_vkGetRefreshCycleDurationGOOGLE _getRefreshCycleDuration;
+    PFN_vkGetPastPresentationTimingGOOGLE _getPastPresentationTiming;
+    // null without _timelineSemaphores
+    PFN_vkGetSemaphoreCounterValueKHR _getSemaphoreCounterValue;
+    PFN_vkWaitSemaphoresKHR _waitSemaphores;
+
+   public:  // per-frame data
+    FrameAllocator _frameAllocator;         // transient uniform, storage and instance data
+    VkDescriptorPool _descriptorPool;
+    VkDescriptorSetLayout _frameSetLayout;  // set 1: camera uniform and object storage, both dynamic
+    VkDescriptorSet _frameSet;
+    // what upload_frame_data streamed for the frame being recorded
+    uint32_t _frameOffsets[2];  // dynamic offsets of _frameSet
+    uint32_t _frameObjects{0};
+    uint32_t _instanceOffset;
+    GPUCullConstants _cullConstants;
+    GpuCulling _culling;
+    DepthPyramid _depthPyramid;
+    glm::mat4 _viewproj;  // camera of the frame being recorded
+    OcclusionQueries _queries;
+    std::vector<uint32_t> _proxyObjects;  // renderables draw_objects queries this frame
+
+    FrameData& get_current_frame() { return _frames[_frameNumber % FRAME_OVERLAP]; }
 
    public:
     std::vector<VkFramebuffer> _framebuffers;
@@ -155,10 +503,37 @@ class VulkanEngine {
     VkPipelineLayout _meshPipelineLayout;
     // VkPipeline _trianglePipeline;
     VkPipeline _meshPipeline;
+    // draws the output of cull.comp, sets 0 and 1 as in _meshPipelineLayout plus the cull set
+    VkPipelineLayout _meshletPipelineLayout;
+    VkPipeline _meshletPipeline;
+    // bounding boxes of the occlusion queries, depth tested without depth or color writes
+    VkPipelineLayout _proxyPipelineLayout;
+    VkPipeline _proxyPipeline;
+    // final pass of dynamic resolution, samples the scene target onto the swapchain image
+    VkRenderPass _upscaleRenderPass;
+    std::vector<VkFramebuffer> _upscaleFramebuffers;
+    VkDescriptorSetLayout _upscaleSetLayout;
+    VkDescriptorPool _upscalePool;
+    VkDescriptorSet _upscaleSet;
+    VkSampler _upscaleSampler;
+    VkPipelineLayout _upscalePipelineLayout;
+    VkPipeline _upscalePipeline;
+    PFN_vkCmdDrawIndexedIndirectCountKHR _drawIndexedIndirectCount;
+
+    // SPIR-V read by the "read shaders" init phase, the modules are created once the device exists
+    std::vector<char> _meshVertCode, _meshFragCode, _meshletVertCode, _cullCompCode, _depthReduceCode, _proxyVertCode, _fullscreenVertCode, _upscaleFragCode;
+    VkShaderModule _meshVertShader, _meshFragShader, _meshletVertShader, _cullCompShader, _depthReduceShader, _proxyVertShader, _fullscreenVertShader, _upscaleFragShader;
 
    private:
     VkImageView _depthImageView;
     AllocatedImage _depthImage;
+    // multisampled color of _renderPass, resolved into the swapchain image. Only with _sampleCount > 1
+    VkImageView _msaaColorView;
+    AllocatedImage _msaaColorImage;
+    // color target of the scene passes with _dynamicResolution, window sized, each frame renders into
+    // its top left _renderExtent
+    VkImageView _sceneColorView;
+    AllocatedImage _sceneColorImage;
 
     // the format for the depth image
     VkFormat _depthFormat;
@@ -166,9 +541,10 @@ class VulkanEngine {
     Mesh _triangleMesh;
     Mesh _monkeyMesh;
 
-   private:
+    VkSampler _blockySampler;
+
+   public:
     VmaAllocator _allocator;  // vma lib allocator
-   private:
     DeletionQueue _mainDeletionQueue;
 
    public:
@@ -177,8 +553,10 @@ class VulkanEngine {
 
     VulkanEngine() : _instance{}, _surface{} {};
 
-    // initializes everything in the engine
-    void init(android_app* app);
+    // initializes everything in the engine, presenting to window
+    void init(PlatformWindow* window, AssetSource* assets);
+    // same engine without surface or swapchain, renders into offscreen images of the given size
+    void init_headless(AssetSource* assets, VkExtent2D extent);
 
     // shuts down the engine
     void cleanup();
@@ -189,45 +567,153 @@ class VulkanEngine {
     // run main loop
     void run();
 
+    // records commands with function on the transfer queue and waits for them to finish. The resources
+    // in handoff are owned by the graphics queue afterwards, see vkutil::QueueSubmitter
+    void immediate_submit(std::function<void(VkCommandBuffer cmd)>&& function, const vkutil::QueueHandoff& handoff = {});
+
+    AllocatedBuffer create_buffer(size_t allocSize, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage);
+
+    // current VMA usage over all heaps, cheap enough to call every frame
+    MemoryUsage memory_usage();
+
+    // reads a whole file from the asset source
+    bool read_asset(const char* filePath, std::vector<char>& outContent);
+
    private:
-    void init_vulkan(android_app* app);
+    void init_engine();
+    void init_vulkan();
     void init_vma();
-    void init_swapchain(android_app* app);
+    void init_swapchain();
+    void init_offscreen_targets();
     void init_commands();
     void init_default_renderpass();
     void init_framebuffers();
     void init_sync_structures();
+    void init_descriptors();
+    // the white texture and material row 0 that "defaultmesh" renders with
+    void init_default_material();
+    void init_depth_pyramid();
+    void init_render_graph();
+    // begins renderPass on the frame's framebuffer, the clear values only matter to _renderPass
+    void begin_main_pass(VkCommandBuffer cmd, VkRenderPass renderPass);
+    void draw_forward_pass(VkCommandBuffer cmd);
+    // one cull phase of occlusion culling and the render pass drawing what it kept
+    void draw_cull_phase(VkCommandBuffer cmd, uint32_t phase);
+    // the indirect draws cull.comp wrote into draw list list this frame
+    void draw_meshlets(VkCommandBuffer cmd, uint32_t list);
+    void init_upscale_pass();
+    void draw_upscale_pass(VkCommandBuffer cmd);
+    void init_hud();
+    // only from the last pass that renders into the swapchain image
+    void draw_hud(VkCommandBuffer cmd);
+    // feeds GPU times and present times of finished frames to _pacer
+    void read_frame_timings();
+    // top Vulkan calls of the last frame, only has data with the wrapper profiler compiled in
+    void log_api_profile();
+    // fills _caps from the capability database, or from the driver when the database doesn't know the device
+    void load_device_capabilities(VkPhysicalDevice gpu);
     void init_querypool(VkDevice vkDevice, uint32_t count);
+    void init_occlusion_queries();
     //
+    // builds _renderables from _sceneConfig, the default config is a monkey on a 41x41 grid of triangles
     void init_scene() {
-        RenderObject monkey;
-        monkey.mesh            = get_mesh("monkey");
-        monkey.material        = get_material("defaultmesh");
-        monkey.transformMatrix = glm::mat4{1.0f};
-
-        _renderables.push_back(monkey);
-
-         for (int x = -20; x <= 20; x++) {
-             for (int y = -20; y <= 20; y++) {
-                 RenderObject tri;
-                 tri.mesh              = get_mesh("triangle");
-                 tri.material          = get_material("defaultmesh");
-                 glm::mat4 translation = glm::translate(glm::mat4{1.0}, glm::vec3(x, 0, y));
-                 glm::mat4 scale       = glm::scale(glm::mat4{1.0}, glm::vec3(0.2, 0.2, 0.2));
-                 tri.transformMatrix   = translation * scale;
-                 _renderables.push_back(tri);
-             }
-         }
+        const SceneConfig& config = _sceneConfig;
+        _view                     = config.camera.view(0);
+        _sceneRoot                = _transforms.add(TransformHierarchy::kNoParent, Transform{});
+
+        // one transform node per renderable, update_transforms() fills in the matrices and bounds
+        std::vector<RenderableDesc> descs;
+        std::vector<uint32_t> nodes;
+        RenderableDesc desc = {};
+        if (!config.centerMesh.empty()) {
+            desc.mesh     = mesh_id(config.centerMesh);
+            desc.material = material_id("defaultmesh");
+            descs.push_back(desc);
+            nodes.push_back(_transforms.add(_sceneRoot, Transform{}));
+        }
+        for (const SceneOccluder& occluder : config.occluders) {
+            Transform local;
+            local.translation = occluder.position;
+            local.scale       = glm::vec3(occluder.scale);
+
+            desc.mesh     = mesh_id(occluder.mesh);
+            desc.material = material_id("defaultmesh");
+            descs.push_back(desc);
+            nodes.push_back(_transforms.add(_sceneRoot, local));
+        }
+
+        // cycle through the first materialCount lost_empire materials, they all share one pipeline
+        uint32_t materialCount = _sceneMaterials.size();
+        if (config.materialCount > 0 && config.materialCount < materialCount) {
+            materialCount = config.materialCount;
+        }
+
+        std::vector<uint32_t> meshPicks = pick_scene_meshes(config);
+        int side                        = (int)ceilf(sqrtf((float)config.objectCount));
+        for (uint32_t i = 0; i < config.objectCount; i++) {
+            int x = (int)(i / side) - side / 2;
+            int y = (int)(i % side) - side / 2;
+
+            Transform local;
+            local.translation = glm::vec3(x * config.spacing, 0, y * config.spacing);
+            local.scale       = glm::vec3(config.scale);
+
+            desc.mesh     = mesh_id(config.meshes[meshPicks[i]].name);
+            desc.material = materialCount == 0 ? material_id("defaultmesh") : material_id(_sceneMaterials[i % materialCount]);
+            descs.push_back(desc);
+            nodes.push_back(_transforms.add(_sceneRoot, local));
+        }
+
+        std::vector<RenderableHandle> handles;
+        _renderables.insert(descs, &handles);
+        _transformObjects.resize(_transforms.size(), RenderableHandle{0, 0});
+        for (size_t i = 0; i < nodes.size(); i++) {
+            _transformObjects[nodes[i]] = handles[i];
+        }
+        update_transforms();
+    }
+    // picks every renderable's mesh level of detail from its projected error, see _lodThreshold
+    void select_lods();
+    // recomputes the moved nodes and copies their world matrices and bounds to the renderables
+    void update_transforms() {
+        _transforms.update();
+        _transformObjects.resize(_transforms.size(), RenderableHandle{0, 0});
+
+        glm::mat4* transforms   = _renderables.transforms();
+        RenderBounds* bounds    = _renderables.bounds();
+        const uint32_t* meshIds = _renderables.meshes();
+        for (uint32_t node : _transforms.changed()) {
+            RenderableHandle handle = _transformObjects[node];
+            if (!_renderables.valid(handle)) {
+                continue;
+            }
+            uint32_t index    = _renderables.index(handle);
+            transforms[index] = _transforms.world(node);
+            bounds[index]     = _meshById[meshIds[index]]->_bounds.transformed(transforms[index]);
+        }
     }
     // shader module
 
     // loads a shader module from a spir-v file. Returns false if it errors
     bool load_shader_module(const char* filePath, VkShaderModule* outShaderModule);
+    bool create_shader_module(const std::vector<char>& code, VkShaderModule* outShaderModule);
+    void read_shaders();
+    void create_shader_modules();
     void init_pipelines();
 
-    //
-    void load_meshes();
+    // builds the triangle and parses the monkey, CPU only
+    void parse_meshes();
+    void upload_meshes();
     void upload_mesh(Mesh& mesh);
+    // packs the meshlets of every mesh into the GPU culling buffers
+    void upload_meshlets();
+    // per-phase log and trace of the init task graph
+    void log_startup();
+
+    // loads a texture once and returns its slot in the material table
+    uint32_t load_texture(const std::string& file);
+    // registers every material of a .mtl file in the material table
+    void load_materials(const char* filename);
 };
 
 class PipelineBuilder {
@@ -245,6 +731,7 @@ class PipelineBuilder {
     VkPipelineMultisampleStateCreateInfo _multisampling;
     VkPipelineDepthStencilStateCreateInfo _depthStencil;
     VkPipelineLayout _pipelineLayout;
+    std::vector<VkDynamicState> _dynamicStates;  // empty for none
 
     VkPipeline build_pipeline(VkDevice device, VkRenderPass pass);
 };
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include "vk_frame_allocator.h"
+#include "vulkan_wrapper.h"
+#include "log.h"
+
+static VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void LinearRing::init(VkDeviceSize capacity) {
+    _capacity     = capacity;
+    _head         = 0;
+    _tail         = 0;
+    _used         = 0;
+    _currentFrame = 0;
+    for (unsigned int i = 0; i < FRAME_OVERLAP; i++) {
+        _frameEnd[i]   = 0;
+        _frameBytes[i] = 0;
+    }
+}
+
+void LinearRing::begin_frame(uint32_t frame) {
+    _currentFrame = frame % FRAME_OVERLAP;
+    // a frame that allocates nothing still ends where it started
+    _frameEnd[_currentFrame] = _head;
+}
+
+void LinearRing::retire_frame(uint32_t frame) {
+    uint32_t slot = frame % FRAME_OVERLAP;
+    if (_frameBytes[slot] == 0) {
+        return;
+    }
+    _tail = _frameEnd[slot];
+    _used -= _frameBytes[slot];
+    _frameBytes[slot] = 0;
+
+    // nothing is live, restart at the front so the next frames get the longest contiguous run
+    if (_used == 0) {
+        _head = 0;
+        _tail = 0;
+    }
+}
+
+bool LinearRing::allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& outOffset) {
+    if (size == 0 || size > _capacity) {
+        return false;
+    }
+
+    VkDeviceSize offset = align_up(_head, alignment);
+    if (_used == 0 || _head > _tail) {
+        // free space is [head, capacity) followed by [0, tail)
+        if (offset + size <= _capacity) {
+            outOffset = commit(offset, size, false);
+        } else if (size <= _tail) {
+            outOffset = commit(0, size, true);
+        } else {
+            return false;
+        }
+    } else {
+        // the ring has wrapped, free space is [head, tail)
+        if (offset + size > _tail) {
+            return false;
+        }
+        outOffset = commit(offset, size, false);
+    }
+    return true;
+}
+
+VkDeviceSize LinearRing::commit(VkDeviceSize offset, VkDeviceSize size, bool wrapped) {
+    // alignment padding, and on a wrap the bytes skipped at the end of the ring, belong to this frame too
+    VkDeviceSize charged = wrapped ? (_capacity - _head) + size : (offset + size) - _head;
+    _used += charged;
+    _frameBytes[_currentFrame] += charged;
+    _head                    = offset + size;
+    _frameEnd[_currentFrame] = _head;
+    return offset;
+}
+
+void FrameAllocator::init(VmaAllocator allocator, const VkPhysicalDeviceLimits& limits, VkDeviceSize capacity, VkDeviceSize maxBindingRange) {
+    _allocator        = allocator;
+    _uniformAlignment = std::max<VkDeviceSize>(limits.minUniformBufferOffsetAlignment, 1);
+    _storageAlignment = std::max<VkDeviceSize>(limits.minStorageBufferOffsetAlignment, 1);
+    _ring.init(capacity);
+
+    // the buffer is padded by the widest descriptor range, so a dynamic offset near the end of the ring
+    // still describes a range inside the buffer
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.pNext              = nullptr;
+    bufferInfo.size               = capacity + maxBindingRange;
+    bufferInfo.usage              = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+
+    VmaAllocationCreateInfo vmaallocInfo = {};
+    vmaallocInfo.usage                   = VMA_MEMORY_USAGE_CPU_TO_GPU;
+
+    // a linear pool holding exactly one block, sized for the buffer
+    VmaPoolCreateInfo poolInfo = {};
+    VK_CHECK(vmaFindMemoryTypeIndexForBufferInfo(_allocator, &bufferInfo, &vmaallocInfo, &poolInfo.memoryTypeIndex));
+    poolInfo.flags         = VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT;
+    poolInfo.blockSize     = bufferInfo.size;
+    poolInfo.minBlockCount = 1;
+    poolInfo.maxBlockCount = 1;
+    VK_CHECK(vmaCreatePool(_allocator, &poolInfo, &_pool));
+
+    vmaallocInfo.pool      = _pool;
+    vmaallocInfo.flags     = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    vmaallocInfo.pUserData = (void*)"FrameAllocator";
+
+    VmaAllocationInfo allocationInfo;
+    VK_CHECK(vmaCreateBuffer(_allocator, &bufferInfo, &vmaallocInfo, &_buffer, &_allocation, &allocationInfo));
+    _mapped = (char*)allocationInfo.pMappedData;
+
+    LOGI("FrameAllocator: %lu bytes, uniform alignment %lu, storage alignment %lu", (unsigned long)capacity, (unsigned long)_uniformAlignment, (unsigned long)_storageAlignment);
+}
+
+void FrameAllocator::cleanup() {
+    vmaDestroyBuffer(_allocator, _buffer, _allocation);
+    vmaDestroyPool(_allocator, _pool);
+}
+
+void FrameAllocator::begin_frame(uint32_t frameNumber) {
+    // the fence of this slot has signaled, whatever it allocated FRAME_OVERLAP frames ago is free again
+    _ring.retire_frame(frameNumber);
+    _ring.begin_frame(frameNumber);
+}
+
+void FrameAllocator::end_frame() {
+    // no-op on coherent memory
+    vmaFlushAllocation(_allocator, _allocation, 0, VK_WHOLE_SIZE);
+}
+
+bool FrameAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment, TransientAllocation& out) {
+    VkDeviceSize offset;
+    if (!_ring.allocate(size, alignment, offset)) {
+        LOGE("FrameAllocator: out of transient memory (%lu bytes requested)", (unsigned long)size);
+        return false;
+    }
+    out.buffer = _buffer;
+    out.offset = (uint32_t)offset;
+    out.data   = _mapped + offset;
+    return true;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include "vk_types.h"
+
+// frames the CPU may record ahead of the GPU, every per-frame resource is ringed by this count
+constexpr unsigned int FRAME_OVERLAP = 2;
+
+// Ring of byte offsets shared by the frames in flight.
+// Pure bookkeeping without Vulkan calls: allocations bump the head, a frame remembers where it ended and
+// retiring it moves the tail there. When the end of the ring is reached the allocation wraps to offset 0
+// and the skipped bytes are charged to the current frame.
+class LinearRing {
+   public:
+    void init(VkDeviceSize capacity);
+
+    // starts charging allocations to frame
+    void begin_frame(uint32_t frame);
+    // releases every byte allocated by frame, frames must retire in the order they began
+    void retire_frame(uint32_t frame);
+
+    // returns false when the ring has no room left for size bytes at the given alignment
+    bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& outOffset);
+
+    VkDeviceSize capacity() const { return _capacity; }
+    VkDeviceSize used() const { return _used; }
+
+   private:
+    VkDeviceSize commit(VkDeviceSize offset, VkDeviceSize size, bool wrapped);
+
+    VkDeviceSize _capacity{0};
+    VkDeviceSize _head{0};  // next free byte
+    VkDeviceSize _tail{0};  // oldest byte still in use
+    VkDeviceSize _used{0};  // live bytes including alignment padding and wrap waste
+
+    uint32_t _currentFrame{0};
+    VkDeviceSize _frameEnd[FRAME_OVERLAP]   = {};
+    VkDeviceSize _frameBytes[FRAME_OVERLAP] = {};
+};
+
+// a sub-allocation of the transient buffer
+struct TransientAllocation {
+    VkBuffer buffer;
+    uint32_t offset;  // usable as a dynamic offset
+    void* data;       // persistently mapped pointer to the first byte
+};
+
+// Per-frame transient GPU allocator for uniforms, storage and instance data.
+// One persistently mapped buffer lives in a VMA pool created with VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT;
+// data is bump allocated out of it and addressed with dynamic offsets. Everything a frame allocated is
+// released by begin_frame once that frame's fence has signaled.
+class FrameAllocator {
+   public:
+    // capacity is the ring size, maxBindingRange the widest dynamic descriptor range bound over it
+    void init(VmaAllocator allocator, const VkPhysicalDeviceLimits& limits, VkDeviceSize capacity, VkDeviceSize maxBindingRange);
+    void cleanup();
+
+    // call after waiting on the fence of frameNumber's slot
+    void begin_frame(uint32_t frameNumber);
+    // makes the frame's writes visible to the device
+    void end_frame();
+
+    bool alloc_uniform(VkDeviceSize size, TransientAllocation& out) { return allocate(size, _uniformAlignment, out); }
+    bool alloc_storage(VkDeviceSize size, TransientAllocation& out) { return allocate(size, _storageAlignment, out); }
+    bool alloc_instance(VkDeviceSize size, TransientAllocation& out) { return allocate(size, kInstanceAlignment, out); }
+
+    VkBuffer _buffer;
+    LinearRing _ring;
+
+   private:
+    static constexpr VkDeviceSize kInstanceAlignment = 16;
+
+    bool allocate(VkDeviceSize size, VkDeviceSize alignment, TransientAllocation& out);
+
+    VmaAllocator _allocator;
+    VmaPool _pool;
+    VmaAllocation _allocation;
+    char* _mapped;
+
+    VkDeviceSize _uniformAlignment;
+    VkDeviceSize _storageAlignment;
+};
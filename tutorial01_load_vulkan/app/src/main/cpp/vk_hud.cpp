@@ -0,0 +1,119 @@
+#include <algorithm>
+#include "vk_hud.h"
+#include "log.h"
+#include "imgui/imgui.h"
+#include "imgui/imgui_impl_vulkan.h"
+
+static void check_vk_result(VkResult err) {
+    VK_CHECK(err);
+}
+
+bool PerfHud::init(VkInstance instance, VkPhysicalDevice gpu, VkDevice device, uint32_t queueFamily, VkQueue queue, VkRenderPass renderPass, VkSampleCountFlagBits samples, uint32_t framesInFlight) {
+    _device  = device;
+    _context = ImGui::CreateContext();
+    ImGui::SetCurrentContext(_context);
+    // nothing to remember between runs, no imgui.ini
+    ImGui::GetIO().IniFilename = nullptr;
+    ImGui::StyleColorsDark();
+
+    // the backend allocates a single set, for the font texture
+    VkDescriptorPoolSize size           = {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1};
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets                    = 1;
+    poolInfo.poolSizeCount              = 1;
+    poolInfo.pPoolSizes                 = &size;
+    VK_CHECK(vkCreateDescriptorPool(_device, &poolInfo, nullptr, &_pool));
+
+    // one vertex and index buffer per frame in flight, the backend moves to the next one every frame
+    ImGui_ImplVulkan_InitInfo info = {};
+    info.Instance                  = instance;
+    info.PhysicalDevice            = gpu;
+    info.Device                    = device;
+    info.QueueFamily               = queueFamily;
+    info.Queue                     = queue;
+    info.DescriptorPool            = _pool;
+    info.MinImageCount             = framesInFlight;
+    info.ImageCount                = framesInFlight;
+    info.MSAASamples               = samples;
+    info.CheckVkResultFn           = check_vk_result;
+    if (!ImGui_ImplVulkan_Init(&info, renderPass)) {
+        LOGE("PerfHud: the imgui Vulkan backend didn't initialize");
+        return false;
+    }
+    return true;
+}
+
+void PerfHud::cleanup() {
+    if (!_context) {
+        return;
+    }
+    ImGui::SetCurrentContext(_context);
+    ImGui_ImplVulkan_Shutdown();
+    ImGui::DestroyContext(_context);
+    vkDestroyDescriptorPool(_device, _pool, nullptr);
+    _context = nullptr;
+}
+
+void PerfHud::upload_fonts(VkCommandBuffer cmd) {
+    ImGui::SetCurrentContext(_context);
+    ImGui_ImplVulkan_CreateFontsTexture(cmd);
+}
+
+void PerfHud::end_upload() {
+    ImGui::SetCurrentContext(_context);
+    ImGui_ImplVulkan_DestroyFontUploadObjects();
+}
+
+void PerfHud::record(VkCommandBuffer cmd, VkExtent2D extent, const FramePacer& pacer, int lastFinishedFrame, const HudCounters& counters) {
+    uint64_t start = _clock.now_ns();
+    ImGui::SetCurrentContext(_context);
+    ImGuiIO& io    = ImGui::GetIO();
+    io.DisplaySize = ImVec2((float)extent.width, (float)extent.height);
+    io.DeltaTime   = _lastRecord ? std::max((start - _lastRecord) / 1e9f, 1e-6f) : 1.f / 60.f;
+    _lastRecord    = start;
+
+    // start to submit and GPU time of the frames in the graphs, 0 for frames before the first
+    float cpuMs[kGraphFrames];
+    float gpuMs[kGraphFrames];
+    float maxMs = 0.f;
+    for (uint32_t i = 0; i < kGraphFrames; i++) {
+        int frame = lastFinishedFrame - (int)(kGraphFrames - 1 - i);
+        cpuMs[i]  = 0.f;
+        gpuMs[i]  = 0.f;
+        if (frame >= 0 && pacer.timing(frame).frame == (uint32_t)frame) {
+            const FrameTiming& timing = pacer.timing(frame);
+            cpuMs[i]                  = (timing.submitNs - timing.startNs) / 1e6f;
+            gpuMs[i]                  = timing.gpuNs / 1e6f;
+        }
+        maxMs = std::max(maxMs, std::max(cpuMs[i], gpuMs[i]));
+    }
+    // both graphs on one scale, at least the refresh period
+    float scaleMs = std::max(maxMs, pacer.refresh_period_ns() / 1e6f) * 1.25f;
+
+    ImGui_ImplVulkan_NewFrame();
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(8.f, 8.f));
+    ImGui::SetNextWindowBgAlpha(0.6f);
+    ImGui::Begin("perf", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoInputs | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing);
+    ImGui::Text("CPU %6.2f ms", cpuMs[kGraphFrames - 1]);
+    ImGui::PlotLines("##cpu", cpuMs, kGraphFrames, 0, nullptr, 0.f, scaleMs, ImVec2(240.f, 40.f));
+    ImGui::Text("GPU %6.2f ms", gpuMs[kGraphFrames - 1]);
+    ImGui::PlotLines("##gpu", gpuMs, kGraphFrames, 0, nullptr, 0.f, scaleMs, ImVec2(240.f, 40.f));
+    ImGui::Separator();
+    ImGui::Text("%u draws, %u indirect", counters.draws, counters.indirectDraws);
+    ImGui::Text("binds: %u pipeline, %u descriptor, %u vertex", counters.pipelineBinds, counters.descriptorBinds, counters.vertexBufferBinds);
+    ImGui::Text("%llu triangles", (unsigned long long)counters.triangles);
+    ImGui::Separator();
+    float fraction = counters.memoryBudget ? (float)counters.memoryUsage / counters.memoryBudget : 0.f;
+    ImGui::Text("memory %.1f of %.1f MB", counters.memoryUsage / 1048576.0, counters.memoryBudget / 1048576.0);
+    ImGui::ProgressBar(fraction, ImVec2(240.f, 0.f));
+    ImGui::Text("pipeline compile queue %u", counters.pipelineQueue);
+    ImGui::End();
+    ImGui::Render();
+
+    ImDrawData* drawData = ImGui::GetDrawData();
+    ImGui_ImplVulkan_RenderDrawData(drawData, cmd);
+    _vertexCount = (uint32_t)drawData->TotalVtxCount;
+    _recordNs    = _clock.now_ns() - start;
+}
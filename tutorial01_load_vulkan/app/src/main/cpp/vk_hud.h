@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include "vk_types.h"
+#include "vk_frame_allocator.h"
+#include "vk_pacing.h"
+#include "vk_timer.h"
+
+struct ImGuiContext;
+
+// what the HUD shows next to the frame times, filled by the engine every frame
+struct HudCounters {
+    uint32_t draws;
+    uint32_t indirectDraws;  // meshlet draws cull.comp kept, read back FRAME_OVERLAP frames late
+    uint32_t pipelineBinds;
+    uint32_t descriptorBinds;
+    uint32_t vertexBufferBinds;
+    uint64_t triangles;
+    VkDeviceSize memoryUsage;  // over all heaps, what VMA reports against its budget
+    VkDeviceSize memoryBudget;
+    uint32_t pipelineQueue;  // pipelines waiting to be compiled
+};
+
+// Performance overlay drawn with the bundled Dear ImGui and its Vulkan backend: CPU and GPU frame time
+// graphs from the FramePacer history, the draw and bind counters, VMA memory against the budget and the
+// pipeline compile queue. It records into a render pass already begun on the swapchain image, the
+// backend cycles through one vertex and index buffer per frame in flight and only ever grows them.
+// The backend keeps its state in globals, there is one PerfHud per process
+class PerfHud {
+   public:
+    // frames in the graphs, they end at the newest frame with a GPU time
+    static constexpr uint32_t kGraphFrames = FramePacer::kHistory - FRAME_OVERLAP;
+
+    // record() draws inside subpass 0 of renderPass, or a pass compatible with it. framesInFlight
+    // command buffers may use the vertex buffers at the same time
+    bool init(VkInstance instance, VkPhysicalDevice gpu, VkDevice device, uint32_t queueFamily, VkQueue queue, VkRenderPass renderPass, VkSampleCountFlagBits samples, uint32_t framesInFlight);
+    // the device has to be idle
+    void cleanup();
+
+    // records the font atlas upload into cmd, end_upload() frees the staging buffer once cmd finished
+    void upload_fonts(VkCommandBuffer cmd);
+    void end_upload();
+
+    // lays out the overlay for a target of extent and records its draws into cmd, inside the render pass
+    void record(VkCommandBuffer cmd, VkExtent2D extent, const FramePacer& pacer, int lastFinishedFrame, const HudCounters& counters);
+
+    // CPU time of the last record(), layout and recording together
+    uint64_t record_ns() const { return _recordNs; }
+    // vertices of the last record()
+    uint32_t vertex_count() const { return _vertexCount; }
+
+   private:
+    ImGuiContext* _context{nullptr};
+    VkDevice _device;
+    VkDescriptorPool _pool;  // the font texture's set
+    SteadyClock _clock;
+    uint64_t _lastRecord{0};
+    uint64_t _recordNs{0};
+    uint32_t _vertexCount{0};
+};
@@ -0,0 +1,4 @@
+// The bundled Dear ImGui Vulkan backend, compiled against the entry points vulkan_wrapper loads at
+// runtime. The wrapper defines VK_NO_PROTOTYPES, the backend's vk* calls then go through its pointers
+#include "vulkan_wrapper.h"
+#include "imgui/imgui_impl_vulkan.cpp"
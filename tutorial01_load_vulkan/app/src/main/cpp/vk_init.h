@@ -1,7 +1,7 @@
 #pragma once
 
 namespace vkinit {
-VkPipelineShaderStageCreateInfo pipeline_shader_stage_create_info(VkShaderStageFlagBits stage, VkShaderModule shaderModule) {
+inline VkPipelineShaderStageCreateInfo pipeline_shader_stage_create_info(VkShaderStageFlagBits stage, VkShaderModule shaderModule) {
     VkPipelineShaderStageCreateInfo info{};
     info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     info.pNext = nullptr;
@@ -15,7 +15,7 @@ VkPipelineShaderStageCreateInfo pipeline_shader_stage_create_info(VkShaderStageF
     return info;
 }
 
-VkPipelineVertexInputStateCreateInfo vertex_input_state_create_info() {
+inline VkPipelineVertexInputStateCreateInfo vertex_input_state_create_info() {
     VkPipelineVertexInputStateCreateInfo info = {};
     info.sType                                = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
     info.pNext                                = nullptr;
@@ -26,7 +26,7 @@ VkPipelineVertexInputStateCreateInfo vertex_input_state_create_info() {
     return info;
 }
 
-VkPipelineInputAssemblyStateCreateInfo input_assembly_create_info(VkPrimitiveTopology topology) {
+inline VkPipelineInputAssemblyStateCreateInfo input_assembly_create_info(VkPrimitiveTopology topology) {
     VkPipelineInputAssemblyStateCreateInfo info = {};
     info.sType                                  = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
     info.pNext                                  = nullptr;
@@ -37,7 +37,7 @@ VkPipelineInputAssemblyStateCreateInfo input_assembly_create_info(VkPrimitiveTop
     return info;
 }
 
-VkPipelineRasterizationStateCreateInfo rasterization_state_create_info(VkPolygonMode polygonMode) {
+inline VkPipelineRasterizationStateCreateInfo rasterization_state_create_info(VkPolygonMode polygonMode) {
     VkPipelineRasterizationStateCreateInfo info = {};
     info.sType                                  = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
     info.pNext                                  = nullptr;
@@ -61,7 +61,7 @@ VkPipelineRasterizationStateCreateInfo rasterization_state_create_info(VkPolygon
     return info;
 }
 
-VkPipelineMultisampleStateCreateInfo multisampling_state_create_info() {
+inline VkPipelineMultisampleStateCreateInfo multisampling_state_create_info() {
     VkPipelineMultisampleStateCreateInfo info = {};
     info.sType                                = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
     info.pNext                                = nullptr;
@@ -76,14 +76,14 @@ VkPipelineMultisampleStateCreateInfo multisampling_state_create_info() {
     return info;
 }
 
-VkPipelineColorBlendAttachmentState color_blend_attachment_state() {
+inline VkPipelineColorBlendAttachmentState color_blend_attachment_state() {
     VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
     colorBlendAttachment.colorWriteMask                      = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
     colorBlendAttachment.blendEnable                         = VK_FALSE;
     return colorBlendAttachment;
 }
 
-VkPipelineLayoutCreateInfo pipeline_layout_create_info() {
+inline VkPipelineLayoutCreateInfo pipeline_layout_create_info() {
     VkPipelineLayoutCreateInfo info{};
     info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     info.pNext = nullptr;
@@ -97,7 +97,7 @@ VkPipelineLayoutCreateInfo pipeline_layout_create_info() {
     return info;
 }
 
-VkImageCreateInfo image_create_info(VkFormat format, VkImageUsageFlags usageFlags, VkExtent3D extent) {
+inline VkImageCreateInfo image_create_info(VkFormat format, VkImageUsageFlags usageFlags, VkExtent3D extent) {
     VkImageCreateInfo info = {};
     info.sType             = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     info.pNext             = nullptr;
@@ -115,7 +115,7 @@ VkImageCreateInfo image_create_info(VkFormat format, VkImageUsageFlags usageFlag
     return info;
 }
 
-VkImageViewCreateInfo imageview_create_info(VkFormat format, VkImage image, VkImageAspectFlags aspectFlags) {
+inline VkImageViewCreateInfo imageview_create_info(VkFormat format, VkImage image, VkImageAspectFlags aspectFlags) {
     // build a image-view for the depth image to use for rendering
     VkImageViewCreateInfo info = {};
     info.sType                 = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -133,7 +133,7 @@ VkImageViewCreateInfo imageview_create_info(VkFormat format, VkImage image, VkIm
     return info;
 }
 
-VkPipelineDepthStencilStateCreateInfo depth_stencil_create_info(bool bDepthTest, bool bDepthWrite, VkCompareOp compareOp) {
+inline VkPipelineDepthStencilStateCreateInfo depth_stencil_create_info(bool bDepthTest, bool bDepthWrite, VkCompareOp compareOp) {
     VkPipelineDepthStencilStateCreateInfo info = {};
     info.sType                                 = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
     info.pNext                                 = nullptr;
@@ -148,4 +148,81 @@ VkPipelineDepthStencilStateCreateInfo depth_stencil_create_info(bool bDepthTest,
 
     return info;
 }
+
+inline VkDescriptorSetLayoutBinding descriptorset_layout_binding(VkDescriptorType type, VkShaderStageFlags stageFlags, uint32_t binding, uint32_t count = 1) {
+    VkDescriptorSetLayoutBinding setbind = {};
+    setbind.binding                      = binding;
+    setbind.descriptorCount              = count;
+    setbind.descriptorType               = type;
+    setbind.pImmutableSamplers           = nullptr;
+    setbind.stageFlags                   = stageFlags;
+
+    return setbind;
+}
+
+inline VkWriteDescriptorSet write_descriptor_buffer(VkDescriptorType type, VkDescriptorSet dstSet, VkDescriptorBufferInfo* bufferInfo, uint32_t binding) {
+    VkWriteDescriptorSet write = {};
+    write.sType                = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.pNext                = nullptr;
+
+    write.dstBinding      = binding;
+    write.dstSet          = dstSet;
+    write.descriptorCount = 1;
+    write.descriptorType  = type;
+    write.pBufferInfo     = bufferInfo;
+
+    return write;
+}
+
+inline VkWriteDescriptorSet write_descriptor_image(VkDescriptorType type, VkDescriptorSet dstSet, VkDescriptorImageInfo* imageInfo, uint32_t binding, uint32_t arrayElement = 0, uint32_t count = 1) {
+    VkWriteDescriptorSet write = {};
+    write.sType                = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.pNext                = nullptr;
+
+    write.dstBinding      = binding;
+    write.dstArrayElement = arrayElement;
+    write.dstSet          = dstSet;
+    write.descriptorCount = count;
+    write.descriptorType  = type;
+    write.pImageInfo      = imageInfo;
+
+    return write;
+}
+
+inline VkSamplerCreateInfo sampler_create_info(VkFilter filters, VkSamplerAddressMode samplerAdressMode = VK_SAMPLER_ADDRESS_MODE_REPEAT) {
+    VkSamplerCreateInfo info = {};
+    info.sType               = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    info.pNext               = nullptr;
+
+    info.magFilter    = filters;
+    info.minFilter    = filters;
+    info.addressModeU = samplerAdressMode;
+    info.addressModeV = samplerAdressMode;
+    info.addressModeW = samplerAdressMode;
+    info.maxLod       = VK_LOD_CLAMP_NONE;
+
+    return info;
+}
+
+inline VkImageMemoryBarrier image_barrier(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT) {
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType                = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.pNext                = nullptr;
+
+    barrier.oldLayout           = oldLayout;
+    barrier.newLayout           = newLayout;
+    barrier.srcAccessMask       = srcAccess;
+    barrier.dstAccessMask       = dstAccess;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image               = image;
+
+    barrier.subresourceRange.aspectMask     = aspectMask;
+    barrier.subresourceRange.baseMipLevel   = 0;
+    barrier.subresourceRange.levelCount     = VK_REMAINING_MIP_LEVELS;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount     = VK_REMAINING_ARRAY_LAYERS;
+
+    return barrier;
+}
 }  // namespace vkinit
\ No newline at end of file
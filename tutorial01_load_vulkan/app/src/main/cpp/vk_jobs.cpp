@@ -0,0 +1,272 @@
+#include <algorithm>
+#include "vk_jobs.h"
+
+namespace vkutil {
+
+struct Job {
+    std::function<void()> work;
+    JobCounter* counter;
+};
+
+// the job system and deque the current thread belongs to
+static thread_local const JobSystem* t_system = nullptr;
+static thread_local int t_index               = -1;
+static thread_local uint32_t t_random         = 0x9e3779b9u;
+
+bool JobDeque::push(Job* job) {
+    int64_t bottom = _bottom.load(std::memory_order_relaxed);
+    int64_t top    = _top.load(std::memory_order_acquire);
+    if (bottom - top >= kCapacity) {
+        return false;
+    }
+    _jobs[bottom & (kCapacity - 1)].store(job, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _bottom.store(bottom + 1, std::memory_order_relaxed);
+    return true;
+}
+
+Job* JobDeque::pop() {
+    int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+    _bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = _top.load(std::memory_order_relaxed);
+    if (top > bottom) {
+        // empty
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    Job* job = _jobs[bottom & (kCapacity - 1)].load(std::memory_order_relaxed);
+    if (top == bottom) {
+        // the last job, thieves may be after it too
+        if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            job = nullptr;
+        }
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+Job* JobDeque::steal() {
+    int64_t top = _top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = _bottom.load(std::memory_order_acquire);
+    if (top >= bottom) {
+        return nullptr;
+    }
+    Job* job = _jobs[top & (kCapacity - 1)].load(std::memory_order_relaxed);
+    if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    return job;
+}
+
+void JobSystem::init(uint32_t workerCount) {
+    shutdown();
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    }
+    _quit = false;
+    for (uint32_t i = 0; i <= workerCount; i++) {
+        _deques.push_back(std::unique_ptr<JobDeque>(new JobDeque()));
+    }
+    t_system = this;
+    t_index  = 0;
+    for (uint32_t i = 1; i <= workerCount; i++) {
+        _workers.emplace_back(&JobSystem::worker_main, this, (int)i);
+    }
+}
+
+void JobSystem::shutdown() {
+    if (_deques.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _quit = true;
+    }
+    _wake.notify_all();
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+    _workers.clear();
+    _deques.clear();
+    _queued = 0;
+    if (t_system == this) {
+        t_system = nullptr;
+        t_index  = -1;
+    }
+}
+
+int JobSystem::thread_index() const {
+    return t_system == this ? t_index : -1;
+}
+
+void JobSystem::run(std::function<void()>&& work, JobCounter* counter) {
+    if (_deques.empty()) {
+        work();
+        return;
+    }
+    if (counter) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    push(new Job{std::move(work), counter});
+}
+
+void JobSystem::run_after(JobCounter& dependency, std::function<void()>&& work, JobCounter* counter) {
+    if (_deques.empty()) {
+        work();
+        return;
+    }
+    if (counter) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    Job* job = new Job{std::move(work), counter};
+    {
+        // the job that brings dependency to zero takes the continuations under the same lock
+        std::lock_guard<std::mutex> lock(dependency._mutex);
+        if (!dependency.done()) {
+            dependency._continuations.push_back(job);
+            return;
+        }
+    }
+    push(job);
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    int self = thread_index();
+    while (!counter.done()) {
+        Job* job = find_job(self);
+        if (job) {
+            execute(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    std::lock_guard<std::mutex> lock(counter._mutex);
+}
+
+void JobSystem::parallel_for(uint32_t begin, uint32_t end, uint32_t grain, const std::function<void(uint32_t begin, uint32_t end)>& body) {
+    if (end <= begin) {
+        return;
+    }
+    grain = std::max(1u, grain);
+    if (end - begin <= grain || thread_count() <= 1) {
+        body(begin, end);
+        return;
+    }
+
+    // queue every chunk but the first, which this thread runs right away
+    JobCounter counter;
+    uint32_t firstEnd = begin + grain;
+    for (uint32_t chunk = firstEnd; chunk < end; chunk += std::min(grain, end - chunk)) {
+        uint32_t chunkEnd = chunk + std::min(grain, end - chunk);
+        run([&body, chunk, chunkEnd]() { body(chunk, chunkEnd); }, &counter);
+    }
+    body(begin, firstEnd);
+    wait(counter);
+}
+
+void JobSystem::push(Job* job) {
+    int self = thread_index();
+    if (self >= 0) {
+        if (!_deques[self]->push(job)) {
+            // the deque is full, running the job right here also throttles whoever queues so much
+            execute(job);
+            return;
+        }
+    } else {
+        std::lock_guard<std::mutex> lock(_sharedMutex);
+        _shared.push_back(job);
+    }
+
+    // a worker counts itself as sleeping before it checks _queued, so either it sees the job or we see it
+    _queued.fetch_add(1, std::memory_order_seq_cst);
+    if (_sleeping.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _wake.notify_one();
+    }
+}
+
+Job* JobSystem::find_job(int self) {
+    Job* job = nullptr;
+    if (self >= 0) {
+        job = _deques[self]->pop();
+    }
+
+    // steal from a random deque first so thieves spread out
+    uint32_t count = (uint32_t)_deques.size();
+    if (!job && count > 1) {
+        t_random ^= t_random << 13;
+        t_random ^= t_random >> 17;
+        t_random ^= t_random << 5;
+        uint32_t start = t_random % count;
+        for (uint32_t i = 0; i < count && !job; i++) {
+            uint32_t victim = (start + i) % count;
+            if ((int)victim != self) {
+                job = _deques[victim]->steal();
+            }
+        }
+    }
+
+    if (!job) {
+        std::lock_guard<std::mutex> lock(_sharedMutex);
+        if (!_shared.empty()) {
+            job = _shared.back();
+            _shared.pop_back();
+        }
+    }
+    if (job) {
+        _queued.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+void JobSystem::execute(Job* job) {
+    job->work();
+
+    JobCounter* counter = job->counter;
+    delete job;
+    if (!counter) {
+        return;
+    }
+    uint32_t pending = counter->pending.load(std::memory_order_relaxed);
+    while (pending > 1 && !counter->pending.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+    }
+    if (pending > 1) {
+        return;
+    }
+
+    // the last job brings the counter to zero under its lock, wait() takes the lock once more before
+    // it returns so the counter can't go away while this thread still uses it
+    std::vector<Job*> continuations;
+    {
+        std::lock_guard<std::mutex> lock(counter->_mutex);
+        if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            continuations.swap(counter->_continuations);
+        }
+    }
+    for (Job* continuation : continuations) {
+        push(continuation);
+    }
+}
+
+void JobSystem::worker_main(int index) {
+    t_system = this;
+    t_index  = index;
+    while (true) {
+        Job* job = find_job(index);
+        if (job) {
+            execute(job);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _sleeping.fetch_add(1, std::memory_order_seq_cst);
+        _wake.wait(lock, [&]() { return _quit || _queued.load(std::memory_order_seq_cst) > 0; });
+        _sleeping.fetch_sub(1, std::memory_order_relaxed);
+        if (_quit) {
+            return;
+        }
+    }
+}
+
+}  // namespace vkutil
@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vkutil {
+
+struct Job;
+
+// Number of unfinished jobs of a group. Jobs started with a counter increment it when queued and
+// decrement it when done; jobs started after a counter run once it reached zero.
+// Only destroy a counter with jobs after JobSystem::wait() on it returned.
+struct JobCounter {
+    std::atomic<uint32_t> pending{0};
+
+    bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+
+   private:
+    friend class JobSystem;
+    std::mutex _mutex;
+    std::vector<Job*> _continuations;  // jobs waiting for pending to reach zero
+};
+
+// Chase-Lev work stealing deque of a fixed capacity.
+// The owning thread pushes and pops at the bottom, any other thread steals from the top.
+class JobDeque {
+   public:
+    static constexpr int64_t kCapacity = 4096;
+
+    // owner only, false when the deque is full
+    bool push(Job* job);
+    // owner only, newest job first
+    Job* pop();
+    // any thread, oldest job first. nullptr when empty or another thread won the race
+    Job* steal();
+
+   private:
+    alignas(64) std::atomic<int64_t> _top{0};
+    alignas(64) std::atomic<int64_t> _bottom{0};
+    std::atomic<Job*> _jobs[kCapacity] = {};
+};
+
+// Work stealing job system.
+// Every worker thread owns a deque. Jobs queued from a worker go to its own deque and are taken
+// newest first, idle workers steal the oldest ones from the others. The thread calling init() owns
+// deque 0 and runs jobs itself while it waits, other threads queue through a shared list.
+class JobSystem {
+   public:
+    ~JobSystem() { shutdown(); }
+
+    // starts workerCount threads besides the calling one, 0 for one per remaining core
+    void init(uint32_t workerCount = 0);
+    void shutdown();
+    // workers plus the thread that called init()
+    uint32_t thread_count() const { return (uint32_t)_deques.size(); }
+
+    // queues work, counter may be null
+    void run(std::function<void()>&& work, JobCounter* counter = nullptr);
+    // queues work to run once dependency reached zero
+    void run_after(JobCounter& dependency, std::function<void()>&& work, JobCounter* counter = nullptr);
+    // runs other jobs until counter reached zero
+    void wait(JobCounter& counter);
+
+    // calls body(chunkBegin, chunkEnd) for chunks of at most grain items covering [begin, end)
+    // and returns when all of them are done. Runs inline when there is a single chunk
+    void parallel_for(uint32_t begin, uint32_t end, uint32_t grain, const std::function<void(uint32_t begin, uint32_t end)>& body);
+
+    // index of the calling thread: 0 for the thread that called init(), 1.. for workers, -1 for any other
+    int thread_index() const;
+
+   private:
+    void push(Job* job);
+    Job* find_job(int self);
+    void execute(Job* job);
+    void worker_main(int index);
+
+    std::vector<std::unique_ptr<JobDeque>> _deques;
+    std::vector<std::thread> _workers;
+
+    // jobs queued by threads without a deque
+    std::mutex _sharedMutex;
+    std::vector<Job*> _shared;
+
+    // idle workers sleep until a job is queued
+    std::atomic<int64_t> _queued{0};
+    std::atomic<uint32_t> _sleeping{0};
+    std::atomic<bool> _quit{false};
+    std::mutex _sleepMutex;
+    std::condition_variable _wake;
+};
+
+}  // namespace vkutil
@@ -0,0 +1,314 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <glm/geometric.hpp>
+#include "vk_lod.h"
+
+namespace {
+
+// symmetric 4x4 matrix of summed squared plane distances, upper triangle only
+struct Quadric {
+    double m[10] = {};
+
+    void add_plane(const glm::dvec3& n, double d, double weight) {
+        double p[4] = {n.x, n.y, n.z, d};
+        int k       = 0;
+        for (int i = 0; i < 4; i++) {
+            for (int j = i; j < 4; j++) {
+                m[k++] += weight * p[i] * p[j];
+            }
+        }
+    }
+    void add(const Quadric& other) {
+        for (int i = 0; i < 10; i++) {
+            m[i] += other.m[i];
+        }
+    }
+    // weighted sum of squared distances of p to the planes
+    double evaluate(const glm::vec3& v) const {
+        double p[4] = {v.x, v.y, v.z, 1.0};
+        double sum  = 0.0;
+        int k       = 0;
+        for (int i = 0; i < 4; i++) {
+            for (int j = i; j < 4; j++) {
+                sum += (i == j ? 1.0 : 2.0) * m[k++] * p[i] * p[j];
+            }
+        }
+        return std::max(sum, 0.0);
+    }
+};
+
+struct Collapse {
+    double cost;
+    uint32_t from;  // moves onto to
+    uint32_t to;
+    uint32_t fromVersion;
+    uint32_t toVersion;
+
+    bool operator>(const Collapse& other) const { return cost > other.cost; }
+};
+
+struct PositionKey {
+    size_t operator()(const glm::vec3& p) const {
+        uint32_t bits[3];
+        memcpy(bits, &p, sizeof(bits));
+        return bits[0] * 73856093u ^ bits[1] * 19349663u ^ bits[2] * 83492791u;
+    }
+};
+
+glm::vec3 closest_point_on_triangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    // regions of the triangle's Voronoi diagram, Ericson's Real-Time Collision Detection 5.1.5
+    glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+    float d1     = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+    if (d1 <= 0.f && d2 <= 0.f) {
+        return a;
+    }
+    glm::vec3 bp = p - b;
+    float d3     = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+    if (d3 >= 0.f && d4 <= d3) {
+        return b;
+    }
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f) {
+        return a + ab * (d1 / (d1 - d3));
+    }
+    glm::vec3 cp = p - c;
+    float d5     = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+    if (d6 >= 0.f && d5 <= d6) {
+        return c;
+    }
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f) {
+        return a + ac * (d2 / (d2 - d6));
+    }
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.f && d4 - d3 >= 0.f && d5 - d6 >= 0.f) {
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+    float denom = 1.f / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+}  // namespace
+
+SimplifiedMesh simplify_triangles(const std::vector<glm::vec3>& positions, uint32_t targetTriangles) {
+    // weld by exact position, corners keep pointing at their input vertex for the attributes
+    std::unordered_map<glm::vec3, uint32_t, PositionKey> welded;
+    std::vector<glm::vec3> points;
+    std::vector<uint32_t> corner(positions.size());
+    for (size_t i = 0; i < positions.size(); i++) {
+        auto it = welded.emplace(positions[i], (uint32_t)points.size());
+        if (it.second) {
+            points.push_back(positions[i]);
+        }
+        corner[i] = it.first->second;
+    }
+
+    // triangles as welded vertex ids, those collapsed by the welding already are dropped
+    std::vector<uint32_t> triangles;  // 3 welded ids per triangle
+    std::vector<uint32_t> sourceTri;  // input triangle of each
+    for (uint32_t t = 0; t + 2 < positions.size(); t += 3) {
+        uint32_t a = corner[t], b = corner[t + 1], c = corner[t + 2];
+        if (a != b && b != c && a != c) {
+            triangles.insert(triangles.end(), {a, b, c});
+            sourceTri.push_back(t / 3);
+        }
+    }
+    uint32_t triangleCount = (uint32_t)sourceTri.size();
+
+    std::vector<Quadric> quadrics(points.size());
+    std::vector<std::vector<uint32_t>> vertexTriangles(points.size());
+    std::unordered_map<uint64_t, uint32_t> edgeUses;
+    auto edge_key = [](uint32_t a, uint32_t b) { return a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a; };
+    for (uint32_t t = 0; t < triangleCount; t++) {
+        const uint32_t* v = &triangles[t * 3];
+        glm::dvec3 p0     = points[v[0]], p1 = points[v[1]], p2 = points[v[2]];
+        glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+        double area2      = glm::length(normal);
+        if (area2 > 0.0) {
+            normal /= area2;
+            for (int k = 0; k < 3; k++) {
+                quadrics[v[k]].add_plane(normal, -glm::dot(normal, p0), area2 * 0.5);
+            }
+        }
+        for (int k = 0; k < 3; k++) {
+            vertexTriangles[v[k]].push_back(t);
+            edgeUses[edge_key(v[k], v[(k + 1) % 3])]++;
+        }
+    }
+
+    // a plane through every border edge, perpendicular to its triangle, pins the border in place
+    for (uint32_t t = 0; t < triangleCount; t++) {
+        const uint32_t* v = &triangles[t * 3];
+        glm::dvec3 p0     = points[v[0]], p1 = points[v[1]], p2 = points[v[2]];
+        glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+        if (glm::length(normal) == 0.0) {
+            continue;
+        }
+        for (int k = 0; k < 3; k++) {
+            uint32_t a = v[k], b = v[(k + 1) % 3];
+            if (edgeUses[edge_key(a, b)] != 1) {
+                continue;
+            }
+            glm::dvec3 edge   = glm::dvec3(points[b]) - glm::dvec3(points[a]);
+            glm::dvec3 border = glm::cross(edge, normal);
+            double length     = glm::length(border);
+            if (length > 0.0) {
+                border /= length;
+                double weight = 10.0 * glm::dot(edge, edge);
+                quadrics[a].add_plane(border, -glm::dot(border, glm::dvec3(points[a])), weight);
+                quadrics[b].add_plane(border, -glm::dot(border, glm::dvec3(points[b])), weight);
+            }
+        }
+    }
+
+    std::vector<uint8_t> triangleAlive(triangleCount, 1);
+    std::vector<uint8_t> vertexAlive(points.size(), 1);
+    std::vector<uint32_t> version(points.size(), 0);
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+    // the cheaper direction of an edge, each end is only ever moved onto the other
+    auto push_edge = [&](uint32_t a, uint32_t b) {
+        Quadric sum = quadrics[a];
+        sum.add(quadrics[b]);
+        double toB = sum.evaluate(points[b]);
+        double toA = sum.evaluate(points[a]);
+        if (toB <= toA) {
+            queue.push({toB, a, b, version[a], version[b]});
+        } else {
+            queue.push({toA, b, a, version[b], version[a]});
+        }
+    };
+    for (uint32_t t = 0; t < triangleCount; t++) {
+        for (int k = 0; k < 3; k++) {
+            uint32_t a = triangles[t * 3 + k], b = triangles[t * 3 + (k + 1) % 3];
+            if (a < b || edgeUses[edge_key(a, b)] == 1) {
+                push_edge(a, b);
+            }
+        }
+    }
+
+    std::vector<uint32_t> fromNeighbors, toNeighbors;
+    auto neighbors = [&](uint32_t vertex, std::vector<uint32_t>& out) {
+        out.clear();
+        for (uint32_t t : vertexTriangles[vertex]) {
+            if (triangleAlive[t]) {
+                for (int k = 0; k < 3; k++) {
+                    if (triangles[t * 3 + k] != vertex) {
+                        out.push_back(triangles[t * 3 + k]);
+                    }
+                }
+            }
+        }
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    };
+
+    uint32_t alive = triangleCount;
+    while (alive > targetTriangles && !queue.empty()) {
+        Collapse collapse = queue.top();
+        queue.pop();
+        uint32_t from = collapse.from, to = collapse.to;
+        if (!vertexAlive[from] || !vertexAlive[to] || version[from] != collapse.fromVersion || version[to] != collapse.toVersion) {
+            continue;
+        }
+
+        // more than two shared neighbours would pinch the surface into a non-manifold edge
+        neighbors(from, fromNeighbors);
+        neighbors(to, toNeighbors);
+        std::vector<uint32_t> shared;
+        std::set_intersection(fromNeighbors.begin(), fromNeighbors.end(), toNeighbors.begin(), toNeighbors.end(), std::back_inserter(shared));
+        if (shared.size() > 2) {
+            continue;
+        }
+
+        // no triangle that stays may flip or collapse to a sliver
+        bool folds = false;
+        for (uint32_t t : vertexTriangles[from]) {
+            const uint32_t* v = &triangles[t * 3];
+            if (!triangleAlive[t] || v[0] == to || v[1] == to || v[2] == to) {
+                continue;
+            }
+            glm::vec3 p[3], moved[3];
+            for (int k = 0; k < 3; k++) {
+                p[k]     = points[v[k]];
+                moved[k] = v[k] == from ? points[to] : p[k];
+            }
+            glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+            glm::vec3 after  = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+            if (glm::dot(before, after) <= 0.05f * glm::length(before) * glm::length(after) || glm::length(after) < 1e-4f * glm::length(before)) {
+                folds = true;
+                break;
+            }
+        }
+        if (folds) {
+            continue;
+        }
+
+        for (uint32_t t : vertexTriangles[from]) {
+            if (!triangleAlive[t]) {
+                continue;
+            }
+            uint32_t* v = &triangles[t * 3];
+            if (v[0] == to || v[1] == to || v[2] == to) {
+                triangleAlive[t] = 0;
+                alive--;
+                continue;
+            }
+            for (int k = 0; k < 3; k++) {
+                v[k] = v[k] == from ? to : v[k];
+            }
+            vertexTriangles[to].push_back(t);
+        }
+        quadrics[to].add(quadrics[from]);
+        vertexAlive[from] = 0;
+        version[to]++;
+
+        // every queued edge of to is stale now, queue them again with the merged quadric
+        neighbors(to, toNeighbors);
+        for (uint32_t neighbor : toNeighbors) {
+            push_edge(to, neighbor);
+        }
+    }
+
+    SimplifiedMesh out;
+    for (uint32_t t = 0; t < triangleCount; t++) {
+        if (!triangleAlive[t]) {
+            continue;
+        }
+        // the triangle's corners in input order, moved to where their welded vertex ended up
+        uint32_t first = sourceTri[t] * 3;
+        for (int k = 0; k < 3; k++) {
+            uint32_t source = first + k;
+            out.corners.push_back(source);
+            out.positions.push_back(points[triangles[t * 3 + k]]);
+        }
+    }
+    return out;
+}
+
+float surface_distance(const std::vector<glm::vec3>& points, const std::vector<glm::vec3>& triangles) {
+    float farthest = 0.f;
+    for (const glm::vec3& point : points) {
+        float nearest = INFINITY;
+        for (size_t t = 0; t + 2 < triangles.size() && nearest > farthest; t += 3) {
+            glm::vec3 closest = closest_point_on_triangle(point, triangles[t], triangles[t + 1], triangles[t + 2]);
+            nearest           = std::min(nearest, glm::dot(point - closest, point - closest));
+        }
+        // a point closer than the current farthest can't raise it, the loop above stops early then
+        farthest = std::max(farthest, nearest);
+    }
+    return sqrtf(farthest);
+}
+
+uint32_t select_lod(const MeshLod* lods, uint32_t count, float unitsToPixels, uint32_t current, float threshold, float hysteresis) {
+    for (uint32_t level = count - 1; level > 0; level--) {
+        float limit = level > current ? threshold * (1.f - hysteresis) : threshold;
+        if (lods[level].error * unitsToPixels <= limit) {
+            return level;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/vec3.hpp>
+
+// one level of detail, a range of Mesh::_vertices
+struct MeshLod {
+    uint32_t firstVertex;
+    uint32_t vertexCount;
+    float error;            // farthest a vertex of the full mesh lies from this level's surface, model space
+    uint32_t firstMeshlet;  // range of Mesh::_meshlets
+    uint32_t meshletCount;
+};
+
+// output of simplify_triangles, three vertices per triangle
+struct SimplifiedMesh {
+    std::vector<uint32_t> corners;     // input vertex each output vertex takes its other attributes from
+    std::vector<glm::vec3> positions;  // where each output vertex sits, always one of the input positions
+};
+
+// Quadric error metric simplification (Garland and Heckbert) of a triangle list, three positions per
+// triangle. Vertices at the same position are welded, then the edge collapse adding the least error
+// is done until targetTriangles are left or every remaining collapse would fold the surface over.
+// Border edges get extra planes so open borders stay in place.
+SimplifiedMesh simplify_triangles(const std::vector<glm::vec3>& positions, uint32_t targetTriangles);
+
+// the farthest any of points lies from the triangles, three positions per triangle. Brute force
+float surface_distance(const std::vector<glm::vec3>& points, const std::vector<glm::vec3>& triangles);
+
+// Picks the coarsest level whose error covers at most threshold pixels, unitsToPixels scales the
+// model space error to pixels. A level coarser than current also has to stay under the threshold
+// reduced by the hysteresis fraction, so objects around a switching distance don't flicker.
+uint32_t select_lod(const MeshLod* lods, uint32_t count, float unitsToPixels, uint32_t current, float threshold, float hysteresis);
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <cstring>
+#include "vk_material.h"
+#include "vk_engine.h"
+#include "vk_init.h"
+
+void MaterialTable::init(VkDevice device, VmaAllocator allocator, bool descriptorIndexing, uint32_t textureCapacity, uint32_t materialCapacity) {
+    _device             = device;
+    _allocator          = allocator;
+    _descriptorIndexing = descriptorIndexing;
+    _textureCapacity    = textureCapacity;
+    _materialCapacity   = materialCapacity;
+
+    VkShaderStageFlags stages              = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    VkDescriptorSetLayoutBinding bindings[] = {
+        vkinit::descriptorset_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, stages, kParamsBinding),
+        vkinit::descriptorset_layout_binding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, kTexturesBinding, _textureCapacity),
+    };
+
+    VkDescriptorSetLayoutCreateInfo setInfo = {};
+    setInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setInfo.pNext                           = nullptr;
+    setInfo.bindingCount                    = 2;
+    setInfo.pBindings                       = bindings;
+
+    // with descriptor indexing the texture array may have holes and can be written while the set is bound
+    VkDescriptorBindingFlagsEXT bindingFlags[]                = {0, VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT};
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT flagsInfo = {};
+    flagsInfo.sType                                          = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    flagsInfo.bindingCount                                   = 2;
+    flagsInfo.pBindingFlags                                  = bindingFlags;
+    if (_descriptorIndexing) {
+        setInfo.pNext = &flagsInfo;
+        setInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+    }
+    VK_CHECK(vkCreateDescriptorSetLayout(_device, &setInfo, nullptr, &_setLayout));
+
+    VkDescriptorPoolSize sizes[] = {
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, _textureCapacity},
+    };
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags                      = _descriptorIndexing ? VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT : 0;
+    poolInfo.maxSets                    = 1;
+    poolInfo.poolSizeCount              = 2;
+    poolInfo.pPoolSizes                 = sizes;
+    VK_CHECK(vkCreateDescriptorPool(_device, &poolInfo, nullptr, &_pool));
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool              = _pool;
+    allocInfo.descriptorSetCount          = 1;
+    allocInfo.pSetLayouts                 = &_setLayout;
+    VK_CHECK(vkAllocateDescriptorSets(_device, &allocInfo, &_set));
+
+    // the parameter buffer stays mapped, rows are written straight into it
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size               = sizeof(GPUMaterialParams) * _materialCapacity;
+    bufferInfo.usage              = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
+    VmaAllocationCreateInfo vmaallocInfo = {};
+    vmaallocInfo.usage                   = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    vmaallocInfo.pUserData               = (void*)"MaterialTable";
+    VK_CHECK(vmaCreateBuffer(_allocator, &bufferInfo, &vmaallocInfo, &_paramBuffer._buffer, &_paramBuffer._allocation, nullptr));
+    VK_CHECK(vmaMapMemory(_allocator, _paramBuffer._allocation, &_mappedParams));
+
+    VkDescriptorBufferInfo paramsInfo = {_paramBuffer._buffer, 0, bufferInfo.size};
+    VkWriteDescriptorSet paramsWrite  = vkinit::write_descriptor_buffer(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, _set, &paramsInfo, kParamsBinding);
+    vkUpdateDescriptorSets(_device, 1, &paramsWrite, 0, nullptr);
+
+    LOGI("MaterialTable: %s, %u texture slots, %u materials", _descriptorIndexing ? "descriptor indexing" : "fixed array", _textureCapacity, _materialCapacity);
+}
+
+void MaterialTable::cleanup() {
+    vmaUnmapMemory(_allocator, _paramBuffer._allocation);
+    vmaDestroyBuffer(_allocator, _paramBuffer._buffer, _paramBuffer._allocation);
+    vkDestroyDescriptorPool(_device, _pool, nullptr);
+    vkDestroyDescriptorSetLayout(_device, _setLayout, nullptr);
+}
+
+uint32_t MaterialTable::add_texture(VkImageView view, VkSampler sampler) {
+    if (_textures.size() >= _textureCapacity) {
+        LOGE("MaterialTable: out of texture slots (%u)", _textureCapacity);
+        return 0;
+    }
+    _textures.push_back({sampler, view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+    return (uint32_t)_textures.size() - 1;
+}
+
+uint32_t MaterialTable::add_material(const GPUMaterialParams& params) {
+    if (_params.size() >= _materialCapacity) {
+        LOGE("MaterialTable: out of material rows (%u)", _materialCapacity);
+        return 0;
+    }
+    _params.push_back(params);
+    return (uint32_t)_params.size() - 1;
+}
+
+void MaterialTable::update() {
+    if (_flushedParams < _params.size()) {
+        char* dst = (char*)_mappedParams + _flushedParams * sizeof(GPUMaterialParams);
+        memcpy(dst, &_params[_flushedParams], (_params.size() - _flushedParams) * sizeof(GPUMaterialParams));
+        _flushedParams = _params.size();
+    }
+
+    if (_textures.empty()) {
+        return;
+    }
+
+    std::vector<VkWriteDescriptorSet> writes;
+    if (_flushedTextures < _textures.size()) {
+        writes.push_back(vkinit::write_descriptor_image(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, _set, &_textures[_flushedTextures], kTexturesBinding, (uint32_t)_flushedTextures, (uint32_t)(_textures.size() - _flushedTextures)));
+    }
+
+    // the fixed-size array must be fully written, point the unused tail at slot 0
+    std::vector<VkDescriptorImageInfo> filler;
+    if (!_descriptorIndexing && _textures.size() < _textureCapacity) {
+        filler.assign(_textureCapacity - _textures.size(), _textures[0]);
+        writes.push_back(vkinit::write_descriptor_image(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, _set, filler.data(), kTexturesBinding, (uint32_t)_textures.size(), (uint32_t)filler.size()));
+    }
+
+    if (!writes.empty()) {
+        vkUpdateDescriptorSets(_device, (uint32_t)writes.size(), writes.data(), 0, nullptr);
+    }
+    _flushedTextures = _textures.size();
+}
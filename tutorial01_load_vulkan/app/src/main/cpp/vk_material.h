@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+#include <glm/vec4.hpp>
+#include "vk_types.h"
+
+// texture slots when VK_EXT_descriptor_indexing is available, clamped to the device update-after-bind limits
+constexpr uint32_t kBindlessTextureCapacity = 1024;
+// texture slots of the fixed-size fallback array, every slot has to hold a valid descriptor
+constexpr uint32_t kFallbackTextureCapacity = 16;
+// rows of the material parameter buffer
+constexpr uint32_t kMaterialCapacity = 256;
+
+// one row of the material parameter buffer, matches the std430 MaterialParams struct in mesh.frag
+struct GPUMaterialParams {
+    glm::vec4 diffuse;    // rgb: Kd, a: alpha cutoff, 0 disables the alpha test
+    glm::uvec4 textures;  // x: diffuse texture slot, y: alpha texture slot
+};
+
+// Bindless material table.
+// All textures live in one sampled image array and all material parameters in one storage buffer,
+// both in a single descriptor set that is bound once per pipeline layout. A draw selects its material
+// through the index in MeshPushConstants::data, so material changes no longer need a descriptor bind.
+class MaterialTable {
+   public:
+    static constexpr uint32_t kParamsBinding   = 0;
+    static constexpr uint32_t kTexturesBinding = 1;
+
+    VkDescriptorSetLayout _setLayout;
+    VkDescriptorSet _set;
+
+    bool _descriptorIndexing;    // partially bound, update-after-bind texture array
+    uint32_t _textureCapacity;   // size of the texture array, the shader gets it as a specialization constant
+    uint32_t _materialCapacity;  // rows of the parameter buffer
+
+    void init(VkDevice device, VmaAllocator allocator, bool descriptorIndexing, uint32_t textureCapacity, uint32_t materialCapacity);
+    void cleanup();
+
+    // returns the slot of the texture in the array
+    uint32_t add_texture(VkImageView view, VkSampler sampler);
+    // returns the row of the material in the parameter buffer
+    uint32_t add_material(const GPUMaterialParams& params);
+    // writes the rows and texture descriptors added since the last update.
+    // Without descriptor indexing the set must not be in use by a pending command buffer.
+    void update();
+
+    uint32_t texture_count() const { return (uint32_t)_textures.size(); }
+    uint32_t material_count() const { return (uint32_t)_params.size(); }
+
+   private:
+    VkDevice _device;
+    VmaAllocator _allocator;
+    VkDescriptorPool _pool;
+
+    AllocatedBuffer _paramBuffer;
+    void* _mappedParams;
+
+    std::vector<GPUMaterialParams> _params;
+    std::vector<VkDescriptorImageInfo> _textures;
+    size_t _flushedParams{0};
+    size_t _flushedTextures{0};
+};
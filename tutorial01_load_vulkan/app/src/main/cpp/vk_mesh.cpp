@@ -1,9 +1,12 @@
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <istream>
 #include <streambuf>
 #include <string>
 #include <tinyobjloader/tiny_obj_loader.h>
-#include <game-activity/native_app_glue/android_native_app_glue.h>
+#include <unordered_map>
+#include <vector>
 #include "log.h"
 #include "vk_mesh.h"
 
@@ -39,9 +42,17 @@ VertexInputDescription Vertex::get_vertex_description() {
     colorAttribute.format                            = VK_FORMAT_R32G32B32_SFLOAT;
     colorAttribute.offset                            = offsetof(Vertex, color);
 
+    // UV will be stored at Location 3
+    VkVertexInputAttributeDescription uvAttribute = {};
+    uvAttribute.binding                           = 0;
+    uvAttribute.location                          = 3;
+    uvAttribute.format                            = VK_FORMAT_R32G32_SFLOAT;
+    uvAttribute.offset                            = offsetof(Vertex, uv);
+
     description.attributes.push_back(positionAttribute);
     description.attributes.push_back(normalAttribute);
     description.attributes.push_back(colorAttribute);
+    description.attributes.push_back(uvAttribute);
     return description;
 }
 
@@ -49,7 +60,7 @@ struct membuf : std::streambuf {
     membuf(char* begin, char* end) { this->setg(begin, begin, end); }
 };
 
-bool Mesh::load_from_obj(AAssetManager* mgr, const char* filename) {
+bool Mesh::load_from_obj(AssetSource* assets, const char* filename) {
     // attrib will contain the vertex arrays of the file
     tinyobj::attrib_t attrib;
 
@@ -64,17 +75,17 @@ bool Mesh::load_from_obj(AAssetManager* mgr, const char* filename) {
     std::string err;
 
     // load the OBJ file
-    AAsset* file      = AAssetManager_open(mgr, filename, AASSET_MODE_BUFFER);
-    size_t fileLength = AAsset_getLength(file);
-
-    char* buffer = new char[fileLength];
-	AAsset_read(file, buffer, fileLength);
+    std::vector<char> buffer;
+    if (!assets->read(filename, buffer)) {
+        LOGE("load_from_obj: %s not found", filename);
+        return false;
+    }
+    size_t fileLength = buffer.size();
 
-    membuf sbuf(buffer, buffer + fileLength*sizeof(char));
+    membuf sbuf(buffer.data(), buffer.data() + fileLength);
     std::istream in(&sbuf);	
 
     tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &in, nullptr);
-    delete[] buffer;
 	
 	//
 	LOGI("load_from_obj %s fileLength=%lu, shapes=%lu", filename, fileLength, shapes.size());
@@ -123,6 +134,14 @@ bool Mesh::load_from_obj(AAssetManager* mgr, const char* filename) {
                 new_vert.normal.y = ny;
                 new_vert.normal.z = nz;
 
+                // vertex uv, flipped on v as OBJ has the origin at the bottom left
+                if (idx.texcoord_index >= 0) {
+                    new_vert.uv.x = attrib.texcoords[2 * idx.texcoord_index + 0];
+                    new_vert.uv.y = 1.f - attrib.texcoords[2 * idx.texcoord_index + 1];
+                } else {
+                    new_vert.uv = {0.f, 0.f};
+                }
+
                 // we are setting the vertex color as the vertex normal. This is just for display purposes
                 new_vert.color = new_vert.normal;
 
@@ -132,5 +151,111 @@ bool Mesh::load_from_obj(AAssetManager* mgr, const char* filename) {
         }
     }
 
+    compute_bounds();
+    build_lods();
+    build_meshlets();
     return true;
-};
\ No newline at end of file
+};
+
+void Mesh::compute_bounds() {
+    if (_vertices.empty()) {
+        _bounds = {glm::vec3(0.f), 0.f};
+        return;
+    }
+    glm::vec3 lower = _vertices[0].position;
+    glm::vec3 upper = _vertices[0].position;
+    for (const Vertex& vertex : _vertices) {
+        lower = glm::min(lower, vertex.position);
+        upper = glm::max(upper, vertex.position);
+    }
+    _bounds.center = (lower + upper) * 0.5f;
+    _bounds.radius = 0.f;
+    for (const Vertex& vertex : _vertices) {
+        _bounds.radius = std::max(_bounds.radius, glm::length(vertex.position - _bounds.center));
+    }
+}
+
+void Mesh::build_lods(uint32_t maxLevels) {
+    uint32_t fullCount = _lods.empty() ? (uint32_t)_vertices.size() : _lods[0].vertexCount;
+    _vertices.resize(fullCount);
+    _lods.assign(1, {0, fullCount, 0.f});
+
+    std::vector<glm::vec3> positions;
+    for (uint32_t i = 0; i < fullCount; i++) {
+        positions.push_back(_vertices[i].position);
+    }
+    // the error is measured at the distinct positions of the full mesh
+    std::vector<glm::vec3> points = positions;
+    std::sort(points.begin(), points.end(), [](const glm::vec3& a, const glm::vec3& b) { return a.x != b.x ? a.x < b.x : a.y != b.y ? a.y < b.y : a.z < b.z; });
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+
+    uint32_t triangles = fullCount / 3;
+    for (uint32_t level = 1; level < maxLevels; level++) {
+        uint32_t target = triangles / 2;
+        if (target < kMinLodTriangles) {
+            break;
+        }
+        SimplifiedMesh simplified = simplify_triangles(positions, target);
+        uint32_t simplifiedCount  = (uint32_t)simplified.positions.size() / 3;
+        // stop once the collapses got stuck well above the target
+        if (simplifiedCount * 10 > triangles * 9) {
+            break;
+        }
+
+        MeshLod lod;
+        lod.firstVertex = (uint32_t)_vertices.size();
+        lod.vertexCount = simplifiedCount * 3;
+        lod.error       = std::max(_lods.back().error, surface_distance(points, simplified.positions));
+        for (size_t i = 0; i < simplified.positions.size(); i++) {
+            Vertex vertex   = _vertices[simplified.corners[i]];
+            vertex.position = simplified.positions[i];
+            _vertices.push_back(vertex);
+        }
+        _lods.push_back(lod);
+        triangles = simplifiedCount;
+    }
+}
+
+namespace {
+
+// vertices equal in every attribute, compared bytewise
+struct VertexHash {
+    size_t operator()(const Vertex* vertex) const {
+        const unsigned char* bytes = (const unsigned char*)vertex;
+        size_t hash                = 14695981039346656037ull;
+        for (size_t i = 0; i < sizeof(Vertex); i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+};
+struct VertexEqual {
+    bool operator()(const Vertex* a, const Vertex* b) const { return memcmp(a, b, sizeof(Vertex)) == 0; }
+};
+
+}  // namespace
+
+void Mesh::build_meshlets() {
+    _meshlets.clear();
+    _meshletIndices.clear();
+
+    std::vector<glm::vec3> positions;
+    positions.reserve(_vertices.size());
+    for (const Vertex& vertex : _vertices) {
+        positions.push_back(vertex.position);
+    }
+
+    for (MeshLod& lod : _lods) {
+        // every vertex of the level maps to the first one equal to it
+        std::unordered_map<const Vertex*, uint32_t, VertexHash, VertexEqual> firstEqual;
+        std::vector<uint32_t> indices(lod.vertexCount);
+        for (uint32_t i = 0; i < lod.vertexCount; i++) {
+            uint32_t vertex = lod.firstVertex + i;
+            indices[i]      = firstEqual.emplace(&_vertices[vertex], vertex).first->second;
+        }
+
+        lod.firstMeshlet = (uint32_t)_meshlets.size();
+        ::build_meshlets(positions, indices, _meshletIndices, _meshlets);
+        lod.meshletCount = (uint32_t)_meshlets.size() - lod.firstMeshlet;
+    }
+}
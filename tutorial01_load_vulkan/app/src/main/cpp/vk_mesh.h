@@ -2,11 +2,17 @@
 
 //#include <vk_types.h>
 #include <vector>
+#include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include <glm/gtx/transform.hpp>
 
-#include "vma/vk_mem_alloc.h"
+#include "vk_types.h"
+#include "vk_assets.h"
+#include "vk_renderables.h"
+#include "vk_lod.h"
+#include "vk_meshlet.h"
+#include "vk_residency.h"
 struct VertexInputDescription {
     std::vector<VkVertexInputBindingDescription> bindings;
     std::vector<VkVertexInputAttributeDescription> attributes;
@@ -18,27 +24,31 @@ struct Vertex {
     glm::vec3 position;
     glm::vec3 normal;
     glm::vec3 color;
+    glm::vec2 uv;
     static VertexInputDescription get_vertex_description();
 };
 
-struct AllocatedBuffer {
-    VkBuffer _buffer;
-    VmaAllocation _allocation;
-};
-
-struct AllocatedImage {
-    VkImage _image;
-    VmaAllocation _allocation;
-};
-
 struct Mesh {
-    std::vector<Vertex> _vertices;
-
-    AllocatedBuffer _vertexBuffer;
-    bool load_from_obj(AAssetManager* AssetManager, const char* filename);
+    std::vector<Vertex> _vertices;  // every level of detail, one after the other
+
+    uint32_t _vertexBuffer{BufferResidency::kNoBuffer};  // handle in the engine's _meshBuffers
+    RenderBounds _bounds;                   // model space, around the center of the vertices' box
+    std::vector<MeshLod> _lods;             // full mesh first, then ever fewer triangles
+    std::vector<Meshlet> _meshlets;         // of every level of detail, see MeshLod::firstMeshlet
+    std::vector<uint32_t> _meshletIndices;  // triangles of the meshlets, indices into _vertices
+    uint32_t _meshletBase{0};               // first meshlet in the GPU meshlet buffer
+    bool load_from_obj(AssetSource* assets, const char* filename);
+    void compute_bounds();
+    // simplifies the full mesh to half the triangles of the previous level until maxLevels or
+    // kMinLodTriangles, appending each level to _vertices. Small meshes keep just the full level
+    void build_lods(uint32_t maxLevels = 4);
+    // splits every level of detail into meshlets, equal vertices are welded so neighbouring triangles share them
+    void build_meshlets();
 };
 
+constexpr uint32_t kMinLodTriangles = 32;
+
+// per-draw data, the matrices are streamed through the frame allocator
 struct MeshPushConstants {
-    glm::vec4 data;
-    glm::mat4 render_matrix;
+    glm::uvec4 data;  // x: index into the material table
 };
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include "vk_meshlet.h"
+
+namespace {
+
+// cosine of the largest angle a triangle's normal may have to the meshlet's average normal once the
+// meshlet has kMeshletConeMinTriangles. Without a limit the cones of curved meshes open past 90 degrees
+// and the facing test never culls, applied from the start coarse meshes end up with a meshlet per triangle
+constexpr float kMeshletConeLimit          = 0.5f;
+constexpr uint32_t kMeshletConeMinTriangles = 16;
+
+struct PositionKey {
+    size_t operator()(const glm::vec3& p) const {
+        uint32_t bits[3];
+        memcpy(bits, &p, sizeof(bits));
+        return bits[0] * 73856093u ^ bits[1] * 19349663u ^ bits[2] * 83492791u;
+    }
+};
+
+// the meshlet being grown, vertices and triangles are indices of the input
+struct MeshletBuilder {
+    std::vector<uint32_t> vertices;
+    std::vector<uint32_t> triangles;
+    glm::vec3 centroidSum{0.f};
+    glm::vec3 normalSum{0.f};
+};
+
+glm::vec3 triangle_normal(const std::vector<glm::vec3>& positions, const uint32_t* corners) {
+    glm::vec3 normal = glm::cross(positions[corners[1]] - positions[corners[0]], positions[corners[2]] - positions[corners[0]]);
+    float length     = glm::length(normal);
+    return length > 0.f ? normal / length : normal;
+}
+
+Meshlet finish_meshlet(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, const MeshletBuilder& builder, std::vector<uint32_t>& outIndices) {
+    Meshlet meshlet       = {};
+    meshlet.firstIndex    = (uint32_t)outIndices.size();
+    meshlet.triangleCount = (uint32_t)builder.triangles.size();
+    meshlet.vertexCount   = (uint32_t)builder.vertices.size();
+
+    // sphere around the center of the vertices' box
+    glm::vec3 lower = positions[builder.vertices[0]];
+    glm::vec3 upper = lower;
+    for (uint32_t vertex : builder.vertices) {
+        lower = glm::min(lower, positions[vertex]);
+        upper = glm::max(upper, positions[vertex]);
+    }
+    meshlet.center = (lower + upper) * 0.5f;
+    for (uint32_t vertex : builder.vertices) {
+        meshlet.radius = std::max(meshlet.radius, glm::length(positions[vertex] - meshlet.center));
+    }
+
+    // the cone around the triangle normals, front faces are counter-clockwise
+    std::vector<glm::vec3> normals;
+    glm::vec3 normalSum(0.f);
+    for (uint32_t triangle : builder.triangles) {
+        const uint32_t* corners = &indices[triangle * 3];
+        outIndices.insert(outIndices.end(), corners, corners + 3);
+
+        glm::vec3 normal = triangle_normal(positions, corners);
+        if (normal != glm::vec3(0.f)) {
+            normals.push_back(normal);
+            normalSum += normal;
+        }
+    }
+    meshlet.coneAxis   = glm::vec3(0.f, 0.f, 1.f);
+    meshlet.coneCutoff = 1.f;
+    float sumLength    = glm::length(normalSum);
+    if (normals.empty() || sumLength < 1e-6f) {
+        return meshlet;
+    }
+    meshlet.coneAxis = normalSum / sumLength;
+    float minDot     = 1.f;
+    for (const glm::vec3& normal : normals) {
+        minDot = std::min(minDot, glm::dot(normal, meshlet.coneAxis));
+    }
+    // a cone of 90 degrees or more has a triangle facing every viewer
+    if (minDot > 0.f) {
+        meshlet.coneCutoff = sqrtf(1.f - minDot * minDot);
+    }
+    return meshlet;
+}
+
+}  // namespace
+
+void build_meshlets(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, std::vector<uint32_t>& outIndices, std::vector<Meshlet>& outMeshlets) {
+    uint32_t triangleCount = (uint32_t)indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // triangles around every position, vertices differing only in normal or uv still connect triangles
+    std::unordered_map<glm::vec3, uint32_t, PositionKey> positionIds;
+    std::vector<uint32_t> cornerPositions(triangleCount * 3);
+    for (uint32_t i = 0; i < triangleCount * 3; i++) {
+        cornerPositions[i] = positionIds.emplace(positions[indices[i]], (uint32_t)positionIds.size()).first->second;
+    }
+    uint32_t positionCount = (uint32_t)positionIds.size();
+    std::vector<uint32_t> adjacencyStart(positionCount + 1, 0);
+    for (uint32_t i = 0; i < triangleCount * 3; i++) {
+        adjacencyStart[cornerPositions[i] + 1]++;
+    }
+    for (uint32_t p = 0; p < positionCount; p++) {
+        adjacencyStart[p + 1] += adjacencyStart[p];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<uint32_t> cursor(adjacencyStart.begin(), adjacencyStart.end() - 1);
+    for (uint32_t i = 0; i < triangleCount * 3; i++) {
+        adjacency[cursor[cornerPositions[i]]++] = i / 3;
+    }
+
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    // meshlet a vertex or position was last added to, so membership needs no clearing between meshlets
+    std::vector<uint32_t> vertexMeshlet(positions.size(), UINT32_MAX);
+    std::vector<uint32_t> positionMeshlet(positionCount, UINT32_MAX);
+    std::vector<uint32_t> meshletPositions;
+    uint32_t meshletNumber = 0;
+    uint32_t nextSeed      = 0;
+    MeshletBuilder builder;
+
+    auto new_vertices = [&](uint32_t triangle) {
+        const uint32_t* corners = &indices[triangle * 3];
+        uint32_t count          = 0;
+        for (int k = 0; k < 3; k++) {
+            bool repeated = (k > 0 && corners[k] == corners[0]) || (k > 1 && corners[k] == corners[1]);
+            if (!repeated && vertexMeshlet[corners[k]] != meshletNumber) {
+                count++;
+            }
+        }
+        return count;
+    };
+    auto centroid = [&](uint32_t triangle) {
+        const uint32_t* corners = &indices[triangle * 3];
+        return (positions[corners[0]] + positions[corners[1]] + positions[corners[2]]) / 3.f;
+    };
+
+    while (true) {
+        uint32_t best    = UINT32_MAX;
+        uint32_t bestNew = 4;
+        float bestScore  = 0.f;
+        if (!builder.triangles.empty()) {
+            glm::vec3 center = builder.centroidSum / (float)builder.triangles.size();
+            glm::vec3 axis   = builder.normalSum / std::max(glm::length(builder.normalSum), 1e-6f);
+            bool limitCone   = builder.triangles.size() >= kMeshletConeMinTriangles && axis != glm::vec3(0.f);
+            float extent     = 1e-6f;
+            for (uint32_t vertex : builder.vertices) {
+                extent = std::max(extent, glm::length(positions[vertex] - center));
+            }
+            for (uint32_t position : meshletPositions) {
+                for (uint32_t a = adjacencyStart[position]; a < adjacencyStart[position + 1]; a++) {
+                    uint32_t triangle = adjacency[a];
+                    if (emitted[triangle]) {
+                        continue;
+                    }
+                    // degenerate triangles fit anywhere
+                    glm::vec3 normal = triangle_normal(positions, &indices[triangle * 3]);
+                    float facing     = normal == glm::vec3(0.f) ? 1.f : glm::dot(normal, axis);
+                    if (limitCone && facing < kMeshletConeLimit) {
+                        continue;
+                    }
+                    // distance in meshlet radii plus the spread the triangle adds to the cone
+                    uint32_t added = new_vertices(triangle);
+                    float score    = glm::length(centroid(triangle) - center) / extent + (1.f - facing);
+                    if (added < bestNew || (added == bestNew && score < bestScore)) {
+                        best      = triangle;
+                        bestNew   = added;
+                        bestScore = score;
+                    }
+                }
+            }
+        }
+        // nothing left to add around the meshlet, the next one starts at the next triangle in order
+        bool finished = best == UINT32_MAX && !builder.triangles.empty();
+        if (best == UINT32_MAX) {
+            while (nextSeed < triangleCount && emitted[nextSeed]) {
+                nextSeed++;
+            }
+            if (nextSeed == triangleCount) {
+                break;
+            }
+            best    = nextSeed;
+            bestNew = new_vertices(best);
+        }
+
+        if (finished || builder.vertices.size() + bestNew > kMeshletMaxVertices || builder.triangles.size() == kMeshletMaxTriangles) {
+            outMeshlets.push_back(finish_meshlet(positions, indices, builder, outIndices));
+            builder = MeshletBuilder{};
+            meshletPositions.clear();
+            meshletNumber++;
+        }
+
+        for (uint32_t i = best * 3; i < best * 3 + 3; i++) {
+            if (vertexMeshlet[indices[i]] != meshletNumber) {
+                vertexMeshlet[indices[i]] = meshletNumber;
+                builder.vertices.push_back(indices[i]);
+            }
+            if (positionMeshlet[cornerPositions[i]] != meshletNumber) {
+                positionMeshlet[cornerPositions[i]] = meshletNumber;
+                meshletPositions.push_back(cornerPositions[i]);
+            }
+        }
+        builder.triangles.push_back(best);
+        builder.centroidSum += centroid(best);
+        builder.normalSum += triangle_normal(positions, &indices[best * 3]);
+        emitted[best] = 1;
+    }
+    if (!builder.triangles.empty()) {
+        outMeshlets.push_back(finish_meshlet(positions, indices, builder, outIndices));
+    }
+}
+
+void frustum_planes(const glm::mat4& viewproj, glm::vec4 planes[6]) {
+    // Gribb and Hartmann, the near plane is z >= 0 of Vulkan's clip space
+    glm::mat4 m = glm::transpose(viewproj);
+    planes[0]   = m[3] + m[0];
+    planes[1]   = m[3] - m[0];
+    planes[2]   = m[3] + m[1];
+    planes[3]   = m[3] - m[1];
+    planes[4]   = m[2];
+    planes[5]   = m[3] - m[2];
+    for (int i = 0; i < 6; i++) {
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+}
+
+bool sphere_in_frustum(const glm::vec4 planes[6], const glm::vec3& center, float radius) {
+    for (int i = 0; i < 6; i++) {
+        if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool cone_backfacing(const glm::vec3& center, float radius, const glm::vec3& coneAxis, float coneCutoff, const glm::vec3& eye) {
+    // every direction from eye into the sphere has to stay within 90 degrees minus the cone's half
+    // angle of the axis, then no normal of the cone can point back at eye
+    glm::vec3 toCenter = center - eye;
+    return glm::dot(toCenter, coneAxis) >= coneCutoff * glm::length(toCenter) + radius * (1.f + coneCutoff);
+}
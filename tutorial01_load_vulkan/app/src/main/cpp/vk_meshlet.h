@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+// size limits of one meshlet
+constexpr uint32_t kMeshletMaxVertices  = 64;
+constexpr uint32_t kMeshletMaxTriangles = 124;
+
+// a cluster of neighbouring triangles, the unit cull.comp culls and draws. Same layout as its Meshlet
+struct Meshlet {
+    glm::vec3 center;  // bounding sphere, model space
+    float radius;
+    glm::vec3 coneAxis;   // average facing of the triangles
+    float coneCutoff;     // sine of the normal cone's half angle, 1 when it can't be culled by facing
+    uint32_t firstIndex;  // into the meshlet index list
+    uint32_t triangleCount;
+    uint32_t vertexCount;  // distinct vertices
+    uint32_t pad;
+};
+
+// Splits a triangle list, three indices into positions per triangle, into meshlets of at most
+// kMeshletMaxVertices and kMeshletMaxTriangles. A meshlet grows from a seed triangle by the neighbour
+// adding the fewest new vertices, ties going to the one closest to the meshlet. The meshlets' triangles
+// are appended to outIndices, and the meshlets, whose firstIndex points into outIndices, to outMeshlets.
+void build_meshlets(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, std::vector<uint32_t>& outIndices, std::vector<Meshlet>& outMeshlets);
+
+// normalized frustum planes of viewproj, a point p is inside when dot(plane.xyz, p) + plane.w >= 0
+void frustum_planes(const glm::mat4& viewproj, glm::vec4 planes[6]);
+bool sphere_in_frustum(const glm::vec4 planes[6], const glm::vec3& center, float radius);
+// true when every triangle inside the sphere with normals inside the cone faces away from eye, the
+// CPU version of the test in cull.comp
+bool cone_backfacing(const glm::vec3& center, float radius, const glm::vec3& coneAxis, float coneCutoff, const glm::vec3& eye);
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include "vk_occlusion.h"
+
+namespace {
+
+uint32_t round_down_pow2(uint32_t value) {
+    uint32_t result = 1;
+    while (result * 2 <= value) {
+        result *= 2;
+    }
+    return result;
+}
+
+// the farthest of the source texels under target texel (x, y), same arithmetic as depth_reduce.comp
+float reduce_texel(const float* source, uint32_t sourceWidth, uint32_t sourceHeight, uint32_t targetWidth, uint32_t targetHeight, uint32_t x, uint32_t y) {
+    uint32_t firstX = x * sourceWidth / targetWidth;
+    uint32_t firstY = y * sourceHeight / targetHeight;
+    uint32_t lastX  = std::min(((x + 1) * sourceWidth + targetWidth - 1) / targetWidth, sourceWidth) - 1;
+    uint32_t lastY  = std::min(((y + 1) * sourceHeight + targetHeight - 1) / targetHeight, sourceHeight) - 1;
+    float depth     = 0.f;
+    for (uint32_t sy = firstY; sy <= lastY; sy++) {
+        for (uint32_t sx = firstX; sx <= lastX; sx++) {
+            depth = std::max(depth, source[sy * sourceWidth + sx]);
+        }
+    }
+    return depth;
+}
+
+}  // namespace
+
+void depth_pyramid_extent(uint32_t width, uint32_t height, uint32_t& outWidth, uint32_t& outHeight) {
+    outWidth  = round_down_pow2(std::max(width, 1u));
+    outHeight = round_down_pow2(std::max(height, 1u));
+}
+
+uint32_t depth_pyramid_levels(uint32_t width, uint32_t height) {
+    uint32_t levels = 1;
+    while ((width | height) > 1) {
+        width >>= 1;
+        height >>= 1;
+        levels++;
+    }
+    return levels;
+}
+
+std::vector<PyramidLevel> build_depth_pyramid(const std::vector<float>& depth, uint32_t width, uint32_t height) {
+    uint32_t levelWidth, levelHeight;
+    depth_pyramid_extent(width, height, levelWidth, levelHeight);
+    uint32_t levels = depth_pyramid_levels(levelWidth, levelHeight);
+
+    std::vector<PyramidLevel> pyramid(levels);
+    const float* source  = depth.data();
+    uint32_t sourceWidth = width, sourceHeight = height;
+    for (uint32_t l = 0; l < levels; l++) {
+        PyramidLevel& level = pyramid[l];
+        level.width         = levelWidth;
+        level.height        = levelHeight;
+        level.depth.resize(levelWidth * levelHeight);
+        for (uint32_t y = 0; y < levelHeight; y++) {
+            for (uint32_t x = 0; x < levelWidth; x++) {
+                level.depth[y * levelWidth + x] = reduce_texel(source, sourceWidth, sourceHeight, levelWidth, levelHeight, x, y);
+            }
+        }
+        source       = level.depth.data();
+        sourceWidth  = levelWidth;
+        sourceHeight = levelHeight;
+        levelWidth   = std::max(levelWidth / 2, 1u);
+        levelHeight  = std::max(levelHeight / 2, 1u);
+    }
+    return pyramid;
+}
+
+bool sphere_occluded(const std::vector<PyramidLevel>& pyramid, const glm::mat4& viewproj, const glm::vec3& center, float radius) {
+    if (pyramid.empty()) {
+        return false;
+    }
+    // screen rectangle and nearest depth of the sphere's box, the box holds the sphere
+    glm::vec2 lower(1e30f), upper(-1e30f);
+    float nearest = 1.f;
+    for (int i = 0; i < 8; i++) {
+        glm::vec3 corner = center + radius * glm::vec3((i & 1) ? 1.f : -1.f, (i & 2) ? 1.f : -1.f, (i & 4) ? 1.f : -1.f);
+        glm::vec4 clip   = viewproj * glm::vec4(corner, 1.f);
+        if (clip.w <= 0.f || clip.z < 0.f) {
+            return false;
+        }
+        glm::vec2 uv = glm::vec2(clip) / clip.w * 0.5f + 0.5f;
+        lower        = glm::min(lower, uv);
+        upper        = glm::max(upper, uv);
+        nearest      = std::min(nearest, clip.z / clip.w);
+    }
+    lower = glm::clamp(lower, 0.f, 1.f);
+    upper = glm::clamp(upper, 0.f, 1.f);
+
+    // the level where the rectangle spans at most two texels each way
+    float extent    = std::max((upper.x - lower.x) * pyramid[0].width, (upper.y - lower.y) * pyramid[0].height);
+    uint32_t levels = (uint32_t)pyramid.size();
+    uint32_t l      = std::min((uint32_t)std::max(ceilf(log2f(std::max(extent, 1.f))), 0.f), levels - 1);
+
+    const PyramidLevel& level = pyramid[l];
+    uint32_t firstX           = std::min((uint32_t)(lower.x * level.width), level.width - 1);
+    uint32_t firstY           = std::min((uint32_t)(lower.y * level.height), level.height - 1);
+    uint32_t lastX            = std::min((uint32_t)(upper.x * level.width), level.width - 1);
+    uint32_t lastY            = std::min((uint32_t)(upper.y * level.height), level.height - 1);
+    float farthest            = 0.f;
+    for (uint32_t y = firstY; y <= lastY; y++) {
+        for (uint32_t x = firstX; x <= lastX; x++) {
+            farthest = std::max(farthest, level.depth[y * level.width + x]);
+        }
+    }
+    return nearest > farthest;
+}
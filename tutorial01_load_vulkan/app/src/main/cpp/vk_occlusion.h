@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+// one level of a depth pyramid, row major
+struct PyramidLevel {
+    uint32_t width;
+    uint32_t height;
+    std::vector<float> depth;
+};
+
+// Level 0 of the depth pyramid of a width x height depth buffer: each side rounded down to a power of
+// two, so every further level halves exactly and a texel of level 0 covers at most 3x3 depth pixels
+void depth_pyramid_extent(uint32_t width, uint32_t height, uint32_t& outWidth, uint32_t& outHeight);
+// levels down to 1x1
+uint32_t depth_pyramid_levels(uint32_t width, uint32_t height);
+
+// CPU version of depth_reduce.comp. Every texel holds the farthest depth of the texels it covers one
+// level down, level 0 of the depth pixels, so anything behind a texel is behind everything drawn there
+std::vector<PyramidLevel> build_depth_pyramid(const std::vector<float>& depth, uint32_t width, uint32_t height);
+
+// true when the sphere lies behind the pyramid everywhere it covers on screen, the CPU version of the
+// test in cull.comp. Spheres reaching past the near plane are never occluded
+bool sphere_occluded(const std::vector<PyramidLevel>& pyramid, const glm::mat4& viewproj, const glm::vec3& center, float radius);
@@ -0,0 +1,139 @@
+#include <glm/gtc/matrix_transform.hpp>
+#include "vk_occlusion_queries.h"
+#include "log.h"
+
+void OcclusionQueries::init(VkDevice device, VmaAllocator allocator, PFN_vkCmdBeginConditionalRenderingEXT beginConditional, PFN_vkCmdEndConditionalRenderingEXT endConditional) {
+    _device           = device;
+    _allocator        = allocator;
+    _beginConditional = beginConditional;
+    _endConditional   = endConditional;
+    _conditional      = beginConditional && endConditional;
+
+    VkQueryPoolCreateInfo poolInfo = {};
+    poolInfo.sType                 = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType             = VK_QUERY_TYPE_OCCLUSION;
+    poolInfo.queryCount            = kMaxOcclusionQueries * FRAME_OVERLAP;
+    VK_CHECK(vkCreateQueryPool(_device, &poolInfo, nullptr, &_pool));
+
+    if (_conditional) {
+        VkBufferCreateInfo bufferInfo = {};
+        bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size               = sizeof(uint32_t) * kMaxOcclusionQueries;
+        bufferInfo.usage              = VK_BUFFER_USAGE_CONDITIONAL_RENDERING_BIT_EXT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+        VmaAllocationCreateInfo vmaallocInfo = {};
+        vmaallocInfo.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
+        vmaallocInfo.pUserData               = (void*)"OcclusionPredicates";
+        for (uint32_t i = 0; i < FRAME_OVERLAP; i++) {
+            VK_CHECK(vmaCreateBuffer(_allocator, &bufferInfo, &vmaallocInfo, &_predicates[i]._buffer, &_predicates[i]._allocation, nullptr));
+        }
+    }
+    LOGI("OcclusionQueries: %u queries per frame, %s", kMaxOcclusionQueries, _conditional ? "conditional rendering" : "results read back on the CPU");
+}
+
+void OcclusionQueries::cleanup() {
+    if (_conditional) {
+        for (uint32_t i = 0; i < FRAME_OVERLAP; i++) {
+            vmaDestroyBuffer(_allocator, _predicates[i]._buffer, _predicates[i]._allocation);
+        }
+    }
+    vkDestroyQueryPool(_device, _pool, nullptr);
+}
+
+uint32_t OcclusionQueries::begin_frame(VkCommandBuffer cmd, uint32_t frameNumber, const RenderableStore& renderables) {
+    _frame         = frameNumber % FRAME_OVERLAP;
+    uint32_t first = _frame * kMaxOcclusionQueries;
+    _predicate.assign(renderables.size(), UINT32_MAX);
+    _occluded.assign(renderables.size(), 0);
+
+    // the slot's fence has signaled, so every result is there and reading them can't stall. Handles
+    // find the renderables again after removals, removed ones are gone
+    uint32_t occluded                      = 0;
+    std::vector<RenderableHandle>& queried = _queried[_frame];
+    if (!queried.empty()) {
+        std::vector<uint32_t> samples(queried.size());
+        if (vkGetQueryPoolResults(_device, _pool, first, (uint32_t)queried.size(), samples.size() * sizeof(uint32_t), samples.data(), sizeof(uint32_t), 0) == VK_SUCCESS) {
+            for (size_t q = 0; q < queried.size(); q++) {
+                if (samples[q] != 0) {
+                    continue;
+                }
+                occluded++;
+                if (!_conditional && renderables.valid(queried[q])) {
+                    _occluded[renderables.index(queried[q])] = 1;
+                }
+            }
+        }
+    }
+    queried.clear();
+    vkCmdResetQueryPool(cmd, _pool, first, kMaxOcclusionQueries);
+    if (!_conditional) {
+        return occluded;
+    }
+
+    // the previous frame was submitted first, the copy waits for its queries on the GPU only
+    uint32_t previous                         = (frameNumber + FRAME_OVERLAP - 1) % FRAME_OVERLAP;
+    const std::vector<RenderableHandle>& last = _queried[previous];
+    if (last.empty()) {
+        return occluded;
+    }
+    vkCmdCopyQueryPoolResults(cmd, _pool, previous * kMaxOcclusionQueries, (uint32_t)last.size(), _predicates[_frame]._buffer, 0, sizeof(uint32_t), VK_QUERY_RESULT_WAIT_BIT);
+    VkMemoryBarrier copyBarrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER, nullptr, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_CONDITIONAL_RENDERING_READ_BIT_EXT};
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_CONDITIONAL_RENDERING_BIT_EXT, 0, 1, &copyBarrier, 0, nullptr, 0, nullptr);
+    for (uint32_t q = 0; q < last.size(); q++) {
+        if (renderables.valid(last[q])) {
+            _predicate[renderables.index(last[q])] = q;
+        }
+    }
+    return occluded;
+}
+
+bool OcclusionQueries::begin_draw(VkCommandBuffer cmd, uint32_t index) {
+    if (!_conditional) {
+        return !_occluded[index];
+    }
+    // an object without a query last frame is drawn as is
+    if (_predicate[index] != UINT32_MAX) {
+        VkConditionalRenderingBeginInfoEXT beginInfo = {};
+        beginInfo.sType                              = VK_STRUCTURE_TYPE_CONDITIONAL_RENDERING_BEGIN_INFO_EXT;
+        beginInfo.buffer                             = _predicates[_frame]._buffer;
+        beginInfo.offset                             = sizeof(uint32_t) * _predicate[index];
+        _beginConditional(cmd, &beginInfo);
+    }
+    return true;
+}
+
+void OcclusionQueries::end_draw(VkCommandBuffer cmd, uint32_t index) {
+    if (_conditional && _predicate[index] != UINT32_MAX) {
+        _endConditional(cmd);
+    }
+}
+
+uint32_t OcclusionQueries::record_proxies(VkCommandBuffer cmd, VkPipelineLayout layout, const RenderableStore& renderables, const std::vector<uint32_t>& objects, const glm::mat4& viewproj) {
+    std::vector<RenderableHandle>& queried = _queried[_frame];
+    const RenderBounds* bounds             = renderables.bounds();
+    for (uint32_t index : objects) {
+        if (queried.size() == kMaxOcclusionQueries) {
+            break;
+        }
+        // the box around the bounding sphere. One reaching past the near plane is clipped and could
+        // miss samples of the object in front of the occluders, those objects stay unconditional
+        glm::mat4 box       = glm::scale(glm::translate(glm::mat4(1.f), bounds[index].center), glm::vec3(bounds[index].radius));
+        glm::mat4 transform = viewproj * box;
+        bool clipped        = false;
+        for (int i = 0; i < 8 && !clipped; i++) {
+            glm::vec4 clip = transform * glm::vec4((i & 1) ? 1.f : -1.f, (i & 2) ? 1.f : -1.f, (i & 4) ? 1.f : -1.f, 1.f);
+            clipped        = clip.w <= 0.f || clip.z < 0.f;
+        }
+        if (clipped) {
+            continue;
+        }
+
+        uint32_t query = _frame * kMaxOcclusionQueries + (uint32_t)queried.size();
+        vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &transform);
+        vkCmdBeginQuery(cmd, _pool, query, 0);
+        vkCmdDraw(cmd, 36, 1, 0, 0);
+        vkCmdEndQuery(cmd, _pool, query);
+        queried.push_back(renderables.handle(index));
+    }
+    return (uint32_t)queried.size();
+}
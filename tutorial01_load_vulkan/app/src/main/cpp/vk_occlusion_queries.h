@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include "vk_types.h"
+#include "vk_frame_allocator.h"
+#include "vk_renderables.h"
+
+// bounding box proxies one frame can query, objects past them are drawn unconditionally
+constexpr uint32_t kMaxOcclusionQueries = 1024;
+
+// Hardware occlusion queries for the draw per object path, the alternative to cull.comp on devices
+// with weak compute. After the pass's draws every expensive object gets its bounding box drawn, depth
+// tested without writes, inside a VK_QUERY_TYPE_OCCLUSION query, and a box that passed no samples
+// holds the object back in a later frame:
+// - with VK_EXT_conditional_rendering the results of the previous frame are copied into a predicate
+//   buffer on the GPU and the object's draw is predicated on them, nothing is read back for it
+// - without it the results are read on the CPU once the frame slot's fence has signaled, FRAME_OVERLAP
+//   frames late, and occluded objects aren't recorded at all
+// Either way an object coming into view shows up that many frames late, and nothing ever stalls.
+class OcclusionQueries {
+   public:
+    VkQueryPool _pool;  // one range of kMaxOcclusionQueries per frame in flight
+    bool _conditional;  // draws are predicated instead of skipped
+
+    // beginConditional and endConditional are null without VK_EXT_conditional_rendering
+    void init(VkDevice device, VmaAllocator allocator, PFN_vkCmdBeginConditionalRenderingEXT beginConditional, PFN_vkCmdEndConditionalRenderingEXT endConditional);
+    void cleanup();
+
+    // Outside the render pass, once the frame slot's fence has signaled. Reads the results of the frame
+    // that last used the slot and resets its queries, with conditional rendering it also copies the
+    // previous frame's results into the predicates. Returns how many of the read results were occluded
+    uint32_t begin_frame(VkCommandBuffer cmd, uint32_t frameNumber, const RenderableStore& renderables);
+    // before the draw of the renderable at index, false when it was occluded and has to be skipped.
+    // With conditional rendering the draw is predicated instead and end_draw has to follow it
+    bool begin_draw(VkCommandBuffer cmd, uint32_t index);
+    void end_draw(VkCommandBuffer cmd, uint32_t index);
+    // after the pass's draws, with a proxy pipeline of layout bound: one query per renderable of objects,
+    // up to kMaxOcclusionQueries. Returns the number of queries recorded
+    uint32_t record_proxies(VkCommandBuffer cmd, VkPipelineLayout layout, const RenderableStore& renderables, const std::vector<uint32_t>& objects, const glm::mat4& viewproj);
+
+   private:
+    VkDevice _device;
+    VmaAllocator _allocator;
+    PFN_vkCmdBeginConditionalRenderingEXT _beginConditional;
+    PFN_vkCmdEndConditionalRenderingEXT _endConditional;
+    uint32_t _frame;  // slot of the frame being recorded
+
+    AllocatedBuffer _predicates[FRAME_OVERLAP];             // 32 bit results of the previous frame's queries
+    std::vector<RenderableHandle> _queried[FRAME_OVERLAP];  // renderable of every query of the slot's frame
+    // per renderable of the frame being recorded
+    std::vector<uint32_t> _predicate;  // query of the previous frame, UINT32_MAX for none
+    std::vector<uint8_t> _occluded;
+};
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <cstring>
+#include "vk_pacing.h"
+
+const char* pacing_mode_name(PacingMode mode) {
+    switch (mode) {
+        case PacingMode::Fifo:
+            return "fifo";
+        case PacingMode::Mailbox:
+            return "mailbox";
+        case PacingMode::FifoRelaxed:
+            return "fifo relaxed";
+        case PacingMode::LowLatency:
+            return "low latency";
+    }
+    return "unknown";
+}
+
+bool parse_pacing_mode(const char* name, PacingMode& mode) {
+    // in the order of PacingMode
+    static const char* const kNames[] = {"fifo", "mailbox", "fifo-relaxed", "low-latency"};
+    for (uint32_t i = 0; i < sizeof(kNames) / sizeof(kNames[0]); i++) {
+        if (!strcmp(name, kNames[i])) {
+            mode = (PacingMode)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+VkPresentModeKHR choose_present_mode(PacingMode mode, const std::vector<VkPresentModeKHR>& supported) {
+    VkPresentModeKHR wanted = VK_PRESENT_MODE_FIFO_KHR;
+    if (mode == PacingMode::Mailbox) {
+        wanted = VK_PRESENT_MODE_MAILBOX_KHR;
+    } else if (mode == PacingMode::FifoRelaxed) {
+        wanted = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+    }
+    // low latency paces the CPU itself and keeps FIFO so every frame gets its vblank
+    if (std::find(supported.begin(), supported.end(), wanted) != supported.end()) {
+        return wanted;
+    }
+    return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+void FramePacer::init(Clock* clock, PacingMode mode, uint64_t refreshPeriodNs) {
+    _clock         = clock;
+    _mode          = mode;
+    _refreshPeriod = refreshPeriodNs;
+}
+
+uint64_t FramePacer::predicted_start_ns() const {
+    if (_lastPresent == 0 || _cpuWork == 0) {
+        return 0;
+    }
+    uint64_t work = _cpuWork + _gpuWork + kSafetyMarginNs;
+
+    // every frame still queued takes a vblank of its own, this one comes after them
+    uint64_t queued = _lastSubmittedFrame > _lastPresentedFrame ? _lastSubmittedFrame - _lastPresentedFrame : 0;
+    uint64_t vblank = _lastPresent + (queued + 1) * _refreshPeriod;
+
+    // the first vblank the frame can still make when it starts now
+    uint64_t earliestEnd = _clock->now_ns() + work;
+    if (vblank < earliestEnd) {
+        vblank += (earliestEnd - vblank + _refreshPeriod - 1) / _refreshPeriod * _refreshPeriod;
+    }
+    return vblank - work;
+}
+
+void FramePacer::begin_frame(uint32_t frame) {
+    if (_mode == PacingMode::LowLatency) {
+        uint64_t start = predicted_start_ns();
+        if (start > _clock->now_ns()) {
+            _clock->sleep_until(start);
+        }
+    }
+    FrameTiming& timing = slot(frame);
+    timing              = {};
+    timing.frame        = frame;
+    timing.startNs      = _clock->now_ns();
+}
+
+void FramePacer::submitted(uint32_t frame) {
+    FrameTiming& timing = slot(frame);
+    timing.submitNs     = _clock->now_ns();
+    _cpuWork            = smooth_ns(_cpuWork, timing.submitNs - timing.startNs);
+    _lastSubmittedFrame = frame;
+}
+
+void FramePacer::gpu_finished(uint32_t frame, uint64_t gpuNs) {
+    FrameTiming& timing = slot(frame);
+    if (timing.frame != frame) {
+        return;
+    }
+    timing.gpuNs = gpuNs;
+    _gpuWork     = smooth_ns(_gpuWork, gpuNs);
+}
+
+void FramePacer::presented(uint32_t frame, uint64_t presentNs) {
+    FrameTiming& timing = slot(frame);
+    // too old, the history slot already holds a newer frame
+    if (timing.frame != frame || timing.submitNs == 0 || presentNs < timing.submitNs) {
+        return;
+    }
+    timing.presentNs = presentNs;
+    _lastLatency     = presentNs - timing.submitNs;
+    _avgLatency      = smooth_ns(_avgLatency, _lastLatency);
+
+    if (presentNs > _lastPresent) {
+        _lastPresent        = presentNs;
+        _lastPresentedFrame = frame;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include "vk_types.h"
+#include "vk_timer.h"
+
+enum class PacingMode {
+    Fifo,         // vsync, the CPU runs up to FRAME_OVERLAP frames ahead
+    Mailbox,      // the newest frame replaces the queued one, no tearing
+    FifoRelaxed,  // vsync, but a late frame tears instead of waiting for the next vblank
+    LowLatency,   // vsync, the CPU starts each frame as late as it can and still make its vblank
+};
+
+const char* pacing_mode_name(PacingMode mode);
+// the command line spelling of a mode: fifo, mailbox, fifo-relaxed or low-latency. False for anything else
+bool parse_pacing_mode(const char* name, PacingMode& mode);
+
+// present mode for mode among the modes the surface supports, falls back to FIFO which is always there
+VkPresentModeKHR choose_present_mode(PacingMode mode, const std::vector<VkPresentModeKHR>& supported);
+
+struct FrameTiming {
+    uint32_t frame;
+    uint64_t startNs;    // CPU starts recording
+    uint64_t submitNs;   // vkQueueSubmit
+    uint64_t gpuNs;      // GPU execution time from timestamp queries, 0 until known
+    uint64_t presentNs;  // on screen, or the GPU finished when there is no display timing. 0 until known
+};
+
+// Frame timing history and the low latency start prediction.
+// All times come from the Clock passed to init so pacing can be driven by a FakeClock.
+class FramePacer {
+   public:
+    static constexpr uint32_t kHistory = 64;
+    // slack kept between the predicted end of a frame and its vblank
+    static constexpr uint64_t kSafetyMarginNs = 2000000;
+
+    void init(Clock* clock, PacingMode mode, uint64_t refreshPeriodNs);
+
+    // in LowLatency mode sleeps until the predicted start point first
+    void begin_frame(uint32_t frame);
+    void submitted(uint32_t frame);
+    void gpu_finished(uint32_t frame, uint64_t gpuNs);
+    void presented(uint32_t frame, uint64_t presentNs);
+
+    // when the next frame should start, 0 when there isn't enough history to predict it
+    uint64_t predicted_start_ns() const;
+
+    // queue to present latency of the latest presented frame
+    uint64_t last_latency_ns() const { return _lastLatency; }
+    // moving average of the queue to present latency
+    uint64_t average_latency_ns() const { return _avgLatency; }
+    const FrameTiming& timing(uint32_t frame) const { return _history[frame % kHistory]; }
+
+    PacingMode mode() const { return _mode; }
+    uint64_t refresh_period_ns() const { return _refreshPeriod; }
+
+   private:
+    FrameTiming& slot(uint32_t frame) { return _history[frame % kHistory]; }
+
+    Clock* _clock;
+    PacingMode _mode;
+    uint64_t _refreshPeriod;
+
+    uint64_t _cpuWork{0};  // moving average of start to submit
+    uint64_t _gpuWork{0};  // moving average of GPU execution
+    uint64_t _lastPresent{0};
+    uint32_t _lastPresentedFrame{0};
+    uint32_t _lastSubmittedFrame{0};
+    uint64_t _lastLatency{0};
+    uint64_t _avgLatency{0};
+
+    FrameTiming _history[kHistory] = {};
+};
@@ -0,0 +1,13 @@
+#pragma once
+#include "vk_types.h"
+
+// The window the engine presents to, implemented by each front-end.
+// The engine core only sees the surface and its size, never the native window type.
+class PlatformWindow {
+   public:
+    virtual ~PlatformWindow() = default;
+
+    virtual VkSurfaceKHR create_surface(VkInstance instance) = 0;
+    // current size in pixels
+    virtual VkExtent2D extent() const = 0;
+};
@@ -0,0 +1,214 @@
+#include "vk_queues.h"
+#include "log.h"
+
+namespace {
+
+// the first family with all of want and none of avoid, UINT32_MAX for none
+uint32_t find_family(const std::vector<VkQueueFamilyProperties>& families, VkQueueFlags want, VkQueueFlags avoid) {
+    for (uint32_t i = 0; i < (uint32_t)families.size(); i++) {
+        VkQueueFlags flags = families[i].queueFlags;
+        if (families[i].queueCount > 0 && (flags & want) == want && (flags & avoid) == 0) {
+            return i;
+        }
+    }
+    return UINT32_MAX;
+}
+
+}  // namespace
+
+vkutil::QueueTopology vkutil::choose_queue_topology(const std::vector<VkQueueFamilyProperties>& families, uint32_t graphicsFamily) {
+    QueueTopology topology     = {};
+    topology.graphicsFamily    = graphicsFamily;
+    topology.computeFamily     = graphicsFamily;
+    topology.transferFamily    = graphicsFamily;
+    topology.dedicatedTransfer = false;
+
+    uint32_t compute = find_family(families, VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT);
+    if (compute != UINT32_MAX) {
+        topology.computeFamily = compute;
+    }
+    // a compute family can copy as well, even when it doesn't say so
+    uint32_t transfer = find_family(families, VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
+    if (transfer != UINT32_MAX) {
+        topology.transferFamily    = transfer;
+        topology.dedicatedTransfer = true;
+    } else if (compute != UINT32_MAX) {
+        topology.transferFamily = compute;
+    }
+    return topology;
+}
+
+void vkutil::QueueSubmitter::init(VkDevice device, const QueueTopology& topology, PFN_vkGetSemaphoreCounterValueKHR getValue, PFN_vkWaitSemaphoresKHR wait) {
+    _device   = device;
+    _topology = topology;
+
+    uint32_t families[3] = {topology.graphicsFamily, topology.computeFamily, topology.transferFamily};
+    for (int i = 0; i < 3; i++) {
+        Context& context = _contexts[i];
+        context.family   = families[i];
+        vkGetDeviceQueue(_device, context.family, 0, &context.queue);
+
+        // one queue, one timeline
+        context.timeline = &_timelines[i];
+        for (int j = 0; j < i; j++) {
+            if (families[j] == families[i]) {
+                context.timeline = _contexts[j].timeline;
+                break;
+            }
+        }
+        if (context.timeline == &_timelines[i]) {
+            _timelines[i].init(_device, getValue, wait);
+        }
+
+        // command buffers are allocated per submit and freed once it is done
+        VkCommandPoolCreateInfo poolInfo = {};
+        poolInfo.sType                   = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.flags                   = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        poolInfo.queueFamilyIndex        = context.family;
+        VK_CHECK(vkCreateCommandPool(_device, &poolInfo, nullptr, &context.pool));
+    }
+    LOGI("QueueSubmitter: graphics family %u, compute family %u%s, transfer family %u%s, %s", topology.graphicsFamily, topology.computeFamily, topology.async_compute() ? " (async)" : "", topology.transferFamily, topology.dedicatedTransfer ? " (dedicated)" : topology.async_transfer() ? " (async)" : "", _timelines[0]._timeline ? "timeline semaphores" : "fences");
+}
+
+void vkutil::QueueSubmitter::cleanup() {
+    // runs the last retirements, the command buffers go with their pools
+    for (int i = 0; i < 3; i++) {
+        if (_contexts[i].timeline == &_timelines[i]) {
+            _timelines[i].cleanup();
+        }
+    }
+    for (Context& context : _contexts) {
+        vkDestroyCommandPool(_device, context.pool, nullptr);
+    }
+    for (VkSemaphore semaphore : _freeSemaphores) {
+        vkDestroySemaphore(_device, semaphore, nullptr);
+    }
+    _freeSemaphores.clear();
+}
+
+VkQueue vkutil::QueueSubmitter::queue(QueueKind kind) const {
+    return _contexts[(int)kind].queue;
+}
+
+uint32_t vkutil::QueueSubmitter::family(QueueKind kind) const {
+    return _contexts[(int)kind].family;
+}
+
+vkutil::GpuTimeline& vkutil::QueueSubmitter::timeline(QueueKind kind) {
+    return *_contexts[(int)kind].timeline;
+}
+
+VkCommandBuffer vkutil::QueueSubmitter::begin(Context& context) {
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool                 = context.pool;
+    allocInfo.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount          = 1;
+    VkCommandBuffer cmd;
+    VK_CHECK(vkAllocateCommandBuffers(_device, &allocInfo, &cmd));
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK(vkBeginCommandBuffer(cmd, &beginInfo));
+    return cmd;
+}
+
+void vkutil::QueueSubmitter::record_handoff(VkCommandBuffer cmd, const QueueHandoff& handoff, uint32_t srcFamily, uint32_t dstFamily, bool release) {
+    if (handoff.images.empty() && handoff.buffers.empty()) {
+        return;
+    }
+    // the layout change happens once, between release and acquire. The release makes the writes
+    // available and the acquire visible, each side leaves out the other side's access and stage
+    bool ownership                             = srcFamily != dstFamily;
+    uint32_t srcIndex                          = ownership ? srcFamily : VK_QUEUE_FAMILY_IGNORED;
+    uint32_t dstIndex                          = ownership ? dstFamily : VK_QUEUE_FAMILY_IGNORED;
+    std::vector<VkImageMemoryBarrier> images   = handoff.images;
+    std::vector<VkBufferMemoryBarrier> buffers = handoff.buffers;
+    for (VkImageMemoryBarrier& barrier : images) {
+        barrier.srcQueueFamilyIndex = srcIndex;
+        barrier.dstQueueFamilyIndex = dstIndex;
+        barrier.srcAccessMask       = ownership && !release ? 0 : barrier.srcAccessMask;
+        barrier.dstAccessMask       = ownership && release ? 0 : barrier.dstAccessMask;
+    }
+    for (VkBufferMemoryBarrier& barrier : buffers) {
+        barrier.srcQueueFamilyIndex = srcIndex;
+        barrier.dstQueueFamilyIndex = dstIndex;
+        barrier.srcAccessMask       = ownership && !release ? 0 : barrier.srcAccessMask;
+        barrier.dstAccessMask       = ownership && release ? 0 : barrier.dstAccessMask;
+    }
+    VkPipelineStageFlags srcStage = ownership && !release ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : handoff.srcStage;
+    VkPipelineStageFlags dstStage = ownership && release ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : handoff.dstStage;
+    vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 0, nullptr, (uint32_t)buffers.size(), buffers.data(), (uint32_t)images.size(), images.data());
+}
+
+uint64_t vkutil::QueueSubmitter::submit(QueueKind kind, std::function<void(VkCommandBuffer cmd)>&& function, const QueueHandoff& handoff) {
+    collect();
+    Context& source   = _contexts[(int)kind];
+    Context& graphics = _contexts[(int)QueueKind::graphics];
+    bool acquire      = source.family != graphics.family && (!handoff.images.empty() || !handoff.buffers.empty());
+
+    VkCommandBuffer cmd = begin(source);
+    function(cmd);
+    record_handoff(cmd, handoff, source.family, graphics.family, true);
+    VK_CHECK(vkEndCommandBuffer(cmd));
+
+    // a semaphore of its own, a binary semaphore can't be signaled again before its wait ran
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    if (acquire && _freeSemaphores.empty()) {
+        VkSemaphoreCreateInfo semaphoreInfo = {};
+        semaphoreInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        VK_CHECK(vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &semaphore));
+    } else if (acquire) {
+        semaphore = _freeSemaphores.back();
+        _freeSemaphores.pop_back();
+    }
+
+    VkSubmitInfo submit         = {};
+    submit.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit.commandBufferCount   = 1;
+    submit.pCommandBuffers      = &cmd;
+    submit.signalSemaphoreCount = acquire ? 1 : 0;
+    submit.pSignalSemaphores    = &semaphore;
+    uint64_t value              = source.timeline->submit(source.queue, submit);
+    VkDevice device             = _device;
+    VkCommandPool pool          = source.pool;
+    source.timeline->retire(value, [=]() { vkFreeCommandBuffers(device, pool, 1, &cmd); });
+    if (!acquire) {
+        return value;
+    }
+
+    // the graphics queue only waits for the semaphore where the resources are first used
+    VkCommandBuffer acquireCmd = begin(graphics);
+    record_handoff(acquireCmd, handoff, source.family, graphics.family, false);
+    VK_CHECK(vkEndCommandBuffer(acquireCmd));
+
+    VkSubmitInfo acquireSubmit       = {};
+    acquireSubmit.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    acquireSubmit.waitSemaphoreCount = 1;
+    acquireSubmit.pWaitSemaphores    = &semaphore;
+    acquireSubmit.pWaitDstStageMask  = &handoff.dstStage;
+    acquireSubmit.commandBufferCount = 1;
+    acquireSubmit.pCommandBuffers    = &acquireCmd;
+    uint64_t acquired                = graphics.timeline->submit(graphics.queue, acquireSubmit);
+    VkCommandPool graphicsPool       = graphics.pool;
+    graphics.timeline->retire(acquired, [=]() {
+        vkFreeCommandBuffers(device, graphicsPool, 1, &acquireCmd);
+        _freeSemaphores.push_back(semaphore);
+    });
+    return value;
+}
+
+void vkutil::QueueSubmitter::submit_and_wait(QueueKind kind, std::function<void(VkCommandBuffer cmd)>&& function, const QueueHandoff& handoff) {
+    uint64_t value = submit(kind, std::move(function), handoff);
+    timeline(kind).wait(value);
+    collect();
+}
+
+void vkutil::QueueSubmitter::collect() {
+    for (int i = 0; i < 3; i++) {
+        if (_contexts[i].timeline == &_timelines[i]) {
+            _timelines[i].collect();
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "vk_types.h"
+#include "vk_timeline.h"
+
+namespace vkutil {
+
+// the queue families the engine submits to, families that don't exist fall back to the graphics one
+struct QueueTopology {
+    uint32_t graphicsFamily;
+    uint32_t computeFamily;   // compute without graphics if there is one
+    uint32_t transferFamily;  // transfer only if there is one, then transfer without graphics
+    bool dedicatedTransfer;   // transferFamily can do neither graphics nor compute, the copy engine
+
+    bool async_compute() const { return computeFamily != graphicsFamily; }
+    bool async_transfer() const { return transferFamily != graphicsFamily; }
+};
+
+// picks the compute and transfer families next to graphicsFamily. Works on the properties alone, so
+// it runs without a device: a single family like on most mobile GPUs gives graphicsFamily everywhere
+QueueTopology choose_queue_topology(const std::vector<VkQueueFamilyProperties>& families, uint32_t graphicsFamily);
+
+enum class QueueKind {
+    graphics,
+    compute,
+    transfer,
+};
+
+// Resources written on one queue and used on the graphics queue. Each barrier holds the layout change
+// and accesses as if everything ran on one queue, the queue family indices are filled in on submit.
+// With separate families ownership moves in a release barrier on the source queue and the matching
+// acquire barrier on the graphics queue, with one family the barriers are recorded as they are
+struct QueueHandoff {
+    std::vector<VkImageMemoryBarrier> images;
+    std::vector<VkBufferMemoryBarrier> buffers;
+    VkPipelineStageFlags srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+};
+
+// Submissions to the queues of a topology, each queue with its own command pool and GpuTimeline.
+// Every submit gets a command buffer of its own that is freed once the queue's timeline passes it.
+// Not thread safe, like the upload context it replaces
+class QueueSubmitter {
+   public:
+    QueueTopology _topology;
+
+    // the device has to have a queue in every family of topology, vk-bootstrap creates one per family.
+    // getValue and wait are null without timeline semaphores, see GpuTimeline
+    void init(VkDevice device, const QueueTopology& topology, PFN_vkGetSemaphoreCounterValueKHR getValue, PFN_vkWaitSemaphoresKHR wait);
+    // the device has to be idle
+    void cleanup();
+
+    VkQueue queue(QueueKind kind) const;
+    uint32_t family(QueueKind kind) const;
+    // shared by the kinds of one family, the frames go through the graphics one
+    GpuTimeline& timeline(QueueKind kind);
+
+    // Records function on kind's queue and submits it without waiting, returns the value of kind's
+    // timeline the commands reach. For another family the graphics queue acquires the resources of
+    // handoff in a second submit that waits on a semaphore the first one signals, at handoff.dstStage
+    // only, so frames already submitted keep rendering while the copy engine or async compute works.
+    // Graphics submits after this one see the resources
+    uint64_t submit(QueueKind kind, std::function<void(VkCommandBuffer cmd)>&& function, const QueueHandoff& handoff = {});
+    // submit and block until kind's commands are done
+    void submit_and_wait(QueueKind kind, std::function<void(VkCommandBuffer cmd)>&& function, const QueueHandoff& handoff = {});
+    // frees what finished submits used, never waits
+    void collect();
+
+   private:
+    struct Context {
+        VkQueue queue;
+        uint32_t family;
+        VkCommandPool pool;
+        GpuTimeline* timeline;  // of the first kind with this family
+    };
+    VkDevice _device;
+    Context _contexts[3];  // by QueueKind, contexts of the same family share the queue
+    GpuTimeline _timelines[3];
+    // a binary semaphore per handoff to another family, back here once the acquire is done
+    std::vector<VkSemaphore> _freeSemaphores;
+
+    VkCommandBuffer begin(Context& context);
+    void record_handoff(VkCommandBuffer cmd, const QueueHandoff& handoff, uint32_t srcFamily, uint32_t dstFamily, bool release);
+};
+
+}  // namespace vkutil
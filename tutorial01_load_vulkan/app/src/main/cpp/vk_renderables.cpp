@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include "vk_renderables.h"
+
+RenderBounds RenderBounds::transformed(const glm::mat4& transform) const {
+    float scale2 = std::max(glm::dot(glm::vec3(transform[0]), glm::vec3(transform[0])), std::max(glm::dot(glm::vec3(transform[1]), glm::vec3(transform[1])), glm::dot(glm::vec3(transform[2]), glm::vec3(transform[2]))));
+    return {glm::vec3(transform * glm::vec4(center, 1.f)), radius * sqrtf(scale2)};
+}
+
+RenderableHandle RenderableStore::insert(const RenderableDesc& desc) {
+    uint32_t slot;
+    if (_freeSlots.empty()) {
+        slot = (uint32_t)_slotIndex.size();
+        _slotIndex.push_back(0);
+        _slotGeneration.push_back(1);
+    } else {
+        slot = _freeSlots.back();
+        _freeSlots.pop_back();
+    }
+    _slotIndex[slot] = size();
+
+    _transforms.push_back(desc.transform);
+    _bounds.push_back(desc.bounds);
+    _meshes.push_back(desc.mesh);
+    _materials.push_back(desc.material);
+    _flags.push_back(desc.flags);
+    _lods.push_back(0);
+    _denseSlots.push_back(slot);
+    return {slot, _slotGeneration[slot]};
+}
+
+void RenderableStore::insert(const std::vector<RenderableDesc>& descs, std::vector<RenderableHandle>* outHandles) {
+    reserve(size() + (uint32_t)descs.size());
+    if (outHandles) {
+        outHandles->reserve(outHandles->size() + descs.size());
+    }
+    for (const RenderableDesc& desc : descs) {
+        RenderableHandle handle = insert(desc);
+        if (outHandles) {
+            outHandles->push_back(handle);
+        }
+    }
+}
+
+bool RenderableStore::remove(RenderableHandle handle) {
+    if (!valid(handle)) {
+        return false;
+    }
+    uint32_t index = _slotIndex[handle.slot];
+    uint32_t last  = size() - 1;
+    if (index != last) {
+        _transforms[index] = _transforms[last];
+        _bounds[index]     = _bounds[last];
+        _meshes[index]     = _meshes[last];
+        _materials[index]  = _materials[last];
+        _flags[index]      = _flags[last];
+        _lods[index]       = _lods[last];
+        _denseSlots[index] = _denseSlots[last];
+        // the moved renderable's handle follows it
+        _slotIndex[_denseSlots[index]] = index;
+    }
+    _transforms.pop_back();
+    _bounds.pop_back();
+    _meshes.pop_back();
+    _materials.pop_back();
+    _flags.pop_back();
+    _lods.pop_back();
+    _denseSlots.pop_back();
+
+    // skip 0 when the counter wraps, it marks a handle that never was valid
+    _slotGeneration[handle.slot] = std::max(1u, _slotGeneration[handle.slot] + 1);
+    _freeSlots.push_back(handle.slot);
+    return true;
+}
+
+void RenderableStore::clear() {
+    // bump every live slot so outstanding handles go invalid
+    for (uint32_t slot : _denseSlots) {
+        _slotGeneration[slot] = std::max(1u, _slotGeneration[slot] + 1);
+        _freeSlots.push_back(slot);
+    }
+    _transforms.clear();
+    _bounds.clear();
+    _meshes.clear();
+    _materials.clear();
+    _flags.clear();
+    _lods.clear();
+    _denseSlots.clear();
+}
+
+void RenderableStore::reserve(uint32_t count) {
+    _transforms.reserve(count);
+    _bounds.reserve(count);
+    _meshes.reserve(count);
+    _materials.reserve(count);
+    _flags.reserve(count);
+    _lods.reserve(count);
+    _denseSlots.reserve(count);
+}
+
+bool RenderableStore::valid(RenderableHandle handle) const {
+    return handle.generation != 0 && handle.slot < _slotGeneration.size() && _slotGeneration[handle.slot] == handle.generation;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+// bounding sphere
+struct RenderBounds {
+    glm::vec3 center;
+    float radius;
+
+    // the sphere around this one after transform, scaled by the largest axis scale
+    RenderBounds transformed(const glm::mat4& transform) const;
+};
+
+enum RenderableFlags : uint32_t {
+    kRenderableHidden = 1u << 0,  // stays in the store but isn't drawn
+};
+
+// Refers to a renderable across insertions and removals of others, unlike its index in the
+// arrays. A removed renderable's handle stays invalid even after its slot is reused.
+struct RenderableHandle {
+    uint32_t slot;
+    uint32_t generation;  // 0 never names a renderable
+};
+
+struct RenderableDesc {
+    uint32_t mesh;      // VulkanEngine::_meshById
+    uint32_t material;  // VulkanEngine::_materialById
+    glm::mat4 transform;
+    RenderBounds bounds;  // world space
+    uint32_t flags;
+};
+
+// Renderables as parallel dense arrays, one per field, so a pass over bounds or ids only pulls
+// those through the cache. Removal moves the last renderable into the hole, the arrays stay
+// dense but the order isn't kept. Handles map to the current index through a slot table.
+class RenderableStore {
+   public:
+    RenderableHandle insert(const RenderableDesc& desc);
+    // appends all of descs, outHandles gets their handles in order when not null
+    void insert(const std::vector<RenderableDesc>& descs, std::vector<RenderableHandle>* outHandles = nullptr);
+    // false when handle doesn't name a renderable anymore
+    bool remove(RenderableHandle handle);
+    void clear();
+    void reserve(uint32_t count);
+
+    bool valid(RenderableHandle handle) const;
+    // index into the arrays, only good until the next removal
+    uint32_t index(RenderableHandle handle) const { return _slotIndex[handle.slot]; }
+    RenderableHandle handle(uint32_t index) const { return {_denseSlots[index], _slotGeneration[_denseSlots[index]]}; }
+    uint32_t size() const { return (uint32_t)_transforms.size(); }
+
+    glm::mat4* transforms() { return _transforms.data(); }
+    const glm::mat4* transforms() const { return _transforms.data(); }
+    RenderBounds* bounds() { return _bounds.data(); }
+    const RenderBounds* bounds() const { return _bounds.data(); }
+    uint32_t* meshes() { return _meshes.data(); }
+    const uint32_t* meshes() const { return _meshes.data(); }
+    uint32_t* materials() { return _materials.data(); }
+    const uint32_t* materials() const { return _materials.data(); }
+    uint32_t* flags() { return _flags.data(); }
+    const uint32_t* flags() const { return _flags.data(); }
+    // level of detail of the mesh the renderable draws with, 0 after insertion
+    uint32_t* lods() { return _lods.data(); }
+    const uint32_t* lods() const { return _lods.data(); }
+
+   private:
+    std::vector<glm::mat4> _transforms;
+    std::vector<RenderBounds> _bounds;
+    std::vector<uint32_t> _meshes;
+    std::vector<uint32_t> _materials;
+    std::vector<uint32_t> _flags;
+    std::vector<uint32_t> _lods;
+    std::vector<uint32_t> _denseSlots;  // slot of every renderable
+
+    std::vector<uint32_t> _slotIndex;
+    std::vector<uint32_t> _slotGeneration;  // bumped on removal
+    std::vector<uint32_t> _freeSlots;
+};
@@ -0,0 +1,414 @@
+#include <algorithm>
+#include "vk_rendergraph.h"
+#include "vk_renderpass.h"
+#include "vulkan_wrapper.h"
+#include "vk_init.h"
+#include "log.h"
+
+namespace vkutil {
+
+static const VkAccessFlags kWriteAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+static const VkPipelineStageFlags kDepthStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+static const VkPipelineStageFlags kShaderStages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+AccessInfo access_info(ImageAccess access) {
+    switch (access) {
+        case ImageAccess::ColorAttachment:
+            return {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, true};
+        case ImageAccess::DepthAttachment:
+            return {kDepthStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, true};
+        case ImageAccess::DepthRead:
+            return {kDepthStages | kShaderStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, false};
+        case ImageAccess::Sampled:
+            return {kShaderStages, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, false};
+        case ImageAccess::StorageRead:
+            return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, false};
+        case ImageAccess::StorageWrite:
+            return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, true};
+        case ImageAccess::TransferSrc:
+            return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, false};
+        case ImageAccess::TransferDst:
+            return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT, true};
+    }
+    return {VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, 0, true};
+}
+
+static bool is_depth_format(VkFormat format) {
+    return format == VK_FORMAT_D16_UNORM || format == VK_FORMAT_D32_SFLOAT || format == VK_FORMAT_X8_D24_UNORM_PACK32 || has_stencil(format);
+}
+
+uint32_t RenderGraph::create_image(const std::string& name, VkFormat format, VkExtent2D extent, VkSampleCountFlagBits samples) {
+    GraphImage image = {};
+    image.name       = name;
+    image.format     = format;
+    image.extent     = extent;
+    image.samples    = samples;
+    image.imported   = false;
+    _images.push_back(image);
+    return (uint32_t)_images.size() - 1;
+}
+
+uint32_t RenderGraph::import_image(const std::string& name, VkFormat format, VkExtent2D extent, VkImageLayout initialLayout, VkPipelineStageFlags initialStage, VkAccessFlags initialAccess, VkImageLayout finalLayout) {
+    GraphImage image    = {};
+    image.name          = name;
+    image.format        = format;
+    image.extent        = extent;
+    image.samples       = VK_SAMPLE_COUNT_1_BIT;
+    image.imported      = true;
+    image.output        = true;
+    image.initialLayout = initialLayout;
+    image.initialStage  = initialStage;
+    image.initialAccess = initialAccess;
+    image.finalLayout   = finalLayout;
+    _images.push_back(image);
+    return (uint32_t)_images.size() - 1;
+}
+
+void RenderGraph::mark_output(uint32_t resource) {
+    _images[resource].output = true;
+}
+
+uint32_t RenderGraph::add_pass(const std::string& name, std::function<void(VkCommandBuffer cmd)>&& execute) {
+    GraphPass pass;
+    pass.name    = name;
+    pass.execute = std::move(execute);
+    pass.alive   = true;
+    _passes.push_back(std::move(pass));
+    return (uint32_t)_passes.size() - 1;
+}
+
+void RenderGraph::use(uint32_t pass, uint32_t resource, ImageAccess access) {
+    _passes[pass].accesses.push_back({resource, access});
+}
+
+void RenderGraph::set_imported_image(uint32_t resource, VkImage image, VkImageView view) {
+    _images[resource].image = image;
+    _images[resource].view  = view;
+}
+
+bool RenderGraph::compile() {
+    cull_passes();
+
+    // lifetimes, usage and size estimates of the images in schedule order
+    _schedule.clear();
+    for (GraphImage& image : _images) {
+        image.usage          = 0;
+        image.firstUse       = -1;
+        image.lastUse        = -1;
+        image.size           = (VkDeviceSize)image.extent.width * image.extent.height * image.samples * format_size(image.format);
+        image.alignment      = 1;
+        image.memoryTypeBits = ~0u;
+    }
+    for (uint32_t p = 0; p < _passes.size(); p++) {
+        if (!_passes[p].alive) {
+            continue;
+        }
+        int position = (int)_schedule.size();
+        _schedule.push_back({p, {}});
+        for (auto& use : _passes[p].accesses) {
+            GraphImage& image = _images[use.first];
+            image.usage |= access_info(use.second).usage;
+            if (image.firstUse < 0) {
+                image.firstUse = position;
+            }
+            image.lastUse = position;
+        }
+    }
+
+    assign_memory();
+    return compute_barriers();
+}
+
+void RenderGraph::cull_passes() {
+    // walk backwards keeping a pass when it writes something a later pass or the outside reads
+    std::vector<bool> needed(_images.size(), false);
+    for (uint32_t i = 0; i < _images.size(); i++) {
+        needed[i] = _images[i].output;
+    }
+    for (int p = (int)_passes.size() - 1; p >= 0; p--) {
+        GraphPass& pass = _passes[p];
+        pass.alive      = false;
+        for (auto& use : pass.accesses) {
+            if (access_info(use.second).write && needed[use.first]) {
+                pass.alive = true;
+            }
+        }
+        if (!pass.alive) {
+            continue;
+        }
+        for (auto& use : pass.accesses) {
+            if (!access_info(use.second).write) {
+                needed[use.first] = true;
+            }
+        }
+    }
+}
+
+void RenderGraph::assign_memory() {
+    _blocks.clear();
+
+    // greedy first fit, largest images first so the big ones set the block sizes
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < _images.size(); i++) {
+        if (!_images[i].imported && _images[i].firstUse >= 0) {
+            order.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return _images[a].size > _images[b].size; });
+
+    for (uint32_t index : order) {
+        GraphImage& image = _images[index];
+        bool placed       = false;
+        for (uint32_t b = 0; b < _blocks.size() && !placed; b++) {
+            MemoryBlock& block = _blocks[b];
+            if ((block.memoryTypeBits & image.memoryTypeBits) == 0) {
+                continue;
+            }
+            bool overlaps = false;
+            for (uint32_t other : block.images) {
+                if (_images[other].firstUse <= image.lastUse && image.firstUse <= _images[other].lastUse) {
+                    overlaps = true;
+                    break;
+                }
+            }
+            if (overlaps) {
+                continue;
+            }
+            block.size      = std::max(block.size, image.size);
+            block.alignment = std::max(block.alignment, image.alignment);
+            block.memoryTypeBits &= image.memoryTypeBits;
+            block.images.push_back(index);
+            image.block = b;
+            placed      = true;
+        }
+        if (!placed) {
+            image.block = (uint32_t)_blocks.size();
+            _blocks.push_back({image.size, image.alignment, image.memoryTypeBits, {index}, VK_NULL_HANDLE});
+        }
+    }
+}
+
+bool RenderGraph::compute_barriers() {
+    struct ImageState {
+        VkImageLayout layout;
+        VkPipelineStageFlags writeStage;    // stage of the last write
+        VkAccessFlags writeAccess;          // access of the last write
+        VkPipelineStageFlags readStages;    // stages that read since the last write
+        VkPipelineStageFlags visibleStages; // stages the last write was made visible to
+        bool touched;
+    };
+    std::vector<ImageState> states(_images.size());
+    for (uint32_t i = 0; i < _images.size(); i++) {
+        states[i]        = {};
+        states[i].layout = _images[i].imported ? _images[i].initialLayout : VK_IMAGE_LAYOUT_UNDEFINED;
+    }
+
+    _finalBarriers.clear();
+    for (CompiledPass& compiled : _schedule) {
+        compiled.barriers.clear();
+        GraphPass& pass = _passes[compiled.pass];
+
+        for (auto& use : pass.accesses) {
+            const GraphImage& image = _images[use.first];
+            ImageState& state       = states[use.first];
+            AccessInfo info         = access_info(use.second);
+
+            GraphBarrier barrier = {use.first, 0, 0, info.stage, info.access, state.layout, info.layout};
+            bool needed          = false;
+
+            if (!state.touched) {
+                if (!image.imported && !info.write) {
+                    LOGE("render graph: pass %s reads %s before anything wrote it", pass.name.c_str(), image.name.c_str());
+                    return false;
+                }
+                if (image.imported) {
+                    // wait for whoever handed the image to the graph, a layout transition also has to
+                    // wait for its writes to be available
+                    barrier.srcStage  = image.initialStage;
+                    barrier.srcAccess = image.initialAccess;
+                    needed            = state.layout != info.layout;
+                } else {
+                    // the memory may still be in use by the image that occupied it before
+                    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                    barrier.srcStage  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+                    int previousUse   = -1;
+                    for (uint32_t other : _blocks[image.block].images) {
+                        if (_images[other].lastUse < image.firstUse && _images[other].lastUse > previousUse) {
+                            previousUse       = _images[other].lastUse;
+                            barrier.srcStage  = states[other].writeStage | states[other].readStages;
+                            barrier.srcAccess = states[other].writeAccess;
+                        }
+                    }
+                    needed = true;
+                }
+            } else if (info.write || state.layout != info.layout) {
+                // write after read/write, or a layout change: wait for every earlier access
+                barrier.srcStage  = state.writeStage | state.readStages;
+                barrier.srcAccess = state.visibleStages ? 0 : state.writeAccess;
+                needed            = true;
+            } else if ((state.visibleStages & info.stage) != info.stage && state.writeAccess) {
+                // read after write in the same layout, only when the write isn't visible to this stage yet
+                barrier.srcStage  = state.writeStage;
+                barrier.srcAccess = state.writeAccess;
+                needed            = true;
+            }
+
+            if (needed) {
+                if (barrier.srcStage == 0) {
+                    barrier.srcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+                }
+                compiled.barriers.push_back(barrier);
+            }
+
+            state.touched = true;
+            state.layout  = info.layout;
+            if (info.write) {
+                state.writeStage    = info.stage;
+                state.writeAccess   = info.access & kWriteAccessMask;
+                state.readStages    = 0;
+                state.visibleStages = 0;
+            } else {
+                state.readStages |= info.stage;
+                if (needed) {
+                    state.visibleStages |= info.stage;
+                }
+            }
+        }
+    }
+
+    // hand imported images back in the layout their owner expects
+    for (uint32_t i = 0; i < _images.size(); i++) {
+        const GraphImage& image = _images[i];
+        ImageState& state       = states[i];
+        if (!image.imported || !state.touched || state.layout == image.finalLayout) {
+            continue;
+        }
+        _finalBarriers.push_back({i, state.writeStage | state.readStages, state.writeAccess, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, state.layout, image.finalLayout});
+    }
+    return true;
+}
+
+VkDeviceSize RenderGraph::aliased_memory() const {
+    VkDeviceSize total = 0;
+    for (const MemoryBlock& block : _blocks) {
+        total += block.size;
+    }
+    return total;
+}
+
+VkDeviceSize RenderGraph::unaliased_memory() const {
+    VkDeviceSize total = 0;
+    for (const GraphImage& image : _images) {
+        if (!image.imported && image.firstUse >= 0) {
+            total += image.size;
+        }
+    }
+    return total;
+}
+
+bool RenderGraph::realize(VkDevice device, VmaAllocator allocator) {
+    // create the images first, their real memory requirements replace the estimates
+    for (GraphImage& image : _images) {
+        if (image.imported || image.firstUse < 0) {
+            continue;
+        }
+        VkImageCreateInfo img_info = vkinit::image_create_info(image.format, image.usage, {image.extent.width, image.extent.height, 1});
+        img_info.samples           = image.samples;
+        VK_CHECK(vkCreateImage(device, &img_info, nullptr, &image.image));
+
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(device, image.image, &requirements);
+        image.size           = requirements.size;
+        image.alignment      = requirements.alignment;
+        image.memoryTypeBits = requirements.memoryTypeBits;
+    }
+
+    // the real sizes can change the packing, and with it the dependencies between aliased images
+    assign_memory();
+    if (!compute_barriers()) {
+        return false;
+    }
+
+    for (MemoryBlock& block : _blocks) {
+        VkMemoryRequirements requirements = {block.size, block.alignment, block.memoryTypeBits};
+        VmaAllocationCreateInfo allocInfo = {};
+        allocInfo.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
+        VkResult result                   = vmaAllocateMemory(allocator, &requirements, &allocInfo, &block.allocation, nullptr);
+        if (result != VK_SUCCESS) {
+            LOGE("render graph: allocating %llu bytes failed: %s", (unsigned long long)block.size, VkResultString(result));
+            return false;
+        }
+        for (uint32_t index : block.images) {
+            VK_CHECK(vmaBindImageMemory(allocator, block.allocation, _images[index].image));
+        }
+    }
+
+    for (GraphImage& image : _images) {
+        if (image.imported || image.firstUse < 0) {
+            continue;
+        }
+        VkImageAspectFlags aspect       = is_depth_format(image.format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+        VkImageViewCreateInfo view_info = vkinit::imageview_create_info(image.format, image.image, aspect);
+        VK_CHECK(vkCreateImageView(device, &view_info, nullptr, &image.view));
+    }
+
+    LOGI("render graph: %zu of %zu passes, %llu bytes of transient images in %u blocks (%llu without aliasing)", _schedule.size(), _passes.size(), (unsigned long long)aliased_memory(), memory_block_count(), (unsigned long long)unaliased_memory());
+    return true;
+}
+
+void RenderGraph::cleanup(VkDevice device, VmaAllocator allocator) {
+    for (GraphImage& image : _images) {
+        if (image.imported || image.image == VK_NULL_HANDLE) {
+            continue;
+        }
+        vkDestroyImageView(device, image.view, nullptr);
+        vkDestroyImage(device, image.image, nullptr);
+        image.view  = VK_NULL_HANDLE;
+        image.image = VK_NULL_HANDLE;
+    }
+    for (MemoryBlock& block : _blocks) {
+        if (block.allocation != VK_NULL_HANDLE) {
+            vmaFreeMemory(allocator, block.allocation);
+            block.allocation = VK_NULL_HANDLE;
+        }
+    }
+}
+
+static void record_barriers(VkCommandBuffer cmd, const std::vector<GraphBarrier>& barriers, const std::vector<VkImage>& images, const std::vector<VkFormat>& formats) {
+    if (barriers.empty()) {
+        return;
+    }
+    // one vkCmdPipelineBarrier per batch, the stage masks are merged
+    std::vector<VkImageMemoryBarrier> imageBarriers;
+    VkPipelineStageFlags srcStages = 0;
+    VkPipelineStageFlags dstStages = 0;
+    for (const GraphBarrier& barrier : barriers) {
+        VkFormat format           = formats[barrier.resource];
+        VkImageAspectFlags aspect = is_depth_format(format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+        if (has_stencil(format)) {
+            aspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+        }
+        imageBarriers.push_back(vkinit::image_barrier(images[barrier.resource], barrier.oldLayout, barrier.newLayout, barrier.srcAccess, barrier.dstAccess, aspect));
+        srcStages |= barrier.srcStage;
+        dstStages |= barrier.dstStage;
+    }
+    vkCmdPipelineBarrier(cmd, srcStages, dstStages, 0, 0, nullptr, 0, nullptr, (uint32_t)imageBarriers.size(), imageBarriers.data());
+}
+
+void RenderGraph::execute(VkCommandBuffer cmd) const {
+    std::vector<VkImage> images;
+    std::vector<VkFormat> formats;
+    for (const GraphImage& image : _images) {
+        images.push_back(image.image);
+        formats.push_back(image.format);
+    }
+
+    for (const CompiledPass& compiled : _schedule) {
+        record_barriers(cmd, compiled.barriers, images, formats);
+        _passes[compiled.pass].execute(cmd);
+    }
+    record_barriers(cmd, _finalBarriers, images, formats);
+}
+
+}  // namespace vkutil
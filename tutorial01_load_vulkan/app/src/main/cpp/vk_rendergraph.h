@@ -0,0 +1,145 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+#include "vk_types.h"
+
+namespace vkutil {
+
+// the ways a pass can touch an image, each one maps to a stage, access mask and layout
+enum class ImageAccess {
+    ColorAttachment,  // written as a color attachment
+    DepthAttachment,  // depth tested and written
+    DepthRead,        // depth tested without writes, or sampled as a read only depth image
+    Sampled,          // read through a sampler in fragment or compute shaders
+    StorageRead,      // read as a storage image from compute
+    StorageWrite,     // written as a storage image from compute
+    TransferSrc,
+    TransferDst,
+};
+
+struct AccessInfo {
+    VkPipelineStageFlags stage;
+    VkAccessFlags access;
+    VkImageLayout layout;
+    VkImageUsageFlags usage;
+    bool write;
+};
+
+AccessInfo access_info(ImageAccess access);
+
+// a layout transition and/or memory dependency on one graph image
+struct GraphBarrier {
+    uint32_t resource;
+    VkPipelineStageFlags srcStage;
+    VkAccessFlags srcAccess;
+    VkPipelineStageFlags dstStage;
+    VkAccessFlags dstAccess;
+    VkImageLayout oldLayout;
+    VkImageLayout newLayout;
+};
+
+// a pass that survived culling with the barriers recorded in front of it
+struct CompiledPass {
+    uint32_t pass;
+    std::vector<GraphBarrier> barriers;
+};
+
+// Frame graph of passes over images.
+// Passes declare how they use each image; compile() culls passes whose results nobody reads,
+// derives the minimal barriers between the remaining ones and packs transient images whose
+// lifetimes don't overlap into shared memory. compile() touches no Vulkan objects, so graphs
+// can be built and inspected without a device. realize() then creates the transient images and
+// execute() records the passes.
+class RenderGraph {
+   public:
+    // graph owned image, only lives between its first and last use inside the graph
+    uint32_t create_image(const std::string& name, VkFormat format, VkExtent2D extent, VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT);
+    // image owned by someone else, e.g. the swapchain. It is in initialLayout when the graph starts, after
+    // initialStage has finished, with the initialAccess writes of it not yet made available, and is left in finalLayout
+    uint32_t import_image(const std::string& name, VkFormat format, VkExtent2D extent, VkImageLayout initialLayout, VkPipelineStageFlags initialStage, VkAccessFlags initialAccess, VkImageLayout finalLayout);
+    // keeps the passes writing a graph owned image alive even if no pass reads it
+    void mark_output(uint32_t resource);
+
+    uint32_t add_pass(const std::string& name, std::function<void(VkCommandBuffer cmd)>&& execute);
+    // accesses are ordered as declared, both inside a pass and across passes
+    void use(uint32_t pass, uint32_t resource, ImageAccess access);
+
+    // returns false when a pass reads a graph owned image nothing wrote before
+    bool compile();
+
+    const std::vector<CompiledPass>& schedule() const { return _schedule; }
+    // transitions of imported images to their final layouts, recorded after the last pass
+    const std::vector<GraphBarrier>& final_barriers() const { return _finalBarriers; }
+    bool is_culled(uint32_t pass) const { return !_passes[pass].alive; }
+
+    // memory of the graph owned images with and without aliasing
+    VkDeviceSize aliased_memory() const;
+    VkDeviceSize unaliased_memory() const;
+    uint32_t memory_block_count() const { return (uint32_t)_blocks.size(); }
+
+    // creates the graph owned images and binds them to the aliased memory blocks, call after compile()
+    bool realize(VkDevice device, VmaAllocator allocator);
+    void cleanup(VkDevice device, VmaAllocator allocator);
+
+    // the current image behind an imported resource, may change every frame
+    void set_imported_image(uint32_t resource, VkImage image, VkImageView view);
+    VkImage image(uint32_t resource) const { return _images[resource].image; }
+    VkImageView view(uint32_t resource) const { return _images[resource].view; }
+
+    void execute(VkCommandBuffer cmd) const;
+
+   private:
+    struct GraphImage {
+        std::string name;
+        VkFormat format;
+        VkExtent2D extent;
+        VkSampleCountFlagBits samples;
+        bool imported;
+        bool output;
+        VkImageLayout initialLayout;
+        VkPipelineStageFlags initialStage;
+        VkAccessFlags initialAccess;
+        VkImageLayout finalLayout;
+
+        // filled by compile()
+        VkImageUsageFlags usage;
+        int firstUse;  // schedule positions, -1 when unused
+        int lastUse;
+        VkDeviceSize size;
+        VkDeviceSize alignment;
+        uint32_t memoryTypeBits;
+        uint32_t block;
+
+        // filled by realize() or set_imported_image()
+        VkImage image;
+        VkImageView view;
+    };
+
+    struct GraphPass {
+        std::string name;
+        std::vector<std::pair<uint32_t, ImageAccess>> accesses;
+        std::function<void(VkCommandBuffer cmd)> execute;
+        bool alive;
+    };
+
+    struct MemoryBlock {
+        VkDeviceSize size;
+        VkDeviceSize alignment;
+        uint32_t memoryTypeBits;
+        std::vector<uint32_t> images;
+        VmaAllocation allocation;
+    };
+
+    void cull_passes();
+    bool compute_barriers();
+    void assign_memory();
+
+    std::vector<GraphImage> _images;
+    std::vector<GraphPass> _passes;
+    std::vector<CompiledPass> _schedule;
+    std::vector<GraphBarrier> _finalBarriers;
+    std::vector<MemoryBlock> _blocks;
+};
+
+}  // namespace vkutil
@@ -0,0 +1,207 @@
+#include "vk_renderpass.h"
+#include "vulkan_wrapper.h"
+#include "vk_init.h"
+#include "log.h"
+
+namespace vkutil {
+
+uint32_t RenderPassDesc::add_color(VkFormat format, VkImageLayout finalLayout, bool clear, bool load, bool consumed, VkSampleCountFlagBits samples) {
+    _attachments.push_back({format, samples, finalLayout, clear, load, consumed});
+    _colorRefs.push_back(attachment_count() - 1);
+    _resolveRefs.push_back(VK_ATTACHMENT_UNUSED);
+    return attachment_count() - 1;
+}
+
+uint32_t RenderPassDesc::add_resolve(uint32_t colorAttachment, VkImageLayout finalLayout, bool consumed) {
+    _attachments.push_back({_attachments[colorAttachment].format, VK_SAMPLE_COUNT_1_BIT, finalLayout, false, false, consumed});
+    for (size_t i = 0; i < _colorRefs.size(); i++) {
+        if (_colorRefs[i] == colorAttachment) {
+            _resolveRefs[i] = attachment_count() - 1;
+        }
+    }
+    return attachment_count() - 1;
+}
+
+uint32_t RenderPassDesc::set_depth(VkFormat format, bool clear, bool load, bool consumed, VkSampleCountFlagBits samples) {
+    _attachments.push_back({format, samples, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, clear, load, consumed});
+    _depthRef = attachment_count() - 1;
+    return attachment_count() - 1;
+}
+
+bool RenderPassDesc::is_transient(uint32_t attachment) const {
+    const AttachmentUsage& usage = _attachments[attachment];
+    return !usage.load && !usage.consumed;
+}
+
+VkAttachmentDescription RenderPassDesc::describe(uint32_t attachment) const {
+    const AttachmentUsage& usage = _attachments[attachment];
+
+    VkAttachmentDescription desc = {};
+    desc.format                  = usage.format;
+    desc.samples                 = usage.samples;
+    // only pay for the load when the previous contents are read, clearing is free on a tiler
+    desc.loadOp = usage.clear ? VK_ATTACHMENT_LOAD_OP_CLEAR : (usage.load ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+    // only write the tile back when somebody reads it after the pass
+    desc.storeOp = usage.consumed ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+    bool stencil        = has_stencil(usage.format);
+    desc.stencilLoadOp  = stencil ? desc.loadOp : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    desc.stencilStoreOp = stencil ? desc.storeOp : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+    // a loaded attachment is expected in the layout the previous pass left it in
+    desc.initialLayout = usage.load ? usage.finalLayout : VK_IMAGE_LAYOUT_UNDEFINED;
+    desc.finalLayout   = usage.finalLayout;
+    return desc;
+}
+
+VkRenderPass RenderPassDesc::build(VkDevice device) const {
+    std::vector<VkAttachmentDescription> attachments;
+    bool loadsColor = false;
+    bool loadsDepth = false;
+    for (uint32_t i = 0; i < attachment_count(); i++) {
+        attachments.push_back(describe(i));
+        if (_attachments[i].load && (int32_t)i == _depthRef) {
+            loadsDepth = true;
+        } else if (_attachments[i].load) {
+            loadsColor = true;
+        }
+    }
+
+    std::vector<VkAttachmentReference> colorRefs, resolveRefs;
+    bool resolves = false;
+    for (size_t i = 0; i < _colorRefs.size(); i++) {
+        colorRefs.push_back({_colorRefs[i], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+        resolveRefs.push_back({_resolveRefs[i], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+        resolves |= _resolveRefs[i] != VK_ATTACHMENT_UNUSED;
+    }
+    VkAttachmentReference depthRef = {(uint32_t)_depthRef, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+
+    VkSubpassDescription subpass    = {};
+    subpass.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount    = (uint32_t)colorRefs.size();
+    subpass.pColorAttachments       = colorRefs.data();
+    subpass.pResolveAttachments     = resolves ? resolveRefs.data() : nullptr;
+    subpass.pDepthStencilAttachment = _depthRef >= 0 ? &depthRef : nullptr;
+
+    // wait for the previous writers of the attachments, they are only read back when loaded
+    VkSubpassDependency dependencies[2] = {};
+    dependencies[0].srcSubpass          = VK_SUBPASS_EXTERNAL;
+    dependencies[0].dstSubpass          = 0;
+    dependencies[0].srcStageMask        = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[0].srcAccessMask       = loadsColor ? VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT : 0;
+    dependencies[0].dstStageMask        = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[0].dstAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | (loadsColor ? VK_ACCESS_COLOR_ATTACHMENT_READ_BIT : 0);
+
+    dependencies[1].srcSubpass    = VK_SUBPASS_EXTERNAL;
+    dependencies[1].dstSubpass    = 0;
+    dependencies[1].srcStageMask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[1].srcAccessMask = loadsDepth ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT : 0;
+    dependencies[1].dstStageMask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[1].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | (loadsDepth ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT : 0);
+
+    VkRenderPassCreateInfo render_pass_info = {};
+    render_pass_info.sType                  = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    render_pass_info.attachmentCount        = (uint32_t)attachments.size();
+    render_pass_info.pAttachments           = attachments.data();
+    render_pass_info.subpassCount           = 1;
+    render_pass_info.pSubpasses             = &subpass;
+    render_pass_info.dependencyCount        = _depthRef >= 0 ? 2 : 1;
+    render_pass_info.pDependencies          = dependencies;
+
+    VkRenderPass renderPass;
+    VK_CHECK(vkCreateRenderPass(device, &render_pass_info, nullptr, &renderPass));
+    return renderPass;
+}
+
+PassBandwidth RenderPassDesc::estimate_bandwidth(VkExtent2D extent) const {
+    PassBandwidth bandwidth = {0, 0};
+    for (const AttachmentUsage& usage : _attachments) {
+        VkDeviceSize bytes = (VkDeviceSize)extent.width * extent.height * usage.samples * format_size(usage.format);
+        if (usage.load && !usage.clear) {
+            bandwidth.loadBytes += bytes;
+        }
+        if (usage.consumed) {
+            bandwidth.storeBytes += bytes;
+        }
+    }
+    return bandwidth;
+}
+
+PassBandwidth RenderPassDesc::estimate_separate_resolve(VkExtent2D extent) const {
+    PassBandwidth bandwidth = estimate_bandwidth(extent);
+    for (size_t i = 0; i < _colorRefs.size(); i++) {
+        const AttachmentUsage& usage = _attachments[_colorRefs[i]];
+        if (_resolveRefs[i] == VK_ATTACHMENT_UNUSED || usage.consumed) {
+            continue;
+        }
+        VkDeviceSize bytes = (VkDeviceSize)extent.width * extent.height * usage.samples * format_size(usage.format);
+        bandwidth.storeBytes += bytes;
+        bandwidth.loadBytes += bytes;
+    }
+    return bandwidth;
+}
+
+uint32_t format_size(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_D16_UNORM:
+            return 2;
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+            return 5;
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+            return 8;
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+            return 16;
+        default:
+            // 8 bit RGBA/BGRA, 10 bit packed, D24S8 and D32
+            return 4;
+    }
+}
+
+VkSampleCountFlagBits choose_sample_count(VkSampleCountFlags supported, uint32_t requested) {
+    for (uint32_t samples = 64; samples > 1; samples /= 2) {
+        if (samples <= requested && (supported & samples)) {
+            return (VkSampleCountFlagBits)samples;
+        }
+    }
+    return VK_SAMPLE_COUNT_1_BIT;
+}
+
+bool has_stencil(VkFormat format) {
+    return format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_S8_UINT;
+}
+
+static bool has_lazy_memory(VmaAllocator allocator) {
+    const VkPhysicalDeviceMemoryProperties* memoryProperties;
+    vmaGetMemoryProperties(allocator, &memoryProperties);
+    for (uint32_t i = 0; i < memoryProperties->memoryTypeCount; i++) {
+        if (memoryProperties->memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool create_attachment_image(VmaAllocator allocator, VkFormat format, VkImageUsageFlags usage, VkExtent3D extent, VkSampleCountFlagBits samples, bool transient, AllocatedImage& outImage) {
+    // desktop GPUs have no lazily allocated memory, the image then is an ordinary device local one
+    bool lazy = transient && has_lazy_memory(allocator);
+    if (lazy) {
+        usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+    }
+
+    VkImageCreateInfo img_info = vkinit::image_create_info(format, usage, extent);
+    img_info.samples           = samples;
+
+    VmaAllocationCreateInfo img_allocinfo = {};
+    img_allocinfo.usage                   = lazy ? VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED : VMA_MEMORY_USAGE_GPU_ONLY;
+    img_allocinfo.requiredFlags           = VkMemoryPropertyFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    img_allocinfo.pUserData               = (void*)"Image";
+
+    VkResult result = vmaCreateImage(allocator, &img_info, &img_allocinfo, &outImage._image, &outImage._allocation, nullptr);
+    if (result != VK_SUCCESS) {
+        LOGE("create_attachment_image: %s", VkResultString(result));
+        return false;
+    }
+    return true;
+}
+
+}  // namespace vkutil
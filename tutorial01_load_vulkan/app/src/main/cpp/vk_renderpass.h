@@ -0,0 +1,71 @@
+#pragma once
+#include <vector>
+#include "vk_types.h"
+
+namespace vkutil {
+
+// how the contents of an attachment are used around a pass, the load and store ops are inferred from it
+struct AttachmentUsage {
+    VkFormat format;
+    VkSampleCountFlagBits samples;
+    VkImageLayout finalLayout;
+    bool clear;     // cleared at the start of the pass
+    bool load;      // the pass reads what an earlier pass left in the attachment
+    bool consumed;  // read after the pass: presented, sampled or loaded by a later pass
+};
+
+// external memory traffic of a pass on a tiler, everything else stays in tile memory
+struct PassBandwidth {
+    VkDeviceSize loadBytes;   // attachment contents read into tile memory
+    VkDeviceSize storeBytes;  // attachment contents written back from tile memory
+
+    VkDeviceSize total() const { return loadBytes + storeBytes; }
+};
+
+// Single subpass render pass description.
+// Attachments are declared by usage instead of load/store ops so that nothing is loaded or stored
+// unless someone reads it. Attachments that are neither loaded nor consumed are transient: they
+// only ever live in tile memory and can be backed by lazily allocated memory.
+// A multisampled color attachment that isn't consumed itself can be resolved into a single sampled
+// one at the end of the subpass, then only the resolved texels leave tile memory.
+class RenderPassDesc {
+   public:
+    // returns the attachment index
+    uint32_t add_color(VkFormat format, VkImageLayout finalLayout, bool clear, bool load, bool consumed, VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT);
+    uint32_t set_depth(VkFormat format, bool clear, bool load, bool consumed, VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT);
+    // the single sampled attachment the color attachment colorAttachment is resolved into, its
+    // previous contents are never read
+    uint32_t add_resolve(uint32_t colorAttachment, VkImageLayout finalLayout, bool consumed);
+
+    uint32_t attachment_count() const { return (uint32_t)_attachments.size(); }
+    bool is_transient(uint32_t attachment) const;
+    VkAttachmentDescription describe(uint32_t attachment) const;
+
+    VkRenderPass build(VkDevice device) const;
+
+    // bytes moved between tile memory and external memory each time the pass runs at extent
+    PassBandwidth estimate_bandwidth(VkExtent2D extent) const;
+    // the same if every resolve happened after the pass instead, with vkCmdResolveImage: the samples
+    // are stored and read back before the resolved texels are written
+    PassBandwidth estimate_separate_resolve(VkExtent2D extent) const;
+
+   private:
+    std::vector<AttachmentUsage> _attachments;
+    std::vector<uint32_t> _colorRefs;
+    std::vector<uint32_t> _resolveRefs;  // per color reference, VK_ATTACHMENT_UNUSED for none
+    int32_t _depthRef = -1;
+};
+
+// bytes per texel of the attachment formats the engine uses, 4 for anything unknown
+uint32_t format_size(VkFormat format);
+
+bool has_stencil(VkFormat format);
+
+// the highest of the sample counts in supported up to requested, 1 when none of them fits
+VkSampleCountFlagBits choose_sample_count(VkSampleCountFlags supported, uint32_t requested);
+
+// creates an attachment image, transient images get TRANSIENT_ATTACHMENT usage and lazily allocated
+// memory when the device exposes it
+bool create_attachment_image(VmaAllocator allocator, VkFormat format, VkImageUsageFlags usage, VkExtent3D extent, VkSampleCountFlagBits samples, bool transient, AllocatedImage& outImage);
+
+}  // namespace vkutil
@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <cstring>
+#include "vk_residency.h"
+#include "vk_queues.h"
+#include "log.h"
+
+void BufferResidency::init(VmaAllocator allocator, VkDevice device, vkutil::QueueSubmitter* queues, VkBufferUsageFlags usage, const ResidencySettings& settings) {
+    _allocator = allocator;
+    _device    = device;
+    _queues    = queues;
+    // the defragmentation copies from the buffers at the old place to the ones at the new place
+    _usage    = usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    _settings = settings;
+    // evicting anything younger would free a buffer a frame in flight still reads
+    _settings.minIdleFrames = std::max(_settings.minIdleFrames, FRAME_OVERLAP);
+
+    // the memory type mesh buffers always had, written by the CPU and read by the GPU
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size               = 1024;
+    bufferInfo.usage              = _usage;
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage                   = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    uint32_t memoryType;
+    VK_CHECK(vmaFindMemoryTypeIndexForBufferInfo(_allocator, &bufferInfo, &allocInfo, &memoryType));
+
+    const VkPhysicalDeviceMemoryProperties* memoryProperties;
+    vmaGetMemoryProperties(_allocator, &memoryProperties);
+    _heap = memoryProperties->memoryTypes[memoryType].heapIndex;
+
+    VmaPoolCreateInfo poolInfo = {};
+    poolInfo.memoryTypeIndex   = memoryType;
+    poolInfo.blockSize         = _settings.blockBytes;
+    VK_CHECK(vmaCreatePool(_allocator, &poolInfo, &_pool));
+}
+
+void BufferResidency::cleanup() {
+    finish_step();
+    for (PendingFree& pending : _pendingFrees) {
+        vmaDestroyBuffer(_allocator, pending.buffer, pending.allocation);
+    }
+    _pendingFrees.clear();
+    for (Entry& entry : _entries) {
+        if (entry.allocation != VK_NULL_HANDLE) {
+            vmaDestroyBuffer(_allocator, entry.buffer, entry.allocation);
+        }
+    }
+    _entries.clear();
+    _freeHandles.clear();
+    vmaDestroyPool(_allocator, _pool);
+}
+
+void BufferResidency::allocate(Entry& entry) {
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size               = entry.size;
+    bufferInfo.usage              = _usage;
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.pool                    = _pool;
+    VK_CHECK(vmaCreateBuffer(_allocator, &bufferInfo, &allocInfo, &entry.buffer, &entry.allocation, nullptr));
+
+    void* data;
+    VK_CHECK(vmaMapMemory(_allocator, entry.allocation, &data));
+    entry.fill(data, entry.size);
+    // the memory type doesn't have to be coherent
+    vmaFlushAllocation(_allocator, entry.allocation, 0, VK_WHOLE_SIZE);
+    vmaUnmapMemory(_allocator, entry.allocation);
+
+    _stats.residentBuffers++;
+    _stats.residentBytes += entry.size;
+}
+
+uint32_t BufferResidency::create(VkDeviceSize size, Fill&& fill) {
+    uint32_t handle;
+    if (_freeHandles.empty()) {
+        handle = (uint32_t)_entries.size();
+        _entries.push_back({});
+    } else {
+        handle = _freeHandles.back();
+        _freeHandles.pop_back();
+    }
+    Entry& entry = _entries[handle];
+    entry        = {VK_NULL_HANDLE, VK_NULL_HANDLE, size, std::move(fill), _frame};
+    allocate(entry);
+    return handle;
+}
+
+void BufferResidency::destroy(uint32_t handle) {
+    Entry& entry = _entries[handle];
+    if (entry.allocation != VK_NULL_HANDLE) {
+        _pendingFrees.push_back({entry.lastUse, entry.buffer, entry.allocation});
+        _stats.residentBuffers--;
+        _stats.residentBytes -= entry.size;
+    }
+    entry = {VK_NULL_HANDLE, VK_NULL_HANDLE, 0, nullptr, 0};
+    _freeHandles.push_back(handle);
+}
+
+VkBuffer BufferResidency::use(uint32_t handle, uint64_t frame) {
+    Entry& entry = _entries[handle];
+    if (entry.allocation == VK_NULL_HANDLE) {
+        allocate(entry);
+        _stats.restores++;
+    }
+    entry.lastUse = frame;
+    return entry.buffer;
+}
+
+void BufferResidency::read(uint32_t handle, void* data) {
+    Entry& entry = _entries[handle];
+    void* mapped;
+    VK_CHECK(vmaMapMemory(_allocator, entry.allocation, &mapped));
+    vmaInvalidateAllocation(_allocator, entry.allocation, 0, VK_WHOLE_SIZE);
+    memcpy(data, mapped, entry.size);
+    vmaUnmapMemory(_allocator, entry.allocation);
+}
+
+void BufferResidency::begin_frame(uint64_t frame) {
+    _frame = frame;
+    // a moved allocation freed before its step ends would leave VMA committing a move of a freed allocation,
+    // and a new buffer could land on an old place the copies still read
+    if (_step != VK_NULL_HANDLE) {
+        return;
+    }
+    // the frames that could still use them are done
+    auto done = std::partition(_pendingFrees.begin(), _pendingFrees.end(), [=](const PendingFree& pending) { return pending.frame + FRAME_OVERLAP > frame; });
+    for (auto it = done; it != _pendingFrees.end(); it++) {
+        vmaDestroyBuffer(_allocator, it->buffer, it->allocation);
+    }
+    _pendingFrees.erase(done, _pendingFrees.end());
+
+    evict(frame);
+}
+
+VkDeviceSize BufferResidency::excess_bytes() const {
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS] = {};
+    vmaGetBudget(_allocator, budgets);
+    const VmaBudget& heap = budgets[_heap];
+
+    // free space inside VMA's blocks doesn't count, defragmentation gives it back
+    VkDeviceSize used   = heap.usage - std::min(heap.usage, heap.blockBytes - heap.allocationBytes);
+    VkDeviceSize excess = 0;
+    if (used > heap.budget * _settings.evictAbove) {
+        excess = used - (VkDeviceSize)(heap.budget * _settings.evictTo);
+    }
+    VkDeviceSize budget = _settings.budgetBytes;
+    if (budget > 0 && _stats.residentBytes > budget * _settings.evictAbove) {
+        excess = std::max(excess, _stats.residentBytes - (VkDeviceSize)(budget * _settings.evictTo));
+    }
+    return excess;
+}
+
+void BufferResidency::evict(uint64_t frame) {
+    VkDeviceSize excess = excess_bytes();
+    if (excess == 0) {
+        return;
+    }
+
+    // least recently used first, of the buffers no frame in flight can use anymore
+    std::vector<uint32_t> idle;
+    for (uint32_t i = 0; i < (uint32_t)_entries.size(); i++) {
+        const Entry& entry = _entries[i];
+        if (entry.allocation != VK_NULL_HANDLE && entry.lastUse + _settings.minIdleFrames <= frame) {
+            idle.push_back(i);
+        }
+    }
+    std::sort(idle.begin(), idle.end(), [this](uint32_t a, uint32_t b) { return _entries[a].lastUse < _entries[b].lastUse; });
+
+    VkDeviceSize freed = 0;
+    for (size_t i = 0; i < idle.size() && freed < excess; i++) {
+        Entry& entry = _entries[idle[i]];
+        vmaDestroyBuffer(_allocator, entry.buffer, entry.allocation);
+        entry.buffer     = VK_NULL_HANDLE;
+        entry.allocation = VK_NULL_HANDLE;
+        freed += entry.size;
+        _stats.residentBuffers--;
+        _stats.residentBytes -= entry.size;
+        _stats.evictions++;
+    }
+    if (freed < excess && frame % 120 == 0) {
+        LOGW("BufferResidency: %llu bytes over budget, every buffer left was used in the last %u frames", (unsigned long long)(excess - freed), _settings.minIdleFrames);
+    }
+}
+
+void BufferResidency::record_defragment(VkCommandBuffer cmd) {
+    VmaPoolStats pool = {};
+    vmaGetPoolStats(_allocator, _pool, &pool);
+    VkDeviceSize scattered = pool.unusedSize - pool.unusedRangeSizeMax;
+    if (_step != VK_NULL_HANDLE || _frame < _nextStep || pool.size == 0 || scattered <= pool.size * _settings.defragAbove) {
+        return;
+    }
+    _nextStep = _frame + _settings.stepInterval;
+
+    std::vector<uint32_t> handles;
+    std::vector<VmaAllocation> allocations;
+    for (uint32_t i = 0; i < (uint32_t)_entries.size(); i++) {
+        if (_entries[i].allocation != VK_NULL_HANDLE) {
+            handles.push_back(i);
+            allocations.push_back(_entries[i].allocation);
+        }
+    }
+
+    // incremental, so the pool isn't locked until the end and buffers can be created while the step is in
+    // flight. VMA only plans the moves, reserving the new places and keeping the old ones until the pass ends
+    VmaDefragmentationInfo2 info = {};
+    info.flags                   = VMA_DEFRAGMENTATION_FLAG_INCREMENTAL;
+    info.allocationCount         = (uint32_t)allocations.size();
+    info.pAllocations            = allocations.data();
+    info.maxCpuBytesToMove       = 0;
+    info.maxCpuAllocationsToMove = 0;
+    info.maxGpuBytesToMove       = _settings.stepBytes;
+    info.maxGpuAllocationsToMove = _settings.stepAllocations;
+    _stepStats                   = {};
+    VkResult result              = vmaDefragmentationBegin(_allocator, &info, &_stepStats, &_step);
+    if (result != VK_NOT_READY) {
+        VK_CHECK(result);
+    }
+    if (_step == VK_NULL_HANDLE) {
+        return;
+    }
+    std::vector<VmaDefragmentationPassMoveInfo> moves(_settings.stepAllocations);
+    VmaDefragmentationPassInfo pass = {(uint32_t)moves.size(), moves.data()};
+    VK_CHECK(vmaBeginDefragmentationPass(_allocator, _step, &pass));
+
+    // a buffer stays bound to where its allocation was, moved ones are created again at the new place and
+    // the frame's draws recorded after the copies use them. Nothing the GPU still reads is at a new place,
+    // it was free since the frames in flight were recorded
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.usage              = _usage;
+    for (uint32_t i = 0; i < pass.moveCount; i++) {
+        const VmaDefragmentationPassMoveInfo& move = moves[i];
+        size_t index                               = std::find(allocations.begin(), allocations.end(), move.allocation) - allocations.begin();
+        Entry& entry                               = _entries[handles[index]];
+        bufferInfo.size                            = entry.size;
+        VkBuffer moved;
+        VK_CHECK(vkCreateBuffer(_device, &bufferInfo, nullptr, &moved));
+        VK_CHECK(vkBindBufferMemory(_device, moved, move.memory, move.offset));
+
+        VkBufferCopy copy = {0, 0, entry.size};
+        vkCmdCopyBuffer(cmd, entry.buffer, moved, 1, &copy);
+        _stepBuffers.push_back(entry.buffer);
+        entry.buffer = moved;
+    }
+    // nothing to wait for without moves
+    _stepSubmitted = false;
+    if (pass.moveCount == 0) {
+        finish_step();
+        return;
+    }
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER, nullptr, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_HOST_READ_BIT};
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void BufferResidency::submitted(uint64_t value) {
+    if (_step == VK_NULL_HANDLE || _stepSubmitted) {
+        return;
+    }
+    _stepSubmitted = true;
+    // the frame's commands are done with the old places, which the frames before it used
+    _queues->timeline(vkutil::QueueKind::graphics).retire(value, [this]() { finish_step(); });
+}
+
+void BufferResidency::finish_step() {
+    // cleanup() may have finished the step its retired function was for
+    if (_step == VK_NULL_HANDLE) {
+        return;
+    }
+    for (VkBuffer buffer : _stepBuffers) {
+        vkDestroyBuffer(_device, buffer, nullptr);
+    }
+    _stepBuffers.clear();
+    // the allocations move to their new place and the old places are freed, with the blocks left empty
+    VkResult result = vmaEndDefragmentationPass(_allocator, _step);
+    if (result != VK_NOT_READY) {
+        VK_CHECK(result);
+    }
+    VK_CHECK(vmaDefragmentationEnd(_allocator, _step));
+    _step = VK_NULL_HANDLE;
+
+    _stats.defragSteps++;
+    _stats.allocationsMoved += _stepStats.allocationsMoved;
+    _stats.bytesMoved += _stepStats.bytesMoved;
+    _stats.blocksFreed += _stepStats.deviceMemoryBlocksFreed;
+}
+
+ResidencyStats BufferResidency::stats() const {
+    ResidencyStats stats = _stats;
+    stats.buffers        = (uint32_t)(_entries.size() - _freeHandles.size());
+
+    VmaPoolStats pool = {};
+    vmaGetPoolStats(_allocator, _pool, &pool);
+    stats.poolBytes     = pool.size;
+    stats.fragmentation = pool.size ? (float)(pool.unusedSize - pool.unusedRangeSizeMax) / pool.size : 0.f;
+    return stats;
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "vk_types.h"
+#include "vk_frame_allocator.h"
+
+namespace vkutil {
+class QueueSubmitter;
+}
+
+struct ResidencySettings {
+    VkDeviceSize blockBytes{16 << 20};  // VkDeviceMemory blocks of the pool the buffers live in
+    // the least recently used buffers are evicted once the heap's usage passes evictAbove of its budget,
+    // until they freed enough to get it back to evictTo
+    float evictAbove{0.9f};
+    float evictTo{0.8f};
+    VkDeviceSize budgetBytes{0};  // caps the resident buffers' bytes the same way, 0 for the heap budget alone
+    // buffers used this recently are never evicted, the frames in flight may still read them
+    uint32_t minIdleFrames{FRAME_OVERLAP};
+    // a defragmentation step runs when more than defragAbove of the pool is free outside its largest
+    // free range. Each step copies at most stepBytes in stepAllocations moves, at most every stepInterval frames
+    float defragAbove{0.25f};
+    VkDeviceSize stepBytes{4 << 20};
+    uint32_t stepAllocations{64};
+    uint32_t stepInterval{8};
+};
+
+struct ResidencyStats {
+    uint32_t buffers;  // created and not destroyed, resident or not
+    uint32_t residentBuffers;
+    VkDeviceSize residentBytes;
+    VkDeviceSize poolBytes;  // VkDeviceMemory of the pool
+    float fragmentation;     // free bytes of the pool outside its largest free range, over the pool size
+    uint32_t evictions;
+    uint32_t restores;  // evicted buffers used again
+    uint32_t defragSteps;
+    uint32_t allocationsMoved;
+    VkDeviceSize bytesMoved;
+    uint32_t blocksFreed;
+};
+
+// Buffers whose contents the owner can produce again, in a VMA pool of their own so long sessions can
+// be kept in budget. When the heap nears its budget (VK_EXT_memory_budget when the device has it) the
+// least recently used ones are freed, and used again they are allocated and filled anew. Evictions and
+// frees leave holes, an incremental defragmentation closes them a few moves per step: a step records
+// the copies into the frame's command buffer ahead of its draws, moved buffers are recreated at their
+// new place. The old places and buffers are freed through the graphics timeline once that frame is done,
+// until then the pool frees nothing, so no new buffer lands on the old places while they are read.
+// Buffers are host visible, fill writes them directly. Handles stay valid across evictions and moves,
+// VkBuffers don't: get them from use() while recording
+class BufferResidency {
+   public:
+    static constexpr uint32_t kNoBuffer = UINT32_MAX;
+    // writes size bytes of contents to data
+    using Fill = std::function<void(void* data, VkDeviceSize size)>;
+
+    // queues is only used to retire the defragmentation steps and has to be initialized by the first submitted()
+    void init(VmaAllocator allocator, VkDevice device, vkutil::QueueSubmitter* queues, VkBufferUsageFlags usage, const ResidencySettings& settings);
+    // the device has to be idle, finishes a step still in flight
+    void cleanup();
+
+    // a buffer of size bytes, filled now and every time it comes back after an eviction
+    uint32_t create(VkDeviceSize size, Fill&& fill);
+    // freed once the frames in flight are done with it
+    void destroy(uint32_t handle);
+    // the buffer for commands of frame, allocated and filled again first when it was evicted
+    VkBuffer use(uint32_t handle, uint64_t frame);
+    bool resident(uint32_t handle) const { return _entries[handle].allocation != VK_NULL_HANDLE; }
+    // copies a resident buffer's contents to data, for checks
+    void read(uint32_t handle, void* data);
+
+    // once per frame after the frame slot wait, when frame - FRAME_OVERLAP is done on the GPU: frees
+    // what was destroyed and evicts when over budget, unless a defragmentation step is in flight
+    void begin_frame(uint64_t frame);
+    // while recording the frame on the graphics queue, before use(): records the copies of a
+    // defragmentation step when one is due, use() returns the moved buffers at their new place after it
+    void record_defragment(VkCommandBuffer cmd);
+    // with the graphics timeline value of the frame's submit, the step's old places are freed once it's reached
+    void submitted(uint64_t value);
+
+    ResidencyStats stats() const;
+
+   private:
+    struct Entry {
+        VkBuffer buffer;
+        VmaAllocation allocation;  // null while evicted
+        VkDeviceSize size;
+        Fill fill;
+        uint64_t lastUse;
+    };
+    struct PendingFree {
+        uint64_t frame;  // last frame that may use it
+        VkBuffer buffer;
+        VmaAllocation allocation;
+    };
+
+    void allocate(Entry& entry);
+    // bytes to evict to get the heap, and the resident buffers with budgetBytes, back under evictTo
+    VkDeviceSize excess_bytes() const;
+    void evict(uint64_t frame);
+    // commits the moves of the step in flight and frees its old places, the copies are done
+    void finish_step();
+
+    VmaAllocator _allocator;
+    VkDevice _device;
+    vkutil::QueueSubmitter* _queues;
+    VkBufferUsageFlags _usage;
+    ResidencySettings _settings;
+    VmaPool _pool;
+    uint32_t _heap;  // of the pool's memory type
+
+    std::vector<Entry> _entries;  // indexed by handle
+    std::vector<uint32_t> _freeHandles;
+    std::vector<PendingFree> _pendingFrees;
+    // the defragmentation step in flight, from record_defragment() until its frame is done
+    VmaDefragmentationContext _step{VK_NULL_HANDLE};
+    VmaDefragmentationStats _stepStats{};  // VMA fills it in until the step's end
+    std::vector<VkBuffer> _stepBuffers;    // the moved buffers at their old place
+    bool _stepSubmitted{false};
+    uint64_t _frame{0};     // of the last begin_frame()
+    uint64_t _nextStep{0};  // first frame the next defragmentation step may run in
+    ResidencyStats _stats{};
+};
@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <cmath>
+#include "vk_resolution.h"
+#include "vk_timer.h"
+
+void ResolutionController::init(const ResolutionSettings& settings, uint64_t budgetNs) {
+    _settings = settings;
+    _budget   = budgetNs;
+    _scale    = quantize(settings.maxScale);
+    _average  = 0;
+    _samples  = 0;
+    _below    = 0;
+    _changes  = 0;
+}
+
+float ResolutionController::quantize(float scale) const {
+    // rounded down to a step, the small epsilon keeps exact multiples where they are
+    float stepped = floorf(scale / _settings.step + 1e-3f) * _settings.step;
+    return std::min(std::max(stepped, _settings.minScale), _settings.maxScale);
+}
+
+void ResolutionController::change(float scale) {
+    _scale   = scale;
+    _average = 0;
+    _samples = 0;
+    _below   = 0;
+    _changes++;
+}
+
+bool ResolutionController::update(float frameScale, uint64_t gpuNs) {
+    // frames in flight when the scale changed say nothing about the new one
+    if (frameScale != _scale || gpuNs == 0) {
+        return false;
+    }
+    _average = smooth_ns(_average, gpuNs);
+    _samples++;
+
+    if (_average > _budget && _samples >= kMinSamples) {
+        // aim for the middle of the band between raiseBelow and the budget, at least a step down
+        float aim    = (1.f + _settings.raiseBelow) * 0.5f;
+        float scale  = quantize(_scale * sqrtf(aim * _budget / _average));
+        float lowest = quantize(_scale - _settings.step);
+        scale        = std::min(scale, lowest);
+        if (scale < _scale) {
+            change(scale);
+            return true;
+        }
+        return false;
+    }
+
+    _below = _average < _budget * _settings.raiseBelow ? _below + 1 : 0;
+    if (_below < _settings.settleFrames || _scale >= _settings.maxScale) {
+        return false;
+    }
+    // the largest scale predicted to stay under raiseBelow, so the next frames don't drop right back.
+    // The fixed cost of a frame doesn't grow with the pixels, the prediction errs on the safe side
+    float scale = quantize(_scale * sqrtf(_settings.raiseBelow * _budget / _average));
+    if (scale <= _scale) {
+        _below = 0;
+        return false;
+    }
+    change(scale);
+    return true;
+}
+
+VkExtent2D ResolutionController::render_extent(VkExtent2D extent) const {
+    VkExtent2D scaled;
+    scaled.width  = std::max(1u, (uint32_t)(extent.width * _scale + 0.5f));
+    scaled.height = std::max(1u, (uint32_t)(extent.height * _scale + 0.5f));
+    return scaled;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include "vk_types.h"
+
+struct ResolutionSettings {
+    uint64_t budgetNs{0};  // GPU time per frame to stay under, 0 for the refresh period
+    float minScale{0.5f};  // of the window width and height
+    float maxScale{1.f};
+    float step{0.05f};  // scales are multiples of it
+    // hysteresis: the scale drops as soon as the average is over budget, but only grows after the
+    // average stayed below raiseBelow of the budget for settleFrames frames in a row
+    float raiseBelow{0.8f};
+    uint32_t settleFrames{30};
+};
+
+// Render scale of dynamic resolution, fed the measured GPU time of every finished frame.
+// GPU time is taken to follow the pixel count, the square of the scale: over budget the scale drops
+// right away to where the average would land between raiseBelow and the budget, after settleFrames
+// under raiseBelow it grows to the largest step predicted to stay there.
+// Needs no device, synthetic timing traces drive it the same as the timestamp queries.
+class ResolutionController {
+   public:
+    // averages of fewer frames than this never drop the scale, a single slow frame is no trend
+    static constexpr uint32_t kMinSamples = 4;
+
+    void init(const ResolutionSettings& settings, uint64_t budgetNs);
+
+    // GPU time of a finished frame and the scale it was recorded with. Frames recorded before the
+    // last change are ignored. Returns true when the scale changed
+    bool update(float frameScale, uint64_t gpuNs);
+
+    float scale() const { return _scale; }
+    // extent scaled down to the current scale, at least 1x1
+    VkExtent2D render_extent(VkExtent2D extent) const;
+    uint64_t budget_ns() const { return _budget; }
+    // moving average of the GPU time at the current scale, 0 right after a change
+    uint64_t average_ns() const { return _average; }
+    uint32_t changes() const { return _changes; }
+
+   private:
+    float quantize(float scale) const;
+    void change(float scale);
+
+    ResolutionSettings _settings;
+    uint64_t _budget;
+    float _scale;
+    uint64_t _average{0};
+    uint32_t _samples{0};  // frames in _average
+    uint32_t _below{0};    // frames in a row under raiseBelow of the budget
+    uint32_t _changes{0};
+};
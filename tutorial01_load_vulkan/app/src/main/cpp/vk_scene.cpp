@@ -0,0 +1,111 @@
+#include <cmath>
+#include <sstream>
+#include <glm/gtc/matrix_transform.hpp>
+#include "vk_scene.h"
+
+glm::mat4 CameraPath::view(uint32_t frame) const {
+    if (kind == Kind::Fixed) {
+        return glm::translate(glm::mat4(1.f), -position);
+    }
+    float angle = glm::two_pi<float>() * (float)(frame % framesPerTurn) / (float)framesPerTurn;
+    glm::vec3 eye{radius * sinf(angle), height, radius * cosf(angle)};
+    return glm::lookAt(eye, glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+}
+
+bool parse_scene_script(const std::string& text, SceneConfig& outConfig, std::string& outError) {
+    SceneConfig config;
+    bool customMix = false;
+
+    std::istringstream lines(text);
+    std::string line;
+    for (int lineNumber = 1; std::getline(lines, line); lineNumber++) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        std::string key;
+        if (!(words >> key)) {
+            continue;
+        }
+
+        bool ok = true;
+        if (key == "objects") {
+            ok = (bool)(words >> config.objectCount);
+        } else if (key == "mesh") {
+            SceneMesh mesh;
+            ok = (bool)(words >> mesh.name >> mesh.weight) && mesh.weight > 0;
+            if (ok) {
+                if (!customMix) {
+                    config.meshes.clear();
+                    customMix = true;
+                }
+                config.meshes.push_back(mesh);
+            }
+        } else if (key == "center") {
+            ok = (bool)(words >> config.centerMesh);
+            if (config.centerMesh == "none") {
+                config.centerMesh.clear();
+            }
+        } else if (key == "occluder") {
+            SceneOccluder occluder;
+            ok = (bool)(words >> occluder.mesh >> occluder.position.x >> occluder.position.y >> occluder.position.z >> occluder.scale);
+            if (ok) {
+                config.occluders.push_back(occluder);
+            }
+        } else if (key == "materials") {
+            ok = (bool)(words >> config.materialCount);
+        } else if (key == "spacing") {
+            ok = (bool)(words >> config.spacing);
+        } else if (key == "scale") {
+            ok = (bool)(words >> config.scale);
+        } else if (key == "seed") {
+            ok = (bool)(words >> config.seed);
+        } else if (key == "camera") {
+            std::string kind;
+            words >> kind;
+            if (kind == "fixed") {
+                config.camera.kind = CameraPath::Kind::Fixed;
+                ok = (bool)(words >> config.camera.position.x >> config.camera.position.y >> config.camera.position.z);
+            } else if (kind == "orbit") {
+                config.camera.kind = CameraPath::Kind::Orbit;
+                ok = (bool)(words >> config.camera.radius >> config.camera.height >> config.camera.framesPerTurn) && config.camera.framesPerTurn > 0;
+            } else {
+                ok = false;
+            }
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            outError = "line " + std::to_string(lineNumber) + ": can't parse '" + line + "'";
+            return false;
+        }
+    }
+
+    if (config.meshes.empty() && config.objectCount > 0) {
+        outError = "no meshes for the scene objects";
+        return false;
+    }
+    outConfig = config;
+    return true;
+}
+
+std::vector<uint32_t> pick_scene_meshes(const SceneConfig& config) {
+    std::vector<uint32_t> picks(config.objectCount, 0);
+    uint32_t totalWeight = 0;
+    for (const SceneMesh& mesh : config.meshes) {
+        totalWeight += mesh.weight;
+    }
+    if (config.meshes.size() < 2) {
+        return picks;
+    }
+
+    SceneRandom random(config.seed);
+    for (uint32_t& pick : picks) {
+        uint32_t r = random.next() % totalWeight;
+        pick       = 0;
+        while (r >= config.meshes[pick].weight) {
+            r -= config.meshes[pick].weight;
+            pick++;
+        }
+    }
+    return picks;
+}
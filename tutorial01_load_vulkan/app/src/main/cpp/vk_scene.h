@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+struct SceneMesh {
+    std::string name;  // key in VulkanEngine::_meshes
+    uint32_t weight;   // relative share of the objects using it
+};
+
+// a large object placed on its own, e.g. a wall hiding part of the grid from the camera
+struct SceneOccluder {
+    std::string mesh;
+    glm::vec3 position;
+    float scale;
+};
+
+// deterministic camera path, the view depends on nothing but the frame number
+struct CameraPath {
+    enum class Kind { Fixed, Orbit };
+    Kind kind{Kind::Fixed};
+    glm::vec3 position{0.f, 6.f, 10.f};  // Fixed: eye, looking down -z
+    float radius{20.f};                  // Orbit: around the origin
+    float height{8.f};
+    uint32_t framesPerTurn{600};
+
+    glm::mat4 view(uint32_t frame) const;
+};
+
+// Objects of the generated scene: an optional centerpiece at the origin and occluders plus objectCount
+// objects on a square grid around it. Meshes are drawn from the weighted mix with a seeded generator and materials
+// cycle through the first materialCount scene materials, so the same config always yields the same scene.
+struct SceneConfig {
+    std::string centerMesh{"monkey"};  // empty for none
+    std::vector<SceneOccluder> occluders;
+    uint32_t objectCount{41 * 41};
+    std::vector<SceneMesh> meshes{{"triangle", 1}};
+    uint32_t materialCount{0};  // 0 uses every scene material
+    float spacing{1.f};
+    float scale{0.2f};
+    uint32_t seed{1};
+    CameraPath camera;
+};
+
+// Reads a scene script, one setting per line, '#' starts a comment:
+//   objects 5000
+//   mesh triangle 3      (repeatable, replaces the default mix)
+//   center monkey        ("center none" drops the centerpiece)
+//   occluder monkey 0 2 30 8   (repeatable, mesh, position and scale)
+//   materials 4
+//   spacing 1.0
+//   scale 0.2
+//   seed 7
+//   camera fixed 0 6 10
+//   camera orbit 20 8 600   (radius, height, frames per turn)
+// Returns false with a message naming the offending line.
+bool parse_scene_script(const std::string& text, SceneConfig& outConfig, std::string& outError);
+
+// small xorshift generator, std distributions differ between standard libraries
+struct SceneRandom {
+    uint32_t state;
+
+    explicit SceneRandom(uint32_t seed) : state(seed ? seed : 1) {}
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+};
+
+// index into config.meshes for every grid object, in grid order
+std::vector<uint32_t> pick_scene_meshes(const SceneConfig& config);
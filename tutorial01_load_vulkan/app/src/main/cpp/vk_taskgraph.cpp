@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <thread>
+#include "vk_taskgraph.h"
+
+namespace vkutil {
+
+uint32_t TaskGraph::add(const std::string& name, std::function<void()>&& task, std::initializer_list<uint32_t> dependencies) {
+    uint32_t index = (uint32_t)_tasks.size();
+    for (uint32_t dependency : dependencies) {
+        assert(dependency < index);
+        _tasks[dependency].dependents.push_back(index);
+    }
+    _tasks.push_back({name, std::move(task), dependencies, {}});
+    return index;
+}
+
+void TaskGraph::run(Clock* clock, uint32_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    _threadCount = std::max(1u, std::min(threadCount, (uint32_t)_tasks.size()));
+    _timings.assign(_tasks.size(), {});
+    uint64_t start = clock->now_ns();
+
+    if (_threadCount == 1) {
+        for (size_t i = 0; i < _tasks.size(); i++) {
+            _timings[i].startNs = clock->now_ns() - start;
+            _tasks[i].execute();
+            _timings[i].endNs = clock->now_ns() - start;
+        }
+        _elapsed = clock->now_ns() - start;
+        return;
+    }
+
+    std::vector<uint32_t> pending(_tasks.size());
+    // ready tasks, the earliest added first so the threads follow the serial order where they can
+    std::set<uint32_t> ready;
+    for (size_t i = 0; i < _tasks.size(); i++) {
+        pending[i] = (uint32_t)_tasks[i].dependencies.size();
+        if (pending[i] == 0) {
+            ready.insert((uint32_t)i);
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    size_t finished = 0;
+    auto worker     = [&](uint32_t thread) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [&]() { return !ready.empty() || finished == _tasks.size(); });
+            if (ready.empty()) {
+                return;
+            }
+            uint32_t task = *ready.begin();
+            ready.erase(ready.begin());
+            lock.unlock();
+
+            uint64_t taskStart = clock->now_ns() - start;
+            _tasks[task].execute();
+            uint64_t taskEnd = clock->now_ns() - start;
+
+            lock.lock();
+            _timings[task] = {thread, taskStart, taskEnd};
+            finished++;
+            for (uint32_t dependent : _tasks[task].dependents) {
+                if (--pending[dependent] == 0) {
+                    ready.insert(dependent);
+                }
+            }
+            wake.notify_all();
+        }
+    };
+
+    std::vector<std::thread> helpers;
+    for (uint32_t i = 1; i < _threadCount; i++) {
+        helpers.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto& helper : helpers) {
+        helper.join();
+    }
+    _elapsed = clock->now_ns() - start;
+}
+
+std::string TaskGraph::trace_json() const {
+    std::string json = "{\"traceEvents\": [";
+    char event[512];
+    for (size_t i = 0; i < _timings.size(); i++) {
+        const TaskTiming& timing = _timings[i];
+        snprintf(event, sizeof(event), "%s\n  {\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}", i ? "," : "", _tasks[i].name.c_str(), timing.thread, timing.startNs / 1e3, (timing.endNs - timing.startNs) / 1e3);
+        json += event;
+    }
+    json += "\n]}\n";
+    return json;
+}
+
+}  // namespace vkutil
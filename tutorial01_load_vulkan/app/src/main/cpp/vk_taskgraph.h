@@ -0,0 +1,53 @@
+#pragma once
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+#include "vk_timer.h"
+
+namespace vkutil {
+
+// when and where a task ran, relative to the start of TaskGraph::run
+struct TaskTiming {
+    uint32_t thread;  // 0 is the thread that called run()
+    uint64_t startNs;
+    uint64_t endNs;
+};
+
+// Dependency graph of one-off work, the engine runs its initialization through it.
+// A task starts as soon as every task it depends on has finished. Dependencies can only name
+// tasks added before, so the graph can't have cycles and the order of add() calls is always a
+// valid serial order: with one thread run() executes the tasks exactly in that order.
+class TaskGraph {
+   public:
+    // returns the task index
+    uint32_t add(const std::string& name, std::function<void()>&& task, std::initializer_list<uint32_t> dependencies = {});
+
+    // runs every task once on the calling thread plus threadCount - 1 helper threads, 0 uses one thread per core
+    void run(Clock* clock, uint32_t threadCount);
+
+    uint32_t task_count() const { return (uint32_t)_tasks.size(); }
+    const std::string& name(uint32_t task) const { return _tasks[task].name; }
+    // filled by run()
+    const TaskTiming& timing(uint32_t task) const { return _timings[task]; }
+    uint64_t elapsed_ns() const { return _elapsed; }
+    uint32_t thread_count() const { return _threadCount; }
+
+    // the last run in the chrome://tracing JSON format, one row per thread
+    std::string trace_json() const;
+
+   private:
+    struct Task {
+        std::string name;
+        std::function<void()> execute;
+        std::vector<uint32_t> dependencies;
+        std::vector<uint32_t> dependents;
+    };
+
+    std::vector<Task> _tasks;
+    std::vector<TaskTiming> _timings;
+    uint64_t _elapsed{0};
+    uint32_t _threadCount{0};
+};
+
+}  // namespace vkutil
@@ -0,0 +1,93 @@
+#include <cstring>
+#include <vector>
+#include "vk_textures.h"
+#include "vk_engine.h"
+#include "vk_init.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#include <stb/stb_image.h>
+
+bool vkutil::upload_image(VulkanEngine& engine, const void* pixels, uint32_t width, uint32_t height, Texture& outTexture) {
+    VkDeviceSize imageSize = (VkDeviceSize)width * height * 4;
+
+    // copy the pixels into a host visible staging buffer first
+    AllocatedBuffer stagingBuffer = engine.create_buffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
+
+    void* data;
+    vmaMapMemory(engine._allocator, stagingBuffer._allocation, &data);
+    memcpy(data, pixels, static_cast<size_t>(imageSize));
+    vmaUnmapMemory(engine._allocator, stagingBuffer._allocation);
+
+    VkExtent3D imageExtent      = {width, height, 1};
+    VkImageCreateInfo dimg_info = vkinit::image_create_info(kTextureFormat, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, imageExtent);
+
+    VmaAllocationCreateInfo dimg_allocinfo = {};
+    dimg_allocinfo.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
+    dimg_allocinfo.pUserData               = (void*)"Texture";
+
+    AllocatedImage newImage;
+    VK_CHECK(vmaCreateImage(engine._allocator, &dimg_info, &dimg_allocinfo, &newImage._image, &newImage._allocation, nullptr));
+
+    // the copy may run on the transfer queue, the graphics queue takes the image over in the layout
+    // the fragment shader reads
+    vkutil::QueueHandoff handoff;
+    handoff.images.push_back(vkinit::image_barrier(newImage._image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT));
+    handoff.srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    handoff.dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+    engine.immediate_submit([&](VkCommandBuffer cmd) {
+        // the image starts undefined, move it to a layout the copy can write to
+        VkImageMemoryBarrier toTransfer = vkinit::image_barrier(newImage._image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT);
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+        VkBufferImageCopy copyRegion               = {};
+        copyRegion.bufferOffset                    = 0;
+        copyRegion.bufferRowLength                 = 0;
+        copyRegion.bufferImageHeight               = 0;
+        copyRegion.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        copyRegion.imageSubresource.mipLevel       = 0;
+        copyRegion.imageSubresource.baseArrayLayer = 0;
+        copyRegion.imageSubresource.layerCount     = 1;
+        copyRegion.imageExtent                     = imageExtent;
+        vkCmdCopyBufferToImage(cmd, stagingBuffer._buffer, newImage._image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+    }, handoff);
+
+    vmaDestroyBuffer(engine._allocator, stagingBuffer._buffer, stagingBuffer._allocation);
+
+    VkImageViewCreateInfo view_info = vkinit::imageview_create_info(kTextureFormat, newImage._image, VK_IMAGE_ASPECT_COLOR_BIT);
+    VK_CHECK(vkCreateImageView(engine._device, &view_info, nullptr, &outTexture.imageView));
+
+    outTexture.image = newImage;
+    outTexture.slot  = 0;
+
+    VkDevice device    = engine._device;
+    VmaAllocator alloc = engine._allocator;
+    VkImageView view   = outTexture.imageView;
+    engine._mainDeletionQueue.push_function([=]() {
+        vkDestroyImageView(device, view, nullptr);
+        vmaDestroyImage(alloc, newImage._image, newImage._allocation);
+    });
+    return true;
+}
+
+bool vkutil::load_image_from_asset(VulkanEngine& engine, const char* file, Texture& outTexture) {
+    std::vector<char> fileContent;
+    if (!engine.read_asset(file, fileContent)) {
+        LOGE("Failed to open texture %s", file);
+        return false;
+    }
+
+    int texWidth, texHeight, texChannels;
+    stbi_uc* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(fileContent.data()), (int)fileContent.size(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+    if (!pixels) {
+        LOGE("Failed to decode texture %s", file);
+        return false;
+    }
+
+    bool uploaded = upload_image(engine, pixels, (uint32_t)texWidth, (uint32_t)texHeight, outTexture);
+    stbi_image_free(pixels);
+
+    LOGI("load_image_from_asset %s %dx%d", file, texWidth, texHeight);
+    return uploaded;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include "vk_types.h"
+
+class VulkanEngine;
+
+namespace vkutil {
+
+// format of every texture loaded through vkutil, 8 bit RGBA
+constexpr VkFormat kTextureFormat = VK_FORMAT_R8G8B8A8_SRGB;
+
+// uploads tightly packed RGBA8 pixels into a device local image that shaders can sample
+bool upload_image(VulkanEngine& engine, const void* pixels, uint32_t width, uint32_t height, Texture& outTexture);
+
+// decodes a png from the apk assets and uploads it with upload_image
+bool load_image_from_asset(VulkanEngine& engine, const char* file, Texture& outTexture);
+
+}  // namespace vkutil
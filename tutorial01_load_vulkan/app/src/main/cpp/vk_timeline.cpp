@@ -0,0 +1,130 @@
+#include <algorithm>
+#include "vk_timeline.h"
+#include "log.h"
+
+void vkutil::GpuTimeline::init(VkDevice device, PFN_vkGetSemaphoreCounterValueKHR getValue, PFN_vkWaitSemaphoresKHR wait) {
+    _device    = device;
+    _getValue  = getValue;
+    _wait      = wait;
+    _timeline  = getValue && wait;
+    _semaphore = VK_NULL_HANDLE;
+    _submitted = 0;
+    _reached   = 0;
+    if (!_timeline) {
+        return;
+    }
+
+    VkSemaphoreTypeCreateInfoKHR typeInfo = {};
+    typeInfo.sType                        = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+    typeInfo.semaphoreType                = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+    typeInfo.initialValue                 = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext                 = &typeInfo;
+    VK_CHECK(vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &_semaphore));
+}
+
+void vkutil::GpuTimeline::cleanup() {
+    _reached = _submitted;
+    collect();
+    for (auto& pending : _fences) {
+        _freeFences.push_back(pending.second);
+    }
+    _fences.clear();
+    for (VkFence fence : _freeFences) {
+        vkDestroyFence(_device, fence, nullptr);
+    }
+    _freeFences.clear();
+    if (_timeline) {
+        vkDestroySemaphore(_device, _semaphore, nullptr);
+    }
+}
+
+uint64_t vkutil::GpuTimeline::submit(VkQueue queue, const VkSubmitInfo& submit) {
+    uint64_t value = ++_submitted;
+    if (!_timeline) {
+        VkFence fence;
+        if (_freeFences.empty()) {
+            VkFenceCreateInfo fenceInfo = {};
+            fenceInfo.sType             = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            VK_CHECK(vkCreateFence(_device, &fenceInfo, nullptr, &fence));
+        } else {
+            fence = _freeFences.back();
+            _freeFences.pop_back();
+        }
+        VK_CHECK(vkQueueSubmit(queue, 1, &submit, fence));
+        _fences.push_back({value, fence});
+        return value;
+    }
+
+    // binary semaphores of the submit ignore their value, the timeline one goes last
+    std::vector<VkSemaphore> signals(submit.pSignalSemaphores, submit.pSignalSemaphores + submit.signalSemaphoreCount);
+    std::vector<uint64_t> values(submit.signalSemaphoreCount, 0);
+    signals.push_back(_semaphore);
+    values.push_back(value);
+
+    VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {};
+    timelineInfo.sType                            = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+    timelineInfo.pNext                            = submit.pNext;
+    timelineInfo.signalSemaphoreValueCount        = (uint32_t)values.size();
+    timelineInfo.pSignalSemaphoreValues           = values.data();
+
+    VkSubmitInfo timelineSubmit         = submit;
+    timelineSubmit.pNext                = &timelineInfo;
+    timelineSubmit.signalSemaphoreCount = (uint32_t)signals.size();
+    timelineSubmit.pSignalSemaphores    = signals.data();
+    VK_CHECK(vkQueueSubmit(queue, 1, &timelineSubmit, VK_NULL_HANDLE));
+    return value;
+}
+
+bool vkutil::GpuTimeline::reached(uint64_t value) {
+    if (value <= _reached) {
+        return true;
+    }
+    if (_timeline) {
+        VK_CHECK(_getValue(_device, _semaphore, &_reached));
+        return value <= _reached;
+    }
+    // fences of one queue signal in submit order, stop at the first that hasn't
+    while (!_fences.empty() && vkGetFenceStatus(_device, _fences.front().second) == VK_SUCCESS) {
+        _reached = _fences.front().first;
+        VK_CHECK(vkResetFences(_device, 1, &_fences.front().second));
+        _freeFences.push_back(_fences.front().second);
+        _fences.pop_front();
+    }
+    return value <= _reached;
+}
+
+void vkutil::GpuTimeline::wait(uint64_t value, uint64_t timeoutNs) {
+    if (reached(value)) {
+        return;
+    }
+    if (_timeline) {
+        VkSemaphoreWaitInfoKHR waitInfo = {};
+        waitInfo.sType                  = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+        waitInfo.semaphoreCount         = 1;
+        waitInfo.pSemaphores            = &_semaphore;
+        waitInfo.pValues                = &value;
+        VK_CHECK(_wait(_device, &waitInfo, timeoutNs));
+        _reached = std::max(_reached, value);
+        return;
+    }
+    // the fence of the first submit at or past value, reached() then frees every fence up to it
+    auto pending = std::find_if(_fences.begin(), _fences.end(), [=](const std::pair<uint64_t, VkFence>& entry) { return entry.first >= value; });
+    if (pending != _fences.end()) {
+        VK_CHECK(vkWaitForFences(_device, 1, &pending->second, true, timeoutNs));
+        reached(value);
+    }
+}
+
+void vkutil::GpuTimeline::retire(uint64_t value, std::function<void()>&& function) {
+    _retired.push_back({value, std::move(function)});
+}
+
+void vkutil::GpuTimeline::collect() {
+    while (!_retired.empty() && reached(_retired.front().first)) {
+        _retired.front().second();
+        _retired.pop_front();
+    }
+}
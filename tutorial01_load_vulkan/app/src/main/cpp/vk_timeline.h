@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "vk_types.h"
+
+namespace vkutil {
+
+// The progress of one queue as a value counting its submits: every submit through the timeline raises
+// it by one and the GPU reaches that value once the submit's commands are done. With
+// VK_KHR_timeline_semaphore (core in Vulkan 1.2) the value lives in a timeline semaphore, without it
+// every submit signals a fence of a small pool and the value is the last submit whose fence signaled.
+// Values the CPU saw reached are cached, asking about them again costs no driver call.
+class GpuTimeline {
+   public:
+    bool _timeline;  // timeline semaphore, false for the fence fallback
+
+    // getValue and wait are null without timeline semaphores
+    void init(VkDevice device, PFN_vkGetSemaphoreCounterValueKHR getValue, PFN_vkWaitSemaphoresKHR wait);
+    // runs what is still retired, the queue has to be idle
+    void cleanup();
+
+    // submits to the timeline's queue, adding the signal of the next value to submit's signal
+    // semaphores, and returns that value
+    uint64_t submit(VkQueue queue, const VkSubmitInfo& submit);
+    uint64_t submitted() const { return _submitted; }
+    // true once the GPU got to value, polls the driver only for values not seen reached yet
+    bool reached(uint64_t value);
+    // blocks until the GPU got to value, aborts after timeoutNs
+    void wait(uint64_t value, uint64_t timeoutNs = UINT64_MAX);
+
+    // runs function from collect() once the GPU got to value, for resources the commands up to it use
+    void retire(uint64_t value, std::function<void()>&& function);
+    // runs the retired functions whose value was reached, never waits
+    void collect();
+
+   private:
+    VkDevice _device;
+    PFN_vkGetSemaphoreCounterValueKHR _getValue;
+    PFN_vkWaitSemaphoresKHR _wait;
+    VkSemaphore _semaphore;
+    uint64_t _submitted;
+    uint64_t _reached;  // highest value known to be reached
+
+    // fence fallback: the fence of every submitted value not seen reached yet, oldest first
+    std::deque<std::pair<uint64_t, VkFence>> _fences;
+    std::vector<VkFence> _freeFences;
+
+    std::deque<std::pair<uint64_t, std::function<void()>>> _retired;  // in the order they were retired
+};
+
+}  // namespace vkutil
@@ -3,3 +3,20 @@
 //
 
 #include "vk_timer.h"
+#include <errno.h>
+#include <time.h>
+
+uint64_t SteadyClock::now_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void SteadyClock::sleep_until(uint64_t ns) {
+    timespec ts;
+    ts.tv_sec  = ns / 1000000000ull;
+    ts.tv_nsec = ns % 1000000000ull;
+    // retry when a signal wakes us up early
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
@@ -5,11 +5,44 @@
 #ifndef TUTORIAL01_LOAD_VULKAN_VK_TIMER_H
 #define TUTORIAL01_LOAD_VULKAN_VK_TIMER_H
 
+#include <cstdint>
 
-class vk_timer {
+// time source of the frame pacer, nanoseconds on CLOCK_MONOTONIC like the presentation timestamps
+class Clock {
+   public:
+    virtual ~Clock() = default;
 
+    virtual uint64_t now_ns() = 0;
+    virtual void sleep_until(uint64_t ns) = 0;
 };
 
-// 503988485264
-// 505474014352
+class SteadyClock : public Clock {
+   public:
+    uint64_t now_ns() override;
+    void sleep_until(uint64_t ns) override;
+};
+
+// manually driven clock, sleeping jumps straight to the deadline.
+// Lets pacing run deterministically, e.g. against a software ICD
+class FakeClock : public Clock {
+   public:
+    explicit FakeClock(uint64_t start = 0) : _now(start) {}
+
+    uint64_t now_ns() override { return _now; }
+    void sleep_until(uint64_t ns) override {
+        if (ns > _now) {
+            _now = ns;
+        }
+    }
+    void advance(uint64_t ns) { _now += ns; }
+
+   private:
+    uint64_t _now;
+};
+
+// exponential moving average of frame times over roughly the last 8 samples, the first sample starts it
+inline uint64_t smooth_ns(uint64_t average, uint64_t sample) {
+    return average == 0 ? sample : (average * 7 + sample) / 8;
+}
+
 #endif //TUTORIAL01_LOAD_VULKAN_VK_TIMER_H
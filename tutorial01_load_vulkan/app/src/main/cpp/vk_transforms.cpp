@@ -0,0 +1,58 @@
+#include <algorithm>
+#include <cassert>
+#include "vk_transforms.h"
+
+glm::mat4 Transform::matrix() const {
+    // translate * rotate * scale without the two full matrix products
+    glm::mat4 m = glm::mat4_cast(rotation);
+    m[0] *= scale.x;
+    m[1] *= scale.y;
+    m[2] *= scale.z;
+    m[3] = glm::vec4(translation, 1.f);
+    return m;
+}
+
+uint32_t TransformHierarchy::add(uint32_t parent, const Transform& local) {
+    uint32_t node = size();
+    assert(parent == kNoParent || parent < node);
+    _parents.push_back(parent);
+    _locals.push_back(local);
+    _worlds.push_back(glm::mat4{1.f});
+    _dirty.push_back(1);
+    _firstDirty = std::min(_firstDirty, node);
+    return node;
+}
+
+void TransformHierarchy::clear() {
+    _parents.clear();
+    _locals.clear();
+    _worlds.clear();
+    _dirty.clear();
+    _changed.clear();
+    _firstDirty = 0;
+}
+
+void TransformHierarchy::set_local(uint32_t node, const Transform& local) {
+    _locals[node] = local;
+    _dirty[node]  = 1;
+    _firstDirty   = std::min(_firstDirty, node);
+}
+
+void TransformHierarchy::update() {
+    _changed.clear();
+    uint32_t count = size();
+    for (uint32_t node = _firstDirty; node < count; node++) {
+        // the parent comes first, so its flag is final by now and passes down the whole subtree
+        uint32_t parent = _parents[node];
+        if (!_dirty[node] && (parent == kNoParent || !_dirty[parent])) {
+            continue;
+        }
+        _dirty[node]  = 1;
+        _worlds[node] = parent == kNoParent ? _locals[node].matrix() : _worlds[parent] * _locals[node].matrix();
+        _changed.push_back(node);
+    }
+    for (uint32_t node : _changed) {
+        _dirty[node] = 0;
+    }
+    _firstDirty = count;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// translation, rotation and scale of a node relative to its parent
+struct Transform {
+    glm::vec3 translation{0.f};
+    glm::quat rotation{1.f, 0.f, 0.f, 0.f};
+    glm::vec3 scale{1.f};
+
+    glm::mat4 matrix() const;
+};
+
+// Transform tree stored as flat arrays in topological order: a node's parent always has a smaller
+// index, so one pass from the front computes every world matrix after its parent's.
+// set_local() only flags a node, update() recomputes the flagged nodes and everything below them and
+// lists the nodes whose world matrix changed, so callers can upload just those.
+class TransformHierarchy {
+   public:
+    static constexpr uint32_t kNoParent = UINT32_MAX;
+
+    // parent must be kNoParent or an existing node, returns the node index
+    uint32_t add(uint32_t parent, const Transform& local);
+    void clear();
+
+    void set_local(uint32_t node, const Transform& local);
+    const Transform& local(uint32_t node) const { return _locals[node]; }
+    uint32_t parent(uint32_t node) const { return _parents[node]; }
+    // as of the last update()
+    const glm::mat4& world(uint32_t node) const { return _worlds[node]; }
+    uint32_t size() const { return (uint32_t)_parents.size(); }
+
+    // recomputes the world matrices of flagged nodes and their descendants
+    void update();
+    // nodes whose world matrix the last update() recomputed, ascending
+    const std::vector<uint32_t>& changed() const { return _changed; }
+
+   private:
+    std::vector<uint32_t> _parents;
+    std::vector<Transform> _locals;
+    std::vector<glm::mat4> _worlds;
+    std::vector<uint8_t> _dirty;
+    std::vector<uint32_t> _changed;
+    // nodes before it are all clean, update() starts there
+    uint32_t _firstDirty{0};
+};
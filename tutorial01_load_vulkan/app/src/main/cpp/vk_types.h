@@ -1,3 +1,23 @@
 #pragma once
+// the wrapper declares the Vulkan entry points as pointers, it has to come before anything including vulkan.h
+#include "vulkan_wrapper.h"
 #include "vma/vk_mem_alloc.h"
 
+// human readable name of a VkResult, used by VK_CHECK
+const char* VkResultString(VkResult err);
+
+struct AllocatedBuffer {
+    VkBuffer _buffer;
+    VmaAllocation _allocation;
+};
+
+struct AllocatedImage {
+    VkImage _image;
+    VmaAllocation _allocation;
+};
+
+struct Texture {
+    AllocatedImage image;
+    VkImageView imageView;
+    uint32_t slot;  // index of the texture in the bindless material table
+};
@@ -1,11 +1,34 @@
 #version 450
 
 layout (location = 0) in vec3 inColor;
+layout (location = 1) in vec2 inTexCoord;
+layout (location = 2) flat in uint inMaterial;
 
 layout (location = 0) out vec4 outFragColor;
 
+// size of the bindless texture array, set by the engine from the device limits
+layout (constant_id = 0) const int MAX_TEXTURES = 16;
+
+struct MaterialParams
+{
+	vec4 diffuse;	// rgb: Kd, a: alpha cutoff, 0 disables the alpha test
+	uvec4 textures;	// x: diffuse texture, y: alpha texture
+};
+
+layout (std430, set = 0, binding = 0) readonly buffer MaterialBuffer
+{
+	MaterialParams params[];
+} materials;
+
+layout (set = 0, binding = 1) uniform sampler2D textures[MAX_TEXTURES];
+
 void main() 
 {
-	outFragColor = vec4(inColor,1.0f);
+	// the material index comes from a push constant or the draw's instance, so it is uniform across the draw
+	MaterialParams material = materials.params[inMaterial];
+	vec4 albedo = texture(textures[material.textures.x], inTexCoord);
+	if (material.diffuse.a > 0.0f && texture(textures[material.textures.y], inTexCoord).r < material.diffuse.a) {
+		discard;
+	}
+	outFragColor = vec4(inColor * material.diffuse.rgb * albedo.rgb, 1.0f);
 }
-
@@ -3,18 +3,36 @@
 layout (location = 0) in vec3 vPosition;
 layout (location = 1) in vec3 vNormal;
 layout (location = 2) in vec3 vColor;
+layout (location = 3) in vec2 vTexCoord;
 
 layout (location = 0) out vec3 outColor;
+layout (location = 1) out vec2 outTexCoord;
+layout (location = 2) flat out uint outMaterial;
+
+// per-frame data, streamed through the frame allocator
+layout (set = 1, binding = 0) uniform CameraBuffer
+{
+	mat4 view;
+	mat4 proj;
+	mat4 viewproj;
+} cameraData;
+
+layout (std430, set = 1, binding = 1) readonly buffer ObjectBuffer
+{
+	mat4 model[];
+} objectBuffer;
 
 //push constants block
 layout (push_constant) uniform constants
 {
-	vec4 data;
-	mat4 render_matrix;
+	uvec4 data;
 } PushConstants;
 
 void main()
 {
-	gl_Position = PushConstants.render_matrix * vec4(vPosition, 1.0f);
+	mat4 modelMatrix = objectBuffer.model[gl_InstanceIndex];
+	gl_Position = cameraData.viewproj * modelMatrix * vec4(vPosition, 1.0f);
 	outColor = vColor;
-}
\ No newline at end of file
+	outTexCoord = vTexCoord;
+	outMaterial = PushConstants.data.x;
+}
@@ -0,0 +1,47 @@
+#version 450
+
+layout (location = 0) in vec3 vPosition;
+layout (location = 1) in vec3 vNormal;
+layout (location = 2) in vec3 vColor;
+layout (location = 3) in vec2 vTexCoord;
+
+layout (location = 0) out vec3 outColor;
+layout (location = 1) out vec2 outTexCoord;
+layout (location = 2) flat out uint outMaterial;
+
+// per-frame data, streamed through the frame allocator
+layout (set = 1, binding = 0) uniform CameraBuffer
+{
+	mat4 view;
+	mat4 proj;
+	mat4 viewproj;
+} cameraData;
+
+layout (std430, set = 1, binding = 1) readonly buffer ObjectBuffer
+{
+	mat4 model[];
+} objectBuffer;
+
+struct Instance
+{
+	vec4 sphere;
+	uint firstMeshlet;
+	uint meshletCount;
+	uint material;
+	uint pad;
+};
+
+layout (std430, set = 2, binding = 0) readonly buffer InstanceBuffer
+{
+	Instance instances[];
+} instanceBuffer;
+
+// mesh.vert for the indirect draws of cull.comp: firstInstance is the object, which also knows its material
+void main()
+{
+	mat4 modelMatrix = objectBuffer.model[gl_InstanceIndex];
+	gl_Position = cameraData.viewproj * modelMatrix * vec4(vPosition, 1.0f);
+	outColor = vColor;
+	outTexCoord = vTexCoord;
+	outMaterial = instanceBuffer.instances[gl_InstanceIndex].material;
+}
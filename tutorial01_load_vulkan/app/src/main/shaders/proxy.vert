@@ -0,0 +1,24 @@
+#version 450
+
+// bounding box proxy of an occlusion query, a cube from -1 to 1 without vertex buffer
+layout (push_constant) uniform constants
+{
+	mat4 transform;  // viewproj * box
+} PushConstants;
+
+// the corners are the bits of their number, x in bit 0, y in bit 1 and z in bit 2
+const int corners[36] = int[36](
+	0, 2, 1, 1, 2, 3,  // -z
+	4, 5, 6, 5, 7, 6,  // +z
+	0, 1, 4, 1, 5, 4,  // -y
+	2, 6, 3, 3, 6, 7,  // +y
+	0, 4, 2, 2, 4, 6,  // -x
+	1, 3, 5, 3, 7, 5   // +x
+);
+
+void main()
+{
+	int corner = corners[gl_VertexIndex];
+	vec3 position = vec3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1) * 2.0 - 1.0;
+	gl_Position = PushConstants.transform * vec4(position, 1.0);
+}
@@ -0,0 +1,21 @@
+#version 450
+
+// Stretches the part of the scene target dynamic resolution rendered to over the whole swapchain
+// image, bilinear. The target is allocated at full size, only its top left corner holds the frame
+layout (location = 0) in vec2 inUV;
+
+layout (location = 0) out vec4 outFragColor;
+
+layout (set = 0, binding = 0) uniform sampler2D scene;
+
+layout (push_constant) uniform constants
+{
+	vec2 scale;  // rendered size over target size
+	vec2 maxUV;  // center of the last rendered texel, the filter never reaches past it
+} PushConstants;
+
+void main()
+{
+	vec2 uv = min(inUV * PushConstants.scale, PushConstants.maxUV);
+	outFragColor = vec4(texture(scene, uv).rgb, 1.0);
+}